@@ -74,11 +74,19 @@ LOCAL_MODULE := SDL3_image
 LOCAL_SRC_FILES :=  		\
     src/IMG.c           	\
     src/IMG_ani.c               \
+    src/IMG_async.c             \
+    src/IMG_cache.c             \
+    src/IMG_diskcache.c         \
+    src/IMG_scratch.c           \
+    src/IMG_stats.c             \
+    src/IMG_progress.c          \
+    src/IMG_limits.c            \
     src/IMG_anim_encoder.c      \
     src/IMG_anim_decoder.c      \
     src/IMG_avif.c      	\
     src/IMG_bmp.c       	\
     src/IMG_gif.c       	\
+    src/IMG_io.c        	\
     src/IMG_jpg.c       	\
     src/IMG_jxl.c       	\
     src/IMG_lbm.c       	\
@@ -228,6 +228,237 @@ extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_Load_IO(SDL_IOStream *src, bool cl
  */
 extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadTyped_IO(SDL_IOStream *src, bool closeio, const char *type);
 
+/**
+ * Load an image from an SDL data source into an existing surface.
+ *
+ * This is useful when loading many images of the same size, for example
+ * tiles, into a pool of preallocated surfaces: no new surface is created for
+ * the decoded image.
+ *
+ * `dst` must have the same width and height as the image, which you can query
+ * with IMG_GetImageInfo_IO() if needed. It can have any pixel format that SDL
+ * can convert to, except an indexed format that doesn't match the image. If
+ * the decoder can output the pixel format of `dst`, either because it's the
+ * format it produces by default (see IMG_PROP_INFO_PIXEL_FORMAT_NUMBER) or
+ * because it can be requested (see IMG_PROP_LOAD_PIXEL_FORMAT_NUMBER), AVIF,
+ * TGA and WEBP images, and JPG and PNG images when SDL_image is built with
+ * libjpeg and libpng, are decoded directly into the pixels of `dst`.
+ * Otherwise, the image is loaded as usual and then converted into `dst`.
+ *
+ * If the image has a palette or a colorkey and is decoded in its native
+ * format, they are also set on `dst`.
+ *
+ * If this function fails, the contents of `dst` are undefined.
+ *
+ * If `closeio` is true, `src` will be closed before returning, whether this
+ * function succeeds or not. SDL_image reads everything it needs from `src`
+ * during this call in any case.
+ *
+ * There is also IMG_LoadTypedInto_IO(), which is equivalent to this function
+ * except a file extension (like "BMP", "JPG", etc) can be specified, in case
+ * SDL_image cannot autodetect the file format.
+ *
+ * \param src an SDL_IOStream that data will be read from.
+ * \param closeio true to close/free the SDL_IOStream before returning, false
+ *                to leave it open.
+ * \param dst the surface that will receive the image.
+ * \returns true on success or false on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_GetImageInfo_IO
+ * \sa IMG_Load_IO
+ * \sa IMG_LoadTypedInto_IO
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_LoadInto_IO(SDL_IOStream *src, bool closeio, SDL_Surface *dst);
+
+/**
+ * Load an image from an SDL data source into an existing surface, optionally
+ * specifying the type.
+ *
+ * This works like IMG_LoadInto_IO(), see its documentation for the
+ * requirements on `dst`.
+ *
+ * Even though this function accepts a file type, SDL_image may still try
+ * other decoders that are capable of detecting file type from the contents of
+ * the image data, but may rely on the caller-provided type string for formats
+ * that it cannot autodetect. If `type` is NULL, SDL_image will rely solely on
+ * its ability to guess the format.
+ *
+ * If `closeio` is true, `src` will be closed before returning, whether this
+ * function succeeds or not. SDL_image reads everything it needs from `src`
+ * during this call in any case.
+ *
+ * \param src an SDL_IOStream that data will be read from.
+ * \param closeio true to close/free the SDL_IOStream before returning, false
+ *                to leave it open.
+ * \param type a filename extension that represent this data ("BMP", "GIF",
+ *             "PNG", etc).
+ * \param dst the surface that will receive the image.
+ * \returns true on success or false on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_LoadInto_IO
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_LoadTypedInto_IO(SDL_IOStream *src, bool closeio, const char *type, SDL_Surface *dst);
+
+/**
+ * A callback that reports the progress of a load and can cancel it.
+ *
+ * This is called on the thread doing the load, at points where the decoder
+ * can stop: between rows, strips, tiles or layers of the image. It is called
+ * at most about a thousand times for an image, and only by the decoders
+ * that can stop early: GIF, JPG, PNG, SVG, TIF and XCF.
+ *
+ * \param userdata the pointer set with the callback.
+ * \param progress an estimate of how much of the image or the animation
+ *                 frame has been decoded, from 0.0 to 1.0.
+ * \returns true to continue loading, false to cancel the load.
+ *
+ * \since This datatype is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_LoadWithProperties
+ * \sa IMG_CreateAnimationDecoderWithProperties
+ */
+typedef bool (SDLCALL *IMG_LoadProgressCallback)(void *userdata, float progress);
+
+/**
+ * An enum representing how a load with IMG_LoadWithProperties() ended.
+ *
+ * \since This enum is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_PROP_LOAD_STATUS_NUMBER
+ */
+typedef enum IMG_LoadStatus
+{
+    IMG_LOAD_STATUS_OK,             /**< The image was loaded */
+    IMG_LOAD_STATUS_FAILED,         /**< The load failed, call SDL_GetError() for more information */
+    IMG_LOAD_STATUS_CANCELLED,      /**< The load was cancelled by the progress callback */
+    IMG_LOAD_STATUS_TIMED_OUT       /**< The load was cancelled because the deadline passed */
+} IMG_LoadStatus;
+
+/**
+ * Load an image with the specified properties.
+ *
+ * These are the supported properties:
+ *
+ * - `IMG_PROP_LOAD_FILENAME_STRING`: the file to load, if an SDL_IOStream
+ *   isn't being used. This is required if `IMG_PROP_LOAD_IOSTREAM_POINTER`
+ *   isn't set.
+ * - `IMG_PROP_LOAD_IOSTREAM_POINTER`: an SDL_IOStream containing the image.
+ *   This is required if `IMG_PROP_LOAD_FILENAME_STRING` isn't set.
+ * - `IMG_PROP_LOAD_IOSTREAM_AUTOCLOSE_BOOLEAN`: true if the SDL_IOStream
+ *   should be closed before returning, whether this function succeeds or not.
+ * - `IMG_PROP_LOAD_TYPE_STRING`: the input file type, e.g. "png", defaults to
+ *   the file extension if `IMG_PROP_LOAD_FILENAME_STRING` is set. SDL_image
+ *   may still detect the type from the image data, as with
+ *   IMG_LoadTyped_IO().
+ * - `IMG_PROP_LOAD_PIXEL_FORMAT_NUMBER`: the SDL_PixelFormat of the returned
+ *   surface. Where the decoding library can output this format directly, no
+ *   conversion is done after decoding: this is the case for 8-bit RGB
+ *   formats (like SDL_PIXELFORMAT_RGB24, SDL_PIXELFORMAT_RGBA32 or
+ *   SDL_PIXELFORMAT_BGRA32) with libjpeg-turbo, libpng, libavif and libwebp.
+ *   Otherwise the image is converted with SDL_ConvertSurface(). Defaults to
+ *   the format chosen by the decoder, see IMG_LoadTyped_IO().
+ * - `IMG_PROP_LOAD_SCALE_DENOMINATOR_NUMBER`: load the image at 1/N of its
+ *   size, rounding up, e.g. 2 for half size. Defaults to 1.
+ * - `IMG_PROP_LOAD_MAX_WIDTH_NUMBER`: the maximum width of the returned
+ *   surface. Larger images are reduced to fit, keeping their aspect ratio.
+ *   Defaults to 0, no limit.
+ * - `IMG_PROP_LOAD_MAX_HEIGHT_NUMBER`: the maximum height of the returned
+ *   surface. Larger images are reduced to fit, keeping their aspect ratio.
+ *   Defaults to 0, no limit.
+ * - `IMG_PROP_LOAD_PROGRESS_CALLBACK_POINTER`: an IMG_LoadProgressCallback
+ *   called while the image is decoded, which can cancel the load by
+ *   returning false.
+ * - `IMG_PROP_LOAD_PROGRESS_USERDATA_POINTER`: the pointer passed to the
+ *   progress callback.
+ * - `IMG_PROP_LOAD_DEADLINE_NUMBER`: a time, as returned by SDL_GetTicksNS(),
+ *   after which the load is cancelled. It is checked every time the decoder
+ *   reports progress, even when the progress callback isn't called. Defaults
+ *   to 0, no deadline.
+ * - `IMG_PROP_LOAD_MAX_PIXELS_NUMBER`: the maximum number of pixels in the
+ *   decoded image, the load fails if the image header declares more.
+ *   Defaults to the value of IMG_HINT_MAX_PIXELS.
+ * - `IMG_PROP_LOAD_MAX_BYTES_NUMBER`: the maximum number of bytes in the
+ *   decoded image. Defaults to the value of IMG_HINT_MAX_IMAGE_BYTES.
+ *
+ * If the load is cancelled by the progress callback or the deadline, the
+ * decoder stops at the next point where it checks for it, and this function
+ * returns NULL with the error set to "Load cancelled". Decoders that can't
+ * stop early finish decoding the image, which is then discarded.
+ *
+ * Before returning, this function sets `IMG_PROP_LOAD_STATUS_NUMBER` in
+ * `props` to an IMG_LoadStatus value, which tells a cancelled or timed out
+ * load apart from one that failed.
+ *
+ * Images are never enlarged. Where the decoding library can decode at a
+ * reduced size, the full size image is never decoded: libjpeg decodes at
+ * 1/2, 1/4 or 1/8 of the size and libwebp and SVG at any size. Otherwise the
+ * image is reduced with a box filter after decoding.
+ *
+ * When done with the returned surface, the app should dispose of it with a
+ * call to SDL_DestroySurface().
+ *
+ * \param props the properties of the image to load.
+ * \returns a new SDL surface, or NULL on error.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_Load
+ * \sa IMG_LoadTyped_IO
+ */
+extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadWithProperties(SDL_PropertiesID props);
+
+#define IMG_PROP_LOAD_FILENAME_STRING               "SDL_image.load.filename"
+#define IMG_PROP_LOAD_IOSTREAM_POINTER              "SDL_image.load.iostream"
+#define IMG_PROP_LOAD_IOSTREAM_AUTOCLOSE_BOOLEAN    "SDL_image.load.iostream.autoclose"
+#define IMG_PROP_LOAD_TYPE_STRING                   "SDL_image.load.type"
+#define IMG_PROP_LOAD_PIXEL_FORMAT_NUMBER           "SDL_image.load.pixel_format"
+#define IMG_PROP_LOAD_SCALE_DENOMINATOR_NUMBER      "SDL_image.load.scale_denominator"
+#define IMG_PROP_LOAD_MAX_WIDTH_NUMBER              "SDL_image.load.max_width"
+#define IMG_PROP_LOAD_MAX_HEIGHT_NUMBER             "SDL_image.load.max_height"
+#define IMG_PROP_LOAD_PROGRESS_CALLBACK_POINTER     "SDL_image.load.progress_callback"
+#define IMG_PROP_LOAD_PROGRESS_USERDATA_POINTER     "SDL_image.load.progress_userdata"
+#define IMG_PROP_LOAD_DEADLINE_NUMBER               "SDL_image.load.deadline"
+#define IMG_PROP_LOAD_MAX_PIXELS_NUMBER             "SDL_image.load.max_pixels"
+#define IMG_PROP_LOAD_MAX_BYTES_NUMBER              "SDL_image.load.max_bytes"
+#define IMG_PROP_LOAD_STATUS_NUMBER                 "SDL_image.load.status"
+
+/**
+ * Load a region of an image from an SDL data source into a software surface.
+ *
+ * This works like IMG_Load_IO(), but returns only the part of the image
+ * inside `rect`, clipped to the image bounds. Where the decoding library
+ * supports it, the rest of the image is not decoded, so the cost is
+ * proportional to the size of the region rather than the size of the image:
+ * this is the case with libjpeg-turbo, libpng (for non-interlaced images),
+ * libtiff and libwebp. Other formats are decoded in full and then cropped.
+ *
+ * If `closeio` is true, `src` will be closed before returning, whether this
+ * function succeeds or not. SDL_image reads everything it needs from `src`
+ * during this call in any case.
+ *
+ * When done with the returned surface, the app should dispose of it with a
+ * call to SDL_DestroySurface().
+ *
+ * \param src an SDL_IOStream that data will be read from.
+ * \param closeio true to close/free the SDL_IOStream before returning, false
+ *                to leave it open.
+ * \param rect the region of the image to load, in pixels.
+ * \returns a new SDL surface, or NULL on error, e.g. if `rect` is outside of
+ *          the image.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_GetImageInfo_IO
+ * \sa IMG_Load_IO
+ */
+extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadRegion_IO(SDL_IOStream *src, bool closeio, const SDL_Rect *rect);
+
 /**
  * Load an image from a filesystem path into a GPU texture.
  *
@@ -363,6 +594,770 @@ extern SDL_DECLSPEC SDL_Texture * SDLCALL IMG_LoadTexture_IO(SDL_Renderer *rende
  */
 extern SDL_DECLSPEC SDL_Texture * SDLCALL IMG_LoadTextureTyped_IO(SDL_Renderer *renderer, SDL_IOStream *src, bool closeio, const char *type);
 
+/**
+ * An identifier for an asynchronous image load.
+ *
+ * Valid IDs are never 0.
+ *
+ * \since This datatype is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_LoadAsync
+ * \sa IMG_CancelLoad
+ */
+typedef Uint32 IMG_LoadID;
+
+/**
+ * A callback that receives the result of an asynchronous image load.
+ *
+ * This is called on one of SDL_image's worker threads, as soon as the image
+ * has been decoded. The callback takes ownership of `surface` and should
+ * dispose of it with a call to SDL_DestroySurface().
+ *
+ * \param userdata the pointer passed to IMG_LoadAsync() or
+ *                 IMG_LoadAsync_IO().
+ * \param id the ID of the load.
+ * \param surface the loaded image, or NULL if loading failed.
+ * \param error NULL if the image was loaded, otherwise a message describing
+ *              why loading failed.
+ *
+ * \since This datatype is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_LoadAsync
+ */
+typedef void (SDLCALL *IMG_LoadCallback)(void *userdata, IMG_LoadID id, SDL_Surface *surface, const char *error);
+
+/**
+ * A callback that receives the result of an asynchronous texture load.
+ *
+ * This is called on the main thread, see SDL_RunOnMainThread(). The callback
+ * takes ownership of `texture`.
+ *
+ * \param userdata the pointer passed to IMG_LoadTextureAsync().
+ * \param id the ID of the load.
+ * \param texture the loaded texture, or NULL if loading failed.
+ * \param error NULL if the texture was created, otherwise a message
+ *              describing why loading failed.
+ *
+ * \since This datatype is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_LoadTextureAsync
+ */
+typedef void (SDLCALL *IMG_LoadTextureCallback)(void *userdata, IMG_LoadID id, SDL_Texture *texture, const char *error);
+
+/**
+ * Load an image from a filesystem path on a worker thread.
+ *
+ * The image is loaded like IMG_Load(), on a pool of threads managed by
+ * SDL_image, and this function returns immediately.
+ *
+ * If `callback` is not NULL, the result is passed to it on the worker
+ * thread. Otherwise an event of the type returned by IMG_GetLoadEventType()
+ * is pushed to the event queue, with `user.code` set to the ID of the load,
+ * `user.data1` set to the loaded surface, or NULL if loading failed, and
+ * `user.data2` set to `userdata`. The app takes ownership of the surface in
+ * the event.
+ *
+ * \param file a path on the filesystem to load an image from.
+ * \param callback a function to call with the result, may be NULL.
+ * \param userdata a pointer that is passed to `callback`.
+ * \returns the ID of the load, which can be passed to IMG_CancelLoad(), or 0
+ *          on failure; call SDL_GetError() for more information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_CancelLoad
+ * \sa IMG_GetLoadEventType
+ * \sa IMG_LoadAsync_IO
+ * \sa IMG_LoadTextureAsync
+ * \sa IMG_QuitAsyncLoad
+ */
+extern SDL_DECLSPEC IMG_LoadID SDLCALL IMG_LoadAsync(const char *file, IMG_LoadCallback callback, void *userdata);
+
+/**
+ * Load an image from an SDL data source on a worker thread.
+ *
+ * This works like IMG_LoadAsync(), but reads the image with IMG_Load_IO().
+ * The app must not use `src` after calling this function, unless `closeio`
+ * is false and the result of the load has been delivered.
+ *
+ * If `closeio` is true, `src` will be closed when the load is finished or
+ * cancelled, or before returning if this function fails.
+ *
+ * \param src an SDL_IOStream that data will be read from.
+ * \param closeio true to close/free the SDL_IOStream when done, false to
+ *                leave it open.
+ * \param callback a function to call with the result, may be NULL.
+ * \param userdata a pointer that is passed to `callback`.
+ * \returns the ID of the load, which can be passed to IMG_CancelLoad(), or 0
+ *          on failure; call SDL_GetError() for more information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_CancelLoad
+ * \sa IMG_LoadAsync
+ */
+extern SDL_DECLSPEC IMG_LoadID SDLCALL IMG_LoadAsync_IO(SDL_IOStream *src, bool closeio, IMG_LoadCallback callback, void *userdata);
+
+/**
+ * Load an image from a filesystem path into a GPU texture, decoding it on a
+ * worker thread.
+ *
+ * The image is decoded like IMG_LoadAsync(), then the texture is created on
+ * the main thread with SDL_CreateTextureFromSurface() and passed to
+ * `callback`. The main thread has to pump events for this to happen, see
+ * SDL_RunOnMainThread().
+ *
+ * \param renderer the SDL_Renderer to use to create the texture.
+ * \param file a path on the filesystem to load an image from.
+ * \param callback a function to call on the main thread with the result.
+ * \param userdata a pointer that is passed to `callback`.
+ * \returns the ID of the load, which can be passed to IMG_CancelLoad(), or 0
+ *          on failure; call SDL_GetError() for more information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_CancelLoad
+ * \sa IMG_LoadAsync
+ * \sa IMG_LoadTexture
+ */
+extern SDL_DECLSPEC IMG_LoadID SDLCALL IMG_LoadTextureAsync(SDL_Renderer *renderer, const char *file, IMG_LoadTextureCallback callback, void *userdata);
+
+/**
+ * Cancel an asynchronous image load.
+ *
+ * If this function succeeds, the result of the load is never delivered. A
+ * load that is already being decoded stops at the next point where its
+ * decoder can stop, see IMG_LoadProgressCallback, or runs to completion on
+ * its worker thread if the decoder can't stop early. Either way the image is
+ * discarded.
+ *
+ * \param id the ID of the load to cancel.
+ * \returns true on success or false if the load is unknown or its result
+ *          has already been delivered; call SDL_GetError() for more
+ *          information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_LoadAsync
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_CancelLoad(IMG_LoadID id);
+
+/**
+ * Get the type of the events pushed by asynchronous loads without a
+ * callback.
+ *
+ * \returns the event type, or 0 on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_LoadAsync
+ */
+extern SDL_DECLSPEC Uint32 SDLCALL IMG_GetLoadEventType(void);
+
+/**
+ * Stop the worker threads used for asynchronous loads.
+ *
+ * Loads that haven't started yet are cancelled, and the results of loads
+ * that are being decoded are discarded, as if by IMG_CancelLoad(). This
+ * function waits until every worker thread has exited, and then frees the
+ * resources used for asynchronous loading, along with the scratch memory
+ * kept by the calling thread, see IMG_HINT_SCRATCH_KEEP_SIZE.
+ *
+ * Worker threads exit by themselves after being idle for a while, so this
+ * only needs to be called before the app quits or unloads SDL_image. Calling
+ * IMG_LoadAsync() or a similar function afterwards starts new threads.
+ *
+ * \threadsafety This function must not be called from a load callback, or
+ *               while other threads are starting asynchronous loads.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_CancelLoad
+ * \sa IMG_LoadAsync
+ */
+extern SDL_DECLSPEC void SDLCALL IMG_QuitAsyncLoad(void);
+
+/**
+ * Load many image files in parallel.
+ *
+ * The files are spread across `threads` worker threads, the calling thread
+ * being one of them. Each worker takes the next file that hasn't been
+ * started yet as soon as it's done with the previous one, so a few large
+ * images don't leave the other workers idle. Files are read in the
+ * background while the previous file is decoded.
+ *
+ * Each file is loaded as if by IMG_Load(). When this function returns,
+ * `out[i]` holds the image loaded from `files[i]`, or NULL if that file
+ * couldn't be loaded. If `errors` isn't NULL, `errors[i]` is set to a copy
+ * of the error message for each file that failed, and NULL for the others.
+ *
+ * When done with the returned surfaces, the app should dispose of them with
+ * calls to SDL_DestroySurface(), and free the error messages with SDL_free().
+ *
+ * \param files an array of `count` image file paths.
+ * \param count the number of files to load.
+ * \param out an array of `count` surface pointers, filled in with the loaded
+ *            images.
+ * \param threads the number of threads to use, or 0 to use one per CPU core.
+ * \param errors an array of `count` strings filled in with the error of each
+ *               file that couldn't be loaded, may be NULL.
+ * \returns true if every file was loaded or false if any of them failed;
+ *          call SDL_GetError() for more information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_Load
+ * \sa IMG_LoadAsync
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_LoadBatch(const char **files, int count, SDL_Surface **out, int threads, char **errors);
+
+/**
+ * A cache of decoded images.
+ *
+ * \since This struct is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_CreateCache
+ * \sa IMG_LoadCached
+ */
+typedef struct IMG_Cache IMG_Cache;
+
+/**
+ * Statistics about an image cache.
+ *
+ * \since This struct is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_GetCacheStats
+ */
+typedef struct IMG_CacheStats
+{
+    Uint64 hits;        /**< The number of loads that were served from the cache */
+    Uint64 misses;      /**< The number of loads that had to decode the image */
+    Uint64 evictions;   /**< The number of images dropped to stay within the budget */
+    int count;          /**< The number of images in the cache */
+    size_t bytes;       /**< The size of the pixels of the images in the cache */
+} IMG_CacheStats;
+
+/**
+ * Create a cache of decoded images.
+ *
+ * The cache keeps the images loaded with IMG_LoadCached() and
+ * IMG_LoadCached_IO(), so loading the same image again doesn't read and
+ * decode it again. When the pixels of the cached images take more than
+ * `byte_budget` bytes, the least recently used images are dropped from the
+ * cache.
+ *
+ * When done with the cache, the app should dispose of it with a call to
+ * IMG_DestroyCache().
+ *
+ * \param byte_budget the maximum size of the pixels kept in the cache.
+ * \returns a new cache, or NULL on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_DestroyCache
+ * \sa IMG_LoadCached
+ */
+extern SDL_DECLSPEC IMG_Cache * SDLCALL IMG_CreateCache(size_t byte_budget);
+
+/**
+ * Load an image from a filesystem path through a cache.
+ *
+ * Images are cached by path, along with the size and modification time of
+ * the file, so a file that changed on disk is loaded again. If several
+ * threads load the same file at once, it's decoded only once and they all
+ * get the same image.
+ *
+ * The returned surface is shared with the cache and other callers, so it
+ * must not be modified. When done with it, the app should release it with a
+ * call to IMG_ReleaseCachedSurface().
+ *
+ * \param cache the cache to use.
+ * \param file a path on the filesystem to load an image from.
+ * \returns a surface, or NULL on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_CreateCache
+ * \sa IMG_LoadCached_IO
+ * \sa IMG_ReleaseCachedSurface
+ */
+extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadCached(IMG_Cache *cache, const char *file);
+
+/**
+ * Load an image from an SDL data source through a cache.
+ *
+ * This works like IMG_LoadCached(), but the image is cached under `key`,
+ * which is chosen by the app. `src` is only read if there's no image with
+ * that key in the cache yet.
+ *
+ * If `closeio` is true, `src` will be closed before returning, whether this
+ * function succeeds or not.
+ *
+ * \param cache the cache to use.
+ * \param key a string that identifies the image in the cache.
+ * \param src an SDL_IOStream that data will be read from.
+ * \param closeio true to close/free the SDL_IOStream before returning, false
+ *                to leave it open.
+ * \returns a surface, or NULL on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_LoadCached
+ * \sa IMG_ReleaseCachedSurface
+ */
+extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadCached_IO(IMG_Cache *cache, const char *key, SDL_IOStream *src, bool closeio);
+
+/**
+ * Release a surface returned by IMG_LoadCached() or IMG_LoadCached_IO().
+ *
+ * The reference count of SDL surfaces isn't atomic, so cached surfaces
+ * should be released with this function rather than SDL_DestroySurface(),
+ * which could race with the cache dropping the same surface on another
+ * thread. The surface may be released after the cache is destroyed.
+ *
+ * \param surface the surface to release, may be NULL.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_LoadCached
+ */
+extern SDL_DECLSPEC void SDLCALL IMG_ReleaseCachedSurface(SDL_Surface *surface);
+
+/**
+ * Get statistics about an image cache.
+ *
+ * \param cache the cache to query.
+ * \param stats a pointer filled in with the statistics of the cache.
+ * \returns true on success or false on failure; call SDL_GetError() for
+ *          more information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_CreateCache
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_GetCacheStats(IMG_Cache *cache, IMG_CacheStats *stats);
+
+/**
+ * Drop all the images from an image cache.
+ *
+ * Surfaces that are still in use by the app stay valid until they're
+ * released. Images that are being loaded are not dropped.
+ *
+ * \param cache the cache to clear.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_CreateCache
+ */
+extern SDL_DECLSPEC void SDLCALL IMG_ClearCache(IMG_Cache *cache);
+
+/**
+ * Destroy an image cache.
+ *
+ * Surfaces that are still in use by the app stay valid until they're
+ * released. The cache must not be in use by other threads when it's
+ * destroyed.
+ *
+ * \param cache the cache to destroy, may be NULL.
+ *
+ * \threadsafety Do not call this function while other threads are using
+ *               the cache.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_CreateCache
+ */
+extern SDL_DECLSPEC void SDLCALL IMG_DestroyCache(IMG_Cache *cache);
+
+/**
+ * Set the directory where decoded images are cached between runs.
+ *
+ * When a directory is set, each image loaded with IMG_Load(),
+ * IMG_Load_IO() or IMG_LoadTyped_IO() is stored there as raw pixels,
+ * keyed by a hash of the image data. Loading the same data again maps the
+ * stored pixels into memory instead of decoding the image.
+ *
+ * The data source is read into memory to be hashed, so this is best suited
+ * to images that are expensive to decode. Images with extra data attached,
+ * like alternate images or surface properties, are not cached.
+ *
+ * The cache is never pruned automatically, see IMG_PruneDiskCache(). Loading
+ * an image from the cache updates the modification time of its file, so
+ * the images that are still in use are kept.
+ *
+ * \param path the directory to store the cache in, which is created if
+ *             needed, or NULL to stop caching images.
+ * \returns true on success or false on failure; call SDL_GetError() for
+ *          more information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_PruneDiskCache
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_SetDiskCacheDirectory(const char *path);
+
+/**
+ * Remove images from the cache directory until it fits in a given size.
+ *
+ * The images that were used the longest time ago are removed first.
+ * Temporary files left behind by a process that stopped while it was
+ * storing an image are removed too, once they are an hour old.
+ *
+ * \param max_bytes the maximum size of the cached images, 0 to remove all
+ *                  of them.
+ * \returns true on success or false on failure; call SDL_GetError() for
+ *          more information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_SetDiskCacheDirectory
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_PruneDiskCache(Uint64 max_bytes);
+
+/**
+ * A function that allocates scratch memory for SDL_image.
+ *
+ * \param userdata the pointer passed to IMG_SetScratchAllocator().
+ * \param size the number of bytes to allocate.
+ * \returns a pointer to the memory, aligned for any type, or NULL on
+ *          failure.
+ *
+ * \threadsafety This may be called on any thread that loads or saves
+ *               images.
+ *
+ * \since This datatype is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_SetScratchAllocator
+ */
+typedef void *(SDLCALL *IMG_ScratchAllocFunc)(void *userdata, size_t size);
+
+/**
+ * A function that frees memory returned by an IMG_ScratchAllocFunc.
+ *
+ * \param userdata the pointer passed to IMG_SetScratchAllocator().
+ * \param mem the memory to free.
+ *
+ * \threadsafety This may be called on any thread that loads or saves
+ *               images.
+ *
+ * \since This datatype is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_SetScratchAllocator
+ */
+typedef void (SDLCALL *IMG_ScratchFreeFunc)(void *userdata, void *mem);
+
+/**
+ * Set the allocator for the temporary memory used by decoders and encoders.
+ *
+ * SDL_image allocates the short-lived buffers it needs while loading or
+ * saving an image from large scratch blocks, which are all released when
+ * the image is done, or when an animation frame is done. By default the
+ * blocks come from SDL_malloc(), and each thread keeps one block around for
+ * the next image, see IMG_HINT_SCRATCH_KEEP_SIZE.
+ *
+ * An app that decodes on several threads can use this function to supply
+ * blocks from its own per-thread arenas. A block is usually freed on the
+ * thread that allocated it, but the blocks of an animation decoder or
+ * encoder are freed on the thread that closes it.
+ *
+ * Blocks that were allocated before this function is called are still freed
+ * with the function they were allocated with.
+ *
+ * \param alloc_func the function that allocates blocks, or NULL to use the
+ *                   default allocator.
+ * \param free_func the function that frees blocks, or NULL to use the
+ *                  default allocator.
+ * \param userdata a pointer that is passed to `alloc_func` and `free_func`.
+ * \returns true on success or false on failure; call SDL_GetError() for
+ *          more information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_SetScratchAllocator(IMG_ScratchAllocFunc alloc_func, IMG_ScratchFreeFunc free_func, void *userdata);
+
+/**
+ * A variable that sets how much scratch memory each thread keeps between
+ * loads.
+ *
+ * When the default allocator is used, each thread that loads an image keeps
+ * its largest scratch block up to this size for the next load, instead of
+ * freeing it. The block is freed when the thread exits, for threads created
+ * with SDL_CreateThread(), or when SDL_CleanupTLS() is called on the thread.
+ * IMG_QuitAsyncLoad() frees the block kept by the calling thread.
+ *
+ * The variable can be set to a size in bytes, or to "0" to free every block
+ * right away. The default is 1048576, one megabyte.
+ *
+ * This hint is checked each time a scratch block is released.
+ *
+ * \since This hint is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_SetScratchAllocator
+ */
+#define IMG_HINT_SCRATCH_KEEP_SIZE "SDL_IMAGE_SCRATCH_KEEP_SIZE"
+
+/**
+ * A variable that enables per-load performance statistics.
+ *
+ * When this hint is enabled, the surfaces returned by the generic load
+ * functions, such as IMG_Load(), IMG_LoadTyped_IO() and
+ * IMG_LoadWithProperties(), and the properties of animation decoders, have
+ * these properties describing the load:
+ *
+ * - `IMG_PROP_STATS_TYPE_STRING`: the format that was decoded, e.g. "PNG".
+ * - `IMG_PROP_STATS_BYTES_READ_NUMBER`: the number of bytes read from the
+ *   data source.
+ * - `IMG_PROP_STATS_READ_CALLS_NUMBER`: the number of read calls on the data
+ *   source.
+ * - `IMG_PROP_STATS_SEEK_CALLS_NUMBER`: the number of seek calls on the data
+ *   source.
+ * - `IMG_PROP_STATS_PROBES_NUMBER`: the number of formats that were checked
+ *   to detect the format of the image.
+ * - `IMG_PROP_STATS_BYTES_ALLOCATED_NUMBER`: the number of bytes SDL_image
+ *   allocated for the pixels of the image and for temporary buffers. Memory
+ *   allocated inside third-party decoding libraries isn't included.
+ * - `IMG_PROP_STATS_HEADER_US_NUMBER`: the wall-clock time spent detecting
+ *   the format and reading the header, in microseconds.
+ * - `IMG_PROP_STATS_DECODE_US_NUMBER`: the wall-clock time spent decoding the
+ *   pixels, in microseconds.
+ * - `IMG_PROP_STATS_CONVERT_US_NUMBER`: the wall-clock time spent converting
+ *   or scaling the decoded pixels, in microseconds.
+ * - `IMG_PROP_STATS_DISK_CACHE_HIT_BOOLEAN`: true if the image was read from
+ *   the disk cache instead of being decoded, see
+ *   IMG_SetDiskCacheDirectory().
+ *
+ * The statistics of an animation decoder are updated after each frame and
+ * cover all the frames decoded so far. The totals for each format are
+ * available with IMG_GetFormatStats().
+ *
+ * Collecting statistics makes loads a little slower, because every read
+ * goes through an extra stream.
+ *
+ * The variable can be set to the following values:
+ *
+ * - "0": Statistics are not collected. (default)
+ * - "1": Statistics are collected.
+ *
+ * This hint is checked at the start of each load.
+ *
+ * \since This hint is available since SDL_image 3.4.0.
+ */
+#define IMG_HINT_LOAD_STATS "SDL_IMAGE_LOAD_STATS"
+
+#define IMG_PROP_STATS_TYPE_STRING              "SDL_image.stats.type"
+#define IMG_PROP_STATS_BYTES_READ_NUMBER        "SDL_image.stats.bytes_read"
+#define IMG_PROP_STATS_READ_CALLS_NUMBER        "SDL_image.stats.read_calls"
+#define IMG_PROP_STATS_SEEK_CALLS_NUMBER        "SDL_image.stats.seek_calls"
+#define IMG_PROP_STATS_PROBES_NUMBER            "SDL_image.stats.probes"
+#define IMG_PROP_STATS_BYTES_ALLOCATED_NUMBER   "SDL_image.stats.bytes_allocated"
+#define IMG_PROP_STATS_HEADER_US_NUMBER         "SDL_image.stats.header_us"
+#define IMG_PROP_STATS_DECODE_US_NUMBER         "SDL_image.stats.decode_us"
+#define IMG_PROP_STATS_CONVERT_US_NUMBER        "SDL_image.stats.convert_us"
+#define IMG_PROP_STATS_DISK_CACHE_HIT_BOOLEAN   "SDL_image.stats.disk_cache_hit"
+
+/**
+ * The statistics of all the loads of an image format.
+ *
+ * \since This struct is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_GetFormatStats
+ */
+typedef struct IMG_FormatStats
+{
+    Uint64 loads;           /**< The number of images and animation decoders loaded */
+    Uint64 failures;        /**< The number of loads that failed */
+    Uint64 bytes_read;      /**< The number of bytes read from the data sources */
+    Uint64 read_calls;      /**< The number of read calls on the data sources */
+    Uint64 seek_calls;      /**< The number of seek calls on the data sources */
+    Uint64 probes;          /**< The number of formats checked to detect the format */
+    Uint64 bytes_allocated; /**< The number of bytes allocated by SDL_image */
+    Uint64 header_us;       /**< The time spent reading headers, in microseconds */
+    Uint64 decode_us;       /**< The time spent decoding pixels, in microseconds */
+    Uint64 convert_us;      /**< The time spent converting pixels, in microseconds */
+} IMG_FormatStats;
+
+/**
+ * Get the statistics of all the loads of an image format.
+ *
+ * Statistics are only collected while IMG_HINT_LOAD_STATS is enabled. An
+ * animation decoder is added to the totals when it's closed.
+ *
+ * \param type the image format, e.g. "PNG", matched case-insensitively.
+ * \param stats filled in with the statistics of the format, zeroed if no
+ *              image of that format has been loaded.
+ * \returns true on success or false on failure; call SDL_GetError() for
+ *          more information.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_ResetFormatStats
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_GetFormatStats(const char *type, IMG_FormatStats *stats);
+
+/**
+ * Reset the statistics of all image formats to zero.
+ *
+ * \threadsafety It is safe to call this function from any thread.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_GetFormatStats
+ */
+extern SDL_DECLSPEC void SDLCALL IMG_ResetFormatStats(void);
+
+/**
+ * A variable that limits the number of pixels in a decoded image.
+ *
+ * Decoders check the size of an image as soon as they have read its header,
+ * before allocating any memory for its pixels, and fail with an error if
+ * the image has more pixels than this. The limit also applies to each frame
+ * and to the canvas of an animation.
+ *
+ * This is useful to protect a process that loads untrusted images from a
+ * file that declares a huge size in its header.
+ *
+ * The variable can be set to the maximum number of pixels, or to "0" for no
+ * limit. (default)
+ *
+ * This hint is checked at the start of each image, it can be overridden for
+ * a single load with `IMG_PROP_LOAD_MAX_PIXELS_NUMBER`.
+ *
+ * \since This hint is available since SDL_image 3.4.0.
+ */
+#define IMG_HINT_MAX_PIXELS "SDL_IMAGE_MAX_PIXELS"
+
+/**
+ * A variable that limits the number of bytes in a decoded image.
+ *
+ * This works like IMG_HINT_MAX_PIXELS, but counts the bytes of the pixels in
+ * the format the decoder produces.
+ *
+ * The variable can be set to the maximum number of bytes, or to "0" for no
+ * limit. (default)
+ *
+ * This hint is checked at the start of each image, it can be overridden for
+ * a single load with `IMG_PROP_LOAD_MAX_BYTES_NUMBER`.
+ *
+ * \since This hint is available since SDL_image 3.4.0.
+ */
+#define IMG_HINT_MAX_IMAGE_BYTES "SDL_IMAGE_MAX_IMAGE_BYTES"
+
+/**
+ * A variable that limits the number of frames decoded from an animation.
+ *
+ * Loading an animation, e.g. with IMG_LoadAnimation(), fails with an error
+ * once it has more frames than this. An animation decoder fails to decode
+ * more frames than this until it is reset.
+ *
+ * The variable can be set to the maximum number of frames, or to "0" for no
+ * limit. (default)
+ *
+ * This hint is checked when an animation decoder is created.
+ *
+ * \since This hint is available since SDL_image 3.4.0.
+ */
+#define IMG_HINT_MAX_ANIMATION_FRAMES "SDL_IMAGE_MAX_ANIMATION_FRAMES"
+
+/**
+ * A variable that limits the number of bytes in all the frames of an
+ * animation.
+ *
+ * Loading an animation fails with an error once its decoded frames take up
+ * more bytes than this. An animation decoder fails to decode more frames
+ * once the frames it decoded since it was created or reset take up more
+ * bytes than this.
+ *
+ * The variable can be set to the maximum number of bytes, or to "0" for no
+ * limit. (default)
+ *
+ * This hint is checked when an animation decoder is created.
+ *
+ * \since This hint is available since SDL_image 3.4.0.
+ */
+#define IMG_HINT_MAX_ANIMATION_BYTES "SDL_IMAGE_MAX_ANIMATION_BYTES"
+
+/**
+ * A variable that controls whether textures are decoded straight into
+ * streaming textures.
+ *
+ * When this is enabled and the renderer is the software renderer,
+ * IMG_LoadTexture() and the related functions create an
+ * SDL_TEXTUREACCESS_STREAMING texture and decode the image into its locked
+ * pixels, without an intermediate surface. This is only done for formats
+ * whose size can be read from the header. Other renderers keep a CPU-side
+ * copy of streaming textures, so they always get static textures.
+ *
+ * The variable can be set to the following values:
+ *
+ * - "0": Textures are created with SDL_TEXTUREACCESS_STATIC. (default)
+ * - "1": Textures are decoded into streaming textures with the software
+ *   renderer.
+ *
+ * This hint is checked at the start of each texture load.
+ *
+ * \since This hint is available since SDL_image 3.4.0.
+ */
+#define IMG_HINT_STREAMING_TEXTURES "SDL_IMAGE_STREAMING_TEXTURES"
+
+/**
+ * A variable that controls whether image files are mapped into memory.
+ *
+ * When this is enabled, IMG_Load() and the other functions that take a file
+ * path map regular files of 64 KB or more into memory instead of reading
+ * them, so decoders can work on the file data in place.
+ *
+ * If a mapped file is truncated by another process while it's being loaded,
+ * reading the missing part raises SIGBUS on POSIX systems or an access
+ * violation on Windows, which terminates the app. Only enable this if the
+ * image files aren't modified while the app is running.
+ *
+ * The variable can be set to the following values:
+ *
+ * - "0": Files are read with SDL_IOFromFile(). (default)
+ * - "1": Large files are mapped into memory.
+ *
+ * This hint is checked each time a file is opened.
+ *
+ * \since This hint is available since SDL_image 3.4.0.
+ */
+#define IMG_HINT_MAP_FILES "SDL_IMAGE_MAP_FILES"
+
 /**
  * Get the image currently in the clipboard.
  *
@@ -375,6 +1370,127 @@ extern SDL_DECLSPEC SDL_Texture * SDLCALL IMG_LoadTextureTyped_IO(SDL_Renderer *
  */
 extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_GetClipboardImage(void);
 
+/**
+ * Detect the image format of data on a readable/seekable SDL_IOStream.
+ *
+ * This function reads a small header window from the SDL_IOStream once and
+ * matches it against the magic numbers of every format SDL_image knows
+ * about, instead of calling each IMG_isTYPE function in turn. A few formats
+ * that can't be identified from the header alone (AVIF, SVG) are confirmed
+ * with an additional check.
+ *
+ * The returned string can be passed to IMG_LoadTyped_IO() or
+ * IMG_LoadAnimationTyped_IO(), and is suitable for caching by the caller.
+ * Formats without a magic number (TGA) are never detected.
+ *
+ * This function will always attempt to seek `src` back to where it started
+ * when this function was called, but it will not report any errors in doing
+ * so.
+ *
+ * \param src a seekable/readable SDL_IOStream to provide image data.
+ * \returns a static string naming the detected format ("PNG", "JPG", etc),
+ *          or NULL if the format isn't recognized.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_LoadTyped_IO
+ * \sa IMG_LoadAnimationTyped_IO
+ */
+extern SDL_DECLSPEC const char * SDLCALL IMG_DetectFormat(SDL_IOStream *src);
+
+/**
+ * Get information about an image file without decoding its pixels.
+ *
+ * This is equivalent to IMG_GetImageInfoTyped_IO(), determining the file
+ * type from the filename's extension.
+ *
+ * When done with the returned properties, the app should dispose of them
+ * with a call to SDL_DestroyProperties().
+ *
+ * \param file a path on the filesystem to read the image information from.
+ * \returns a valid property ID on success or 0 on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_GetImageInfo_IO
+ * \sa IMG_GetImageInfoTyped_IO
+ */
+extern SDL_DECLSPEC SDL_PropertiesID SDLCALL IMG_GetImageInfo(const char *file);
+
+/**
+ * Get information about an image from an SDL data source without decoding
+ * its pixels.
+ *
+ * This is equivalent to IMG_GetImageInfoTyped_IO() with a NULL type.
+ *
+ * \param src an SDL_IOStream that data will be read from.
+ * \param closeio true to close/free the SDL_IOStream before returning, false
+ *                to leave it open.
+ * \returns a valid property ID on success or 0 on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_GetImageInfo
+ * \sa IMG_GetImageInfoTyped_IO
+ */
+extern SDL_DECLSPEC SDL_PropertiesID SDLCALL IMG_GetImageInfo_IO(SDL_IOStream *src, bool closeio);
+
+/**
+ * Get information about an image from an SDL data source without decoding
+ * its pixels.
+ *
+ * For AVIF, GIF, JPG, PNG (including APNG), QOI, TGA and WEBP images this
+ * only parses the file header, stopping before any pixel data is decoded.
+ * Other formats are decoded in full to gather the same information, so the
+ * result is always consistent with what IMG_LoadTyped_IO() would return.
+ *
+ * These are the supported properties:
+ *
+ * - `IMG_PROP_INFO_TYPE_STRING`: the detected image format, e.g. "PNG".
+ * - `IMG_PROP_INFO_WIDTH_NUMBER`: the width of the image, in pixels.
+ * - `IMG_PROP_INFO_HEIGHT_NUMBER`: the height of the image, in pixels.
+ * - `IMG_PROP_INFO_PIXEL_FORMAT_NUMBER`: the SDL_PixelFormat of the surface
+ *   that loading the image would return.
+ * - `IMG_PROP_INFO_BIT_DEPTH_NUMBER`: the number of bits per color channel
+ *   stored in the file, or the number of bits per palette index for indexed
+ *   images.
+ * - `IMG_PROP_INFO_HAS_ALPHA_BOOLEAN`: true if the image has an alpha channel
+ *   or transparent color.
+ * - `IMG_PROP_INFO_FRAME_COUNT_NUMBER`: the number of frames in the image,
+ *   which is 1 for still images.
+ *
+ * If `closeio` is true, `src` will be closed before returning, whether this
+ * function succeeds or not. Otherwise `src` is left at the position it was
+ * at when this function was called.
+ *
+ * When done with the returned properties, the app should dispose of them
+ * with a call to SDL_DestroyProperties().
+ *
+ * \param src an SDL_IOStream that data will be read from.
+ * \param closeio true to close/free the SDL_IOStream before returning, false
+ *                to leave it open.
+ * \param type a filename extension that represent this data ("BMP", "GIF",
+ *             "PNG", etc), or NULL to detect the format.
+ * \returns a valid property ID on success or 0 on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_GetImageInfo
+ * \sa IMG_GetImageInfo_IO
+ */
+extern SDL_DECLSPEC SDL_PropertiesID SDLCALL IMG_GetImageInfoTyped_IO(SDL_IOStream *src, bool closeio, const char *type);
+
+#define IMG_PROP_INFO_TYPE_STRING           "SDL_image.info.type"
+#define IMG_PROP_INFO_WIDTH_NUMBER          "SDL_image.info.width"
+#define IMG_PROP_INFO_HEIGHT_NUMBER         "SDL_image.info.height"
+#define IMG_PROP_INFO_PIXEL_FORMAT_NUMBER   "SDL_image.info.pixel_format"
+#define IMG_PROP_INFO_BIT_DEPTH_NUMBER      "SDL_image.info.bit_depth"
+#define IMG_PROP_INFO_HAS_ALPHA_BOOLEAN     "SDL_image.info.has_alpha"
+#define IMG_PROP_INFO_FRAME_COUNT_NUMBER    "SDL_image.info.frame_count"
+
 /**
  * Detect ANI animated cursor data on a readable/seekable SDL_IOStream.
  *
@@ -2947,7 +4063,8 @@ typedef enum IMG_AnimationDecoderStatus
     IMG_DECODER_STATUS_INVALID = -1,    /**< The decoder is invalid */
     IMG_DECODER_STATUS_OK,              /**< The decoder is ready to decode the next frame */
     IMG_DECODER_STATUS_FAILED,          /**< The decoder failed to decode a frame, call SDL_GetError() for more information. */
-    IMG_DECODER_STATUS_COMPLETE         /**< No more frames available */
+    IMG_DECODER_STATUS_COMPLETE,        /**< No more frames available */
+    IMG_DECODER_STATUS_CANCELLED        /**< Decoding was cancelled by the progress callback or the deadline, reset the decoder to continue */
 } IMG_AnimationDecoderStatus;
 
 /**
@@ -3041,6 +4158,43 @@ extern SDL_DECLSPEC IMG_AnimationDecoder * SDLCALL IMG_CreateAnimationDecoder_IO
  * - `IMG_PROP_ANIMATION_DECODER_CREATE_TYPE_STRING`: the input file type,
  *   e.g. "webp", defaults to the file extension if
  *   `IMG_PROP_ANIMATION_DECODER_CREATE_FILENAME_STRING` is set.
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_PROGRESS_CALLBACK_POINTER`: an
+ *   IMG_LoadProgressCallback called while each frame is decoded, which can
+ *   cancel decoding by returning false.
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_PROGRESS_USERDATA_POINTER`: the
+ *   pointer passed to the progress callback.
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_DEADLINE_NUMBER`: a time, as returned
+ *   by SDL_GetTicksNS(), after which decoding is cancelled. Defaults to 0, no
+ *   deadline.
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_MAX_PIXELS_NUMBER`: the maximum number
+ *   of pixels in the canvas and each frame. Defaults to the value of
+ *   IMG_HINT_MAX_PIXELS.
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_MAX_BYTES_NUMBER`: the maximum number
+ *   of bytes in each frame. Defaults to the value of
+ *   IMG_HINT_MAX_IMAGE_BYTES.
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_MAX_FRAMES_NUMBER`: the maximum number
+ *   of frames decoded until the decoder is reset. Defaults to the value of
+ *   IMG_HINT_MAX_ANIMATION_FRAMES.
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_MAX_TOTAL_BYTES_NUMBER`: the maximum
+ *   number of bytes in all the frames decoded until the decoder is reset.
+ *   Defaults to the value of IMG_HINT_MAX_ANIMATION_BYTES.
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_BORROW_FRAMES_BOOLEAN`: true if the
+ *   frames returned by IMG_GetAnimationDecoderFrame() belong to the decoder
+ *   and are only valid until the next call to it or until the decoder is
+ *   closed. They must not be modified or freed. Formats that composite frames
+ *   onto a canvas return the canvas itself, without copying it. Defaults to
+ *   false.
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_RECYCLE_FRAMES_BOOLEAN`: true if the
+ *   surface pointed to by the `frame` parameter of
+ *   IMG_GetAnimationDecoderFrame() is a frame previously returned by the
+ *   decoder, or NULL. The decoder takes it back and overwrites it with the
+ *   next frame if it can, or frees it. Ignored if
+ *   `IMG_PROP_ANIMATION_DECODER_CREATE_BORROW_FRAMES_BOOLEAN` is true.
+ *   Defaults to false.
+ *
+ * When decoding is cancelled, IMG_GetAnimationDecoderFrame() returns false
+ * and the status of the decoder is IMG_DECODER_STATUS_CANCELLED until it is
+ * reset with IMG_ResetAnimationDecoder().
  *
  * \param props the properties of the animation decoder.
  * \returns a new IMG_AnimationDecoder, or NULL on failure; call
@@ -3062,6 +4216,15 @@ extern SDL_DECLSPEC IMG_AnimationDecoder * SDLCALL IMG_CreateAnimationDecoderWit
 #define IMG_PROP_ANIMATION_DECODER_CREATE_TYPE_STRING                    "SDL_image.animation_decoder.create.type"
 #define IMG_PROP_ANIMATION_DECODER_CREATE_TIMEBASE_NUMERATOR_NUMBER      "SDL_image.animation_decoder.create.timebase.numerator"
 #define IMG_PROP_ANIMATION_DECODER_CREATE_TIMEBASE_DENOMINATOR_NUMBER    "SDL_image.animation_decoder.create.timebase.denominator"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_PROGRESS_CALLBACK_POINTER      "SDL_image.animation_decoder.create.progress_callback"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_PROGRESS_USERDATA_POINTER      "SDL_image.animation_decoder.create.progress_userdata"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_DEADLINE_NUMBER                "SDL_image.animation_decoder.create.deadline"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_MAX_PIXELS_NUMBER              "SDL_image.animation_decoder.create.max_pixels"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_MAX_BYTES_NUMBER               "SDL_image.animation_decoder.create.max_bytes"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_MAX_FRAMES_NUMBER              "SDL_image.animation_decoder.create.max_frames"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_MAX_TOTAL_BYTES_NUMBER         "SDL_image.animation_decoder.create.max_total_bytes"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_BORROW_FRAMES_BOOLEAN          "SDL_image.animation_decoder.create.borrow_frames"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_RECYCLE_FRAMES_BOOLEAN         "SDL_image.animation_decoder.create.recycle_frames"
 
 /**
  * Get the properties of an animation decoder.
@@ -3097,6 +4260,14 @@ extern SDL_DECLSPEC SDL_PropertiesID SDLCALL IMG_GetAnimationDecoderProperties(I
  * as an SDL_Surface. The returned surface should be freed with
  * SDL_FreeSurface() when no longer needed.
  *
+ * If the decoder was created with
+ * `IMG_PROP_ANIMATION_DECODER_CREATE_BORROW_FRAMES_BOOLEAN`, the returned
+ * surface belongs to the decoder and is only valid until the next call to
+ * this function. If it was created with
+ * `IMG_PROP_ANIMATION_DECODER_CREATE_RECYCLE_FRAMES_BOOLEAN`, `*frame` must be
+ * NULL or a frame previously returned by the decoder, which the decoder takes
+ * back and may reuse for the next frame.
+ *
  * If the animation decoder has no more frames or an error occurred while
  * decoding the frame, this function returns false. In that case, please call
  * SDL_GetError() for more information. If SDL_GetError() returns an empty
@@ -3119,12 +4290,39 @@ extern SDL_DECLSPEC SDL_PropertiesID SDLCALL IMG_GetAnimationDecoderProperties(I
  * \sa IMG_CreateAnimationDecoder
  * \sa IMG_CreateAnimationDecoder_IO
  * \sa IMG_CreateAnimationDecoderWithProperties
+ * \sa IMG_GetAnimationDecoderFrameRect
  * \sa IMG_GetAnimationDecoderStatus
  * \sa IMG_ResetAnimationDecoder
  * \sa IMG_CloseAnimationDecoder
  */
 extern SDL_DECLSPEC bool SDLCALL IMG_GetAnimationDecoderFrame(IMG_AnimationDecoder *decoder, SDL_Surface **frame, Uint64 *duration);
 
+/**
+ * Get the area of the last decoded frame that changed from the frame before
+ * it.
+ *
+ * After IMG_GetAnimationDecoderFrame() returns a frame, the pixels outside
+ * this rectangle are the same as in the frame returned before it, so only
+ * this part of a texture showing the animation needs to be updated, for
+ * example with SDL_UpdateTexture(). The rectangle can be larger than the
+ * pixels that actually changed.
+ *
+ * The rectangle covers the whole frame for the first frame after the decoder
+ * is created or reset, and for formats that don't composite frames onto a
+ * canvas. It is empty if no frame was decoded or the last call to
+ * IMG_GetAnimationDecoderFrame() failed.
+ *
+ * \param decoder the animation decoder.
+ * \param rect a pointer filled in with the area of the frame that changed.
+ * \returns true on success or false on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.4.0.
+ *
+ * \sa IMG_GetAnimationDecoderFrame
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_GetAnimationDecoderFrameRect(IMG_AnimationDecoder *decoder, SDL_Rect *rect);
+
 /**
  * Get the decoder status indicating the current state of the decoder.
  *
@@ -23,6 +23,14 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_diskcache.h"
+#include "IMG_info.h"
+#include "IMG_io.h"
+#include "IMG_limits.h"
+#include "IMG_load_options.h"
+#include "IMG_progress.h"
+#include "IMG_stats.h"
+
 #ifdef __EMSCRIPTEN__
 #include <emscripten/emscripten.h>
 #endif
@@ -44,46 +52,234 @@ SDL_COMPILE_TIME_ASSERT(SDL_IMAGE_MINOR_VERSION_max, SDL_IMAGE_MINOR_VERSION <=
 SDL_COMPILE_TIME_ASSERT(SDL_IMAGE_MICRO_VERSION_min, SDL_IMAGE_MICRO_VERSION >= 0);
 SDL_COMPILE_TIME_ASSERT(SDL_IMAGE_MICRO_VERSION_max, SDL_IMAGE_MICRO_VERSION <= 999);
 
-/* Table of image detection and loading functions */
+/* Size of the header window read once to detect the image format */
+#define DETECT_WINDOW_SIZE  64
+
+static bool MatchAVIF(const Uint8 *magic, size_t len)
+{
+    /* This might be AVIF, IMG_isAVIF() does more thorough checks */
+    return len >= 12 && SDL_memcmp(&magic[4], "ftyp", 4) == 0;
+}
+
+static bool MatchANI(const Uint8 *magic, size_t len)
+{
+    return len >= 12 && SDL_memcmp(magic, "RIFF", 4) == 0 && SDL_memcmp(&magic[8], "ACON", 4) == 0;
+}
+
+static bool MatchICOCUR(const Uint8 *magic, size_t len, Uint8 type)
+{
+    /* The Win32 ICO file header: reserved, type and a non-zero image count */
+    return len >= 6 &&
+           magic[0] == 0 && magic[1] == 0 &&
+           magic[2] == type && magic[3] == 0 &&
+           (magic[4] != 0 || magic[5] != 0);
+}
+
+static bool MatchCUR(const Uint8 *magic, size_t len)
+{
+    return MatchICOCUR(magic, len, 2);
+}
+
+static bool MatchICO(const Uint8 *magic, size_t len)
+{
+    return MatchICOCUR(magic, len, 1);
+}
+
+static bool MatchBMP(const Uint8 *magic, size_t len)
+{
+    return len >= 2 && magic[0] == 'B' && magic[1] == 'M';
+}
+
+static bool MatchGIF(const Uint8 *magic, size_t len)
+{
+    return len >= 6 &&
+           (SDL_memcmp(magic, "GIF87a", 6) == 0 || SDL_memcmp(magic, "GIF89a", 6) == 0);
+}
+
+static bool MatchJPG(const Uint8 *magic, size_t len)
+{
+    /* Start of image, followed by the first marker */
+    return len >= 3 && magic[0] == 0xFF && magic[1] == 0xD8 && magic[2] == 0xFF;
+}
+
+static bool MatchJXL(const Uint8 *magic, size_t len)
+{
+    static const Uint8 container[12] = {
+        0x00, 0x00, 0x00, 0x0C, 'J', 'X', 'L', ' ', 0x0D, 0x0A, 0x87, 0x0A
+    };
+
+    if (len >= 2 && magic[0] == 0xFF && magic[1] == 0x0A) {
+        /* This is a JXL codestream */
+        return true;
+    }
+    return len >= sizeof(container) && SDL_memcmp(magic, container, sizeof(container)) == 0;
+}
+
+static bool MatchLBM(const Uint8 *magic, size_t len)
+{
+    return len >= 12 && SDL_memcmp(magic, "FORM", 4) == 0 &&
+           (SDL_memcmp(&magic[8], "PBM ", 4) == 0 || SDL_memcmp(&magic[8], "ILBM", 4) == 0);
+}
+
+static bool MatchPCX(const Uint8 *magic, size_t len)
+{
+    /* ZSoft manufacturer, PC Paintbrush version 5, uncompressed or RLE encoding */
+    return len >= 3 && magic[0] == 10 && magic[1] == 5 && magic[2] <= 1;
+}
+
+static bool MatchPNG(const Uint8 *magic, size_t len)
+{
+    return len >= 4 && magic[0] == 0x89 && magic[1] == 'P' && magic[2] == 'N' && magic[3] == 'G';
+}
+
+static bool MatchPNM(const Uint8 *magic, size_t len)
+{
+    /* P1 - P6, PBM/PGM/PPM in ascii or binary format */
+    return len >= 2 && magic[0] == 'P' && magic[1] >= '1' && magic[1] <= '6';
+}
+
+static bool MatchSVG(const Uint8 *magic, size_t len)
+{
+    size_t i = 0;
+
+    /* This might be XML, IMG_isSVG() looks further for the <svg> element */
+    if (len >= 3 && magic[0] == 0xEF && magic[1] == 0xBB && magic[2] == 0xBF) {
+        i = 3;
+    }
+    while (i < len && (magic[i] == ' ' || magic[i] == '\t' || magic[i] == '\r' || magic[i] == '\n')) {
+        ++i;
+    }
+    return i < len && magic[i] == '<';
+}
+
+static bool MatchTIF(const Uint8 *magic, size_t len)
+{
+    return len >= 4 &&
+           ((magic[0] == 'I' && magic[1] == 'I' && magic[2] == 0x2a && magic[3] == 0x00) ||
+            (magic[0] == 'M' && magic[1] == 'M' && magic[2] == 0x00 && magic[3] == 0x2a));
+}
+
+static bool MatchXCF(const Uint8 *magic, size_t len)
+{
+    return len >= 14 && SDL_memcmp(magic, "gimp xcf ", 9) == 0;
+}
+
+static bool MatchXPM(const Uint8 *magic, size_t len)
+{
+    return len >= 9 && SDL_memcmp(magic, "/* XPM */", 9) == 0;
+}
+
+static bool MatchXV(const Uint8 *magic, size_t len)
+{
+    return len >= 6 && SDL_memcmp(magic, "P7 332", 6) == 0;
+}
+
+static bool MatchWEBP(const Uint8 *magic, size_t len)
+{
+    return len >= 20 &&
+           SDL_memcmp(magic, "RIFF", 4) == 0 &&
+           SDL_memcmp(&magic[8], "WEBPVP8", 7) == 0 &&
+           (magic[15] == ' ' || magic[15] == 'X' || magic[15] == 'L');
+}
+
+static bool MatchQOI(const Uint8 *magic, size_t len)
+{
+    return len >= 4 && SDL_memcmp(magic, "qoif", 4) == 0;
+}
+
+/* Table of image detection functions, matched against a single header read */
 static struct {
     const char *type;
-    bool (SDLCALL *is)(SDL_IOStream *src);
+    bool (*match)(const Uint8 *magic, size_t len);
+    bool (SDLCALL *confirm)(SDL_IOStream *src);
+} detect[] = {
+    { "AVIF", MatchAVIF, IMG_isAVIF },
+    { "ANI", MatchANI, NULL },
+    { "CUR", MatchCUR, NULL },
+    { "ICO", MatchICO, NULL },
+    { "BMP", MatchBMP, NULL },
+    { "GIF", MatchGIF, NULL },
+    { "JPG", MatchJPG, NULL },
+    { "JXL", MatchJXL, NULL },
+    { "LBM", MatchLBM, NULL },
+    { "PCX", MatchPCX, NULL },
+    { "PNG", MatchPNG, NULL },
+    { "PNM", MatchPNM, NULL }, /* P[BGP]M share code */
+    { "SVG", MatchSVG, IMG_isSVG },
+    { "TIF", MatchTIF, NULL },
+    { "XCF", MatchXCF, NULL },
+    { "XPM", MatchXPM, NULL },
+    { "XV",  MatchXV,  NULL },
+    { "WEBP", MatchWEBP, NULL },
+    { "QOI", MatchQOI, NULL },
+};
+
+/* Table of image loading functions */
+static struct {
+    const char *type;
+    bool magicless;
     SDL_Surface *(SDLCALL *load)(SDL_IOStream *src);
 } supported[] = {
     /* keep magicless formats first */
-    { "TGA", NULL,      IMG_LoadTGA_IO },
-    { "AVIF",IMG_isAVIF,IMG_LoadAVIF_IO },
-    { "CUR", IMG_isCUR, IMG_LoadCUR_IO },
-    { "ICO", IMG_isICO, IMG_LoadICO_IO },
-    { "BMP", IMG_isBMP, IMG_LoadBMP_IO },
-    { "GIF", IMG_isGIF, IMG_LoadGIF_IO },
-    { "JPG", IMG_isJPG, IMG_LoadJPG_IO },
-    { "JXL", IMG_isJXL, IMG_LoadJXL_IO },
-    { "LBM", IMG_isLBM, IMG_LoadLBM_IO },
-    { "PCX", IMG_isPCX, IMG_LoadPCX_IO },
-    { "PNG", IMG_isPNG, IMG_LoadPNG_IO },
-    { "PNM", IMG_isPNM, IMG_LoadPNM_IO }, /* P[BGP]M share code */
-    { "SVG", IMG_isSVG, IMG_LoadSVG_IO },
-    { "TIF", IMG_isTIF, IMG_LoadTIF_IO },
-    { "XCF", IMG_isXCF, IMG_LoadXCF_IO },
-    { "XPM", IMG_isXPM, IMG_LoadXPM_IO },
-    { "XV",  IMG_isXV,  IMG_LoadXV_IO  },
-    { "WEBP", IMG_isWEBP, IMG_LoadWEBP_IO },
-    { "QOI", IMG_isQOI, IMG_LoadQOI_IO },
+    { "TGA", true,  IMG_LoadTGA_IO },
+    { "AVIF", false, IMG_LoadAVIF_IO },
+    { "CUR", false, IMG_LoadCUR_IO },
+    { "ICO", false, IMG_LoadICO_IO },
+    { "BMP", false, IMG_LoadBMP_IO },
+    { "GIF", false, IMG_LoadGIF_IO },
+    { "JPG", false, IMG_LoadJPG_IO },
+    { "JXL", false, IMG_LoadJXL_IO },
+    { "LBM", false, IMG_LoadLBM_IO },
+    { "PCX", false, IMG_LoadPCX_IO },
+    { "PNG", false, IMG_LoadPNG_IO },
+    { "PNM", false, IMG_LoadPNM_IO },
+    { "SVG", false, IMG_LoadSVG_IO },
+    { "TIF", false, IMG_LoadTIF_IO },
+    { "XCF", false, IMG_LoadXCF_IO },
+    { "XPM", false, IMG_LoadXPM_IO },
+    { "XV",  false, IMG_LoadXV_IO  },
+    { "WEBP", false, IMG_LoadWEBP_IO },
+    { "QOI", false, IMG_LoadQOI_IO },
 };
 
-/* Table of animation detection and loading functions */
+/* Table of animation loading functions, keyed by detected image format */
 static struct {
     const char *type;
-    bool (SDLCALL *is)(SDL_IOStream *src);
     IMG_Animation *(SDLCALL *load)(SDL_IOStream *src);
 } supported_anims[] = {
-    /* keep magicless formats first */
-    { "GIF", IMG_isGIF, IMG_LoadGIFAnimation_IO     },
-    { "WEBP", IMG_isWEBP, IMG_LoadWEBPAnimation_IO  },
-    { "APNG", IMG_isPNG, IMG_LoadAPNGAnimation_IO   },
-    { "AVIFS", IMG_isAVIF, IMG_LoadAVIFAnimation_IO },
-    { "ANI", IMG_isANI, IMG_LoadANIAnimation_IO },
+    { "GIF", IMG_LoadGIFAnimation_IO },
+    { "WEBP", IMG_LoadWEBPAnimation_IO },
+    { "PNG", IMG_LoadAPNGAnimation_IO },   /* APNG */
+    { "AVIF", IMG_LoadAVIFAnimation_IO },  /* AVIFS */
+    { "ANI", IMG_LoadANIAnimation_IO },
+};
+
+/* Table of header-only image information functions, keyed by image format */
+static struct {
+    const char *type;
+    bool (*info)(SDL_IOStream *src, SDL_PropertiesID props);
+} supported_info[] = {
+    { "TGA", IMG_GetTGAInfo_IO },
+    { "AVIF", IMG_GetAVIFInfo_IO },
+    { "GIF", IMG_GetGIFInfo_IO },
+    { "JPG", IMG_GetJPGInfo_IO },
+    { "PNG", IMG_GetPNGInfo_IO },
+    { "QOI", IMG_GetQOIInfo_IO },
+    { "WEBP", IMG_GetWEBPInfo_IO },
+};
+
+/* Table of image loaders that support load options */
+static struct {
+    const char *type;
+    SDL_Surface *(*load)(SDL_IOStream *src, IMG_LoadOptions *options);
+} supported_options[] = {
+    { "TGA", IMG_LoadTGAWithOptions_IO },
+    { "AVIF", IMG_LoadAVIFWithOptions_IO },
+    { "JPG", IMG_LoadJPGWithOptions_IO },
+    { "PNG", IMG_LoadPNGWithOptions_IO },
+    { "SVG", IMG_LoadSVGWithOptions_IO },
+    { "TIF", IMG_LoadTIFWithOptions_IO },
+    { "WEBP", IMG_LoadWEBPWithOptions_IO },
 };
 
 int IMG_Version(void)
@@ -111,9 +307,9 @@ SDL_Surface *IMG_Load(const char *file)
     }
 #endif
 
-    SDL_IOStream *src = SDL_IOFromFile(file, "rb");
+    SDL_IOStream *src = IMG_OpenFile(file);
     if (!src) {
-        /* The error message has been set in SDL_IOFromFile */
+        /* The error message has been set in IMG_OpenFile */
         return NULL;
     }
 
@@ -125,17 +321,84 @@ SDL_Surface *IMG_Load(const char *file)
 }
 #endif
 
+/* Detect the image format with a single read of the header */
+const char *IMG_DetectFormat(SDL_IOStream *src)
+{
+    Sint64 start;
+    Uint8 magic[DETECT_WINDOW_SIZE];
+    size_t len;
+    size_t i;
+
+    if (!src) {
+        SDL_InvalidParamError("src");
+        return NULL;
+    }
+
+    start = SDL_TellIO(src);
+    len = SDL_ReadIO(src, magic, sizeof(magic));
+    SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+
+    for (i = 0; i < SDL_arraysize(detect); ++i) {
+        if (!detect[i].match(magic, len)) {
+            continue;
+        }
+        if (detect[i].confirm && !detect[i].confirm(src)) {
+            continue;
+        }
+        IMG_CountLoadProbes((int)(i + 1));
+        return detect[i].type;
+    }
+    IMG_CountLoadProbes((int)SDL_arraysize(detect));
+    return NULL;
+}
+
 /* Load an image from an SDL datasource (for compatibility) */
 SDL_Surface *IMG_Load_IO(SDL_IOStream *src, bool closeio)
 {
     return IMG_LoadTyped_IO(src, closeio, NULL);
 }
 
+/* Decode an image with the loader for its type, leaving the stream open */
+static SDL_Surface *LoadSupportedType(SDL_IOStream *src, const char *type)
+{
+    size_t i;
+    const char *detected;
+
+    /* Magicless formats can only be loaded by type */
+    if (type) {
+        for (i = 0; i < SDL_arraysize(supported) && supported[i].magicless; ++i) {
+            if (SDL_strcasecmp(type, supported[i].type) == 0) {
+                IMG_SetLoadType(supported[i].type);
+                return supported[i].load(src);
+            }
+        }
+    }
+
+    /* Detect the type of image being loaded */
+    detected = IMG_DetectFormat(src);
+    if (detected) {
+        for (i = 0; i < SDL_arraysize(supported); ++i) {
+            if (SDL_strcmp(detected, supported[i].type) != 0) {
+                continue;
+            }
+#ifdef DEBUG_IMGLIB
+            SDL_Log("IMGLIB: Loading image as %s\n", supported[i].type);
+#endif
+            IMG_SetLoadType(supported[i].type);
+            return supported[i].load(src);
+        }
+    }
+
+    SDL_SetError("Unsupported image format");
+    return NULL;
+}
+
 /* Load an image from an SDL datasource, optionally specifying the type */
 SDL_Surface *IMG_LoadTyped_IO(SDL_IOStream *src, bool closeio, const char *type)
 {
-    size_t i;
     SDL_Surface *image;
+    IMG_LoadStats stats;
+    SDL_IOStream *stats_src;
 
     /* Make sure there is something to do.. */
     if (!src) {
@@ -177,37 +440,654 @@ SDL_Surface *IMG_LoadTyped_IO(SDL_IOStream *src, bool closeio, const char *type)
     }
 #endif
 
-    /* Detect the type of image being loaded */
-    for (i = 0; i < SDL_arraysize(supported); ++i) {
-        if (supported[i].is) {
-            if (!supported[i].is(src)) {
-                continue;
+    stats_src = IMG_BeginLoadStats(&stats, src);
+    if (IMG_IsDiskCacheEnabled()) {
+        image = IMG_LoadDiskCached(stats_src ? stats_src : src, type, LoadSupportedType);
+    } else {
+        image = LoadSupportedType(stats_src ? stats_src : src, type);
+    }
+    IMG_FinishLoadStats(&stats, image);
+    if (closeio) {
+        SDL_CloseIO(src);
+    }
+    return image;
+}
+
+/* Create a surface for a decoder, sharing the pixels of the target if it matches */
+SDL_Surface *IMG_CreateLoadSurface(int width, int height, SDL_PixelFormat format, const IMG_LoadOptions *options)
+{
+    SDL_Surface *target = options ? options->target : NULL;
+
+    if (target && target->w == width && target->h == height && target->format == format) {
+        return SDL_CreateSurfaceFrom(width, height, format, target->pixels, target->pitch);
+    }
+    if (!IMG_CheckImageLimits(width, height, format)) {
+        return NULL;
+    }
+    return SDL_CreateSurface(width, height, format);
+}
+
+/* Get the size of an image after scaling, returns true if it differs from the original size */
+bool IMG_GetLoadSize(const IMG_LoadOptions *options, int width, int height, int *out_width, int *out_height)
+{
+    int w = width;
+    int h = height;
+
+    if (options->scale_denom > 1) {
+        w = (w + options->scale_denom - 1) / options->scale_denom;
+        h = (h + options->scale_denom - 1) / options->scale_denom;
+    }
+    if (options->max_width > 0 && w > options->max_width) {
+        h = SDL_max(1, (int)((Sint64)h * options->max_width / w));
+        w = options->max_width;
+    }
+    if (options->max_height > 0 && h > options->max_height) {
+        w = SDL_max(1, (int)((Sint64)w * options->max_height / h));
+        h = options->max_height;
+    }
+    *out_width = w;
+    *out_height = h;
+
+    return (w != width || h != height);
+}
+
+/* Clip the requested region to the image */
+bool IMG_GetLoadRegion(const IMG_LoadOptions *options, int width, int height, SDL_Rect *region)
+{
+    SDL_Rect bounds;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = width;
+    bounds.h = height;
+    if (!SDL_GetRectIntersection(&bounds, options->region, region)) {
+        return SDL_SetError("Region is outside of the %dx%d image", width, height);
+    }
+    return true;
+}
+
+/* Reduce an image with a box filter, averaging the source pixels covered by each destination pixel */
+static SDL_Surface *ScaleSurfaceBox(SDL_Surface *surface, int width, int height)
+{
+    SDL_Surface *converted = NULL;
+    SDL_Surface *scaled = NULL;
+    Uint32 *sums = NULL;
+    int *columns = NULL;
+    Uint32 key;
+    int bpp, x, y, i;
+
+    /* Every byte must be an 8-bit channel so they can be averaged separately */
+    if (SDL_PIXELTYPE(surface->format) != SDL_PIXELTYPE_ARRAYU8 &&
+        (SDL_PIXELTYPE(surface->format) != SDL_PIXELTYPE_PACKED32 || SDL_PIXELLAYOUT(surface->format) != SDL_PACKEDLAYOUT_8888)) {
+        converted = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_ARGB8888);
+        if (!converted) {
+            return NULL;
+        }
+        surface = converted;
+    }
+    bpp = SDL_BYTESPERPIXEL(surface->format);
+
+    scaled = SDL_CreateSurface(width, height, surface->format);
+    if (!scaled) {
+        goto done;
+    }
+    if (!SDL_SetSurfaceColorspace(scaled, SDL_GetSurfaceColorspace(surface)) ||
+        !SDL_CopyProperties(SDL_GetSurfaceProperties(surface), SDL_GetSurfaceProperties(scaled))) {
+        goto error;
+    }
+    if (SDL_GetSurfaceColorKey(surface, &key) && !SDL_SetSurfaceColorKey(scaled, true, key)) {
+        goto error;
+    }
+
+    /* The image is only ever reduced, so each destination pixel covers at least one source pixel */
+    sums = (Uint32 *)SDL_malloc((size_t)width * bpp * sizeof(*sums));
+    columns = (int *)SDL_malloc((size_t)(width + 1) * sizeof(*columns));
+    if (!sums || !columns) {
+        goto error;
+    }
+    for (x = 0; x <= width; ++x) {
+        columns[x] = (int)((Sint64)x * surface->w / width);
+    }
+
+    for (y = 0; y < height; ++y) {
+        int y0 = (int)((Sint64)y * surface->h / height);
+        int y1 = (int)((Sint64)(y + 1) * surface->h / height);
+        Uint8 *dst = (Uint8 *)scaled->pixels + y * scaled->pitch;
+        int sy;
+
+        SDL_memset(sums, 0, (size_t)width * bpp * sizeof(*sums));
+        for (sy = y0; sy < y1; ++sy) {
+            const Uint8 *src = (const Uint8 *)surface->pixels + sy * surface->pitch;
+            Uint32 *sum = sums;
+
+            for (x = 0; x < width; ++x) {
+                const Uint8 *end = src + columns[x + 1] * bpp;
+
+                while (src < end) {
+                    for (i = 0; i < bpp; ++i) {
+                        sum[i] += *src++;
+                    }
+                }
+                sum += bpp;
+            }
+        }
+        for (x = 0; x < width; ++x) {
+            Uint32 count = (Uint32)((columns[x + 1] - columns[x]) * (y1 - y0));
+            const Uint32 *sum = &sums[x * bpp];
+
+            for (i = 0; i < bpp; ++i) {
+                *dst++ = (Uint8)((sum[i] + count / 2) / count);
+            }
+        }
+    }
+    goto done;
+
+error:
+    SDL_DestroySurface(scaled);
+    scaled = NULL;
+done:
+    SDL_free(columns);
+    SDL_free(sums);
+    if (converted) {
+        SDL_DestroySurface(converted);
+    }
+    return scaled;
+}
+
+/* Load an image, letting its decoder apply as many of the options as it can */
+static SDL_Surface *LoadTypedWithOptions_IO(SDL_IOStream *src, const char *type, IMG_LoadOptions *options)
+{
+    size_t i;
+    const char *detected = NULL;
+
+    /* See whether or not this data source can handle seeking */
+    if (SDL_SeekIO(src, 0, SDL_IO_SEEK_CUR) < 0) {
+        SDL_SetError("Can't seek in this data source");
+        return NULL;
+    }
+
+    /* Magicless formats can only be identified by type */
+    if (type) {
+        for (i = 0; i < SDL_arraysize(supported) && supported[i].magicless; ++i) {
+            if (SDL_strcasecmp(type, supported[i].type) == 0) {
+                detected = supported[i].type;
+                break;
             }
+        }
+    }
+    if (!detected) {
+        detected = IMG_DetectFormat(src);
+    }
+    if (detected) {
+        for (i = 0; i < SDL_arraysize(supported_options); ++i) {
+            if (SDL_strcmp(detected, supported_options[i].type) == 0) {
+                IMG_SetLoadType(supported_options[i].type);
+                return supported_options[i].load(src, options);
+            }
+        }
+    }
+
+    /* This format doesn't support any options, the caller converts the result */
+    return IMG_LoadTyped_IO(src, false, type);
+}
+
+SDL_Surface *IMG_LoadWithProperties(SDL_PropertiesID props)
+{
+    IMG_LoadOptions options;
+    SDL_Surface *image = NULL;
+    IMG_LoadStats stats;
+    IMG_LoadProgress progress;
+    IMG_DecodeLimits limits;
+    SDL_IOStream *stats_src;
+    int width, height;
+
+    if (!props) {
+        SDL_InvalidParamError("props");
+        return NULL;
+    }
+    SDL_SetNumberProperty(props, IMG_PROP_LOAD_STATUS_NUMBER, IMG_LOAD_STATUS_FAILED);
+
+    const char *file = SDL_GetStringProperty(props, IMG_PROP_LOAD_FILENAME_STRING, NULL);
+    SDL_IOStream *src = SDL_GetPointerProperty(props, IMG_PROP_LOAD_IOSTREAM_POINTER, NULL);
+    bool closeio = SDL_GetBooleanProperty(props, IMG_PROP_LOAD_IOSTREAM_AUTOCLOSE_BOOLEAN, false);
+    const char *type = SDL_GetStringProperty(props, IMG_PROP_LOAD_TYPE_STRING, NULL);
+    SDL_PixelFormat format = (SDL_PixelFormat)SDL_GetNumberProperty(props, IMG_PROP_LOAD_PIXEL_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN);
+    int scale_denom = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_SCALE_DENOMINATOR_NUMBER, 1);
+    int max_width = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_MAX_WIDTH_NUMBER, 0);
+    int max_height = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_MAX_HEIGHT_NUMBER, 0);
+    IMG_LoadProgressCallback progress_callback = (IMG_LoadProgressCallback)SDL_GetPointerProperty(props, IMG_PROP_LOAD_PROGRESS_CALLBACK_POINTER, NULL);
+    void *progress_userdata = SDL_GetPointerProperty(props, IMG_PROP_LOAD_PROGRESS_USERDATA_POINTER, NULL);
+    Uint64 deadline = (Uint64)SDL_GetNumberProperty(props, IMG_PROP_LOAD_DEADLINE_NUMBER, 0);
+
+    IMG_GetDecodeLimits(&limits);
+    limits.max_pixels = SDL_GetNumberProperty(props, IMG_PROP_LOAD_MAX_PIXELS_NUMBER, limits.max_pixels);
+    limits.max_bytes = SDL_GetNumberProperty(props, IMG_PROP_LOAD_MAX_BYTES_NUMBER, limits.max_bytes);
+
+    if ((!type || !*type) && file) {
+        type = SDL_strrchr(file, '.');
+        if (type) {
+            // Skip the '.' in the file extension
+            ++type;
+        }
+    }
+
+    if (!src) {
+        if (!file) {
+            SDL_SetError("No input properties set");
+            return NULL;
+        }
+
+        src = IMG_OpenFile(file);
+        if (!src) {
+            return NULL;
+        }
+        closeio = true;
+    }
+
+    if (scale_denom < 1) {
+        SDL_SetError("Invalid scale denominator %d", scale_denom);
+        goto done;
+    }
+
+    SDL_zero(options);
+    options.format = format;
+    options.scale_denom = scale_denom;
+    options.max_width = max_width;
+    options.max_height = max_height;
+
+    stats_src = IMG_BeginLoadStats(&stats, src);
+    IMG_BeginLoadProgress(&progress, progress_callback, progress_userdata, deadline);
+    IMG_PushDecodeLimits(&limits);
+    image = LoadTypedWithOptions_IO(stats_src ? stats_src : src, type, &options);
+    IMG_PopDecodeLimits(&limits);
+    if (image && !IMG_UpdateLoadProgress(1, 1)) {
+        /* The load was cancelled while a decoder that can't stop early was running */
+        SDL_DestroySurface(image);
+        image = NULL;
+    }
+    IMG_EndLoadProgress(&progress);
+    if (progress.timed_out) {
+        SDL_SetNumberProperty(props, IMG_PROP_LOAD_STATUS_NUMBER, IMG_LOAD_STATUS_TIMED_OUT);
+    } else if (progress.cancelled) {
+        SDL_SetNumberProperty(props, IMG_PROP_LOAD_STATUS_NUMBER, IMG_LOAD_STATUS_CANCELLED);
+    }
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_CONVERT);
+    if (image) {
+        if (options.scaled_width > 0) {
+            /* The decoder only scaled the image partway */
+            width = options.scaled_width;
+            height = options.scaled_height;
         } else {
-            /* magicless format */
-            if (!type || SDL_strcasecmp(type, supported[i].type) != 0) {
-                continue;
+            IMG_GetLoadSize(&options, image->w, image->h, &width, &height);
+        }
+        if (image->w != width || image->h != height) {
+            /* The decoder couldn't scale the image natively, or not all the way */
+            SDL_Surface *scaled = ScaleSurfaceBox(image, width, height);
+            SDL_DestroySurface(image);
+            image = scaled;
+        }
+    }
+    if (image && format != SDL_PIXELFORMAT_UNKNOWN && image->format != format) {
+        /* The decoder couldn't produce this format natively */
+        SDL_Surface *converted = SDL_ConvertSurface(image, format);
+        SDL_DestroySurface(image);
+        image = converted;
+    }
+    IMG_FinishLoadStats(&stats, image);
+    if (image) {
+        SDL_SetNumberProperty(props, IMG_PROP_LOAD_STATUS_NUMBER, IMG_LOAD_STATUS_OK);
+    }
+
+done:
+    if (closeio) {
+        SDL_CloseIO(src);
+    }
+    return image;
+}
+
+/* Copy the palette, colorkey and colorspace of a decoded image to a surface of the same format */
+static bool CopySurfaceAttributes(SDL_Surface *surface, SDL_Surface *dst)
+{
+    Uint32 key;
+
+    if (!SDL_SetSurfaceColorspace(dst, SDL_GetSurfaceColorspace(surface)) ||
+        !SDL_CopyProperties(SDL_GetSurfaceProperties(surface), SDL_GetSurfaceProperties(dst))) {
+        return false;
+    }
+    if (SDL_ISPIXELFORMAT_INDEXED(surface->format)) {
+        SDL_Palette *palette = SDL_GetSurfacePalette(surface);
+        if (palette && !SDL_SetSurfacePalette(dst, palette)) {
+            return false;
+        }
+    }
+    if (SDL_GetSurfaceColorKey(surface, &key)) {
+        return SDL_SetSurfaceColorKey(dst, true, key);
+    }
+    return true;
+}
+
+/* Copy a decoded image into the caller's surface, converting it if needed */
+static bool CopySurfaceInto(SDL_Surface *surface, SDL_Surface *dst)
+{
+    SDL_Surface *converted = NULL;
+    bool result;
+
+    if (surface->format == dst->format) {
+        if (!CopySurfaceAttributes(surface, dst)) {
+            return false;
+        }
+    } else if (SDL_ISPIXELFORMAT_INDEXED(dst->format)) {
+        return SDL_SetError("Can't convert %s image to %s", SDL_GetPixelFormatName(surface->format), SDL_GetPixelFormatName(dst->format));
+    } else if (SDL_ISPIXELFORMAT_INDEXED(surface->format) || SDL_SurfaceHasColorKey(surface)) {
+        /* The palette and colorkey need a full surface conversion */
+        converted = SDL_ConvertSurface(surface, dst->format);
+        if (!converted) {
+            return false;
+        }
+        surface = converted;
+    }
+
+    result = SDL_ConvertPixels(surface->w, surface->h, surface->format, surface->pixels, surface->pitch,
+                               dst->format, dst->pixels, dst->pitch);
+    if (converted) {
+        SDL_DestroySurface(converted);
+    }
+    return result;
+}
+
+/* Load an image from an SDL datasource into an existing surface */
+bool IMG_LoadInto_IO(SDL_IOStream *src, bool closeio, SDL_Surface *dst)
+{
+    return IMG_LoadTypedInto_IO(src, closeio, NULL, dst);
+}
+
+/* Load an image from an SDL datasource into an existing surface, optionally specifying the type */
+/* Decode an image into a locked surface, setting `decode_failed` if the image itself couldn't be decoded */
+static bool LoadIntoLockedSurface(SDL_IOStream *src, const char *type, SDL_Surface *dst, bool *decode_failed)
+{
+    IMG_LoadOptions options;
+    SDL_Surface *image;
+    bool result = false;
+
+    /* Ask the decoder for the surface format, so no conversion is needed */
+    SDL_zero(options);
+    options.target = dst;
+    options.format = dst->format;
+
+    image = LoadTypedWithOptions_IO(src, type, &options);
+    if (!image) {
+        if (decode_failed) {
+            *decode_failed = true;
+        }
+        return false;
+    }
+
+    if (image->w != dst->w || image->h != dst->h) {
+        SDL_SetError("Image is %dx%d, surface is %dx%d", image->w, image->h, dst->w, dst->h);
+    } else if (image->pixels == dst->pixels) {
+        /* The image was decoded directly into the surface */
+        result = CopySurfaceAttributes(image, dst);
+    } else {
+        result = CopySurfaceInto(image, dst);
+    }
+    SDL_DestroySurface(image);
+    return result;
+}
+
+bool IMG_LoadTypedInto_IO(SDL_IOStream *src, bool closeio, const char *type, SDL_Surface *dst)
+{
+    bool result = false;
+
+    /* Make sure there is something to do.. */
+    if (!src) {
+        return SDL_InvalidParamError("src");
+    }
+    if (!dst) {
+        SDL_InvalidParamError("dst");
+        goto done;
+    }
+
+    if (!SDL_LockSurface(dst)) {
+        goto done;
+    }
+    result = LoadIntoLockedSurface(src, type, dst, NULL);
+    SDL_UnlockSurface(dst);
+
+done:
+    if (closeio) {
+        SDL_CloseIO(src);
+    }
+    return result;
+}
+
+/* Copy a region of a decoded image to a new surface */
+static SDL_Surface *CropSurface(SDL_Surface *surface, const SDL_Rect *region)
+{
+    SDL_Surface *converted = NULL;
+    SDL_Surface *cropped;
+    const Uint8 *src;
+    int bpp, y;
+
+    /* Pixels smaller than a byte can't be copied directly */
+    if (SDL_BITSPERPIXEL(surface->format) < 8) {
+        converted = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_ARGB8888);
+        if (!converted) {
+            return NULL;
+        }
+        surface = converted;
+    }
+    bpp = SDL_BYTESPERPIXEL(surface->format);
+
+    cropped = SDL_CreateSurface(region->w, region->h, surface->format);
+    if (cropped) {
+        if (CopySurfaceAttributes(surface, cropped)) {
+            src = (const Uint8 *)surface->pixels + region->y * surface->pitch + region->x * bpp;
+            for (y = 0; y < region->h; ++y) {
+                SDL_memcpy((Uint8 *)cropped->pixels + y * cropped->pitch, src, (size_t)region->w * bpp);
+                src += surface->pitch;
             }
+        } else {
+            SDL_DestroySurface(cropped);
+            cropped = NULL;
         }
-#ifdef DEBUG_IMGLIB
-        SDL_Log("IMGLIB: Loading image as %s\n", supported[i].type);
-#endif
-        image = supported[i].load(src);
-        if (closeio) {
-            SDL_CloseIO(src);
+    }
+    if (converted) {
+        SDL_DestroySurface(converted);
+    }
+    return cropped;
+}
+
+/* Load a region of an image from an SDL datasource */
+SDL_Surface *IMG_LoadRegion_IO(SDL_IOStream *src, bool closeio, const SDL_Rect *rect)
+{
+    IMG_LoadOptions options;
+    SDL_Surface *image = NULL;
+    SDL_Rect region;
+
+    /* Make sure there is something to do.. */
+    if (!src) {
+        SDL_InvalidParamError("src");
+        return NULL;
+    }
+    if (!rect) {
+        SDL_InvalidParamError("rect");
+        goto done;
+    }
+    if (SDL_RectEmpty(rect)) {
+        SDL_SetError("Region is empty");
+        goto done;
+    }
+
+    SDL_zero(options);
+    options.region = rect;
+
+    image = LoadTypedWithOptions_IO(src, NULL, &options);
+    if (image && options.region) {
+        /* The decoder couldn't crop the image natively */
+        SDL_Surface *cropped = NULL;
+
+        if (IMG_GetLoadRegion(&options, image->w, image->h, &region)) {
+            cropped = CropSurface(image, &region);
         }
-        return image;
+        SDL_DestroySurface(image);
+        image = cropped;
     }
 
+done:
     if (closeio) {
         SDL_CloseIO(src);
     }
-    SDL_SetError("Unsupported image format");
+    return image;
+}
+
+/* Detect the type of an image, magicless formats can only be identified by type */
+static const char *DetectImageType(SDL_IOStream *src, const char *type)
+{
+    size_t i;
+
+    if (type) {
+        for (i = 0; i < SDL_arraysize(supported) && supported[i].magicless; ++i) {
+            if (SDL_strcasecmp(type, supported[i].type) == 0) {
+                return supported[i].type;
+            }
+        }
+    }
+    return IMG_DetectFormat(src);
+}
+
+/* Get image information from the image header, returns false if there's no header-only path for the format */
+static bool GetImageHeaderInfo(SDL_IOStream *src, const char *type, SDL_PropertiesID props)
+{
+    Sint64 start = SDL_TellIO(src);
+    size_t i;
+    bool result;
+
+    for (i = 0; i < SDL_arraysize(supported_info); ++i) {
+        if (SDL_strcmp(type, supported_info[i].type) == 0) {
+            result = supported_info[i].info(src, props);
+            SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+            return result;
+        }
+    }
+    return false;
+}
+
+/* Choose a texture format the renderer supports for an image, preferring the one the decoder produces */
+static SDL_PixelFormat GetStreamingTextureFormat(SDL_Renderer *renderer, SDL_PixelFormat format, bool has_alpha)
+{
+    const SDL_PixelFormat *texture_formats;
+    SDL_PixelFormat preferred[3];
+    size_t i;
+    int j;
+
+    texture_formats = (const SDL_PixelFormat *)SDL_GetPointerProperty(SDL_GetRendererProperties(renderer), SDL_PROP_RENDERER_TEXTURE_FORMATS_POINTER, NULL);
+    if (!texture_formats) {
+        return SDL_PIXELFORMAT_UNKNOWN;
+    }
+
+    preferred[0] = format;
+    if (has_alpha) {
+        preferred[1] = SDL_PIXELFORMAT_ARGB8888;
+        preferred[2] = SDL_PIXELFORMAT_ABGR8888;
+    } else {
+        preferred[1] = SDL_PIXELFORMAT_XRGB8888;
+        preferred[2] = SDL_PIXELFORMAT_XBGR8888;
+    }
+
+    for (i = 0; i < SDL_arraysize(preferred); ++i) {
+        if (preferred[i] == SDL_PIXELFORMAT_UNKNOWN ||
+            SDL_ISPIXELFORMAT_INDEXED(preferred[i]) ||
+            SDL_ISPIXELFORMAT_FOURCC(preferred[i]) ||
+            (has_alpha && !SDL_ISPIXELFORMAT_ALPHA(preferred[i]))) {
+            continue;
+        }
+        for (j = 0; texture_formats[j] != SDL_PIXELFORMAT_UNKNOWN; ++j) {
+            if (texture_formats[j] == preferred[i]) {
+                return preferred[i];
+            }
+        }
+    }
+    return SDL_PIXELFORMAT_UNKNOWN;
+}
+
+/* Decode an image straight into a locked streaming texture, without an intermediate surface.
+ * Returns NULL with the stream at its original position if this isn't possible, or with
+ * `decode_failed` set if the image couldn't be decoded.
+ */
+static SDL_Texture *LoadStreamingTexture(SDL_Renderer *renderer, SDL_IOStream *src, const char *type, bool *decode_failed)
+{
+#ifdef __EMSCRIPTEN__
+    /* Let IMG_LoadTyped_IO() check for preloaded image data */
     return NULL;
+#else
+    Sint64 start;
+    const char *detected;
+    SDL_PropertiesID props;
+    SDL_PixelFormat format = SDL_PIXELFORMAT_UNKNOWN;
+    SDL_Texture *texture = NULL;
+    SDL_Surface *surface;
+    bool has_alpha = false;
+    bool loaded = false;
+    int w = 0, h = 0;
+
+    /* Other renderers keep a copy of streaming textures in memory, so only the software renderer saves anything */
+    if (!SDL_GetHintBoolean(IMG_HINT_STREAMING_TEXTURES, false) ||
+        SDL_strcmp(SDL_GetRendererName(renderer), SDL_SOFTWARE_RENDERER) != 0) {
+        return NULL;
+    }
+
+    start = SDL_TellIO(src);
+    if (start < 0) {
+        return NULL;
+    }
+
+    detected = DetectImageType(src, type);
+    if (!detected) {
+        return NULL;
+    }
+
+    props = SDL_CreateProperties();
+    if (!props) {
+        return NULL;
+    }
+    if (GetImageHeaderInfo(src, detected, props) &&
+        SDL_GetNumberProperty(props, IMG_PROP_INFO_BIT_DEPTH_NUMBER, 8) <= 8) {
+        w = (int)SDL_GetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, 0);
+        h = (int)SDL_GetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, 0);
+        has_alpha = SDL_GetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, false);
+        format = GetStreamingTextureFormat(renderer, (SDL_PixelFormat)SDL_GetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN), has_alpha);
+    }
+    SDL_DestroyProperties(props);
+
+    if (w <= 0 || h <= 0 || format == SDL_PIXELFORMAT_UNKNOWN) {
+        return NULL;
+    }
+
+    texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STREAMING, w, h);
+    if (!texture) {
+        return NULL;
+    }
+    if (SDL_LockTextureToSurface(texture, NULL, &surface)) {
+        loaded = LoadIntoLockedSurface(src, type, surface, decode_failed);
+        SDL_UnlockTexture(texture);
+    }
+    if (!loaded) {
+        SDL_DestroyTexture(texture);
+        SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+        return NULL;
+    }
+
+    if (has_alpha) {
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    }
+    return texture;
+#endif
 }
 
 SDL_Texture *IMG_LoadTexture(SDL_Renderer *renderer, const char *file)
 {
+#if defined(__EMSCRIPTEN__) || (defined(__APPLE__) && !defined(SDL_IMAGE_USE_COMMON_BACKEND))
+    /* IMG_Load() has a platform specific path for files */
     SDL_Texture *texture = NULL;
     SDL_Surface *surface = IMG_Load(file);
     if (surface) {
@@ -215,23 +1095,51 @@ SDL_Texture *IMG_LoadTexture(SDL_Renderer *renderer, const char *file)
         SDL_DestroySurface(surface);
     }
     return texture;
+#else
+    SDL_IOStream *src = IMG_OpenFile(file);
+    const char *ext = SDL_strrchr(file, '.');
+    if (ext) {
+        ext++;
+    }
+    if (!src) {
+        /* The error message has been set in IMG_OpenFile */
+        return NULL;
+    }
+    return IMG_LoadTextureTyped_IO(renderer, src, true, ext);
+#endif
 }
 
 SDL_Texture *IMG_LoadTexture_IO(SDL_Renderer *renderer, SDL_IOStream *src, bool closeio)
 {
-    SDL_Texture *texture = NULL;
-    SDL_Surface *surface = IMG_Load_IO(src, closeio);
-    if (surface) {
-        texture = SDL_CreateTextureFromSurface(renderer, surface);
-        SDL_DestroySurface(surface);
-    }
-    return texture;
+    return IMG_LoadTextureTyped_IO(renderer, src, closeio, NULL);
 }
 
 SDL_Texture *IMG_LoadTextureTyped_IO(SDL_Renderer *renderer, SDL_IOStream *src, bool closeio, const char *type)
 {
     SDL_Texture *texture = NULL;
-    SDL_Surface *surface = IMG_LoadTyped_IO(src, closeio, type);
+    SDL_Surface *surface;
+    bool decode_failed = false;
+
+    if (!renderer) {
+        SDL_InvalidParamError("renderer");
+        if (src && closeio) {
+            SDL_CloseIO(src);
+        }
+        return NULL;
+    }
+
+    if (src) {
+        texture = LoadStreamingTexture(renderer, src, type, &decode_failed);
+        if (texture || decode_failed) {
+            /* Decoding the image a second time would fail the same way */
+            if (closeio) {
+                SDL_CloseIO(src);
+            }
+            return texture;
+        }
+    }
+
+    surface = IMG_LoadTyped_IO(src, closeio, type);
     if (surface) {
         texture = SDL_CreateTextureFromSurface(renderer, surface);
         SDL_DestroySurface(surface);
@@ -242,13 +1150,13 @@ SDL_Texture *IMG_LoadTextureTyped_IO(SDL_Renderer *renderer, SDL_IOStream *src,
 /* Load an animation from a file */
 IMG_Animation *IMG_LoadAnimation(const char *file)
 {
-    SDL_IOStream *src = SDL_IOFromFile(file, "rb");
+    SDL_IOStream *src = IMG_OpenFile(file);
     const char *ext = SDL_strrchr(file, '.');
     if (ext) {
         ext++;
     }
     if (!src) {
-        /* The error message has been set in SDL_IOFromFile */
+        /* The error message has been set in IMG_OpenFile */
         return NULL;
     }
     return IMG_LoadAnimationTyped_IO(src, true, ext);
@@ -264,6 +1172,7 @@ IMG_Animation *IMG_LoadAnimation_IO(SDL_IOStream *src, bool closeio)
 IMG_Animation *IMG_LoadAnimationTyped_IO(SDL_IOStream *src, bool closeio, const char *type)
 {
     size_t i;
+    const char *detected;
     IMG_Animation *anim;
     SDL_Surface *image;
 
@@ -283,25 +1192,21 @@ IMG_Animation *IMG_LoadAnimationTyped_IO(SDL_IOStream *src, bool closeio, const
     }
 
     /* Detect the type of image being loaded */
-    for (i = 0; i < SDL_arraysize(supported_anims); ++i) {
-        if (supported_anims[i].is) {
-            if (!supported_anims[i].is(src)) {
+    detected = IMG_DetectFormat(src);
+    if (detected) {
+        for (i = 0; i < SDL_arraysize(supported_anims); ++i) {
+            if (SDL_strcmp(detected, supported_anims[i].type) != 0) {
                 continue;
             }
-        } else {
-            /* magicless format */
-            if (!type || SDL_strcasecmp(type, supported_anims[i].type) != 0) {
-                continue;
-            }
-        }
 #ifdef DEBUG_IMGLIB
-        SDL_Log("IMGLIB: Loading image as %s\n", supported_anims[i].type);
+            SDL_Log("IMGLIB: Loading image as %s\n", supported_anims[i].type);
 #endif
-        anim = supported_anims[i].load(src);
-        if (closeio) {
-            SDL_CloseIO(src);
+            anim = supported_anims[i].load(src);
+            if (closeio) {
+                SDL_CloseIO(src);
+            }
+            return anim;
         }
-        return anim;
     }
 
     /* Create a single frame animation from an image */
@@ -326,6 +1231,109 @@ IMG_Animation *IMG_LoadAnimationTyped_IO(SDL_IOStream *src, bool closeio, const
     return NULL;
 }
 
+/* Get image information from a file */
+SDL_PropertiesID IMG_GetImageInfo(const char *file)
+{
+    SDL_IOStream *src = SDL_IOFromFile(file, "rb");
+    const char *ext = SDL_strrchr(file, '.');
+    if (ext) {
+        ext++;
+    }
+    if (!src) {
+        /* The error message has been set in SDL_IOFromFile */
+        return 0;
+    }
+    return IMG_GetImageInfoTyped_IO(src, true, ext);
+}
+
+/* Get image information from an SDL datasource */
+SDL_PropertiesID IMG_GetImageInfo_IO(SDL_IOStream *src, bool closeio)
+{
+    return IMG_GetImageInfoTyped_IO(src, closeio, NULL);
+}
+
+static int GetFormatBitDepth(SDL_PixelFormat format)
+{
+    const SDL_PixelFormatDetails *details = SDL_GetPixelFormatDetails(format);
+    if (!details) {
+        return 0;
+    }
+    if (SDL_ISPIXELFORMAT_INDEXED(format) || details->Rbits == 0) {
+        return details->bits_per_pixel;
+    }
+    return details->Rbits;
+}
+
+/* Get image information by decoding the image, for formats without a header-only path */
+static bool GetImageInfoFromAnimation(SDL_IOStream *src, const char *type, SDL_PropertiesID props)
+{
+    IMG_Animation *anim = IMG_LoadAnimationTyped_IO(src, false, type);
+    if (!anim) {
+        return false;
+    }
+
+    SDL_Surface *image = anim->frames[0];
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, anim->w);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, anim->h);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, image->format);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_BIT_DEPTH_NUMBER, GetFormatBitDepth(image->format));
+    SDL_SetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, SDL_ISPIXELFORMAT_ALPHA(image->format) || SDL_SurfaceHasColorKey(image));
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_FRAME_COUNT_NUMBER, anim->count);
+    IMG_FreeAnimation(anim);
+    return true;
+}
+
+/* Get image information from an SDL datasource, optionally specifying the type */
+SDL_PropertiesID IMG_GetImageInfoTyped_IO(SDL_IOStream *src, bool closeio, const char *type)
+{
+    Sint64 start;
+    const char *detected;
+    SDL_PropertiesID props = 0;
+    bool result = false;
+
+    /* Make sure there is something to do.. */
+    if (!src) {
+        SDL_InvalidParamError("src");
+        return 0;
+    }
+
+    /* See whether or not this data source can handle seeking */
+    start = SDL_TellIO(src);
+    if (start < 0) {
+        SDL_SetError("Can't seek in this data source");
+        goto done;
+    }
+
+    detected = DetectImageType(src, type);
+    if (!detected) {
+        SDL_SetError("Unsupported image format");
+        goto done;
+    }
+
+    props = SDL_CreateProperties();
+    if (!props) {
+        goto done;
+    }
+    SDL_SetStringProperty(props, IMG_PROP_INFO_TYPE_STRING, detected);
+
+    result = GetImageHeaderInfo(src, detected, props);
+    if (!result) {
+        /* No header-only path for this format or backend, decode the image instead */
+        result = GetImageInfoFromAnimation(src, detected, props);
+        SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+    }
+
+done:
+    if (!result && props) {
+        SDL_DestroyProperties(props);
+        props = 0;
+    }
+    if (closeio) {
+        SDL_CloseIO(src);
+    }
+    return props;
+}
+
 bool IMG_Save(SDL_Surface *surface, const char *file)
 {
     if (!surface) {
@@ -11,6 +11,8 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_limits.h"
+
 // Used because CGDataProviderCreate became deprecated in 10.5
 #include <AvailabilityMacros.h>
 #include <TargetConditionals.h>
@@ -224,6 +226,11 @@ static SDL_Surface* Create_SDL_Surface_From_CGImage_RGB(CGImageRef image_ref)
         format = SDL_PIXELFORMAT_ARGB8888;
     }
 
+    if (!IMG_CheckImageLimits((Sint64)w, (Sint64)h, format)) {
+        CGColorSpaceRelease(color_space);
+        return NULL;
+    }
+
     surface = SDL_CreateSurface((int)w, (int)h, format);
     if (surface)
     {
@@ -306,6 +313,10 @@ static SDL_Surface* Create_SDL_Surface_From_CGImage_Index(CGImageRef image_ref)
         return NULL;
     }
 
+    if (!IMG_CheckImageLimits((Sint64)w, (Sint64)h, SDL_PIXELFORMAT_INDEX8)) {
+        return NULL;
+    }
+
     CGColorSpaceGetColorTable(color_space, entries);
     surface = SDL_CreateSurface((int)w, (int)h, SDL_PIXELFORMAT_INDEX8);
     if (surface) {
@@ -22,15 +22,20 @@
 #if defined(SDL_IMAGE_USE_WIC_BACKEND)
 
 #include <SDL3_image/SDL_image.h>
+
+#include "IMG_limits.h"
+#include "IMG_stats.h"
+
 #define COBJMACROS
 #include <initguid.h>
 #include <wincodec.h>
 
+static SDL_InitState wicInit;
 static IWICImagingFactory* wicFactory = NULL;
 
 static bool WIC_Init(void)
 {
-    if (wicFactory == NULL) {
+    if (SDL_ShouldInit(&wicInit)) {
         HRESULT hr = CoCreateInstance(
             &CLSID_WICImagingFactory,
             NULL,
@@ -38,9 +43,8 @@ static bool WIC_Init(void)
             &IID_IWICImagingFactory,
             (void**)&wicFactory
         );
-        if (FAILED(hr)) {
-            return false;
-        }
+        SDL_SetInitialized(&wicInit, SUCCEEDED(hr));
+        return SUCCEEDED(hr);
     }
 
     return true;
@@ -49,8 +53,10 @@ static bool WIC_Init(void)
 #if 0
 static void WIC_Quit(void)
 {
-    if (wicFactory) {
+    if (SDL_ShouldQuit(&wicInit)) {
         IWICImagingFactory_Release(wicFactory);
+        wicFactory = NULL;
+        SDL_SetInitialized(&wicInit, false);
     }
 }
 #endif // 0
@@ -220,6 +226,11 @@ static SDL_Surface* WIC_LoadImage(SDL_IOStream *src)
     DONE_IF_FAILED(IWICBitmapFrameDecode_GetSize(bitmapFrame, &width, &height));
 #undef DONE_IF_FAILED
 
+    if (!IMG_CheckImageLimits(width, height, SDL_PIXELFORMAT_ABGR8888)) {
+        goto done;
+    }
+
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     surface = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_ABGR8888);
     IWICFormatConverter_CopyPixels(
         formatConverter,
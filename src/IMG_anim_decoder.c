@@ -26,6 +26,9 @@
 #include "IMG_avif.h"
 #include "IMG_gif.h"
 #include "IMG_libpng.h"
+#include "IMG_limits.h"
+#include "IMG_progress.h"
+#include "IMG_stats.h"
 #include "IMG_webp.h"
 
 IMG_AnimationDecoder *IMG_CreateAnimationDecoder(const char *file)
@@ -84,6 +87,18 @@ IMG_AnimationDecoder *IMG_CreateAnimationDecoderWithProperties(SDL_PropertiesID
     const char *type = SDL_GetStringProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_TYPE_STRING, NULL);
     int timebase_numerator = (int)SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_ENCODER_CREATE_TIMEBASE_NUMERATOR_NUMBER, 1);
     int timebase_denominator = (int)SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_ENCODER_CREATE_TIMEBASE_DENOMINATOR_NUMBER, 1000);
+    IMG_LoadProgressCallback progress_callback = (IMG_LoadProgressCallback)SDL_GetPointerProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_PROGRESS_CALLBACK_POINTER, NULL);
+    void *progress_userdata = SDL_GetPointerProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_PROGRESS_USERDATA_POINTER, NULL);
+    Uint64 deadline = (Uint64)SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_DEADLINE_NUMBER, 0);
+    bool borrow_frames = SDL_GetBooleanProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_BORROW_FRAMES_BOOLEAN, false);
+    bool recycle_frames = SDL_GetBooleanProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_RECYCLE_FRAMES_BOOLEAN, false);
+    IMG_DecodeLimits limits;
+
+    IMG_GetDecodeLimits(&limits);
+    limits.max_pixels = SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_MAX_PIXELS_NUMBER, limits.max_pixels);
+    limits.max_bytes = SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_MAX_BYTES_NUMBER, limits.max_bytes);
+    limits.max_frames = SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_MAX_FRAMES_NUMBER, limits.max_frames);
+    limits.max_animation_bytes = SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_MAX_TOTAL_BYTES_NUMBER, limits.max_animation_bytes);
 
     if (!type || !*type) {
         if (file) {
@@ -128,17 +143,47 @@ IMG_AnimationDecoder *IMG_CreateAnimationDecoderWithProperties(SDL_PropertiesID
     }
 
     decoder->src = src;
+    decoder->io = src;
     decoder->start = SDL_TellIO(src);
     decoder->closeio = closeio;
     decoder->timebase_numerator = timebase_numerator;
     decoder->timebase_denominator = timebase_denominator;
+    decoder->progress_callback = progress_callback;
+    decoder->progress_userdata = progress_userdata;
+    decoder->deadline = deadline;
+    decoder->borrow_frames = borrow_frames;
+    decoder->recycle_frames = recycle_frames && !borrow_frames;
+    decoder->limits = (IMG_DecodeLimits *)SDL_malloc(sizeof(*decoder->limits));
+    if (!decoder->limits) {
+        goto error;
+    }
+    *decoder->limits = limits;
     decoder->props = SDL_CreateProperties();
     if (!decoder->props) {
         SDL_SetError("Failed to create properties for animation decoder");
         goto error;
     }
 
+    if (SDL_GetHintBoolean(IMG_HINT_LOAD_STATS, false)) {
+        decoder->stats = (IMG_LoadStats *)SDL_malloc(sizeof(*decoder->stats));
+        if (!decoder->stats) {
+            goto error;
+        }
+        SDL_IOStream *stats_src = IMG_BeginLoadStats(decoder->stats, src);
+        if (stats_src) {
+            decoder->src = stats_src;
+        }
+        if (decoder->stats->enabled) {
+            IMG_SetLoadType(type);
+        } else {
+            /* This decoder is part of a load that is already being measured */
+            SDL_free(decoder->stats);
+            decoder->stats = NULL;
+        }
+    }
+
     bool result = false;
+    IMG_PushDecodeLimits(decoder->limits);
     if (SDL_strcasecmp(type, "ani") == 0) {
         result = IMG_CreateANIAnimationDecoder(decoder, props);
     } else if (SDL_strcasecmp(type, "apng") == 0 || SDL_strcasecmp(type, "png") == 0) {
@@ -152,12 +197,21 @@ IMG_AnimationDecoder *IMG_CreateAnimationDecoderWithProperties(SDL_PropertiesID
     } else {
         SDL_SetError("Unrecognized output type");
     }
+    IMG_PopDecodeLimits(decoder->limits);
 
     if (result) {
+        if (decoder->stats) {
+            IMG_SuspendLoadStats(decoder->stats);
+            IMG_PublishLoadStats(decoder->stats, decoder->props);
+        }
         return decoder;
     }
 
 error:
+    if (decoder && decoder->stats) {
+        IMG_EndLoadStats(decoder->stats, false);
+        SDL_free(decoder->stats);
+    }
     if (src) {
         if (closeio) {
             SDL_CloseIO(src);
@@ -166,6 +220,7 @@ error:
         }
     }
     if (decoder) {
+        SDL_free(decoder->limits);
         SDL_free(decoder);
     }
     return NULL;
@@ -197,26 +252,110 @@ bool IMG_GetAnimationDecoderFrame(IMG_AnimationDecoder *decoder, SDL_Surface **f
         duration = &temp_duration;
     }
 
+    // Frames can be decoded into the surface passed back in, or the last borrowed frame
+    if (decoder->recycle_frames) {
+        decoder->recycled = *frame;
+    } else if (decoder->borrow_frames) {
+        decoder->recycled = decoder->borrowed;
+        decoder->borrowed = NULL;
+    }
+    decoder->canvas_frame = NULL;
+    SDL_zero(decoder->dirty_rect);
+    *frame = NULL;
+
+    // A cancelled frame may have left the decoder part way through the stream
+    if (decoder->status == IMG_DECODER_STATUS_CANCELLED) {
+        SDL_DestroySurface(decoder->recycled);
+        decoder->recycled = NULL;
+        *duration = 0;
+        return SDL_SetError("Decoding was cancelled, reset the decoder to continue");
+    }
+
     // Reset the status before trying to get the next frame
     decoder->status = IMG_DECODER_STATUS_OK;
 
+    IMG_LoadProgress progress;
+    IMG_BeginLoadProgress(&progress, decoder->progress_callback, decoder->progress_userdata, decoder->deadline);
+    if (decoder->stats) {
+        IMG_ResumeLoadStats(decoder->stats, IMG_LOAD_PHASE_DECODE);
+    }
+    IMG_PushDecodeLimits(decoder->limits);
     bool result = decoder->GetNextFrame(decoder, frame, duration);
-    if (temp_frame) {
+    IMG_PopDecodeLimits(decoder->limits);
+    if (decoder->recycled) {
+        SDL_DestroySurface(decoder->recycled);
+        decoder->recycled = NULL;
+    }
+    if (result && decoder->borrow_frames && *frame != decoder->canvas_frame) {
+        // The caller only borrows the frame, the decoder frees it later
+        decoder->borrowed = *frame;
+    }
+    if (decoder->stats) {
+        IMG_SuspendLoadStats(decoder->stats);
+        IMG_PublishLoadStats(decoder->stats, decoder->props);
+    }
+    if (result && !IMG_UpdateLoadProgress(1, 1)) {
+        // The decoder couldn't stop early, drop the frame it finished
+        if (!decoder->borrow_frames) {
+            SDL_DestroySurface(*frame);
+        }
+        *frame = NULL;
+        temp_frame = NULL;
+        result = false;
+    }
+    if (result) {
+        // The first frame and frames from backends without dirty rects change everything
+        if (decoder->frames_decoded == 0 || !decoder->tracks_dirty_rects) {
+            decoder->dirty_rect.x = 0;
+            decoder->dirty_rect.y = 0;
+            decoder->dirty_rect.w = (*frame)->w;
+            decoder->dirty_rect.h = (*frame)->h;
+        }
+        decoder->frames_decoded += 1;
+        decoder->bytes_decoded += (Sint64)(*frame)->pitch * (*frame)->h;
+        if (!IMG_CheckAnimationLimits(decoder->limits, decoder->frames_decoded, decoder->bytes_decoded)) {
+            if (!decoder->borrow_frames) {
+                SDL_DestroySurface(*frame);
+            }
+            *frame = NULL;
+            temp_frame = NULL;
+            result = false;
+        }
+    }
+    bool cancelled = progress.cancelled;
+    IMG_EndLoadProgress(&progress);
+    if (temp_frame && !decoder->borrow_frames) {
         SDL_DestroySurface(temp_frame);
     }
 
     if (!result) {
-        if (decoder->status == IMG_DECODER_STATUS_COMPLETE) {
+        if (cancelled) {
+            decoder->status = IMG_DECODER_STATUS_CANCELLED;
+        } else if (decoder->status == IMG_DECODER_STATUS_COMPLETE) {
             SDL_ClearError();
         } else {
             decoder->status = IMG_DECODER_STATUS_FAILED;
         }
+        SDL_zero(decoder->dirty_rect);
         *frame = NULL;
         *duration = 0;
     }
     return result;
 }
 
+bool IMG_GetAnimationDecoderFrameRect(IMG_AnimationDecoder *decoder, SDL_Rect *rect)
+{
+    if (!decoder) {
+        return SDL_InvalidParamError("decoder");
+    }
+    if (!rect) {
+        return SDL_InvalidParamError("rect");
+    }
+
+    *rect = decoder->dirty_rect;
+    return true;
+}
+
 IMG_AnimationDecoderStatus IMG_GetAnimationDecoderStatus(IMG_AnimationDecoder* decoder)
 {
     if (!decoder) {
@@ -231,7 +370,14 @@ bool IMG_ResetAnimationDecoder(IMG_AnimationDecoder *decoder)
         return SDL_InvalidParamError("decoder");
     }
 
-    return decoder->Reset(decoder);
+    if (!decoder->Reset(decoder)) {
+        return false;
+    }
+    decoder->status = IMG_DECODER_STATUS_OK;
+    decoder->frames_decoded = 0;
+    decoder->bytes_decoded = 0;
+    SDL_zero(decoder->dirty_rect);
+    return true;
 }
 
 bool IMG_CloseAnimationDecoder(IMG_AnimationDecoder *decoder)
@@ -242,8 +388,13 @@ bool IMG_CloseAnimationDecoder(IMG_AnimationDecoder *decoder)
 
     bool result = decoder->Close(decoder);
 
+    if (decoder->stats) {
+        IMG_EndLoadStats(decoder->stats, decoder->status != IMG_DECODER_STATUS_FAILED && decoder->status != IMG_DECODER_STATUS_CANCELLED);
+        SDL_free(decoder->stats);
+    }
+
     if (decoder->closeio) {
-        result &= SDL_CloseIO(decoder->src);
+        result &= SDL_CloseIO(decoder->io);
     }
 
     if (decoder->props) {
@@ -251,10 +402,79 @@ bool IMG_CloseAnimationDecoder(IMG_AnimationDecoder *decoder)
         decoder->props = 0;
     }
 
+    SDL_DestroySurface(decoder->borrowed);
+    SDL_free(decoder->limits);
     SDL_free(decoder);
     return result;
 }
 
+SDL_Surface *IMG_CreateDecoderFrame(IMG_AnimationDecoder *decoder, int width, int height, SDL_PixelFormat format)
+{
+    SDL_Surface *surface = decoder->recycled;
+
+    decoder->recycled = NULL;
+    if (surface) {
+        if (surface->w == width && surface->h == height && surface->format == format &&
+            surface->pixels && !SDL_MUSTLOCK(surface)) {
+            return surface;
+        }
+        SDL_DestroySurface(surface);
+    }
+    return SDL_CreateSurface(width, height, format);
+}
+
+SDL_Surface *IMG_GetDecoderCanvasFrame(IMG_AnimationDecoder *decoder, SDL_Surface *canvas)
+{
+    SDL_Surface *frame;
+    SDL_BlendMode blend_mode;
+
+    if (decoder->borrow_frames) {
+        decoder->canvas_frame = canvas;
+        return canvas;
+    }
+
+    if (!decoder->recycled) {
+        return SDL_DuplicateSurface(canvas);
+    }
+
+    frame = IMG_CreateDecoderFrame(decoder, canvas->w, canvas->h, canvas->format);
+    if (!frame) {
+        return NULL;
+    }
+    if (!SDL_ConvertPixels(canvas->w, canvas->h, canvas->format, canvas->pixels, canvas->pitch,
+                           frame->format, frame->pixels, frame->pitch) ||
+        !SDL_GetSurfaceBlendMode(canvas, &blend_mode) ||
+        !SDL_SetSurfaceBlendMode(frame, blend_mode)) {
+        SDL_DestroySurface(frame);
+        return NULL;
+    }
+    return frame;
+}
+
+void IMG_AddDecoderDirtyRect(IMG_AnimationDecoder *decoder, const SDL_Surface *canvas, const SDL_Rect *rect)
+{
+    // Clip in 64 bits, the offsets and sizes in some formats are unchecked 32-bit values
+    Sint64 x1 = SDL_max((Sint64)rect->x, 0);
+    Sint64 y1 = SDL_max((Sint64)rect->y, 0);
+    Sint64 x2 = SDL_min((Sint64)rect->x + rect->w, (Sint64)canvas->w);
+    Sint64 y2 = SDL_min((Sint64)rect->y + rect->h, (Sint64)canvas->h);
+    SDL_Rect clipped;
+
+    if (x2 <= x1 || y2 <= y1) {
+        return;
+    }
+    clipped.x = (int)x1;
+    clipped.y = (int)y1;
+    clipped.w = (int)(x2 - x1);
+    clipped.h = (int)(y2 - y1);
+
+    if (SDL_RectEmpty(&decoder->dirty_rect)) {
+        decoder->dirty_rect = clipped;
+    } else {
+        SDL_GetRectUnion(&decoder->dirty_rect, &clipped, &decoder->dirty_rect);
+    }
+}
+
 Uint64 IMG_GetDecoderDuration(IMG_AnimationDecoder *decoder, Uint64 duration, Uint64 timebase_denominator)
 {
     Uint64 value = IMG_TimebaseDuration(decoder->accumulated_pts, duration, 1, timebase_denominator, decoder->timebase_numerator, decoder->timebase_denominator);
@@ -26,11 +26,26 @@ struct IMG_AnimationDecoder
     IMG_AnimationDecoderStatus status;
     SDL_PropertiesID props;
     SDL_IOStream *src;
+    SDL_IOStream *io;               /* the stream passed in, src may count reads for the stats */
+    struct IMG_LoadStats *stats;    /* NULL unless IMG_HINT_LOAD_STATS is set */
     Sint64 start;
     bool closeio;
     int timebase_numerator;
     int timebase_denominator;
     Uint64 accumulated_pts;
+    IMG_LoadProgressCallback progress_callback;
+    void *progress_userdata;
+    Uint64 deadline;
+    struct IMG_DecodeLimits *limits;
+    Sint64 frames_decoded;          /* since the decoder was created or reset, for the limits */
+    Sint64 bytes_decoded;
+    bool borrow_frames;             /* hand out frames the decoder keeps, valid until the next call */
+    bool recycle_frames;            /* the caller passes back a frame to overwrite */
+    SDL_Surface *recycled;          /* the surface the next frame can be decoded into */
+    SDL_Surface *borrowed;          /* the borrowed frame the decoder owns, if it isn't a canvas */
+    SDL_Surface *canvas_frame;      /* the canvas last handed out as a borrowed frame */
+    bool tracks_dirty_rects;        /* the backend reports the area each frame changes */
+    SDL_Rect dirty_rect;            /* the area of the last frame that changed */
 
     bool (*GetNextFrame)(IMG_AnimationDecoder *decoder, SDL_Surface **frame, Uint64 *duration);
     bool (*Reset)(IMG_AnimationDecoder *decoder);
@@ -42,4 +57,13 @@ struct IMG_AnimationDecoder
 extern Uint64 IMG_TimebaseDuration(Uint64 pts, Uint64 duration, Uint64 src_numerator, Uint64 src_denominator, Uint64 dst_numerator, Uint64 dst_denominator);
 extern Uint64 IMG_GetDecoderDuration(IMG_AnimationDecoder *decoder, Uint64 duration, Uint64 timebase_denominator);
 
+/* Create a surface for the next frame, reusing the recycled surface if it has the same size and format */
+extern SDL_Surface *IMG_CreateDecoderFrame(IMG_AnimationDecoder *decoder, int width, int height, SDL_PixelFormat format);
+
+/* Get the next frame from the canvas a decoder composites onto: the canvas itself if frames are borrowed, or a copy */
+extern SDL_Surface *IMG_GetDecoderCanvasFrame(IMG_AnimationDecoder *decoder, SDL_Surface *canvas);
+
+/* Add an area of the canvas that the next frame changes, clipped to the canvas */
+extern void IMG_AddDecoderDirtyRect(IMG_AnimationDecoder *decoder, const SDL_Surface *canvas, const SDL_Rect *rect);
+
 extern IMG_Animation *IMG_DecodeAsAnimation(SDL_IOStream *src, const char *format, int maxFrames);
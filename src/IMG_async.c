@@ -0,0 +1,700 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Asynchronous image loading on a pool of worker threads, and parallel batch loading */
+
+#include <SDL3_image/SDL_image.h>
+
+#include "IMG_progress.h"
+#include "IMG_scratch.h"
+
+/* Maximum number of worker threads */
+#define MAX_ASYNC_THREADS   8
+
+/* Worker threads exit after being idle for this long */
+#define ASYNC_IDLE_TIMEOUT  5000
+
+/* Number of file reads each batch worker keeps in flight */
+#define BATCH_READ_AHEAD    2
+
+/* The states of the files in a batch */
+#define BATCH_ITEM_UNCLAIMED    0
+#define BATCH_ITEM_READING      1   /* claimed by a worker that is reading it ahead */
+#define BATCH_ITEM_STARTED      2   /* being decoded, or done */
+
+typedef struct IMG_AsyncJob
+{
+    IMG_LoadID id;
+    char *file;
+    SDL_IOStream *src;
+    bool closeio;
+    SDL_Renderer *renderer;
+    IMG_LoadCallback callback;
+    IMG_LoadTextureCallback texture_callback;
+    void *userdata;
+    bool cancelled;
+    SDL_Surface *surface;
+    char *error;
+    struct IMG_AsyncJob *next;
+} IMG_AsyncJob;
+
+static SDL_InitState async_init;
+
+static struct
+{
+    SDL_Mutex *lock;
+    SDL_Condition *cond;
+    IMG_AsyncJob *queue_head;   /* waiting for a worker thread */
+    IMG_AsyncJob *queue_tail;
+    IMG_AsyncJob *running;      /* being decoded by a worker thread */
+    int num_threads;
+    int num_idle;
+    bool quit;                  /* set while IMG_QuitAsyncLoad() waits for the threads */
+    IMG_LoadID next_id;
+    Uint32 event_type;
+} pool;
+
+static bool InitAsyncLoad(void)
+{
+    if (SDL_ShouldInit(&async_init)) {
+        bool initialized = false;
+
+        pool.lock = SDL_CreateMutex();
+        pool.cond = SDL_CreateCondition();
+        if (!pool.event_type) {
+            /* The event type is kept if async loading is started again */
+            pool.event_type = SDL_RegisterEvents(1);
+        }
+        if (pool.lock && pool.cond) {
+            initialized = true;
+        } else {
+            SDL_DestroyCondition(pool.cond);
+            pool.cond = NULL;
+            SDL_DestroyMutex(pool.lock);
+            pool.lock = NULL;
+        }
+        SDL_SetInitialized(&async_init, initialized);
+        return initialized;
+    }
+    return true;
+}
+
+static void FreeJob(IMG_AsyncJob *job)
+{
+    if (job->src && job->closeio) {
+        SDL_CloseIO(job->src);
+    }
+    if (job->surface) {
+        SDL_DestroySurface(job->surface);
+    }
+    SDL_free(job->file);
+    SDL_free(job->error);
+    SDL_free(job);
+}
+
+/* Remove a job from a list, returns true if it was found */
+static bool RemoveJob(IMG_AsyncJob **list, IMG_AsyncJob **tail, IMG_AsyncJob *job)
+{
+    IMG_AsyncJob *prev = NULL;
+    IMG_AsyncJob *entry;
+
+    for (entry = *list; entry; prev = entry, entry = entry->next) {
+        if (entry == job) {
+            if (prev) {
+                prev->next = job->next;
+            } else {
+                *list = job->next;
+            }
+            if (tail && *tail == job) {
+                *tail = prev;
+            }
+            job->next = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+static IMG_AsyncJob *FindJob(IMG_AsyncJob *list, IMG_LoadID id)
+{
+    for (; list; list = list->next) {
+        if (list->id == id) {
+            return list;
+        }
+    }
+    return NULL;
+}
+
+/* Create the texture for IMG_LoadTextureAsync() on the main thread */
+static void SDLCALL CreateAsyncTexture(void *data)
+{
+    IMG_AsyncJob *job = (IMG_AsyncJob *)data;
+    SDL_Texture *texture = NULL;
+
+    if (job->surface) {
+        texture = SDL_CreateTextureFromSurface(job->renderer, job->surface);
+        if (!texture) {
+            job->error = SDL_strdup(SDL_GetError());
+        }
+    }
+    job->texture_callback(job->userdata, job->id, texture, job->error);
+    FreeJob(job);
+}
+
+/* Hand the result of a job over to the application */
+static void DeliverJob(IMG_AsyncJob *job)
+{
+    if (job->texture_callback) {
+        if (!job->surface) {
+            job->error = SDL_strdup(SDL_GetError());
+        }
+        if (!SDL_RunOnMainThread(CreateAsyncTexture, job, false)) {
+            /* There's no way to reach the render thread, report the failure here */
+            if (job->surface) {
+                SDL_DestroySurface(job->surface);
+                job->surface = NULL;
+                job->error = SDL_strdup(SDL_GetError());
+            }
+            job->texture_callback(job->userdata, job->id, NULL, job->error);
+            FreeJob(job);
+        }
+        return;
+    }
+
+    if (job->callback) {
+        job->callback(job->userdata, job->id, job->surface, job->surface ? NULL : SDL_GetError());
+    } else {
+        SDL_Event event;
+
+        SDL_zero(event);
+        event.user.type = pool.event_type;
+        event.user.code = (Sint32)job->id;
+        event.user.data1 = job->surface;
+        event.user.data2 = job->userdata;
+        if (!SDL_PushEvent(&event)) {
+            SDL_DestroySurface(job->surface);
+        }
+    }
+    job->surface = NULL;
+    FreeJob(job);
+}
+
+/* Stop decoding a running job as soon as it's cancelled */
+static bool SDLCALL AsyncLoadProgress(void *userdata, float progress)
+{
+    IMG_AsyncJob *job = (IMG_AsyncJob *)userdata;
+    bool cancelled;
+
+    SDL_LockMutex(pool.lock);
+    cancelled = job->cancelled;
+    SDL_UnlockMutex(pool.lock);
+    return !cancelled;
+}
+
+static int SDLCALL AsyncLoadThread(void *data)
+{
+    IMG_AsyncJob *job;
+    IMG_LoadProgress progress;
+    bool cancelled;
+
+    SDL_LockMutex(pool.lock);
+    for (;;) {
+        job = pool.queue_head;
+        if (!job) {
+            bool signaled;
+
+            if (pool.quit) {
+                break;
+            }
+            ++pool.num_idle;
+            signaled = SDL_WaitConditionTimeout(pool.cond, pool.lock, ASYNC_IDLE_TIMEOUT);
+            --pool.num_idle;
+            if (!signaled && !pool.queue_head) {
+                break;
+            }
+            continue;
+        }
+
+        RemoveJob(&pool.queue_head, &pool.queue_tail, job);
+        job->next = pool.running;
+        pool.running = job;
+        SDL_UnlockMutex(pool.lock);
+
+        IMG_BeginLoadProgress(&progress, AsyncLoadProgress, job, 0);
+        if (job->file) {
+            job->surface = IMG_Load(job->file);
+        } else {
+            job->surface = IMG_Load_IO(job->src, job->closeio);
+            job->src = NULL;
+        }
+        IMG_EndLoadProgress(&progress);
+
+        /* Once the job is off the running list it can't be cancelled anymore */
+        SDL_LockMutex(pool.lock);
+        RemoveJob(&pool.running, NULL, job);
+        cancelled = job->cancelled;
+        SDL_UnlockMutex(pool.lock);
+
+        if (cancelled) {
+            FreeJob(job);
+        } else {
+            DeliverJob(job);
+        }
+
+        SDL_LockMutex(pool.lock);
+    }
+    --pool.num_threads;
+    if (pool.quit) {
+        /* Let IMG_QuitAsyncLoad() know that another thread is gone */
+        SDL_BroadcastCondition(pool.cond);
+    }
+    SDL_UnlockMutex(pool.lock);
+
+    return 0;
+}
+
+static IMG_LoadID QueueJob(IMG_AsyncJob *job)
+{
+    IMG_LoadID id = 0;
+
+    if (!InitAsyncLoad()) {
+        FreeJob(job);
+        return 0;
+    }
+    if (!job->callback && !job->texture_callback && !pool.event_type) {
+        SDL_SetError("Couldn't register the image load event");
+        FreeJob(job);
+        return 0;
+    }
+
+    SDL_LockMutex(pool.lock);
+    job->id = ++pool.next_id;
+    if (job->id == 0) {
+        job->id = ++pool.next_id;
+    }
+    if (pool.queue_tail) {
+        pool.queue_tail->next = job;
+    } else {
+        pool.queue_head = job;
+    }
+    pool.queue_tail = job;
+
+    if (pool.num_idle == 0 && pool.num_threads < SDL_clamp(SDL_GetNumLogicalCPUCores(), 1, MAX_ASYNC_THREADS)) {
+        SDL_Thread *thread = SDL_CreateThread(AsyncLoadThread, "SDL_image", NULL);
+        if (thread) {
+            SDL_DetachThread(thread);
+            ++pool.num_threads;
+        }
+    }
+
+    if (pool.num_threads > 0) {
+        id = job->id;
+        SDL_SignalCondition(pool.cond);
+    } else {
+        /* There is no thread to run this job */
+        RemoveJob(&pool.queue_head, &pool.queue_tail, job);
+    }
+    SDL_UnlockMutex(pool.lock);
+
+    if (!id) {
+        FreeJob(job);
+    }
+    return id;
+}
+
+static IMG_AsyncJob *CreateFileJob(const char *file)
+{
+    IMG_AsyncJob *job;
+
+    if (!file || !*file) {
+        SDL_InvalidParamError("file");
+        return NULL;
+    }
+
+    job = (IMG_AsyncJob *)SDL_calloc(1, sizeof(*job));
+    if (!job) {
+        return NULL;
+    }
+    job->file = SDL_strdup(file);
+    if (!job->file) {
+        SDL_free(job);
+        return NULL;
+    }
+    return job;
+}
+
+IMG_LoadID IMG_LoadAsync(const char *file, IMG_LoadCallback callback, void *userdata)
+{
+    IMG_AsyncJob *job = CreateFileJob(file);
+
+    if (!job) {
+        return 0;
+    }
+    job->callback = callback;
+    job->userdata = userdata;
+
+    return QueueJob(job);
+}
+
+IMG_LoadID IMG_LoadAsync_IO(SDL_IOStream *src, bool closeio, IMG_LoadCallback callback, void *userdata)
+{
+    IMG_AsyncJob *job;
+
+    if (!src) {
+        SDL_InvalidParamError("src");
+        return 0;
+    }
+
+    job = (IMG_AsyncJob *)SDL_calloc(1, sizeof(*job));
+    if (!job) {
+        if (closeio) {
+            SDL_CloseIO(src);
+        }
+        return 0;
+    }
+    job->src = src;
+    job->closeio = closeio;
+    job->callback = callback;
+    job->userdata = userdata;
+
+    return QueueJob(job);
+}
+
+IMG_LoadID IMG_LoadTextureAsync(SDL_Renderer *renderer, const char *file, IMG_LoadTextureCallback callback, void *userdata)
+{
+    IMG_AsyncJob *job;
+
+    if (!renderer) {
+        SDL_InvalidParamError("renderer");
+        return 0;
+    }
+    if (!callback) {
+        SDL_InvalidParamError("callback");
+        return 0;
+    }
+
+    job = CreateFileJob(file);
+    if (!job) {
+        return 0;
+    }
+    job->renderer = renderer;
+    job->texture_callback = callback;
+    job->userdata = userdata;
+
+    return QueueJob(job);
+}
+
+bool IMG_CancelLoad(IMG_LoadID id)
+{
+    IMG_AsyncJob *job;
+    bool result = true;
+
+    if (!InitAsyncLoad()) {
+        return false;
+    }
+
+    SDL_LockMutex(pool.lock);
+    job = FindJob(pool.queue_head, id);
+    if (job) {
+        RemoveJob(&pool.queue_head, &pool.queue_tail, job);
+    } else {
+        IMG_AsyncJob *running = FindJob(pool.running, id);
+        if (running) {
+            /* The worker thread discards the image when it's done */
+            running->cancelled = true;
+        } else {
+            result = SDL_SetError("Load %" SDL_PRIu32 " isn't pending", id);
+        }
+    }
+    SDL_UnlockMutex(pool.lock);
+
+    if (job) {
+        FreeJob(job);
+    }
+    return result;
+}
+
+Uint32 IMG_GetLoadEventType(void)
+{
+    if (!InitAsyncLoad()) {
+        return 0;
+    }
+    return pool.event_type;
+}
+
+void IMG_QuitAsyncLoad(void)
+{
+    IMG_AsyncJob *queued;
+    IMG_AsyncJob *job;
+
+    /* The worker threads free theirs when they exit */
+    IMG_FreeKeptScratch();
+
+    if (!SDL_ShouldQuit(&async_init)) {
+        return;
+    }
+
+    SDL_LockMutex(pool.lock);
+    queued = pool.queue_head;
+    pool.queue_head = NULL;
+    pool.queue_tail = NULL;
+    for (job = pool.running; job; job = job->next) {
+        job->cancelled = true;
+    }
+
+    /* Wake the idle threads and wait until every thread has exited */
+    pool.quit = true;
+    SDL_BroadcastCondition(pool.cond);
+    while (pool.num_threads > 0) {
+        SDL_WaitCondition(pool.cond, pool.lock);
+    }
+    pool.quit = false;
+    SDL_UnlockMutex(pool.lock);
+
+    while (queued) {
+        job = queued;
+        queued = job->next;
+        FreeJob(job);
+    }
+
+    SDL_DestroyCondition(pool.cond);
+    pool.cond = NULL;
+    SDL_DestroyMutex(pool.lock);
+    pool.lock = NULL;
+    SDL_SetInitialized(&async_init, false);
+}
+
+typedef struct IMG_BatchLoad
+{
+    const char **files;
+    int count;
+    SDL_Surface **out;
+    char **errors;
+    SDL_AtomicInt *states;  /* the BATCH_ITEM_* state of each file */
+    SDL_AtomicInt next;     /* index of the next file nobody has claimed yet */
+    SDL_AtomicInt failed;
+} IMG_BatchLoad;
+
+/* Claim the next file of the batch, returns -1 when they're all taken */
+static int ClaimBatchItem(IMG_BatchLoad *batch, int state)
+{
+    int index = SDL_AddAtomicInt(&batch->next, 1);
+
+    if (index >= batch->count) {
+        return -1;
+    }
+    SDL_SetAtomicInt(&batch->states[index], state);
+    return index;
+}
+
+/* Take a claimed file to decode it, returns false if another worker took it first */
+static bool StartBatchItem(IMG_BatchLoad *batch, int index)
+{
+    return SDL_CompareAndSwapAtomicInt(&batch->states[index], BATCH_ITEM_READING, BATCH_ITEM_STARTED);
+}
+
+/* Take a file that another worker is still reading ahead, returns -1 if there are none */
+static int StealBatchItem(IMG_BatchLoad *batch)
+{
+    int index;
+
+    /* The files claimed last are the most likely to be waiting */
+    for (index = batch->count - 1; index >= 0; --index) {
+        if (SDL_GetAtomicInt(&batch->states[index]) == BATCH_ITEM_READING && StartBatchItem(batch, index)) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+static void FinishBatchItem(IMG_BatchLoad *batch, int index, SDL_Surface *surface)
+{
+    batch->out[index] = surface;
+    if (!surface) {
+        if (batch->errors) {
+            batch->errors[index] = SDL_strdup(SDL_GetError());
+        }
+        SDL_AddAtomicInt(&batch->failed, 1);
+    }
+}
+
+static bool StartBatchRead(IMG_BatchLoad *batch, SDL_AsyncIOQueue *queue, int index)
+{
+    const char *file = batch->files[index];
+
+    if (!file || !*file) {
+        SDL_InvalidParamError("file");
+        if (StartBatchItem(batch, index)) {
+            FinishBatchItem(batch, index, NULL);
+        }
+        return false;
+    }
+    if (!SDL_LoadFileAsync(file, queue, (void *)(intptr_t)index)) {
+        if (StartBatchItem(batch, index)) {
+            FinishBatchItem(batch, index, NULL);
+        }
+        return false;
+    }
+    return true;
+}
+
+static SDL_Surface *DecodeBatchItem(IMG_BatchLoad *batch, int index, const SDL_AsyncIOOutcome *outcome)
+{
+    const char *file = batch->files[index];
+    const char *ext;
+    SDL_IOStream *src;
+
+    if (outcome->result != SDL_ASYNCIO_COMPLETE) {
+        SDL_SetError("Couldn't read %s", file);
+        return NULL;
+    }
+
+    src = SDL_IOFromConstMem(outcome->buffer, (size_t)outcome->bytes_transferred);
+    if (!src) {
+        return NULL;
+    }
+    ext = SDL_strrchr(file, '.');
+    if (ext) {
+        ext++;
+    }
+    return IMG_LoadTyped_IO(src, true, ext);
+}
+
+/* Each worker keeps BATCH_READ_AHEAD files claimed, so the next file is
+ * read in the background while the current one is decoded. A worker stuck
+ * on a large image would hold up the file it read ahead, so workers that run
+ * out of files to claim take over the files that are still waiting to be
+ * decoded, and load them again themselves.
+ */
+static int SDLCALL BatchLoadThread(void *data)
+{
+    IMG_BatchLoad *batch = (IMG_BatchLoad *)data;
+    SDL_AsyncIOQueue *queue;
+    SDL_AsyncIOOutcome outcome;
+    int pending = 0;
+    int index;
+
+    queue = SDL_CreateAsyncIOQueue();
+    if (!queue) {
+        while ((index = ClaimBatchItem(batch, BATCH_ITEM_STARTED)) >= 0 ||
+               (index = StealBatchItem(batch)) >= 0) {
+            FinishBatchItem(batch, index, IMG_Load(batch->files[index]));
+        }
+        return 0;
+    }
+
+    for (;;) {
+        while (pending < BATCH_READ_AHEAD && (index = ClaimBatchItem(batch, BATCH_ITEM_READING)) >= 0) {
+            if (StartBatchRead(batch, queue, index)) {
+                ++pending;
+            }
+        }
+        if (pending == 0) {
+            index = StealBatchItem(batch);
+            if (index < 0) {
+                break;
+            }
+            FinishBatchItem(batch, index, IMG_Load(batch->files[index]));
+            continue;
+        }
+
+        if (!SDL_WaitAsyncIOResult(queue, &outcome, -1)) {
+            continue;
+        }
+        --pending;
+
+        index = (int)(intptr_t)outcome.userdata;
+        if (StartBatchItem(batch, index)) {
+            FinishBatchItem(batch, index, DecodeBatchItem(batch, index, &outcome));
+        }
+        SDL_free(outcome.buffer);
+    }
+    SDL_DestroyAsyncIOQueue(queue);
+
+    return 0;
+}
+
+bool IMG_LoadBatch(const char **files, int count, SDL_Surface **out, int threads, char **errors)
+{
+    IMG_BatchLoad batch;
+    SDL_Thread **workers;
+    int num_workers = 0;
+    int failed;
+    int i;
+
+    if (count < 0) {
+        return SDL_InvalidParamError("count");
+    }
+    if (count == 0) {
+        return true;
+    }
+    if (!files) {
+        return SDL_InvalidParamError("files");
+    }
+    if (!out) {
+        return SDL_InvalidParamError("out");
+    }
+
+    SDL_memset(out, 0, count * sizeof(*out));
+    if (errors) {
+        SDL_memset(errors, 0, count * sizeof(*errors));
+    }
+
+    SDL_zero(batch);
+    batch.states = (SDL_AtomicInt *)SDL_calloc(count, sizeof(*batch.states));
+    if (!batch.states) {
+        return false;
+    }
+    batch.files = files;
+    batch.count = count;
+    batch.out = out;
+    batch.errors = errors;
+
+    if (threads <= 0) {
+        threads = SDL_GetNumLogicalCPUCores();
+    }
+    threads = SDL_clamp(threads, 1, count);
+
+    /* The calling thread is one of the workers */
+    workers = (SDL_Thread **)SDL_calloc(threads, sizeof(*workers));
+    if (workers) {
+        for (i = 1; i < threads; ++i) {
+            workers[num_workers] = SDL_CreateThread(BatchLoadThread, "SDL_image batch", &batch);
+            if (!workers[num_workers]) {
+                break;
+            }
+            ++num_workers;
+        }
+    }
+    BatchLoadThread(&batch);
+
+    for (i = 0; i < num_workers; ++i) {
+        SDL_WaitThread(workers[i], NULL);
+    }
+    SDL_free(workers);
+    SDL_free(batch.states);
+
+    failed = SDL_GetAtomicInt(&batch.failed);
+    if (failed > 0) {
+        return SDL_SetError("%d of %d images failed to load", failed, count);
+    }
+    return true;
+}
@@ -24,6 +24,11 @@
 #include <SDL3_image/SDL_image.h>
 
 #include "IMG_avif.h"
+#include "IMG_info.h"
+#include "IMG_io.h"
+#include "IMG_limits.h"
+#include "IMG_load_options.h"
+#include "IMG_stats.h"
 #include "IMG_anim_encoder.h"
 #include "IMG_anim_decoder.h"
 #include "xmlman.h"
@@ -56,7 +61,7 @@
 
 
 static struct {
-    int loaded;
+    SDL_InitState init;
     void *handle;
     avifDecoder * (*avifDecoderCreate)(void);
     void (*avifDecoderDestroy)(avifDecoder * decoder);
@@ -94,52 +99,56 @@ static struct {
     /* Need to turn off optimizations so weak framework load check works */
     __attribute__ ((optnone))
 #endif
-static bool IMG_InitAVIF(void)
+static bool LoadAVIFLibrary(void)
 {
-    if ( lib.loaded == 0 ) {
 #ifdef LOAD_AVIF_DYNAMIC
-        lib.handle = SDL_LoadObject(LOAD_AVIF_DYNAMIC);
-        if ( lib.handle == NULL ) {
-            return false;
-        }
+    lib.handle = SDL_LoadObject(LOAD_AVIF_DYNAMIC);
+    if ( lib.handle == NULL ) {
+        return false;
+    }
 #endif
-        FUNCTION_LOADER(avifDecoderCreate, avifDecoder * (*)(void))
-        FUNCTION_LOADER(avifDecoderDestroy, void (*)(avifDecoder * decoder))
-        FUNCTION_LOADER(avifDecoderNextImage, avifResult (*)(avifDecoder * decoder))
-        FUNCTION_LOADER(avifDecoderParse, avifResult (*)(avifDecoder * decoder))
-        FUNCTION_LOADER(avifDecoderSetIO, void (*)(avifDecoder * decoder, avifIO * io))
-        FUNCTION_LOADER(avifEncoderAddImage, avifResult (*)(avifEncoder * encoder, const avifImage * image, uint64_t durationInTimescales, avifAddImageFlags addImageFlags))
-        FUNCTION_LOADER(avifEncoderCreate, avifEncoder * (*)(void))
-        FUNCTION_LOADER(avifEncoderDestroy, void (*)(avifEncoder * encoder))
-        FUNCTION_LOADER(avifEncoderFinish, avifResult (*)(avifEncoder * encoder, avifRWData * output))
-        FUNCTION_LOADER(avifImageCreate, avifImage * (*)(uint32_t width, uint32_t height, uint32_t depth, avifPixelFormat yuvFormat))
-        FUNCTION_LOADER(avifImageDestroy, void (*)(avifImage * image))
-        FUNCTION_LOADER(avifImageRGBToYUV, avifResult (*)(avifImage * image, const avifRGBImage * rgb))
-        FUNCTION_LOADER(avifImageYUVToRGB, avifResult (*)(const avifImage * image, avifRGBImage * rgb))
-        FUNCTION_LOADER(avifPeekCompatibleFileType, avifBool (*)(const avifROData * input))
-        FUNCTION_LOADER(avifRGBImageSetDefaults, void (*)(avifRGBImage * rgb, const avifImage * image))
-        FUNCTION_LOADER(avifRWDataFree, void (*)(avifRWData * raw))
-        FUNCTION_LOADER(avifResultToString, const char * (*)(avifResult res))
-
-        // XMP metadata support
-        FUNCTION_LOADER(avifImageSetMetadataXMP, avifResult (*)(avifImage * image, const uint8_t * xmp, size_t xmpSize))
-    }
-    ++lib.loaded;
+    FUNCTION_LOADER(avifDecoderCreate, avifDecoder * (*)(void))
+    FUNCTION_LOADER(avifDecoderDestroy, void (*)(avifDecoder * decoder))
+    FUNCTION_LOADER(avifDecoderNextImage, avifResult (*)(avifDecoder * decoder))
+    FUNCTION_LOADER(avifDecoderParse, avifResult (*)(avifDecoder * decoder))
+    FUNCTION_LOADER(avifDecoderSetIO, void (*)(avifDecoder * decoder, avifIO * io))
+    FUNCTION_LOADER(avifEncoderAddImage, avifResult (*)(avifEncoder * encoder, const avifImage * image, uint64_t durationInTimescales, avifAddImageFlags addImageFlags))
+    FUNCTION_LOADER(avifEncoderCreate, avifEncoder * (*)(void))
+    FUNCTION_LOADER(avifEncoderDestroy, void (*)(avifEncoder * encoder))
+    FUNCTION_LOADER(avifEncoderFinish, avifResult (*)(avifEncoder * encoder, avifRWData * output))
+    FUNCTION_LOADER(avifImageCreate, avifImage * (*)(uint32_t width, uint32_t height, uint32_t depth, avifPixelFormat yuvFormat))
+    FUNCTION_LOADER(avifImageDestroy, void (*)(avifImage * image))
+    FUNCTION_LOADER(avifImageRGBToYUV, avifResult (*)(avifImage * image, const avifRGBImage * rgb))
+    FUNCTION_LOADER(avifImageYUVToRGB, avifResult (*)(const avifImage * image, avifRGBImage * rgb))
+    FUNCTION_LOADER(avifPeekCompatibleFileType, avifBool (*)(const avifROData * input))
+    FUNCTION_LOADER(avifRGBImageSetDefaults, void (*)(avifRGBImage * rgb, const avifImage * image))
+    FUNCTION_LOADER(avifRWDataFree, void (*)(avifRWData * raw))
+    FUNCTION_LOADER(avifResultToString, const char * (*)(avifResult res))
+
+    // XMP metadata support
+    FUNCTION_LOADER(avifImageSetMetadataXMP, avifResult (*)(avifImage * image, const uint8_t * xmp, size_t xmpSize))
 
     return true;
 }
+
+static bool IMG_InitAVIF(void)
+{
+    if (SDL_ShouldInit(&lib.init)) {
+        bool initialized = LoadAVIFLibrary();
+        SDL_SetInitialized(&lib.init, initialized);
+        return initialized;
+    }
+    return true;
+}
 #if 0
 void IMG_QuitAVIF(void)
 {
-    if ( lib.loaded == 0 ) {
-        return;
-    }
-    if ( lib.loaded == 1 ) {
+    if (SDL_ShouldQuit(&lib.init)) {
 #ifdef LOAD_AVIF_DYNAMIC
         SDL_UnloadObject(lib.handle);
 #endif
+        SDL_SetInitialized(&lib.init, false);
     }
-    --lib.loaded;
 }
 #endif // 0
 
@@ -242,12 +251,23 @@ typedef struct
     Uint64 start;
     uint8_t *data;
     Sint64 size;
+    const Uint8 *mem;   /* the image data, if it's in memory */
+    Uint64 mem_size;
 } avifIOContext;
 
 static avifResult ReadAVIFIO(struct avifIO * io, uint32_t readFlags, uint64_t offset, size_t size, avifROData * out)
 {
     avifIOContext *context = (avifIOContext *)io->data;
 
+    if (context->mem) {
+        if (offset > context->mem_size) {
+            return AVIF_RESULT_IO_ERROR;
+        }
+        out->data = context->mem + offset;
+        out->size = (size_t)SDL_min((Uint64)size, context->mem_size - offset);
+        return AVIF_RESULT_OK;
+    }
+
     /* The AVIF reader bounces all over, so always seek to the correct offset */
     if (SDL_SeekIO(context->src, context->start + offset, SDL_IO_SEEK_SET) < 0) {
         return AVIF_RESULT_IO_ERROR;
@@ -285,6 +305,30 @@ static void DestroyAVIFIO(struct avifIO * io)
     }
 }
 
+static void InitAVIFIO(avifIO *io, avifIOContext *context, SDL_IOStream *src, Uint64 start)
+{
+    const Uint8 *mem;
+    size_t mem_size = 0;
+
+    SDL_zerop(io);
+    SDL_zerop(context);
+    context->src = src;
+    context->start = start;
+
+    /* Memory streams are handed to libavif in place, and stay valid as long as the stream */
+    mem = IMG_GetIOMemory(src, &mem_size);
+    if (mem && start <= mem_size) {
+        context->mem = mem + start;
+        context->mem_size = mem_size - start;
+        io->persistent = AVIF_TRUE;
+        io->sizeHint = context->mem_size;
+    }
+
+    io->destroy = DestroyAVIFIO;
+    io->read = ReadAVIFIO;
+    io->data = context;
+}
+
 static int ConvertGBR444toXBGR2101010(avifImage *image, SDL_Surface *surface)
 {
     const Uint16 *srcR, *srcG, *srcB;
@@ -358,7 +402,34 @@ static void ConvertRGB16toXBGR2101010(avifRGBImage *image, SDL_Surface *surface)
 }
 
 /* Load a AVIF type image from an SDL datasource */
-SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
+/* Get the libavif RGB format that produces an 8-bit pixel format directly */
+static bool GetAVIFRGBFormat(SDL_PixelFormat format, avifRGBFormat *rgb_format)
+{
+    switch (format) {
+    case SDL_PIXELFORMAT_RGB24:
+        *rgb_format = AVIF_RGB_FORMAT_RGB;
+        return true;
+    case SDL_PIXELFORMAT_BGR24:
+        *rgb_format = AVIF_RGB_FORMAT_BGR;
+        return true;
+    case SDL_PIXELFORMAT_RGBA32:
+        *rgb_format = AVIF_RGB_FORMAT_RGBA;
+        return true;
+    case SDL_PIXELFORMAT_BGRA32:
+        *rgb_format = AVIF_RGB_FORMAT_BGRA;
+        return true;
+    case SDL_PIXELFORMAT_ARGB32:
+        *rgb_format = AVIF_RGB_FORMAT_ARGB;
+        return true;
+    case SDL_PIXELFORMAT_ABGR32:
+        *rgb_format = AVIF_RGB_FORMAT_ABGR;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static SDL_Surface *LoadAVIF_IO(SDL_IOStream *src, IMG_LoadOptions *options)
 {
     Sint64 start;
     avifDecoder *decoder = NULL;
@@ -378,8 +449,7 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
         return NULL;
     }
 
-    SDL_zero(context);
-    SDL_zero(io);
+    InitAVIFIO(&io, &context, src, start);
 
     decoder = lib.avifDecoderCreate();
     if (!decoder) {
@@ -390,11 +460,6 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
     /* Be permissive so we can load as many images as possible */
     decoder->strictFlags = AVIF_STRICT_DISABLED;
 
-    context.src = src;
-    context.start = start;
-    io.destroy = DestroyAVIFIO;
-    io.read = ReadAVIFIO;
-    io.data = &context;
     lib.avifDecoderSetIO(decoder, &io);
 
     result = lib.avifDecoderParse(decoder);
@@ -403,12 +468,19 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
         goto done;
     }
 
+    /* Check the size before libavif allocates the planes */
+    if (!IMG_CheckImageLimits(decoder->image->width, decoder->image->height, SDL_PIXELFORMAT_RGBA32)) {
+        goto done;
+    }
+
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     result = lib.avifDecoderNextImage(decoder);
     if (result != AVIF_RESULT_OK) {
         SDL_SetError("Couldn't get AVIF image: %s", lib.avifResultToString(result));
         goto done;
     }
 
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_CONVERT);
     image = decoder->image;
     if (image->transferCharacteristics == AVIF_TRANSFER_CHARACTERISTICS_SMPTE2084) {
         // This is an HDR PQ image
@@ -417,7 +489,7 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
             image->yuvFormat == AVIF_PIXEL_FORMAT_YUV444) {
             // This image uses identity GBR channel ordering
             if (image->depth == 10) {
-                surface = SDL_CreateSurface(image->width, image->height, SDL_PIXELFORMAT_XBGR2101010);
+                surface = IMG_CreateLoadSurface(image->width, image->height, SDL_PIXELFORMAT_XBGR2101010, options);
                 if (surface) {
                     if (ConvertGBR444toXBGR2101010(image, surface) < 0) {
                         // Invalid image, let avif take care of it
@@ -449,7 +521,7 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
                 goto done;
             }
 
-            surface = SDL_CreateSurface(image->width, image->height, SDL_PIXELFORMAT_XBGR2101010);
+            surface = IMG_CreateLoadSurface(image->width, image->height, SDL_PIXELFORMAT_XBGR2101010, options);
             if (surface) {
                 ConvertRGB16toXBGR2101010(&rgb, surface);
             }
@@ -492,22 +564,29 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
 
     if (!surface) {
         avifRGBImage rgb;
+        SDL_PixelFormat format;
 
-        surface = SDL_CreateSurface(image->width, image->height, SDL_PIXELFORMAT_ARGB8888);
+        /* Convert the YUV image to RGB */
+        SDL_zero(rgb);
+        if (options && GetAVIFRGBFormat(options->format, &rgb.format)) {
+            format = options->format;
+        } else {
+            format = SDL_PIXELFORMAT_ARGB8888;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            rgb.format = AVIF_RGB_FORMAT_BGRA;
+#else
+            rgb.format = AVIF_RGB_FORMAT_ARGB;
+#endif
+        }
+
+        surface = IMG_CreateLoadSurface(image->width, image->height, format, options);
         if (!surface) {
             goto done;
         }
 
-        /* Convert the YUV image to RGB */
-        SDL_zero(rgb);
         rgb.width = surface->w;
         rgb.height = surface->h;
         rgb.depth = 8;
-#if SDL_BYTEORDER == SDL_LIL_ENDIAN
-        rgb.format = AVIF_RGB_FORMAT_BGRA;
-#else
-        rgb.format = AVIF_RGB_FORMAT_ARGB;
-#endif
         rgb.pixels = (uint8_t *)surface->pixels;
         rgb.rowBytes = (uint32_t)surface->pitch;
         result = lib.avifImageYUVToRGB(image, &rgb);
@@ -529,6 +608,66 @@ done:
     return surface;
 }
 
+SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
+{
+    return LoadAVIF_IO(src, NULL);
+}
+
+SDL_Surface *IMG_LoadAVIFWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return LoadAVIF_IO(src, options);
+}
+
+bool IMG_GetAVIFInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    avifDecoder *decoder = NULL;
+    avifImage *image;
+    avifIO io;
+    avifIOContext context;
+    avifResult result;
+    bool retval = false;
+
+    if (!IMG_InitAVIF()) {
+        return false;
+    }
+
+    InitAVIFIO(&io, &context, src, SDL_TellIO(src));
+
+    decoder = lib.avifDecoderCreate();
+    if (!decoder) {
+        return SDL_SetError("Couldn't create AVIF decoder");
+    }
+
+    /* Be permissive so we can load as many images as possible */
+    decoder->strictFlags = AVIF_STRICT_DISABLED;
+
+    lib.avifDecoderSetIO(decoder, &io);
+
+    /* Parsing reads the container metadata, but doesn't decode any frames */
+    result = lib.avifDecoderParse(decoder);
+    if (result != AVIF_RESULT_OK) {
+        SDL_SetError("Couldn't parse AVIF image: %s", lib.avifResultToString(result));
+        goto done;
+    }
+
+    image = decoder->image;
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, image->width);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, image->height);
+    if (image->transferCharacteristics == AVIF_TRANSFER_CHARACTERISTICS_SMPTE2084) {
+        SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, SDL_PIXELFORMAT_XBGR2101010);
+    } else {
+        SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, SDL_PIXELFORMAT_ARGB8888);
+    }
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_BIT_DEPTH_NUMBER, image->depth);
+    SDL_SetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, decoder->alphaPresent ? true : false);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_FRAME_COUNT_NUMBER, decoder->imageCount);
+    retval = true;
+
+done:
+    lib.avifDecoderDestroy(decoder);
+    return retval;
+}
+
 static bool IMG_SaveAVIF_IO_libavif(SDL_Surface *surface, SDL_IOStream *dst, int quality)
 {
     avifImage *image = NULL;
@@ -728,6 +867,16 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
     return NULL;
 }
 
+bool IMG_GetAVIFInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    return SDL_SetError("SDL_image built without AVIF support");
+}
+
+SDL_Surface *IMG_LoadAVIFWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return IMG_LoadAVIF_IO(src);
+}
+
 #endif /* LOAD_AVIF */
 
 #if SAVE_AVIF
@@ -868,14 +1017,7 @@ static bool IMG_AnimationDecoderReset_Internal(IMG_AnimationDecoder *decoder)
         SDL_free(ctx->ioContext.data);
     }
 
-    ctx->ioContext.src = decoder->src;
-    ctx->ioContext.start = ctx->start_pos;
-    ctx->ioContext.data = NULL;
-    ctx->ioContext.size = 0;
-
-    ctx->io.destroy = DestroyAVIFIO;
-    ctx->io.read = ReadAVIFIO;
-    ctx->io.data = &ctx->ioContext;
+    InitAVIFIO(&ctx->io, &ctx->ioContext, decoder->src, ctx->start_pos);
     lib.avifDecoderSetIO(ctx->decoder, &ctx->io);
 
     // Reset state
@@ -924,7 +1066,7 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
         rgb.depth = 16;
         rgb.format = AVIF_RGB_FORMAT_RGBA;
 
-        frame_surface = SDL_CreateSurface(image->width, image->height, SDL_PIXELFORMAT_RGBA64);
+        frame_surface = IMG_CreateDecoderFrame(decoder, image->width, image->height, SDL_PIXELFORMAT_RGBA64);
         if (!frame_surface) {
             return SDL_SetError("Couldn't create 16-bit surface for AVIF frame");
         }
@@ -946,7 +1088,7 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
         if (image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_IDENTITY &&
             image->yuvFormat == AVIF_PIXEL_FORMAT_YUV444) {
             if (image->depth == 10) {
-                frame_surface = SDL_CreateSurface(image->width, image->height, SDL_PIXELFORMAT_XBGR2101010);
+                frame_surface = IMG_CreateDecoderFrame(decoder, image->width, image->height, SDL_PIXELFORMAT_XBGR2101010);
                 if (frame_surface) {
                     if (ConvertGBR444toXBGR2101010(image, frame_surface) < 0) {
                         SDL_DestroySurface(frame_surface);
@@ -976,7 +1118,7 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
                 return SDL_SetError("Couldn't convert AVIF image to RGB: %s", lib.avifResultToString(result));
             }
 
-            frame_surface = SDL_CreateSurface(image->width, image->height, SDL_PIXELFORMAT_XBGR2101010);
+            frame_surface = IMG_CreateDecoderFrame(decoder, image->width, image->height, SDL_PIXELFORMAT_XBGR2101010);
             if (frame_surface) {
                 ConvertRGB16toXBGR2101010(&rgb, frame_surface);
             }
@@ -987,7 +1129,7 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
             SetHDRProperties(frame_surface, image);
         }
     } else {
-        frame_surface = SDL_CreateSurface(image->width, image->height, SDL_PIXELFORMAT_RGBA32);
+        frame_surface = IMG_CreateDecoderFrame(decoder, image->width, image->height, SDL_PIXELFORMAT_RGBA32);
         if (!frame_surface) {
             return SDL_SetError("Couldn't create surface for AVIF frame");
         }
@@ -1078,14 +1220,7 @@ bool IMG_CreateAVIFAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
     ctx->decoder->strictFlags = AVIF_STRICT_DISABLED;
     ctx->decoder->timescale = decoder->timebase_denominator;
 
-    ctx->ioContext.src = decoder->src;
-    ctx->ioContext.start = ctx->start_pos;
-    ctx->ioContext.data = NULL;
-    ctx->ioContext.size = 0;
-
-    ctx->io.destroy = DestroyAVIFIO;
-    ctx->io.read = ReadAVIFIO;
-    ctx->io.data = &ctx->ioContext;
+    InitAVIFIO(&ctx->io, &ctx->ioContext, decoder->src, ctx->start_pos);
     lib.avifDecoderSetIO(ctx->decoder, &ctx->io);
 
     ctx->current_frame = 0;
@@ -1127,6 +1262,11 @@ bool IMG_CreateAVIFAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
     ctx->height = ctx->decoder->image->height;
     ctx->total_frames = ctx->decoder->imageCount;
 
+    if (!IMG_CheckImageLimits(ctx->width, ctx->height, SDL_PIXELFORMAT_RGBA32)) {
+        SDL_free(ctx);
+        return false;
+    }
+
     if (!ignoreProps) {
         // Allow implicit properties to be set which are not globalized but specific to the decoder.
         SDL_SetNumberProperty(decoder->props, "IMG_PROP_METADATA_FRAME_COUNT_NUMBER", ctx->total_frames);
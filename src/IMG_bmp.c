@@ -42,6 +42,9 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_limits.h"
+#include "IMG_stats.h"
+
 #ifdef LOAD_BMP
 
 #define RIFF_FOURCC(c0, c1, c2, c3)                 \
@@ -164,8 +167,61 @@ bool IMG_isCUR(SDL_IOStream *src)
 #define BI_BITFIELDS    3
 #endif
 
+/* Check the size in the header before SDL allocates the surface */
+static bool CheckBMPLimits(SDL_IOStream *src)
+{
+    Sint64 start;
+    Uint32 biSize;
+    Sint32 biWidth = 0;
+    Sint32 biHeight = 0;
+    Uint16 width16, height16;
+    Uint16 biBitCount = 0;
+    SDL_PixelFormat format;
+
+    start = SDL_TellIO(src);
+    if (SDL_SeekIO(src, 14, SDL_IO_SEEK_CUR) < 0 || !SDL_ReadU32LE(src, &biSize)) {
+        /* Leave reporting the truncated file to SDL */
+        SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+        return true;
+    }
+    if (biSize == 12) {
+        if (SDL_ReadU16LE(src, &width16) && SDL_ReadU16LE(src, &height16) &&
+            SDL_ReadU16LE(src, NULL /* bcPlanes */) && SDL_ReadU16LE(src, &biBitCount)) {
+            biWidth = width16;
+            biHeight = height16;
+        }
+    } else {
+        if (SDL_ReadS32LE(src, &biWidth) && SDL_ReadS32LE(src, &biHeight) &&
+            SDL_ReadU16LE(src, NULL /* biPlanes */) && SDL_ReadU16LE(src, &biBitCount)) {
+            /* Top-down images have a negative height */
+            if (biHeight < 0 && biHeight != SDL_MIN_SINT32) {
+                biHeight = -biHeight;
+            }
+        }
+    }
+    SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+
+    if (biBitCount <= 8) {
+        format = SDL_PIXELFORMAT_INDEX8;
+    } else if (biBitCount == 24) {
+        format = SDL_PIXELFORMAT_BGR24;
+    } else {
+        format = SDL_PIXELFORMAT_ARGB8888;
+    }
+    return IMG_CheckImageLimits(biWidth, biHeight, format);
+}
+
 static SDL_Surface *LoadBMP_IO(SDL_IOStream *src, bool closeio)
 {
+    if (IMG_HasImageLimits() && !CheckBMPLimits(src)) {
+        if (closeio) {
+            SDL_CloseIO(src);
+        }
+        return NULL;
+    }
+
+    /* SDL reads the header and the pixels in one call */
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     return SDL_LoadBMP_IO(src, closeio);
 }
 
@@ -298,6 +354,9 @@ static SDL_Surface *GetBMPSurface(SDL_IOStream *src)
     /* Create a RGBA surface */
     biHeight = biHeight >> 1;
     //printf("%d x %d\n", biWidth, biHeight);
+    if (!IMG_CheckImageLimits(biWidth, biHeight, SDL_PIXELFORMAT_ARGB8888)) {
+        goto done;
+    }
     surface = SDL_CreateSurface(biWidth, biHeight, SDL_PIXELFORMAT_ARGB8888);
     if (surface == NULL) {
         goto done;
@@ -642,6 +701,7 @@ static SDL_Surface *LoadICOCUR_IO(SDL_IOStream *src, int type, bool closeio)
         goto done;
     }
 
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     /* Load the icon surfaces */
     for (i = 0; i < entries.num_entries; ++i) {
         IconEntry *entry = &entries.entries[i];
@@ -0,0 +1,508 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* A cache of decoded images with least recently used eviction
+ *
+ * The entries are spread across a few stripes by the hash of their key, each
+ * with its own lock, so threads loading different images rarely contend.
+ * Each stripe keeps its own LRU list, and eviction drops the oldest entry
+ * among the tails of all the stripes.
+ */
+
+#include <SDL3_image/SDL_image.h>
+
+/* Number of independently locked parts of the cache */
+#define NUM_CACHE_STRIPES   16
+
+/* Initial number of hash buckets in each stripe */
+#define CACHE_BUCKETS       16
+
+typedef enum IMG_CacheEntryState
+{
+    CACHE_ENTRY_LOADING,
+    CACHE_ENTRY_READY,
+    CACHE_ENTRY_FAILED
+} IMG_CacheEntryState;
+
+typedef struct IMG_CacheEntry
+{
+    char *key;
+    Uint32 hash;
+    Uint64 file_size;           /* to notice when a cached file changes */
+    SDL_Time file_time;
+    IMG_CacheEntryState state;
+    SDL_Surface *surface;       /* the reference held by the cache */
+    size_t bytes;
+    Uint64 last_used;
+    int waiters;                /* threads waiting for another thread to load the image */
+    char *error;
+    bool linked;                /* in the hash table, and the LRU list once it's ready */
+    struct IMG_CacheEntry *next;
+    struct IMG_CacheEntry *lru_prev;    /* more recently used */
+    struct IMG_CacheEntry *lru_next;    /* less recently used */
+} IMG_CacheEntry;
+
+typedef struct IMG_CacheStripe
+{
+    SDL_Mutex *lock;
+    SDL_Condition *cond;        /* signaled when an image has been loaded */
+    IMG_CacheEntry **buckets;
+    int num_buckets;
+    int count;
+    size_t bytes;
+    IMG_CacheEntry *lru_head;
+    IMG_CacheEntry *lru_tail;
+    Uint64 hits;
+    Uint64 misses;
+    Uint64 evictions;
+} IMG_CacheStripe;
+
+struct IMG_Cache
+{
+    size_t byte_budget;
+    IMG_CacheStripe stripes[NUM_CACHE_STRIPES];
+};
+
+/* Protects the reference count of cached surfaces, which may outlive their cache */
+static SDL_SpinLock surface_lock;
+
+static void RetainSurface(SDL_Surface *surface)
+{
+    SDL_LockSpinlock(&surface_lock);
+    ++surface->refcount;
+    SDL_UnlockSpinlock(&surface_lock);
+}
+
+void IMG_ReleaseCachedSurface(SDL_Surface *surface)
+{
+    bool last;
+
+    if (!surface) {
+        return;
+    }
+
+    SDL_LockSpinlock(&surface_lock);
+    last = (surface->refcount <= 1);
+    if (!last) {
+        --surface->refcount;
+    }
+    SDL_UnlockSpinlock(&surface_lock);
+
+    if (last) {
+        SDL_DestroySurface(surface);
+    }
+}
+
+static void FreeEntry(IMG_CacheEntry *entry)
+{
+    IMG_ReleaseCachedSurface(entry->surface);
+    SDL_free(entry->key);
+    SDL_free(entry->error);
+    SDL_free(entry);
+}
+
+static IMG_CacheEntry *FindEntry(IMG_CacheStripe *stripe, const char *key, Uint32 hash)
+{
+    IMG_CacheEntry *entry;
+
+    for (entry = stripe->buckets[(hash / NUM_CACHE_STRIPES) % stripe->num_buckets]; entry; entry = entry->next) {
+        if (entry->hash == hash && SDL_strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void GrowBuckets(IMG_CacheStripe *stripe)
+{
+    int num_buckets = stripe->num_buckets * 2;
+    IMG_CacheEntry **buckets;
+    int i;
+
+    buckets = (IMG_CacheEntry **)SDL_calloc(num_buckets, sizeof(*buckets));
+    if (!buckets) {
+        /* The chains just get longer */
+        return;
+    }
+    for (i = 0; i < stripe->num_buckets; ++i) {
+        IMG_CacheEntry *entry = stripe->buckets[i];
+        while (entry) {
+            IMG_CacheEntry *next = entry->next;
+            int bucket = (entry->hash / NUM_CACHE_STRIPES) % num_buckets;
+
+            entry->next = buckets[bucket];
+            buckets[bucket] = entry;
+            entry = next;
+        }
+    }
+    SDL_free(stripe->buckets);
+    stripe->buckets = buckets;
+    stripe->num_buckets = num_buckets;
+}
+
+static void InsertEntry(IMG_CacheStripe *stripe, IMG_CacheEntry *entry)
+{
+    int bucket;
+
+    if (stripe->count >= stripe->num_buckets) {
+        GrowBuckets(stripe);
+    }
+    bucket = (entry->hash / NUM_CACHE_STRIPES) % stripe->num_buckets;
+    entry->next = stripe->buckets[bucket];
+    stripe->buckets[bucket] = entry;
+    entry->linked = true;
+    ++stripe->count;
+}
+
+static void AddToLRU(IMG_CacheStripe *stripe, IMG_CacheEntry *entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = stripe->lru_head;
+    if (stripe->lru_head) {
+        stripe->lru_head->lru_prev = entry;
+    } else {
+        stripe->lru_tail = entry;
+    }
+    stripe->lru_head = entry;
+}
+
+static void RemoveFromLRU(IMG_CacheStripe *stripe, IMG_CacheEntry *entry)
+{
+    if (entry->lru_prev) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    } else {
+        stripe->lru_head = entry->lru_next;
+    }
+    if (entry->lru_next) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    } else {
+        stripe->lru_tail = entry->lru_prev;
+    }
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+static void UnlinkEntry(IMG_CacheStripe *stripe, IMG_CacheEntry *entry)
+{
+    IMG_CacheEntry **link = &stripe->buckets[(entry->hash / NUM_CACHE_STRIPES) % stripe->num_buckets];
+
+    while (*link != entry) {
+        link = &(*link)->next;
+    }
+    *link = entry->next;
+    entry->next = NULL;
+    entry->linked = false;
+    --stripe->count;
+
+    if (entry->state == CACHE_ENTRY_READY) {
+        RemoveFromLRU(stripe, entry);
+        stripe->bytes -= entry->bytes;
+    }
+}
+
+/* Remove an entry from the cache, it's freed by the last waiting thread if there are any */
+static void DropEntry(IMG_CacheStripe *stripe, IMG_CacheEntry *entry)
+{
+    UnlinkEntry(stripe, entry);
+    if (entry->waiters == 0) {
+        FreeEntry(entry);
+    }
+}
+
+static void EvictCacheEntries(IMG_Cache *cache)
+{
+    for (;;) {
+        IMG_CacheStripe *oldest = NULL;
+        Uint64 oldest_time = 0;
+        size_t bytes = 0;
+        int i;
+
+        for (i = 0; i < NUM_CACHE_STRIPES; ++i) {
+            IMG_CacheStripe *stripe = &cache->stripes[i];
+
+            SDL_LockMutex(stripe->lock);
+            bytes += stripe->bytes;
+            if (stripe->lru_tail && (!oldest || stripe->lru_tail->last_used < oldest_time)) {
+                oldest = stripe;
+                oldest_time = stripe->lru_tail->last_used;
+            }
+            SDL_UnlockMutex(stripe->lock);
+        }
+        if (bytes <= cache->byte_budget || !oldest) {
+            break;
+        }
+
+        /* Another thread may have touched the stripe meanwhile, its tail is still a good candidate */
+        SDL_LockMutex(oldest->lock);
+        if (oldest->lru_tail) {
+            DropEntry(oldest, oldest->lru_tail);
+            ++oldest->evictions;
+        }
+        SDL_UnlockMutex(oldest->lock);
+    }
+}
+
+static SDL_Surface *LoadCachedImage(IMG_Cache *cache, const char *key, const SDL_PathInfo *info, const char *file, SDL_IOStream *src, bool closeio)
+{
+    Uint32 hash = SDL_murmur3_32(key, SDL_strlen(key), 0);
+    IMG_CacheStripe *stripe = &cache->stripes[hash % NUM_CACHE_STRIPES];
+    IMG_CacheEntry *entry;
+    SDL_Surface *surface = NULL;
+
+    SDL_LockMutex(stripe->lock);
+    entry = FindEntry(stripe, key, hash);
+    if (entry && entry->state == CACHE_ENTRY_READY && info &&
+        (entry->file_size != info->size || entry->file_time != info->modify_time)) {
+        /* The file changed since it was cached */
+        DropEntry(stripe, entry);
+        entry = NULL;
+    }
+
+    if (entry) {
+        /* Another thread may still be loading the image, wait for it */
+        ++entry->waiters;
+        while (entry->state == CACHE_ENTRY_LOADING) {
+            SDL_WaitCondition(stripe->cond, stripe->lock);
+        }
+        --entry->waiters;
+
+        if (entry->state == CACHE_ENTRY_READY) {
+            ++stripe->hits;
+            entry->last_used = SDL_GetTicksNS();
+            if (entry->linked) {
+                RemoveFromLRU(stripe, entry);
+                AddToLRU(stripe, entry);
+            }
+            RetainSurface(entry->surface);
+            surface = entry->surface;
+        } else {
+            SDL_SetError("%s", entry->error ? entry->error : "Couldn't load image");
+        }
+        if (!entry->linked && entry->waiters == 0) {
+            FreeEntry(entry);
+        }
+        SDL_UnlockMutex(stripe->lock);
+
+        if (src && closeio) {
+            SDL_CloseIO(src);
+        }
+        return surface;
+    }
+
+    entry = (IMG_CacheEntry *)SDL_calloc(1, sizeof(*entry));
+    if (entry) {
+        entry->key = SDL_strdup(key);
+        if (!entry->key) {
+            SDL_free(entry);
+            entry = NULL;
+        }
+    }
+    if (!entry) {
+        SDL_UnlockMutex(stripe->lock);
+        if (src && closeio) {
+            SDL_CloseIO(src);
+        }
+        return NULL;
+    }
+    entry->hash = hash;
+    if (info) {
+        entry->file_size = info->size;
+        entry->file_time = info->modify_time;
+    }
+    entry->state = CACHE_ENTRY_LOADING;
+    InsertEntry(stripe, entry);
+    ++stripe->misses;
+    SDL_UnlockMutex(stripe->lock);
+
+    /* Decode without holding the lock, other threads asking for this image wait on the entry */
+    if (file) {
+        surface = IMG_Load(file);
+    } else {
+        surface = IMG_Load_IO(src, closeio);
+    }
+
+    SDL_LockMutex(stripe->lock);
+    if (surface) {
+        entry->surface = surface;
+        entry->bytes = (size_t)surface->pitch * surface->h;
+        entry->last_used = SDL_GetTicksNS();
+        entry->state = CACHE_ENTRY_READY;
+        AddToLRU(stripe, entry);
+        stripe->bytes += entry->bytes;
+        RetainSurface(surface);
+    } else {
+        entry->error = SDL_strdup(SDL_GetError());
+        entry->state = CACHE_ENTRY_FAILED;
+        UnlinkEntry(stripe, entry);
+        if (entry->waiters == 0) {
+            FreeEntry(entry);
+        }
+    }
+    SDL_BroadcastCondition(stripe->cond);
+    SDL_UnlockMutex(stripe->lock);
+
+    if (surface) {
+        EvictCacheEntries(cache);
+    }
+    return surface;
+}
+
+IMG_Cache *IMG_CreateCache(size_t byte_budget)
+{
+    IMG_Cache *cache;
+    int i;
+
+    cache = (IMG_Cache *)SDL_calloc(1, sizeof(*cache));
+    if (!cache) {
+        return NULL;
+    }
+    cache->byte_budget = byte_budget;
+
+    for (i = 0; i < NUM_CACHE_STRIPES; ++i) {
+        IMG_CacheStripe *stripe = &cache->stripes[i];
+
+        stripe->lock = SDL_CreateMutex();
+        stripe->cond = SDL_CreateCondition();
+        stripe->buckets = (IMG_CacheEntry **)SDL_calloc(CACHE_BUCKETS, sizeof(*stripe->buckets));
+        stripe->num_buckets = CACHE_BUCKETS;
+        if (!stripe->lock || !stripe->cond || !stripe->buckets) {
+            IMG_DestroyCache(cache);
+            return NULL;
+        }
+    }
+    return cache;
+}
+
+SDL_Surface *IMG_LoadCached(IMG_Cache *cache, const char *file)
+{
+    SDL_PathInfo info;
+
+    if (!cache) {
+        SDL_InvalidParamError("cache");
+        return NULL;
+    }
+    if (!file || !*file) {
+        SDL_InvalidParamError("file");
+        return NULL;
+    }
+
+    if (!SDL_GetPathInfo(file, &info)) {
+        /* This may be an asset that SDL_IOFromFile() can still open */
+        SDL_zero(info);
+    }
+    return LoadCachedImage(cache, file, &info, file, NULL, false);
+}
+
+SDL_Surface *IMG_LoadCached_IO(IMG_Cache *cache, const char *key, SDL_IOStream *src, bool closeio)
+{
+    if (!cache || !key || !src) {
+        if (src && closeio) {
+            SDL_CloseIO(src);
+        }
+        if (!cache) {
+            SDL_InvalidParamError("cache");
+        } else if (!key) {
+            SDL_InvalidParamError("key");
+        } else {
+            SDL_InvalidParamError("src");
+        }
+        return NULL;
+    }
+    return LoadCachedImage(cache, key, NULL, NULL, src, closeio);
+}
+
+bool IMG_GetCacheStats(IMG_Cache *cache, IMG_CacheStats *stats)
+{
+    int i;
+
+    if (!cache) {
+        return SDL_InvalidParamError("cache");
+    }
+    if (!stats) {
+        return SDL_InvalidParamError("stats");
+    }
+
+    SDL_zerop(stats);
+    for (i = 0; i < NUM_CACHE_STRIPES; ++i) {
+        IMG_CacheStripe *stripe = &cache->stripes[i];
+        IMG_CacheEntry *entry;
+
+        SDL_LockMutex(stripe->lock);
+        stats->hits += stripe->hits;
+        stats->misses += stripe->misses;
+        stats->evictions += stripe->evictions;
+        for (entry = stripe->lru_head; entry; entry = entry->lru_next) {
+            ++stats->count;
+        }
+        stats->bytes += stripe->bytes;
+        SDL_UnlockMutex(stripe->lock);
+    }
+    return true;
+}
+
+void IMG_ClearCache(IMG_Cache *cache)
+{
+    int i;
+
+    if (!cache) {
+        return;
+    }
+
+    for (i = 0; i < NUM_CACHE_STRIPES; ++i) {
+        IMG_CacheStripe *stripe = &cache->stripes[i];
+
+        SDL_LockMutex(stripe->lock);
+        while (stripe->lru_head) {
+            DropEntry(stripe, stripe->lru_head);
+        }
+        SDL_UnlockMutex(stripe->lock);
+    }
+}
+
+void IMG_DestroyCache(IMG_Cache *cache)
+{
+    int i;
+
+    if (!cache) {
+        return;
+    }
+
+    for (i = 0; i < NUM_CACHE_STRIPES; ++i) {
+        IMG_CacheStripe *stripe = &cache->stripes[i];
+
+        if (stripe->buckets) {
+            int bucket;
+
+            for (bucket = 0; bucket < stripe->num_buckets; ++bucket) {
+                while (stripe->buckets[bucket]) {
+                    IMG_CacheEntry *entry = stripe->buckets[bucket];
+
+                    stripe->buckets[bucket] = entry->next;
+                    FreeEntry(entry);
+                }
+            }
+            SDL_free(stripe->buckets);
+        }
+        SDL_DestroyCondition(stripe->cond);
+        SDL_DestroyMutex(stripe->lock);
+    }
+    SDL_free(cache);
+}
@@ -0,0 +1,580 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Decoded images cached on disk between runs
+ *
+ * Each cached image is a file named after a hash of the source data, made
+ * of a header, the palette if there is one, and the rows of pixels exactly
+ * as they are laid out in the surface. The pixels start on an aligned
+ * offset, so the file can be mapped and used as the surface pixels as is.
+ * The files are written in native byte order, and aren't meant to be shared
+ * between machines.
+ */
+
+#include <SDL3_image/SDL_image.h>
+
+#include "IMG_diskcache.h"
+#include "IMG_io.h"
+#include "IMG_limits.h"
+#include "IMG_stats.h"
+
+#define DISK_CACHE_MAGIC        "SDLIMGC1"
+#define DISK_CACHE_BYTEORDER    0x01020304
+#define DISK_CACHE_EXTENSION    ".sdlimg"
+
+/* Temporary files older than this were left behind by a writer that stopped */
+#define DISK_CACHE_TEMP_AGE     ((SDL_Time)SDL_SECONDS_TO_NS(60 * 60))
+
+/* Alignment of the pixels in a cache file */
+#define DISK_CACHE_ALIGN        64
+
+/* Flags for IMG_DiskCacheHeader */
+#define DISK_CACHE_COLORKEY     0x01
+#define DISK_CACHE_RLE          0x02
+
+/* Name of the surface property that holds the mapped cache file */
+#define DISK_CACHE_MAPPING_PROPERTY "SDL_image.disk_cache.mapping"
+
+typedef struct IMG_DiskCacheHeader
+{
+    char magic[8];
+    Uint64 source_size;
+    Uint32 byteorder;
+    Uint32 hash[2];
+    Uint32 format;
+    Sint32 w;
+    Sint32 h;
+    Sint32 pitch;
+    Uint32 colorspace;
+    Uint32 blend_mode;
+    Uint32 flags;
+    Uint32 colorkey;
+    Sint32 ncolors;
+    Uint32 pixels_offset;
+    Uint32 reserved;
+} IMG_DiskCacheHeader;
+
+typedef struct IMG_DiskCacheMapping
+{
+    void *data;
+    size_t size;
+} IMG_DiskCacheMapping;
+
+typedef struct IMG_DiskCacheFile
+{
+    char *path;
+    Uint64 size;
+    SDL_Time time;
+} IMG_DiskCacheFile;
+
+static SDL_SpinLock disk_cache_lock;
+static char *disk_cache_dir;
+
+/* Get a copy of the cache directory, with a trailing separator */
+static char *GetDiskCacheDirectory(void)
+{
+    char *dir = NULL;
+
+    SDL_LockSpinlock(&disk_cache_lock);
+    if (disk_cache_dir) {
+        dir = SDL_strdup(disk_cache_dir);
+    }
+    SDL_UnlockSpinlock(&disk_cache_lock);
+    return dir;
+}
+
+bool IMG_SetDiskCacheDirectory(const char *path)
+{
+    char *dir = NULL;
+    char *old_dir;
+
+    if (path) {
+        SDL_PathInfo info;
+        size_t len = SDL_strlen(path);
+
+        if (len == 0) {
+            return SDL_InvalidParamError("path");
+        }
+        if (!SDL_CreateDirectory(path)) {
+            return false;
+        }
+        if (!SDL_GetPathInfo(path, &info)) {
+            return false;
+        }
+        if (info.type != SDL_PATHTYPE_DIRECTORY) {
+            return SDL_SetError("%s is not a directory", path);
+        }
+
+        if (path[len - 1] == '/' || path[len - 1] == '\\') {
+            dir = SDL_strdup(path);
+        } else {
+            SDL_asprintf(&dir, "%s/", path);
+        }
+        if (!dir) {
+            return false;
+        }
+    }
+
+    SDL_LockSpinlock(&disk_cache_lock);
+    old_dir = disk_cache_dir;
+    disk_cache_dir = dir;
+    SDL_UnlockSpinlock(&disk_cache_lock);
+
+    SDL_free(old_dir);
+    return true;
+}
+
+bool IMG_IsDiskCacheEnabled(void)
+{
+    bool enabled;
+
+    SDL_LockSpinlock(&disk_cache_lock);
+    enabled = (disk_cache_dir != NULL);
+    SDL_UnlockSpinlock(&disk_cache_lock);
+    return enabled;
+}
+
+static void MakeCacheKey(IMG_DiskCacheHeader *key, const Uint8 *data, size_t datasize, const char *type)
+{
+    Uint32 seed = 0;
+
+    /* The type matters for formats that are only loaded by type, like TGA */
+    if (type) {
+        for (; *type; ++type) {
+            seed = seed * 31 + (Uint32)SDL_toupper((unsigned char)*type);
+        }
+    }
+
+    SDL_zerop(key);
+    key->source_size = datasize;
+    key->hash[0] = SDL_murmur3_32(data, datasize, seed);
+    key->hash[1] = SDL_murmur3_32(data, datasize, ~seed);
+}
+
+static bool IsValidCacheFile(const IMG_DiskCacheHeader *header, const IMG_DiskCacheHeader *key, size_t filesize)
+{
+    Uint64 pixels_end;
+
+    if (filesize < sizeof(*header) ||
+        SDL_memcmp(header->magic, DISK_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->byteorder != DISK_CACHE_BYTEORDER ||
+        header->source_size != key->source_size ||
+        header->hash[0] != key->hash[0] ||
+        header->hash[1] != key->hash[1]) {
+        return false;
+    }
+    if (header->w <= 0 || header->h <= 0 || header->pitch <= 0 ||
+        header->ncolors < 0 || header->ncolors > 256 ||
+        SDL_ISPIXELFORMAT_FOURCC(header->format)) {
+        return false;
+    }
+    if (header->pixels_offset % DISK_CACHE_ALIGN != 0 ||
+        header->pixels_offset < sizeof(*header) + header->ncolors * sizeof(SDL_Color)) {
+        return false;
+    }
+    pixels_end = (Uint64)header->pixels_offset + (Uint64)header->pitch * header->h;
+    return pixels_end <= filesize;
+}
+
+static void SDLCALL UnmapCachedPixels(void *userdata, void *value)
+{
+    IMG_DiskCacheMapping *mapping = (IMG_DiskCacheMapping *)value;
+
+    (void)userdata;
+    IMG_UnmapFile(mapping->data, mapping->size);
+    SDL_free(mapping);
+}
+
+/* Create a surface from a validated cache file, using the pixels in place if the file is mapped */
+static SDL_Surface *CreateCachedSurface(const Uint8 *data, const IMG_DiskCacheHeader *header, IMG_DiskCacheMapping *mapping)
+{
+    SDL_Surface *surface;
+    const Uint8 *pixels = data + header->pixels_offset;
+
+    if (mapping) {
+        surface = SDL_CreateSurfaceFrom(header->w, header->h, (SDL_PixelFormat)header->format, (void *)pixels, header->pitch);
+        if (!surface) {
+            return NULL;
+        }
+        if (!SDL_SetPointerPropertyWithCleanup(SDL_GetSurfaceProperties(surface), DISK_CACHE_MAPPING_PROPERTY, mapping, UnmapCachedPixels, NULL)) {
+            /* The cleanup has already been called */
+            SDL_DestroySurface(surface);
+            return NULL;
+        }
+    } else {
+        size_t row_size;
+        int y;
+
+        surface = SDL_CreateSurface(header->w, header->h, (SDL_PixelFormat)header->format);
+        if (!surface) {
+            return NULL;
+        }
+        row_size = SDL_min(surface->pitch, header->pitch);
+        for (y = 0; y < header->h; ++y) {
+            SDL_memcpy((Uint8 *)surface->pixels + y * surface->pitch, pixels + y * header->pitch, row_size);
+        }
+    }
+
+    if (header->ncolors > 0) {
+        SDL_Palette *palette = SDL_GetSurfacePalette(surface);
+
+        if (!palette) {
+            palette = SDL_CreateSurfacePalette(surface);
+        }
+        if (!palette || !SDL_SetPaletteColors(palette, (const SDL_Color *)(data + sizeof(*header)), 0, header->ncolors)) {
+            SDL_DestroySurface(surface);
+            return NULL;
+        }
+    }
+    SDL_SetSurfaceColorspace(surface, (SDL_Colorspace)header->colorspace);
+    SDL_SetSurfaceBlendMode(surface, (SDL_BlendMode)header->blend_mode);
+    if (header->flags & DISK_CACHE_COLORKEY) {
+        SDL_SetSurfaceColorKey(surface, true, header->colorkey);
+    }
+    if (header->flags & DISK_CACHE_RLE) {
+        SDL_SetSurfaceRLE(surface, true);
+    }
+    return surface;
+}
+
+static SDL_Surface *LoadCacheFile(const char *path, const IMG_DiskCacheHeader *key)
+{
+    IMG_DiskCacheMapping *mapping = NULL;
+    const IMG_DiskCacheHeader *header;
+    Uint8 *data;
+    size_t filesize = 0;
+    SDL_Surface *surface = NULL;
+
+    data = (Uint8 *)IMG_MapFile(path, &filesize);
+    if (data) {
+        mapping = (IMG_DiskCacheMapping *)SDL_malloc(sizeof(*mapping));
+        if (!mapping) {
+            IMG_UnmapFile(data, filesize);
+            return NULL;
+        }
+        mapping->data = data;
+        mapping->size = filesize;
+    } else {
+        data = (Uint8 *)SDL_LoadFile(path, &filesize);
+        if (!data) {
+            return NULL;
+        }
+    }
+
+    header = (const IMG_DiskCacheHeader *)data;
+    if (IsValidCacheFile(header, key, filesize) &&
+        IMG_CheckImageLimits(header->w, header->h, (SDL_PixelFormat)header->format)) {
+        surface = CreateCachedSurface(data, header, mapping);
+        if (mapping) {
+            /* The surface owns the mapping now, or has already released it */
+            return surface;
+        }
+    }
+
+    if (mapping) {
+        UnmapCachedPixels(NULL, mapping);
+    } else {
+        SDL_free(data);
+    }
+    return surface;
+}
+
+static void SDLCALL CountProperty(void *userdata, SDL_PropertiesID props, const char *name)
+{
+    (void)props;
+    (void)name;
+    ++*(int *)userdata;
+}
+
+/* Only cache surfaces that can be rebuilt exactly from the file */
+static bool CanCacheSurface(SDL_Surface *surface)
+{
+    int num_properties = 0;
+
+    if (SDL_ISPIXELFORMAT_FOURCC(surface->format) || SDL_SurfaceHasAlternateImages(surface)) {
+        return false;
+    }
+    SDL_EnumerateProperties(SDL_GetSurfaceProperties(surface), CountProperty, &num_properties);
+    return num_properties == 0;
+}
+
+static bool WriteCacheFile(SDL_IOStream *dst, const IMG_DiskCacheHeader *key, SDL_Surface *surface)
+{
+    static const Uint8 padding[DISK_CACHE_ALIGN];
+    IMG_DiskCacheHeader header;
+    SDL_Palette *palette = SDL_GetSurfacePalette(surface);
+    SDL_BlendMode blend_mode = SDL_BLENDMODE_NONE;
+    Uint32 colorkey = 0;
+    size_t offset;
+    bool result = true;
+    int y;
+
+    header = *key;
+    SDL_memcpy(header.magic, DISK_CACHE_MAGIC, sizeof(header.magic));
+    header.byteorder = DISK_CACHE_BYTEORDER;
+    header.format = surface->format;
+    header.w = surface->w;
+    header.h = surface->h;
+    header.pitch = surface->pitch;
+    header.colorspace = SDL_GetSurfaceColorspace(surface);
+    SDL_GetSurfaceBlendMode(surface, &blend_mode);
+    header.blend_mode = blend_mode;
+    if (SDL_SurfaceHasColorKey(surface) && SDL_GetSurfaceColorKey(surface, &colorkey)) {
+        header.flags |= DISK_CACHE_COLORKEY;
+        header.colorkey = colorkey;
+    }
+    if (SDL_SurfaceHasRLE(surface)) {
+        header.flags |= DISK_CACHE_RLE;
+    }
+    header.ncolors = palette ? palette->ncolors : 0;
+    offset = sizeof(header) + header.ncolors * sizeof(SDL_Color);
+    header.pixels_offset = (Uint32)((offset + DISK_CACHE_ALIGN - 1) & ~(size_t)(DISK_CACHE_ALIGN - 1));
+
+    if (SDL_WriteIO(dst, &header, sizeof(header)) != sizeof(header)) {
+        return false;
+    }
+    if (header.ncolors > 0 &&
+        SDL_WriteIO(dst, palette->colors, header.ncolors * sizeof(SDL_Color)) != header.ncolors * sizeof(SDL_Color)) {
+        return false;
+    }
+    if (SDL_WriteIO(dst, padding, header.pixels_offset - offset) != header.pixels_offset - offset) {
+        return false;
+    }
+
+    if (!SDL_LockSurface(surface)) {
+        return false;
+    }
+    for (y = 0; y < surface->h; ++y) {
+        if (SDL_WriteIO(dst, (const Uint8 *)surface->pixels + y * surface->pitch, surface->pitch) != (size_t)surface->pitch) {
+            result = false;
+            break;
+        }
+    }
+    SDL_UnlockSurface(surface);
+    return result;
+}
+
+/* Store a decoded image, failures are ignored since the image has been loaded anyway */
+static void SaveCacheFile(const char *path, const IMG_DiskCacheHeader *key, SDL_Surface *surface)
+{
+    SDL_IOStream *dst;
+    char *temp = NULL;
+    Uint64 seed;
+    bool result;
+
+    if (!CanCacheSurface(surface)) {
+        return;
+    }
+
+    /* Write to a unique temporary file first, so readers never see a partial file.
+     * The thread ID is only unique within this process, other processes sharing
+     * the cache directory are told apart by the random part.
+     */
+    seed = SDL_GetPerformanceCounter();
+    if (SDL_asprintf(&temp, "%s.%" SDL_PRIu64 ".%08" SDL_PRIx32 ".tmp", path,
+                     (Uint64)SDL_GetCurrentThreadID(), SDL_rand_bits_r(&seed)) < 0) {
+        return;
+    }
+    dst = SDL_IOFromFile(temp, "wb");
+    if (!dst) {
+        SDL_free(temp);
+        return;
+    }
+    result = WriteCacheFile(dst, key, surface);
+    if (!SDL_CloseIO(dst)) {
+        result = false;
+    }
+    if (!result || !SDL_RenamePath(temp, path)) {
+        SDL_RemovePath(temp);
+    }
+    SDL_free(temp);
+}
+
+SDL_Surface *IMG_LoadDiskCached(SDL_IOStream *src, const char *type, IMG_DiskCacheLoadFunc load)
+{
+    IMG_DiskCacheHeader key;
+    const Uint8 *data;
+    void *allocated = NULL;
+    size_t datasize = 0;
+    Sint64 start;
+    char *dir;
+    char *path = NULL;
+    SDL_Surface *surface = NULL;
+
+    dir = GetDiskCacheDirectory();
+    if (!dir) {
+        return load(src, type);
+    }
+
+    start = SDL_TellIO(src);
+    data = IMG_LoadIOData(src, &datasize, &allocated);
+    if (!data) {
+        /* Let the decoder deal with whatever is wrong with the stream */
+        SDL_free(dir);
+        SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+        return load(src, type);
+    }
+
+    MakeCacheKey(&key, data, datasize, type);
+    if (SDL_asprintf(&path, "%s%08" SDL_PRIx32 "%08" SDL_PRIx32 "%016" SDL_PRIx64 DISK_CACHE_EXTENSION,
+                     dir, key.hash[0], key.hash[1], key.source_size) < 0) {
+        path = NULL;
+    }
+    if (path) {
+        surface = LoadCacheFile(path, &key);
+        if (surface) {
+            /* Keep the file from being pruned while it's in use */
+            IMG_TouchFile(path);
+            IMG_CountDiskCacheHit();
+        }
+    }
+
+    if (!surface) {
+        SDL_IOStream *mem = SDL_IOFromConstMem(data, datasize);
+        if (mem) {
+            surface = load(mem, type);
+            SDL_CloseIO(mem);
+        }
+        if (surface && path) {
+            SaveCacheFile(path, &key, surface);
+        }
+    }
+
+    SDL_free(path);
+    SDL_free(allocated);
+    SDL_free(dir);
+    return surface;
+}
+
+static int SDLCALL CompareCacheFiles(const void *a, const void *b)
+{
+    const IMG_DiskCacheFile *file_a = (const IMG_DiskCacheFile *)a;
+    const IMG_DiskCacheFile *file_b = (const IMG_DiskCacheFile *)b;
+
+    if (file_a->time < file_b->time) {
+        return -1;
+    }
+    if (file_a->time > file_b->time) {
+        return 1;
+    }
+    return 0;
+}
+
+/* Remove the temporary files of writers that stopped before renaming them */
+static void PruneTempFiles(const char *dir)
+{
+    SDL_Time now;
+    char **names;
+    int count = 0;
+    int i;
+
+    if (!SDL_GetCurrentTime(&now)) {
+        return;
+    }
+    names = SDL_GlobDirectory(dir, "*" DISK_CACHE_EXTENSION ".*.tmp", 0, &count);
+    if (!names) {
+        return;
+    }
+    for (i = 0; i < count; ++i) {
+        SDL_PathInfo info;
+        char *path = NULL;
+
+        if (SDL_asprintf(&path, "%s%s", dir, names[i]) < 0) {
+            break;
+        }
+        if (SDL_GetPathInfo(path, &info) && info.type == SDL_PATHTYPE_FILE &&
+            info.modify_time < now - DISK_CACHE_TEMP_AGE) {
+            SDL_RemovePath(path);
+        }
+        SDL_free(path);
+    }
+    SDL_free(names);
+}
+
+bool IMG_PruneDiskCache(Uint64 max_bytes)
+{
+    IMG_DiskCacheFile *files = NULL;
+    char **names;
+    char *dir;
+    Uint64 total = 0;
+    int count = 0;
+    int num_files = 0;
+    int i;
+    bool result = true;
+
+    dir = GetDiskCacheDirectory();
+    if (!dir) {
+        return SDL_SetError("No disk cache directory has been set");
+    }
+
+    PruneTempFiles(dir);
+
+    names = SDL_GlobDirectory(dir, "*" DISK_CACHE_EXTENSION, 0, &count);
+    if (!names) {
+        SDL_free(dir);
+        return false;
+    }
+
+    if (count > 0) {
+        files = (IMG_DiskCacheFile *)SDL_calloc(count, sizeof(*files));
+        if (!files) {
+            result = false;
+            goto done;
+        }
+    }
+    for (i = 0; i < count; ++i) {
+        SDL_PathInfo info;
+        char *path = NULL;
+
+        if (SDL_asprintf(&path, "%s%s", dir, names[i]) < 0) {
+            result = false;
+            goto done;
+        }
+        if (!SDL_GetPathInfo(path, &info) || info.type != SDL_PATHTYPE_FILE) {
+            SDL_free(path);
+            continue;
+        }
+        files[num_files].path = path;
+        files[num_files].size = info.size;
+        files[num_files].time = info.modify_time;
+        total += info.size;
+        ++num_files;
+    }
+
+    /* Remove the least recently used files first */
+    SDL_qsort(files, num_files, sizeof(*files), CompareCacheFiles);
+    for (i = 0; i < num_files && total > max_bytes; ++i) {
+        if (!SDL_RemovePath(files[i].path)) {
+            result = false;
+            continue;
+        }
+        total -= files[i].size;
+    }
+
+done:
+    for (i = 0; i < num_files; ++i) {
+        SDL_free(files[i].path);
+    }
+    SDL_free(files);
+    SDL_free(names);
+    SDL_free(dir);
+    return result;
+}
@@ -0,0 +1,33 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Decoded images cached on disk, see IMG_SetDiskCacheDirectory() */
+
+typedef SDL_Surface *(*IMG_DiskCacheLoadFunc)(SDL_IOStream *src, const char *type);
+
+/* Returns true if a cache directory has been set */
+extern bool IMG_IsDiskCacheEnabled(void);
+
+/* Load the image at the current position of `src` from the disk cache, or
+ * decode it with `load` and store it in the cache. `src` is read to the end
+ * and is left open.
+ */
+extern SDL_Surface *IMG_LoadDiskCached(SDL_IOStream *src, const char *type, IMG_DiskCacheLoadFunc load);
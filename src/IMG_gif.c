@@ -26,6 +26,11 @@
 #include "IMG_gif.h"
 #include "IMG_anim_encoder.h"
 #include "IMG_anim_decoder.h"
+#include "IMG_info.h"
+#include "IMG_limits.h"
+#include "IMG_progress.h"
+#include "IMG_scratch.h"
+#include "IMG_stats.h"
 
 // We will have the saving GIF feature by default
 #if !defined(SAVE_GIF)
@@ -118,16 +123,23 @@ typedef struct {
         int disposal;
     } Gif89;
 
+    /* LZW decoder state, the current data sub-block is buf[block_pos..block_len) */
     unsigned char buf[280];
-    int curbit, lastbit, done, last_byte;
+    int block_pos, block_len;
+    int next_count;
+    Uint32 bits;
+    int nbits;
+    int done;
 
     int fresh;
     int code_size, set_code_size;
     int max_code, max_code_size;
     int firstcode, oldcode;
     int clear_code, end_code;
-    int table[2][(1 << MAX_LWZ_BITS)];
-    int stack[(1 << (MAX_LWZ_BITS)) * 2], *sp;
+    Uint16 prefix[(1 << MAX_LWZ_BITS)];
+    Uint8 suffix[(1 << MAX_LWZ_BITS)];
+    Uint16 length[(1 << MAX_LWZ_BITS)];
+    Uint8 stack[(1 << MAX_LWZ_BITS)], *sp, *sp_end;
 
     int ZeroDataBlock;
 } State_t;
@@ -150,11 +162,11 @@ static int ReadColorMap(SDL_IOStream * src, int number,
 			unsigned char buffer[3][MAXCOLORMAPSIZE], int *flag);
 static int DoExtension(SDL_IOStream * src, int label, State_t * state);
 static int GetDataBlock(SDL_IOStream * src, unsigned char *buf, State_t * state);
-static int GetCode(SDL_IOStream * src, int code_size, int flag, State_t * state);
-static int LWZReadByte(SDL_IOStream * src, int flag, int input_code_size, State_t * state);
-static Image *ReadImage(SDL_IOStream *src, int len, int height, int cmapSize,
-          unsigned char cmap[3][MAXCOLORMAPSIZE],
-          int gray, int interlace, int ignore, State_t *state);
+static int LWZInit(SDL_IOStream * src, int input_code_size, State_t * state);
+static int LWZReadRow(SDL_IOStream * src, Uint8 *row, int len, State_t * state);
+static bool CompositeImage(SDL_IOStream *src, int len, int height, int cmapSize,
+          unsigned char cmap[3][MAXCOLORMAPSIZE], int interlace,
+          SDL_Surface *canvas, int left, int top, Uint8 *row, State_t *state);
 
 static int
 ReadColorMap(SDL_IOStream *src, int number,
@@ -243,150 +255,188 @@ GetDataBlock(SDL_IOStream *src, unsigned char *buf, State_t * state)
     return count;
 }
 
+/* Read the next data sub-block, along with the count byte of the sub-block after it */
 static int
-GetCode(SDL_IOStream *src, int code_size, int flag, State_t * state)
+NextDataBlock(SDL_IOStream *src, State_t * state)
 {
-    int i, j, ret;
-    unsigned char count;
+    int count = state->next_count;
+    size_t amount;
 
-    if (flag) {
-        state->curbit = 0;
-        state->lastbit = 0;
-        state->done = FALSE;
-        return 0;
+    if (count == 0) {
+        return FALSE;
     }
-    if ((state->curbit + code_size) >= state->lastbit) {
-        if (state->done) {
-            if (state->curbit >= state->lastbit)
-                RWSetMsg("ran off the end of my bits");
-            return -1;
-        }
-        state->buf[0] = state->buf[state->last_byte - 2];
-        state->buf[1] = state->buf[state->last_byte - 1];
 
-        if ((ret = GetDataBlock(src, &state->buf[2], state)) > 0)
-            count = (unsigned char) ret;
-        else {
-            count = 0;
-            state->done = TRUE;
-        }
-
-        state->last_byte = 2 + count;
-        state->curbit = (state->curbit - state->lastbit) + 16;
-        state->lastbit = (2 + count) * 8;
+    amount = SDL_ReadIO(src, state->buf, count + 1);
+    if (amount > (size_t)count) {
+        state->next_count = state->buf[count];
+        state->ZeroDataBlock = state->next_count == 0;
+    } else {
+        /* Truncated image data, use whatever we got */
+        state->next_count = 0;
+        state->ZeroDataBlock = FALSE;
     }
-    ret = 0;
-    for (i = state->curbit, j = 0; j < code_size; ++i, ++j)
-        ret |= ((state->buf[i / 8] & (1 << (i % 8))) != 0) << j;
+    state->block_pos = 0;
+    state->block_len = (int)SDL_min(amount, (size_t)count);
+    return state->block_len > 0;
+}
 
-    state->curbit += code_size;
+/* Skip the rest of the image data, up to and including the block terminator */
+static void
+LWZFinish(SDL_IOStream *src, State_t * state)
+{
+    while (NextDataBlock(src, state))
+        ;
+    state->block_pos = state->block_len = 0;
+    state->done = TRUE;
+}
 
-    return ret;
+static void
+LWZResetTable(State_t * state)
+{
+    state->code_size = state->set_code_size + 1;
+    state->max_code_size = 2 * state->clear_code;
+    state->max_code = state->clear_code + 2;
+    state->fresh = TRUE;
 }
 
 static int
-LWZReadByte(SDL_IOStream *src, int flag, int input_code_size, State_t * state)
+LWZInit(SDL_IOStream *src, int input_code_size, State_t * state)
 {
-    int i, code, incode;
+    unsigned char count;
+    int i;
 
     /* Fixed buffer overflow found by Michael Skladnikiewicz */
     if (input_code_size > MAX_LWZ_BITS)
         return -1;
 
-    if (flag) {
-        state->set_code_size = input_code_size;
-        state->code_size = state->set_code_size + 1;
-        state->clear_code = 1 << state->set_code_size;
-        state->end_code = state->clear_code + 1;
-        state->max_code_size = 2 * state->clear_code;
-        state->max_code = state->clear_code + 2;
-
-        GetCode(src, 0, TRUE, state);
+    state->set_code_size = input_code_size;
+    state->clear_code = 1 << state->set_code_size;
+    state->end_code = state->clear_code + 1;
+    LWZResetTable(state);
 
-        state->fresh = TRUE;
-
-        for (i = 0; i < state->clear_code; ++i) {
-            state->table[0][i] = 0;
-            state->table[1][i] = i;
-        }
-        state->table[1][0] = 0;
-        for (; i < (1 << MAX_LWZ_BITS); ++i)
-            state->table[0][i] = 0;
+    /* The single byte strings, the table entries after them are filled in as codes arrive */
+    for (i = 0; i < state->clear_code && i < (1 << MAX_LWZ_BITS); ++i) {
+        state->prefix[i] = 0;
+        state->suffix[i] = (Uint8)i;
+        state->length[i] = 1;
+    }
 
-        state->sp = state->stack;
+    state->bits = 0;
+    state->nbits = 0;
+    state->block_pos = state->block_len = 0;
+    state->sp = state->sp_end = state->stack;
+    state->done = FALSE;
 
-        return 0;
-    } else if (state->fresh) {
-        state->fresh = FALSE;
-        do {
-            state->firstcode = state->oldcode = GetCode(src, state->code_size, FALSE, state);
-        } while (state->firstcode == state->clear_code);
-        return state->firstcode;
+    if (!ReadOK(src, &count, 1)) {
+        return -1;
     }
-    if (state->sp > state->stack)
-        return *--state->sp;
+    state->next_count = count;
+    state->ZeroDataBlock = count == 0;
+    return 0;
+}
 
-    while ((code = GetCode(src, state->code_size, FALSE, state)) >= 0) {
-        if (code == state->clear_code) {
-            for (i = 0; i < state->clear_code; ++i) {
-                state->table[0][i] = 0;
-                state->table[1][i] = i;
+/* Decode the next `len` pixels into `row`, returning how many were decoded */
+static int
+LWZReadRow(SDL_IOStream *src, Uint8 *row, int len, State_t * state)
+{
+    Uint8 *out = row;
+    Uint8 *end = row + len;
+    Uint8 *p;
+    Uint32 bits = state->bits;
+    int nbits = state->nbits;
+    int code, incode, count;
+
+    /* Finish the string that didn't fit in the previous row */
+    if (state->sp < state->sp_end) {
+        count = (int)SDL_min((Sint64)(state->sp_end - state->sp), (Sint64)len);
+        SDL_memcpy(out, state->sp, count);
+        state->sp += count;
+        out += count;
+    }
+
+    while (out < end && !state->done) {
+        /* Refill a byte at a time, there is always room in the bit buffer for one more */
+        while (nbits < state->code_size) {
+            if (state->block_pos == state->block_len && !NextDataBlock(src, state)) {
+                break;
             }
-            for (; i < (1 << MAX_LWZ_BITS); ++i)
-                state->table[0][i] = state->table[1][i] = 0;
-            state->code_size = state->set_code_size + 1;
-            state->max_code_size = 2 * state->clear_code;
-            state->max_code = state->clear_code + 2;
-            state->sp = state->stack;
-            state->firstcode = state->oldcode = GetCode(src, state->code_size, FALSE, state);
-            return state->firstcode;
-        } else if (code == state->end_code) {
-            int count;
-            unsigned char buf[260];
-
-            if (state->ZeroDataBlock)
-                return -2;
-
-            while ((count = GetDataBlock(src, buf, state)) > 0)
-                ;
-
-            if (count != 0) {
-            /*
-             * pm_message("missing EOD in data stream (common occurrence)");
-             */
+            bits |= (Uint32)state->buf[state->block_pos++] << nbits;
+            nbits += 8;
+        }
+        if (nbits < state->code_size) {
+            RWSetMsg("ran off the end of my bits");
+            state->done = TRUE;
+            break;
+        }
+        code = (int)(bits & ((1u << state->code_size) - 1));
+        bits >>= state->code_size;
+        nbits -= state->code_size;
+
+        if (code == state->clear_code) {
+            LWZResetTable(state);
+            continue;
+        }
+        if (code == state->end_code) {
+            LWZFinish(src, state);
+            break;
+        }
+
+        if (state->fresh) {
+            if (code >= state->clear_code) {
+                RWSetMsg("invalid LWZ data");
+                state->done = TRUE;
+                break;
             }
-            return -2;
+            state->fresh = FALSE;
+            state->firstcode = state->oldcode = code;
+            *out++ = (Uint8)code;
+            continue;
         }
+
         incode = code;
+        if (code < state->max_code) {
+            count = state->length[code];
+        } else if (code == state->max_code && code < (1 << MAX_LWZ_BITS)) {
+            /* The code being defined: the previous string plus its own first byte */
+            count = state->length[state->oldcode] + 1;
+        } else {
+            RWSetMsg("invalid LWZ data");
+            state->done = TRUE;
+            break;
+        }
 
-        if (code >= state->max_code) {
-            *state->sp++ = state->firstcode;
+        /* Write the string backwards from its last byte, straight into the row if it fits */
+        if (count <= end - out) {
+            p = out + count;
+            out += count;
+        } else {
+            p = state->stack + count;
+            state->sp = state->stack;
+            state->sp_end = p;
+        }
+        if (code == state->max_code) {
+            *--p = (Uint8)state->firstcode;
             code = state->oldcode;
         }
         while (code >= state->clear_code) {
-            /* Guard against buffer overruns */
-            if (code < 0 || code >= (1 << MAX_LWZ_BITS)) {
-                RWSetMsg("invalid LWZ data");
-                return -3;
-            }
-            *state->sp++ = state->table[1][code];
-            if (code == state->table[0][code]) {
-                RWSetMsg("circular table entry BIG ERROR");
-                return -3;
-            }
-            code = state->table[0][code];
+            *--p = state->suffix[code];
+            code = state->prefix[code];
         }
+        *--p = (Uint8)code;
+        state->firstcode = code;
 
-        /* Guard against buffer overruns */
-        if (code < 0 || code >= (1 << MAX_LWZ_BITS)) {
-            RWSetMsg("invalid LWZ data");
-            return -4;
+        if (state->sp < state->sp_end) {
+            count = (int)(end - out);
+            SDL_memcpy(out, state->sp, count);
+            state->sp += count;
+            out = end;
         }
-        *state->sp++ = state->firstcode = state->table[1][code];
 
+        /* Add the previous string plus the first byte of this one */
         if ((code = state->max_code) < (1 << MAX_LWZ_BITS)) {
-            state->table[0][code] = state->oldcode;
-            state->table[1][code] = state->firstcode;
+            state->prefix[code] = (Uint16)state->oldcode;
+            state->suffix[code] = (Uint8)state->firstcode;
+            state->length[code] = state->length[state->oldcode] + 1;
             ++state->max_code;
             if ((state->max_code >= state->max_code_size) &&
                 (state->max_code_size < (1 << MAX_LWZ_BITS))) {
@@ -395,110 +445,109 @@ LWZReadByte(SDL_IOStream *src, int flag, int input_code_size, State_t * state)
             }
         }
         state->oldcode = incode;
-
-        if (state->sp > state->stack)
-            return *--state->sp;
     }
-    return code;
+
+    state->bits = bits;
+    state->nbits = nbits;
+    return (int)(out - row);
 }
 
-static Image *
-ReadImage(SDL_IOStream * src, int len, int height, int cmapSize,
-          unsigned char cmap[3][MAXCOLORMAPSIZE],
-          int gray, int interlace, int ignore, State_t * state)
+/* Move on to the next row of the image, returns false after the last one */
+static bool
+NextImageRow(int *ypos, int *pass, int height, int interlace)
 {
-    Image *image;
-    SDL_Palette *palette;
+    static const int pass_start[] = { 0, 4, 2, 1 };
+    static const int pass_step[] = { 8, 8, 4, 2 };
+
+    if (!interlace) {
+        return ++*ypos < height;
+    }
+
+    *ypos += pass_step[*pass];
+    while (*ypos >= height) {
+        if (++*pass == (int)SDL_arraysize(pass_start)) {
+            return false;
+        }
+        *ypos = pass_start[*pass];
+    }
+    return true;
+}
+
+/* Decode an image straight onto an RGBA canvas at (left, top), leaving the
+ * transparent pixels and any rows missing from the data as they were.
+ * `row` holds the color indices of one row of the image.
+ */
+static bool
+CompositeImage(SDL_IOStream *src, int len, int height, int cmapSize,
+               unsigned char cmap[3][MAXCOLORMAPSIZE], int interlace,
+               SDL_Surface *canvas, int left, int top, Uint8 *row, State_t *state)
+{
+    Uint32 lut[MAXCOLORMAPSIZE];
+    Uint32 *dst;
     unsigned char c;
-    int i, v;
-    int xpos = 0, ypos = 0, pass = 0;
+    int transparent = -1;
+    int i, x, decoded, count, visible;
+    int ypos = 0, pass = 0;
+    int rows = 0;
 
     /*
     **  Initialize the compression routines
      */
     if (!ReadOK(src, &c, 1)) {
-        RWSetMsg("EOF / read error on image data");
-        return NULL;
+        return RWSetMsg("EOF / read error on image data");
     }
-    if (LWZReadByte(src, TRUE, c, state) < 0) {
-        RWSetMsg("error reading image");
-        return NULL;
-    }
-    /*
-    **  If this is an "uninteresting picture" ignore it.
-     */
-    if (ignore) {
-        while (LWZReadByte(src, FALSE, c, state) >= 0)
-            ;
-        return NULL;
-    }
-    image = ImageNewCmap(len, height, cmapSize);
-    if (!image) {
-        return NULL;
+    if (LWZInit(src, c, state) < 0) {
+        return RWSetMsg("error reading image");
     }
 
-    palette = SDL_CreateSurfacePalette(image);
-    if (!palette) {
-        return NULL;
+    if (cmapSize > MAXCOLORMAPSIZE) {
+        cmapSize = MAXCOLORMAPSIZE;
     }
-    if (cmapSize > palette->ncolors) {
-        cmapSize = palette->ncolors;
+    for (i = 0; i < cmapSize; ++i) {
+        lut[i] = SDL_MapSurfaceRGBA(canvas, cmap[CM_RED][i], cmap[CM_GREEN][i], cmap[CM_BLUE][i], 0xFF);
     }
-    palette->ncolors = cmapSize;
-    for (i = 0; i < cmapSize; i++) {
-        ImageSetCmap(image, i, cmap[CM_RED][i], cmap[CM_GREEN][i], cmap[CM_BLUE][i]);
+    for (; i < MAXCOLORMAPSIZE; ++i) {
+        lut[i] = SDL_MapSurfaceRGBA(canvas, 0, 0, 0, 0xFF);
     }
-
     if (state->Gif89.transparent >= 0 && state->Gif89.transparent < cmapSize) {
-        SDL_SetSurfaceColorKey(image, true, state->Gif89.transparent);
-    }
-
-    while ((v = LWZReadByte(src, FALSE, c, state)) >= 0) {
-        ((Uint8 *)image->pixels)[xpos + ypos * image->pitch] = (Uint8)v;
-        ++xpos;
-        if (xpos == len) {
-            xpos = 0;
-            if (interlace) {
-                switch (pass) {
-                case 0:
-                case 1:
-                    ypos += 8;
-                    break;
-                case 2:
-                    ypos += 4;
-                    break;
-                case 3:
-                    ypos += 2;
-                    break;
-                }
+        transparent = state->Gif89.transparent;
+    }
 
-                if (ypos >= height) {
-                    ++pass;
-                    switch (pass) {
-                    case 1:
-                        ypos = 4;
-                        break;
-                    case 2:
-                        ypos = 2;
-                        break;
-                    case 3:
-                        ypos = 1;
-                        break;
-                    default:
-                        goto fini;
-                    }
+    /* The part of each row that lands on the canvas */
+    visible = SDL_max(SDL_min(len, canvas->w - left), 0);
+
+    while (rows < height) {
+        decoded = LWZReadRow(src, row, len, state);
+        count = SDL_min(decoded, visible);
+        if (count > 0 && top + ypos < canvas->h) {
+            dst = (Uint32 *)((Uint8 *)canvas->pixels + (top + ypos) * canvas->pitch) + left;
+            if (transparent < 0) {
+                for (x = 0; x < count; ++x) {
+                    dst[x] = lut[row[x]];
                 }
             } else {
-                ++ypos;
+                for (x = 0; x < count; ++x) {
+                    if (row[x] != transparent) {
+                        dst[x] = lut[row[x]];
+                    }
+                }
             }
         }
-        if (ypos >= height)
+        if (decoded < len) {
+            break;
+        }
+        if (!IMG_UpdateLoadProgress(++rows, height)) {
+            return false;
+        }
+        if (!NextImageRow(&ypos, &pass, height, interlace)) {
             break;
+        }
     }
 
-  fini:
+    /* Leave the stream at the end of the image data, even if there was more than we needed */
+    LWZFinish(src, state);
 
-    return image;
+    return true;
 }
 
 struct IMG_AnimationDecoderContext
@@ -513,6 +562,7 @@ struct IMG_AnimationDecoderContext
 
     SDL_Surface *canvas;         /* Canvas for compositing frames */
     SDL_Surface *prev_canvas;    /* Previous canvas for DISPOSE_PREVIOUS */
+    IMG_Scratch scratch;         /* Temporaries for decoding a frame */
 
     int frame_count;             /* Total number of frames seen */
     int current_frame;           /* Current frame index */
@@ -534,6 +584,7 @@ struct IMG_AnimationDecoderContext
     /* Frame info */
     Uint64 last_duration;        /* The duration of the previous frame */
     int last_disposal;           /* Disposal method from previous frame */
+    SDL_Rect last_rect;          /* Image rectangle of the previous frame */
     int restore_frame;           /* Frame to restore when using DISPOSE_PREVIOUS */
 
     bool ignore_props;
@@ -580,6 +631,10 @@ static bool IMG_AnimationDecoderGetGIFHeader(IMG_AnimationDecoder *decoder, char
         ctx->state.GifScreen.Background = ctx->buf[5];
         ctx->state.GifScreen.AspectRatio = ctx->buf[6];
 
+        if (!IMG_CheckImageLimits(ctx->width, ctx->height, SDL_PIXELFORMAT_RGBA32)) {
+            return false;
+        }
+
         ctx->has_global_colormap = BitSet(ctx->buf[4], LOCALCOLORMAP);
 
         if (ctx->has_global_colormap) {
@@ -832,6 +887,10 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
         int width = LM_to_uint(ctx->buf[4], ctx->buf[5]);
         int height = LM_to_uint(ctx->buf[6], ctx->buf[7]);
 
+        if (!IMG_CheckImageLimits(width, height, SDL_PIXELFORMAT_INDEX8)) {
+            return false;
+        }
+
         unsigned char localColorMap[3][MAXCOLORMAPSIZE];
         int grayScale = 0;
 
@@ -853,6 +912,7 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
             if (!SDL_FillSurfaceRect(ctx->canvas, &rect, 0)) {
                 return SDL_SetError("Failed to fill canvas with background color");
             }
+            IMG_AddDecoderDirtyRect(decoder, ctx->canvas, &rect);
         } break;
 
         case GIF_DISPOSE_RESTORE_PREVIOUS:
@@ -861,6 +921,8 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
                 if (!SDL_BlitSurface(ctx->prev_canvas, NULL, ctx->canvas, NULL)) {
                     return SDL_SetError("Failed to restore previous canvas");
                 }
+                /* The canvas was saved just before the previous frame was drawn */
+                IMG_AddDecoderDirtyRect(decoder, ctx->canvas, &ctx->last_rect);
             }
             break;
 
@@ -875,40 +937,40 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
                 return SDL_SetError("Failed to save current canvas for restoration");
             }
         }
-        Image *image;
+        /* Decode the frame straight onto the canvas */
+        Uint8 *row = (Uint8 *)IMG_AllocScratch(&ctx->scratch, SDL_max(width, 1));
+        bool composited;
+        if (!row) {
+            return false;
+        }
         if (!useGlobalColormap) {
-            image = ReadImage(src, width, height, bitPixel, localColorMap, grayScale,
-                              BitSet(ctx->buf[8], INTERLACE), 0, &ctx->state);
+            composited = CompositeImage(src, width, height, bitPixel, localColorMap,
+                                        BitSet(ctx->buf[8], INTERLACE), ctx->canvas, left, top, row, &ctx->state);
         } else {
-            image = ReadImage(src, width, height, ctx->state.GifScreen.BitPixel,
-                              ctx->state.GifScreen.ColorMap, ctx->state.GifScreen.GrayScale,
-                              BitSet(ctx->buf[8], INTERLACE), 0, &ctx->state);
+            composited = CompositeImage(src, width, height, ctx->state.GifScreen.BitPixel,
+                                        ctx->state.GifScreen.ColorMap,
+                                        BitSet(ctx->buf[8], INTERLACE), ctx->canvas, left, top, row, &ctx->state);
         }
+        IMG_ResetScratch(&ctx->scratch);
 
-      if (!image) {
+      if (!composited) {
           // Incorrect animation is harder to detect than a direct failure,
           // so it's better to fail than try to animate a GIF without a,
           // full set of frames it has in the file.
 
-          // Only set the error if ReadImage did not do it.
+          // Only set the error if CompositeImage did not do it.
           if (SDL_GetError()[0] == '\0') {
               return SDL_SetError("Failed to decode frame.");
           }
 
           return false;
       }
-
-        /* Composite the frame onto the canvas */
-        SDL_Rect dest = { left, top, width, height };
-        if (!SDL_BlitSurface(image, NULL, ctx->canvas, &dest)) {
-            SDL_DestroySurface(image);
-            return SDL_SetError("Failed to blit frame onto canvas");
-        }
+        SDL_Rect image_rect = { left, top, width, height };
+        IMG_AddDecoderDirtyRect(decoder, ctx->canvas, &image_rect);
 
         /* Store the frame in the output array */
-        retval = SDL_DuplicateSurface(ctx->canvas);
+        retval = IMG_GetDecoderCanvasFrame(decoder, ctx->canvas);
         if (!retval) {
-            SDL_DestroySurface(image);
             return SDL_SetError("Failed to duplicate frame surface");
         }
 
@@ -923,8 +985,7 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
         ctx->last_duration = *duration;
 
         ctx->last_disposal = ctx->state.Gif89.disposal;
-
-        SDL_DestroySurface(image);
+        ctx->last_rect = image_rect;
 
         ctx->state.Gif89.transparent = -1;
         ctx->state.Gif89.delayTime = -1;
@@ -959,6 +1020,7 @@ static bool IMG_AnimationDecoderClose_Internal(IMG_AnimationDecoder *decoder)
         SDL_DestroySurface(ctx->prev_canvas);
     }
 
+    IMG_FreeScratch(&ctx->scratch);
     SDL_free(ctx);
     decoder->ctx = NULL;
 
@@ -991,6 +1053,7 @@ bool IMG_CreateGIFAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Properties
     decoder->Reset = IMG_AnimationDecoderReset_Internal;
     decoder->GetNextFrame = IMG_AnimationDecoderGetNextFrame_Internal;
     decoder->Close = IMG_AnimationDecoderClose_Internal;
+    decoder->tracks_dirty_rects = true;
 
     char *comment = NULL;
     int loop_count = 0;
@@ -1052,14 +1115,15 @@ bool IMG_isGIF(SDL_IOStream *src)
     return is_GIF;
 }
 
-/* Load a GIF type image from an SDL datasource */
-SDL_Surface *IMG_LoadGIF_IO(SDL_IOStream *src)
+/* Load the first frame through the animation decoder, composited onto an RGBA canvas */
+static SDL_Surface *LoadGIFAnimationFrame(SDL_IOStream *src)
 {
     IMG_AnimationDecoder *decoder = IMG_CreateAnimationDecoder_IO(src, false, "gif");
     if (!decoder) {
         return NULL;
     }
 
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     Uint64 pts = 0;
     SDL_Surface *frame = NULL;
     IMG_GetAnimationDecoderFrame(decoder, &frame, &pts);
@@ -1068,6 +1132,211 @@ SDL_Surface *IMG_LoadGIF_IO(SDL_IOStream *src)
     return frame;
 }
 
+/* Load a GIF type image from an SDL datasource
+ *
+ * The first image is decoded straight into an INDEX8 surface the size of the
+ * logical screen, keeping its palette and transparent color. The area of the
+ * screen it doesn't cover is transparent, so the result matches the first
+ * frame of the animation. If that would need a transparent color and all 256
+ * are in use, the image is composited by the animation decoder instead.
+ */
+SDL_Surface *IMG_LoadGIF_IO(SDL_IOStream *src)
+{
+    Sint64 start;
+    IMG_Scratch scratch;
+    State_t *state;
+    SDL_Surface *image = NULL;
+    SDL_Palette *palette;
+    unsigned char buf[16];
+    unsigned char localColorMap[3][MAXCOLORMAPSIZE];
+    unsigned char (*cmap)[MAXCOLORMAPSIZE];
+    const char *error = NULL;
+    unsigned char c;
+    int screen_width, screen_height;
+    int left, top, width, height;
+    int cmapSize, grayScale, interlace;
+    int transparent, visible, decoded, i;
+    int ypos = 0, pass = 0, rows = 0;
+    bool covered, inside;
+    Uint8 *row = NULL;
+
+    if (!src) {
+        /* The error message has been set in SDL_IOFromFile */
+        return NULL;
+    }
+    start = SDL_TellIO(src);
+    SDL_zero(scratch);
+
+    state = (State_t *)IMG_CallocScratch(&scratch, 1, sizeof(*state));
+    if (!state) {
+        goto done;
+    }
+    state->Gif89.transparent = -1;
+    state->Gif89.delayTime = -1;
+    state->Gif89.inputFlag = -1;
+    state->Gif89.disposal = GIF_DISPOSE_NA;
+
+    if (!ReadOK(src, buf, 13)) {
+        error = "Error reading GIF header";
+        goto done;
+    }
+    if (SDL_memcmp(buf, "GIF87a", 6) != 0 && SDL_memcmp(buf, "GIF89a", 6) != 0) {
+        error = "Not a GIF file";
+        goto done;
+    }
+    screen_width = LM_to_uint(buf[6], buf[7]);
+    screen_height = LM_to_uint(buf[8], buf[9]);
+    state->GifScreen.BitPixel = 2 << (buf[10] & 0x07);
+    if (BitSet(buf[10], LOCALCOLORMAP)) {
+        if (ReadColorMap(src, state->GifScreen.BitPixel, state->GifScreen.ColorMap, &state->GifScreen.GrayScale)) {
+            error = "Error reading global colormap";
+            goto done;
+        }
+    }
+
+    /* Find the first image, picking up the graphic control extension on the way */
+    for (;;) {
+        if (!ReadOK(src, &c, 1) || c == ';') {
+            error = "GIF file contains no images";
+            goto done;
+        }
+        if (c == '!') {
+            if (!ReadOK(src, &c, 1)) {
+                error = "Error reading GIF extension label";
+                goto done;
+            }
+            DoExtension(src, c, state);
+            continue;
+        }
+        if (c == ',') {
+            break;
+        }
+    }
+
+    if (!ReadOK(src, buf, 9)) {
+        error = "Error reading GIF image descriptor";
+        goto done;
+    }
+    left = LM_to_uint(buf[0], buf[1]);
+    top = LM_to_uint(buf[2], buf[3]);
+    width = LM_to_uint(buf[4], buf[5]);
+    height = LM_to_uint(buf[6], buf[7]);
+    interlace = BitSet(buf[8], INTERLACE);
+    if (BitSet(buf[8], LOCALCOLORMAP)) {
+        cmapSize = 1 << ((buf[8] & 0x07) + 1);
+        if (ReadColorMap(src, cmapSize, localColorMap, &grayScale)) {
+            goto done;
+        }
+        cmap = localColorMap;
+    } else {
+        cmapSize = state->GifScreen.BitPixel;
+        cmap = state->GifScreen.ColorMap;
+    }
+
+    transparent = -1;
+    if (state->Gif89.transparent >= 0 && state->Gif89.transparent < cmapSize) {
+        transparent = state->Gif89.transparent;
+    }
+    covered = (left == 0 && top == 0 && width >= screen_width && height >= screen_height);
+    if (!covered && transparent < 0) {
+        if (cmapSize == MAXCOLORMAPSIZE) {
+            /* There's no color left to make the rest of the screen transparent */
+            SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+            IMG_FreeScratch(&scratch);
+            return LoadGIFAnimationFrame(src);
+        }
+        transparent = cmapSize;
+    }
+
+    if (!IMG_CheckImageLimits(screen_width, screen_height, SDL_PIXELFORMAT_INDEX8)) {
+        goto done;
+    }
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
+    image = ImageNewCmap(screen_width, screen_height, cmapSize);
+    if (!image) {
+        goto done;
+    }
+    palette = SDL_CreateSurfacePalette(image);
+    if (!palette) {
+        SDL_DestroySurface(image);
+        image = NULL;
+        goto done;
+    }
+    for (i = 0; i < cmapSize; i++) {
+        ImageSetCmap(image, i, cmap[CM_RED][i], cmap[CM_GREEN][i], cmap[CM_BLUE][i]);
+    }
+    if (transparent == cmapSize) {
+        ImageSetCmap(image, transparent, 0, 0, 0);
+    }
+    palette->ncolors = SDL_max(cmapSize, transparent + 1);
+    if (transparent >= 0) {
+        SDL_SetSurfaceColorKey(image, true, transparent);
+    }
+    if (!covered) {
+        SDL_FillSurfaceRect(image, NULL, transparent);
+    }
+
+    /* Decode rows in place, unless the image hangs off the edge of the screen */
+    inside = (left + width <= screen_width && top + height <= screen_height);
+    if (!inside) {
+        row = (Uint8 *)IMG_AllocScratch(&scratch, SDL_max(width, 1));
+        if (!row) {
+            SDL_DestroySurface(image);
+            image = NULL;
+            goto done;
+        }
+    }
+    visible = SDL_max(SDL_min(width, screen_width - left), 0);
+
+    if (!ReadOK(src, &c, 1)) {
+        error = "EOF / read error on image data";
+        goto done;
+    }
+    if (LWZInit(src, c, state) < 0) {
+        error = "error reading image";
+        goto done;
+    }
+
+    while (rows < height) {
+        if (inside) {
+            decoded = LWZReadRow(src, (Uint8 *)image->pixels + (top + ypos) * image->pitch + left, width, state);
+        } else {
+            decoded = LWZReadRow(src, row, width, state);
+            if (top + ypos < screen_height && visible > 0) {
+                SDL_memcpy((Uint8 *)image->pixels + (top + ypos) * image->pitch + left, row, SDL_min(decoded, visible));
+            }
+        }
+        if (decoded < width) {
+            break;
+        }
+        if (!IMG_UpdateLoadProgress(++rows, height)) {
+            SDL_DestroySurface(image);
+            image = NULL;
+            goto done;
+        }
+        if (!NextImageRow(&ypos, &pass, height, interlace)) {
+            break;
+        }
+    }
+
+    /* Leave the stream at the end of the image data, even if there was more than we needed */
+    LWZFinish(src, state);
+
+done:
+    IMG_FreeScratch(&scratch);
+    if (error) {
+        if (image) {
+            SDL_DestroySurface(image);
+            image = NULL;
+        }
+        SDL_SetError("%s", error);
+    }
+    if (!image) {
+        SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+    }
+    return image;
+}
+
 #else
 
 /* See if an image is contained in a data source */
@@ -1087,6 +1356,137 @@ SDL_Surface *IMG_LoadGIF_IO(SDL_IOStream *src)
 
 #endif /* !defined(__APPLE__) || defined(SDL_IMAGE_USE_COMMON_BACKEND) */
 
+#if defined(LOAD_GIF) && (!defined(__APPLE__) || defined(SDL_IMAGE_USE_COMMON_BACKEND))
+
+/* Skip a sequence of data sub-blocks, up to and including the block terminator */
+static bool SkipDataBlocks(SDL_IOStream *src)
+{
+    Uint8 count;
+
+    for (;;) {
+        if (!ReadOK(src, &count, 1)) {
+            return false;
+        }
+        if (count == 0) {
+            return true;
+        }
+        if (SDL_SeekIO(src, count, SDL_IO_SEEK_CUR) < 0) {
+            return false;
+        }
+    }
+}
+
+/* Get GIF image information by walking the block structure, without decoding any image data */
+bool IMG_GetGIFInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    unsigned char buf[9];
+    int depth = 8;
+    bool alpha = false;
+    int frames = 0;
+
+    if (!ReadOK(src, buf, 6)) {
+        return SDL_SetError("Error reading GIF magic number");
+    }
+    if (SDL_strncmp((char *)buf, "GIF", 3) != 0) {
+        return SDL_SetError("Not a GIF file");
+    }
+    if (!ReadOK(src, buf, 7)) {
+        return SDL_SetError("Failed to read screen descriptor");
+    }
+
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, LM_to_uint(buf[0], buf[1]));
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, LM_to_uint(buf[2], buf[3]));
+
+    if (BitSet(buf[4], LOCALCOLORMAP)) {
+        depth = (buf[4] & 0x07) + 1;
+        if (SDL_SeekIO(src, 3 * (2 << (buf[4] & 0x07)), SDL_IO_SEEK_CUR) < 0) {
+            return SDL_SetError("Error reading global colormap");
+        }
+    }
+
+    for (;;) {
+        Uint8 c;
+
+        if (!ReadOK(src, &c, 1)) {
+            /* Tolerate a missing trailer, like the decoder does */
+            break;
+        }
+        if (c == ';') {
+            /* GIF terminator */
+            break;
+        }
+
+        if (c == '!') {
+            /* Extension */
+            if (!ReadOK(src, &c, 1)) {
+                break;
+            }
+            if (c == 0xF9) {
+                /* Graphic Control Extension */
+                if (!ReadOK(src, buf, 1)) {
+                    break;
+                }
+                if (buf[0] >= 4) {
+                    if (!ReadOK(src, &buf[1], 4)) {
+                        break;
+                    }
+                    if (buf[1] & 0x1) {
+                        alpha = true;
+                    }
+                    if (SDL_SeekIO(src, buf[0] - 4, SDL_IO_SEEK_CUR) < 0) {
+                        break;
+                    }
+                } else if (SDL_SeekIO(src, buf[0], SDL_IO_SEEK_CUR) < 0) {
+                    break;
+                }
+            }
+            if (!SkipDataBlocks(src)) {
+                break;
+            }
+            continue;
+        }
+
+        if (c != ',') {
+            /* Not a valid start character */
+            continue;
+        }
+
+        /* Image descriptor */
+        if (!ReadOK(src, buf, 9)) {
+            break;
+        }
+        if (BitSet(buf[8], LOCALCOLORMAP)) {
+            if (SDL_SeekIO(src, 3 * (1 << ((buf[8] & 0x07) + 1)), SDL_IO_SEEK_CUR) < 0) {
+                break;
+            }
+        }
+        /* Skip the LZW minimum code size and the image data */
+        if (SDL_SeekIO(src, 1, SDL_IO_SEEK_CUR) < 0 || !SkipDataBlocks(src)) {
+            break;
+        }
+        ++frames;
+    }
+
+    if (frames == 0) {
+        return SDL_SetError("No images found in GIF");
+    }
+
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, SDL_PIXELFORMAT_RGBA32);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_BIT_DEPTH_NUMBER, depth);
+    SDL_SetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, alpha);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_FRAME_COUNT_NUMBER, frames);
+    return true;
+}
+
+#else
+
+bool IMG_GetGIFInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    return SDL_Unsupported();
+}
+
+#endif /* LOAD_GIF */
+
 #if SAVE_GIF
 #pragma pack(push,1)
 // GIF Header (6 bytes) + Logical Screen Descriptor (7 bytes)
@@ -1168,6 +1568,7 @@ struct IMG_AnimationEncoderContext
     bool lut_initialized;
     bool use_lut;
     SDL_PropertiesID metadata;
+    IMG_Scratch scratch;    /* temporaries for encoding a frame */
 };
 
 #define LZW_MAX_CODES 4096
@@ -1191,6 +1592,7 @@ typedef struct
 
 typedef struct
 {
+    IMG_Scratch *scratch;
     uint8_t *buffer;
     size_t currentByte;
     int currentBit;
@@ -1199,7 +1601,7 @@ typedef struct
 
 static bool BitStream_Init(BitStream *bs)
 {
-    bs->buffer = (uint8_t *)SDL_calloc(1, bs->allocatedSize);
+    bs->buffer = (uint8_t *)IMG_CallocScratch(bs->scratch, 1, bs->allocatedSize);
     if (!bs->buffer) {
         return false;
     }
@@ -1224,7 +1626,7 @@ static bool BitStream_WriteCode(BitStream *bs, int code, int numBits)
         if (newSize < requiredBytes) {
             newSize = requiredBytes + 256;
         }
-        uint8_t *newBuffer = (uint8_t *)SDL_realloc(bs->buffer, newSize);
+        uint8_t *newBuffer = (uint8_t *)IMG_ReallocScratch(bs->scratch, bs->buffer, bs->allocatedSize, newSize);
         if (!newBuffer) {
             SDL_SetError("Failed to reallocate BitStream buffer.");
             return false;
@@ -1259,15 +1661,8 @@ static size_t BitStream_Flush(BitStream *bs)
     return bs->currentByte;
 }
 
-static void BitStream_Free(BitStream *bs)
-{
-    if (bs->buffer) {
-        SDL_free(bs->buffer);
-        bs->buffer = NULL;
-    }
-}
-
-static int lzwCompress(const uint8_t *indexedPixels, uint16_t width, uint16_t height,
+/* The dictionary, hash table and output all come from `scratch` */
+static int lzwCompress(IMG_Scratch *scratch, const uint8_t *indexedPixels, uint16_t width, uint16_t height,
                        uint8_t minCodeSize, uint8_t **compressedData, size_t *compressedSize,
                        int quality)
 {
@@ -1289,17 +1684,6 @@ static int lzwCompress(const uint8_t *indexedPixels, uint16_t width, uint16_t he
     const int qualityThreshold = (quality < 50) ? 3072 : (quality < 75) ? 3584
                                                                         : 4096;
 
-    BitStream bs;
-    bs.allocatedSize = width * height;
-    if (bs.allocatedSize < 4096) {
-        bs.allocatedSize = 4096;
-    }
-
-    if (!BitStream_Init(&bs)) {
-        SDL_SetError("Failed to allocate bitstream buffer");
-        return -1;
-    }
-
     typedef struct
     {
         int prefix;
@@ -1307,21 +1691,32 @@ static int lzwCompress(const uint8_t *indexedPixels, uint16_t width, uint16_t he
         int next_in_chain;
     } DictEntry;
 
-    DictEntry *dict = (DictEntry *)SDL_calloc(LZW_MAX_CODES, sizeof(DictEntry));
+    // Entries are always written before they're reached through the hash table
+    DictEntry *dict = (DictEntry *)IMG_AllocScratch(scratch, LZW_MAX_CODES * sizeof(DictEntry));
     if (!dict) {
-        BitStream_Free(&bs);
         SDL_SetError("Failed to allocate LZW dictionary");
         return -1;
     }
 
-    int *hashTable = (int *)SDL_calloc(HASH_TABLE_SIZE, sizeof(int));
+    int *hashTable = (int *)IMG_AllocScratch(scratch, HASH_TABLE_SIZE * sizeof(int));
     if (!hashTable) {
-        SDL_free(dict);
-        BitStream_Free(&bs);
         SDL_SetError("Failed to allocate hash table");
         return -1;
     }
 
+    // Allocated last, so it can grow in place
+    BitStream bs;
+    bs.scratch = scratch;
+    bs.allocatedSize = width * height;
+    if (bs.allocatedSize < 4096) {
+        bs.allocatedSize = 4096;
+    }
+
+    if (!BitStream_Init(&bs)) {
+        SDL_SetError("Failed to allocate bitstream buffer");
+        return -1;
+    }
+
     const int clearCode = 1 << minCodeSize;
     const int eoiCode = clearCode + 1;
     int nextCode;
@@ -1338,9 +1733,6 @@ static int lzwCompress(const uint8_t *indexedPixels, uint16_t width, uint16_t he
     curCodeSize = minCodeSize + 1;
 
     if (!BitStream_WriteCode(&bs, clearCode, curCodeSize)) {
-        SDL_free(dict);
-        SDL_free(hashTable);
-        BitStream_Free(&bs);
         return -1;
     }
 
@@ -1364,9 +1756,6 @@ static int lzwCompress(const uint8_t *indexedPixels, uint16_t width, uint16_t he
 
             if (!found) {
                 if (!BitStream_WriteCode(&bs, curString, curCodeSize)) {
-                    SDL_free(dict);
-                    SDL_free(hashTable);
-                    BitStream_Free(&bs);
                     return -1;
                 }
 
@@ -1383,9 +1772,6 @@ static int lzwCompress(const uint8_t *indexedPixels, uint16_t width, uint16_t he
                 } else {
                     // Dictionary reset is controlled by quality threshold
                     if (!BitStream_WriteCode(&bs, clearCode, curCodeSize)) {
-                        SDL_free(dict);
-                        SDL_free(hashTable);
-                        BitStream_Free(&bs);
                         return -1;
                     }
                     curCodeSize = minCodeSize + 1;
@@ -1396,26 +1782,16 @@ static int lzwCompress(const uint8_t *indexedPixels, uint16_t width, uint16_t he
             }
         }
         if (!BitStream_WriteCode(&bs, curString, curCodeSize)) {
-            SDL_free(dict);
-            SDL_free(hashTable);
-            BitStream_Free(&bs);
             return -1;
         }
     }
 
     if (!BitStream_WriteCode(&bs, eoiCode, curCodeSize)) {
-        SDL_free(dict);
-        SDL_free(hashTable);
-        BitStream_Free(&bs);
         return -1;
     }
 
     *compressedData = bs.buffer;
     *compressedSize = BitStream_Flush(&bs);
-
-    SDL_free(dict);
-    SDL_free(hashTable);
-
     return 0;
 
 #undef HASH_FUNC
@@ -2611,7 +2987,7 @@ static bool AnimationEncoder_AddFrame(IMG_AnimationEncoder *encoder, SDL_Surface
         SDL_SetError("Surface dimensions too large for GIF encoding");
         return false;
     }
-    indexedPixels = (uint8_t *)SDL_malloc(pixel_buffer_size);
+    indexedPixels = (uint8_t *)IMG_AllocScratch(&ctx->scratch, pixel_buffer_size);
     if (!indexedPixels) {
         SDL_SetError("Failed to allocate indexed pixel buffer.");
         goto error;
@@ -2708,7 +3084,7 @@ static bool AnimationEncoder_AddFrame(IMG_AnimationEncoder *encoder, SDL_Surface
     size_t compressedSize = 0;
     uint8_t lzwMinCodeSize = SDL_max(2, palette_bits_per_pixel);
 
-    if (lzwCompress(indexedPixels, surface->w, surface->h, lzwMinCodeSize,
+    if (lzwCompress(&ctx->scratch, indexedPixels, surface->w, surface->h, lzwMinCodeSize,
                     &compressedData, &compressedSize, encoder->quality) != 0) {
         goto error;
     }
@@ -2717,8 +3093,7 @@ static bool AnimationEncoder_AddFrame(IMG_AnimationEncoder *encoder, SDL_Surface
         goto error;
     }
 
-    SDL_free(indexedPixels);
-    SDL_free(compressedData);
+    IMG_ResetScratch(&ctx->scratch);
 
     if (ctx->firstFrame) {
         ctx->firstFrame = false;
@@ -2727,8 +3102,7 @@ static bool AnimationEncoder_AddFrame(IMG_AnimationEncoder *encoder, SDL_Surface
     return true;
 
 error:
-    SDL_free(indexedPixels);
-    SDL_free(compressedData);
+    IMG_ResetScratch(&ctx->scratch);
     return false;
 }
 
@@ -2753,6 +3127,7 @@ static bool AnimationEncoder_End(IMG_AnimationEncoder *encoder)
         success = false;
     }
 
+    IMG_FreeScratch(&ctx->scratch);
     SDL_free(ctx);
     encoder->ctx = NULL;
 
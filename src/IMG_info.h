@@ -0,0 +1,36 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Header-only image information, see IMG_GetImageInfoTyped_IO().
+ *
+ * Each function parses the image header at the current position of `src`
+ * and sets the IMG_PROP_INFO_* properties on `props`, without decoding any
+ * pixel data. The caller takes care of restoring the stream position. If a
+ * function fails, the caller falls back to decoding the whole image.
+ */
+
+extern bool IMG_GetAVIFInfo_IO(SDL_IOStream *src, SDL_PropertiesID props);
+extern bool IMG_GetGIFInfo_IO(SDL_IOStream *src, SDL_PropertiesID props);
+extern bool IMG_GetJPGInfo_IO(SDL_IOStream *src, SDL_PropertiesID props);
+extern bool IMG_GetPNGInfo_IO(SDL_IOStream *src, SDL_PropertiesID props);
+extern bool IMG_GetQOIInfo_IO(SDL_IOStream *src, SDL_PropertiesID props);
+extern bool IMG_GetTGAInfo_IO(SDL_IOStream *src, SDL_PropertiesID props);
+extern bool IMG_GetWEBPInfo_IO(SDL_IOStream *src, SDL_PropertiesID props);
@@ -0,0 +1,365 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Memory mapped files and in place access to memory streams */
+
+#include <SDL3_image/SDL_image.h>
+#include "IMG_io.h"
+#include "IMG_stats.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define HAVE_WIN32_MMAP
+#elif (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#define HAVE_POSIX_MMAP
+#endif
+
+/* Files smaller than this are cheaper to read than to map */
+#define MMAP_THRESHOLD  (64 * 1024)
+
+typedef struct IMG_MappedFile
+{
+    const Uint8 *data;
+    Sint64 size;
+    Sint64 pos;
+} IMG_MappedFile;
+
+/* Map a regular file of at least `min_size` bytes, with private copy-on-write pages if `writable` */
+static void *MapFile(const char *file, Sint64 min_size, bool writable, Sint64 *size)
+{
+#if defined(HAVE_WIN32_MMAP)
+    WCHAR *wfile;
+    HANDLE handle;
+    HANDLE mapping;
+    LARGE_INTEGER filesize;
+    void *data = NULL;
+
+    wfile = (WCHAR *)SDL_iconv_string("UTF-16LE", "UTF-8", file, SDL_strlen(file) + 1);
+    if (!wfile) {
+        return NULL;
+    }
+    handle = CreateFileW(wfile, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    SDL_free(wfile);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    if (GetFileType(handle) == FILE_TYPE_DISK &&
+        GetFileSizeEx(handle, &filesize) && filesize.QuadPart > 0 && filesize.QuadPart >= min_size &&
+        (Uint64)filesize.QuadPart <= SDL_SIZE_MAX) {
+        mapping = CreateFileMappingW(handle, NULL, writable ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            data = MapViewOfFile(mapping, writable ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            *size = filesize.QuadPart;
+        }
+    }
+    CloseHandle(handle);
+    return data;
+
+#elif defined(HAVE_POSIX_MMAP)
+    struct stat st;
+    void *data = NULL;
+    int fd;
+
+#if defined(__APPLE__) || defined(__ANDROID__)
+    /* Relative paths may refer to the app bundle or assets, let SDL_IOFromFile() find those */
+    if (*file != '/') {
+        return NULL;
+    }
+#endif
+
+    fd = open(file, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+        st.st_size > 0 && st.st_size >= min_size && (Uint64)st.st_size <= SDL_SIZE_MAX) {
+        data = mmap(NULL, (size_t)st.st_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            data = NULL;
+        } else {
+            *size = st.st_size;
+        }
+    }
+    close(fd);
+    return data;
+
+#else
+    (void)file;
+    (void)min_size;
+    (void)writable;
+    (void)size;
+    return NULL;
+#endif
+}
+
+static void UnmapFile(const void *data, Sint64 size)
+{
+#if defined(HAVE_WIN32_MMAP)
+    (void)size;
+    UnmapViewOfFile(data);
+#elif defined(HAVE_POSIX_MMAP)
+    munmap((void *)data, (size_t)size);
+#else
+    (void)data;
+    (void)size;
+#endif
+}
+
+static Sint64 SDLCALL MappedFileSize(void *userdata)
+{
+    IMG_MappedFile *map = (IMG_MappedFile *)userdata;
+
+    return map->size;
+}
+
+static Sint64 SDLCALL MappedFileSeek(void *userdata, Sint64 offset, SDL_IOWhence whence)
+{
+    IMG_MappedFile *map = (IMG_MappedFile *)userdata;
+    Sint64 pos;
+
+    switch (whence) {
+    case SDL_IO_SEEK_SET:
+        pos = offset;
+        break;
+    case SDL_IO_SEEK_CUR:
+        pos = map->pos + offset;
+        break;
+    case SDL_IO_SEEK_END:
+        pos = map->size + offset;
+        break;
+    default:
+        SDL_SetError("Unknown value for 'whence'");
+        return -1;
+    }
+    if (pos < 0) {
+        SDL_SetError("Seek before the start of the file");
+        return -1;
+    }
+    map->pos = SDL_min(pos, map->size);
+    return map->pos;
+}
+
+static size_t SDLCALL MappedFileRead(void *userdata, void *ptr, size_t size, SDL_IOStatus *status)
+{
+    IMG_MappedFile *map = (IMG_MappedFile *)userdata;
+    size_t left = (size_t)(map->size - map->pos);
+
+    if (size > left) {
+        size = left;
+    }
+    if (size == 0) {
+        *status = SDL_IO_STATUS_EOF;
+        return 0;
+    }
+    SDL_memcpy(ptr, map->data + map->pos, size);
+    map->pos += size;
+    return size;
+}
+
+static bool SDLCALL MappedFileClose(void *userdata)
+{
+    IMG_MappedFile *map = (IMG_MappedFile *)userdata;
+
+    UnmapFile(map->data, map->size);
+    SDL_free(map);
+    return true;
+}
+
+SDL_IOStream *IMG_OpenFile(const char *file)
+{
+    SDL_IOStreamInterface iface;
+    IMG_MappedFile *map;
+    SDL_IOStream *src;
+    SDL_PropertiesID props;
+    const Uint8 *data;
+    Sint64 size = 0;
+
+    if (!file || !*file || !SDL_GetHintBoolean(IMG_HINT_MAP_FILES, false)) {
+        return SDL_IOFromFile(file, "rb");
+    }
+
+    data = (const Uint8 *)MapFile(file, MMAP_THRESHOLD, false, &size);
+    if (!data) {
+        return SDL_IOFromFile(file, "rb");
+    }
+
+    map = (IMG_MappedFile *)SDL_calloc(1, sizeof(*map));
+    if (!map) {
+        UnmapFile(data, size);
+        return NULL;
+    }
+    map->data = data;
+    map->size = size;
+
+    SDL_INIT_INTERFACE(&iface);
+    iface.size = MappedFileSize;
+    iface.seek = MappedFileSeek;
+    iface.read = MappedFileRead;
+    iface.close = MappedFileClose;
+
+    src = SDL_OpenIO(&iface, map);
+    if (!src) {
+        MappedFileClose(map);
+        return NULL;
+    }
+
+    /* Let decoders use the mapping the same way as a memory stream */
+    props = SDL_GetIOProperties(src);
+    SDL_SetPointerProperty(props, SDL_PROP_IOSTREAM_MEMORY_POINTER, (void *)data);
+    SDL_SetNumberProperty(props, SDL_PROP_IOSTREAM_MEMORY_SIZE_NUMBER, size);
+    return src;
+}
+
+void *IMG_MapFile(const char *file, size_t *size)
+{
+    Sint64 mapsize = 0;
+    void *data;
+
+    data = MapFile(file, 0, true, &mapsize);
+    if (data) {
+        *size = (size_t)mapsize;
+    }
+    return data;
+}
+
+void IMG_UnmapFile(void *data, size_t size)
+{
+    UnmapFile(data, (Sint64)size);
+}
+
+bool IMG_TouchFile(const char *file)
+{
+#if defined(HAVE_WIN32_MMAP)
+    WCHAR *wfile;
+    HANDLE handle;
+    FILETIME now;
+    BOOL result;
+
+    wfile = (WCHAR *)SDL_iconv_string("UTF-16LE", "UTF-8", file, SDL_strlen(file) + 1);
+    if (!wfile) {
+        return false;
+    }
+    handle = CreateFileW(wfile, FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    SDL_free(wfile);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    GetSystemTimeAsFileTime(&now);
+    result = SetFileTime(handle, NULL, NULL, &now);
+    CloseHandle(handle);
+    return result != 0;
+
+#elif defined(HAVE_POSIX_MMAP)
+    return utime(file, NULL) == 0;
+
+#else
+    (void)file;
+    return false;
+#endif
+}
+
+const Uint8 *IMG_GetIOMemory(SDL_IOStream *src, size_t *size)
+{
+    SDL_PropertiesID props = SDL_GetIOProperties(src);
+    const Uint8 *mem;
+
+    if (!props) {
+        return NULL;
+    }
+    mem = (const Uint8 *)SDL_GetPointerProperty(props, SDL_PROP_IOSTREAM_MEMORY_POINTER, NULL);
+    if (mem) {
+        *size = (size_t)SDL_GetNumberProperty(props, SDL_PROP_IOSTREAM_MEMORY_SIZE_NUMBER, 0);
+    }
+    return mem;
+}
+
+const Uint8 *IMG_PeekIOMemory(SDL_IOStream *src, size_t *left)
+{
+    const Uint8 *mem;
+    size_t memsize = 0;
+    Sint64 offset;
+
+    mem = IMG_GetIOMemory(src, &memsize);
+    if (!mem) {
+        return NULL;
+    }
+    offset = SDL_TellIO(src);
+    if (offset < 0 || (Uint64)offset > memsize) {
+        return NULL;
+    }
+    *left = memsize - (size_t)offset;
+    return mem + offset;
+}
+
+const Uint8 *IMG_ReadIOData(SDL_IOStream *src, size_t size, void **allocated)
+{
+    const Uint8 *mem;
+    size_t left = 0;
+
+    *allocated = NULL;
+
+    mem = IMG_PeekIOMemory(src, &left);
+    if (mem && size <= left && SDL_SeekIO(src, (Sint64)size, SDL_IO_SEEK_CUR) >= 0) {
+        IMG_CountLoadBytesRead(size);
+        return mem;
+    }
+
+    *allocated = SDL_malloc(size ? size : 1);
+    if (!*allocated) {
+        return NULL;
+    }
+    IMG_CountLoadAllocation(size);
+    if (SDL_ReadIO(src, *allocated, size) != size) {
+        SDL_free(*allocated);
+        *allocated = NULL;
+        return NULL;
+    }
+    return (const Uint8 *)*allocated;
+}
+
+const Uint8 *IMG_LoadIOData(SDL_IOStream *src, size_t *datasize, void **allocated)
+{
+    const Uint8 *mem;
+    size_t left = 0;
+
+    *allocated = NULL;
+
+    mem = IMG_PeekIOMemory(src, &left);
+    if (mem && SDL_SeekIO(src, 0, SDL_IO_SEEK_END) >= 0) {
+        *datasize = left;
+        IMG_CountLoadBytesRead(left);
+        return mem;
+    }
+
+    *allocated = SDL_LoadFile_IO(src, datasize, false);
+    if (*allocated) {
+        IMG_CountLoadAllocation(*datasize);
+    }
+    return (const Uint8 *)*allocated;
+}
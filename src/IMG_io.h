@@ -0,0 +1,71 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Stream helpers that let decoders work on image data in place.
+ *
+ * Memory streams, and the read-only file mappings created by IMG_OpenFile(),
+ * have the SDL_PROP_IOSTREAM_MEMORY_POINTER and
+ * SDL_PROP_IOSTREAM_MEMORY_SIZE_NUMBER properties set. Decoders that need
+ * the whole image in memory can use that memory directly instead of
+ * copying it to the heap.
+ */
+
+/* Open a file for reading, mapping large regular files into memory if
+ * IMG_HINT_MAP_FILES is enabled
+ */
+extern SDL_IOStream *IMG_OpenFile(const char *file);
+
+/* Map a whole file into memory with private copy-on-write pages, so it may
+ * be modified like any heap memory. Returns NULL if the file can't be mapped,
+ * in which case it may still be readable with SDL_IOFromFile().
+ *
+ * If the file is truncated while it's mapped, touching the pages past the new
+ * end raises SIGBUS (or an access violation on Windows) instead of a read
+ * error. Only map files that are replaced by renaming a new file over them and
+ * never rewritten in place, like the disk cache entries.
+ */
+extern void *IMG_MapFile(const char *file, size_t *size);
+
+/* Unmap a file mapped with IMG_MapFile() */
+extern void IMG_UnmapFile(void *data, size_t size);
+
+/* Set the modification time of a file to now, returns false if it can't be changed */
+extern bool IMG_TouchFile(const char *file);
+
+/* Get the memory behind a memory stream, or NULL if `src` isn't one */
+extern const Uint8 *IMG_GetIOMemory(SDL_IOStream *src, size_t *size);
+
+/* Get the memory at the current position of a memory stream and the number
+ * of bytes left, or NULL if `src` isn't a memory stream.
+ */
+extern const Uint8 *IMG_PeekIOMemory(SDL_IOStream *src, size_t *left);
+
+/* Read `size` bytes from a stream, in place if it's a memory stream.
+ * `*allocated` is set to the buffer the caller should free with SDL_free(),
+ * or NULL if the data wasn't copied.
+ */
+extern const Uint8 *IMG_ReadIOData(SDL_IOStream *src, size_t size, void **allocated);
+
+/* Read the rest of a stream, like SDL_LoadFile_IO(), in place if it's a memory stream.
+ * `*allocated` is set to the buffer the caller should free with SDL_free(),
+ * or NULL if the data wasn't copied.
+ */
+extern const Uint8 *IMG_LoadIOData(SDL_IOStream *src, size_t *datasize, void **allocated);
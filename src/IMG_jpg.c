@@ -23,6 +23,12 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_info.h"
+#include "IMG_io.h"
+#include "IMG_load_options.h"
+#include "IMG_progress.h"
+#include "IMG_stats.h"
+
 #include <stdio.h>
 #include <setjmp.h>
 
@@ -65,7 +71,7 @@
 #define FAST_IS_JPEG
 
 static struct {
-    int loaded;
+    SDL_InitState init;
     void *handle;
     void (*jpeg_calc_output_dimensions) (j_decompress_ptr cinfo);
     void (*jpeg_CreateDecompress) (j_decompress_ptr cinfo, int version, size_t structsize);
@@ -83,6 +89,10 @@ static struct {
     void (*jpeg_finish_compress) (j_compress_ptr cinfo);
     void (*jpeg_destroy_compress) (j_compress_ptr cinfo);
     struct jpeg_error_mgr * (*jpeg_std_error) (struct jpeg_error_mgr * err);
+#ifdef LIBJPEG_TURBO_VERSION
+    void (*jpeg_crop_scanline) (j_decompress_ptr cinfo, JDIMENSION *xoffset, JDIMENSION *width);
+    JDIMENSION (*jpeg_skip_scanlines) (j_decompress_ptr cinfo, JDIMENSION num_lines);
+#endif
 } lib;
 
 #ifdef LOAD_JPG_DYNAMIC
@@ -94,49 +104,57 @@ static struct {
     lib.FUNC = FUNC;
 #endif
 
-static bool IMG_InitJPG(void)
+static bool LoadJPGLibrary(void)
 {
-    if ( lib.loaded == 0 ) {
 #ifdef LOAD_JPG_DYNAMIC
-        lib.handle = SDL_LoadObject(LOAD_JPG_DYNAMIC);
-        if ( lib.handle == NULL ) {
-            return false;
-        }
+    lib.handle = SDL_LoadObject(LOAD_JPG_DYNAMIC);
+    if ( lib.handle == NULL ) {
+        return false;
+    }
+#endif
+    FUNCTION_LOADER(jpeg_calc_output_dimensions, void (*) (j_decompress_ptr cinfo))
+    FUNCTION_LOADER(jpeg_CreateDecompress, void (*) (j_decompress_ptr cinfo, int version, size_t structsize))
+    FUNCTION_LOADER(jpeg_destroy_decompress, void (*) (j_decompress_ptr cinfo))
+    FUNCTION_LOADER(jpeg_finish_decompress, boolean (*) (j_decompress_ptr cinfo))
+    FUNCTION_LOADER(jpeg_read_header, int (*) (j_decompress_ptr cinfo, boolean require_image))
+    FUNCTION_LOADER(jpeg_read_scanlines, JDIMENSION (*) (j_decompress_ptr cinfo, JSAMPARRAY scanlines, JDIMENSION max_lines))
+    FUNCTION_LOADER(jpeg_resync_to_restart, boolean (*) (j_decompress_ptr cinfo, int desired))
+    FUNCTION_LOADER(jpeg_start_decompress, boolean (*) (j_decompress_ptr cinfo))
+    FUNCTION_LOADER(jpeg_CreateCompress, void (*) (j_compress_ptr cinfo, int version, size_t structsize))
+    FUNCTION_LOADER(jpeg_start_compress, void (*) (j_compress_ptr cinfo, boolean write_all_tables))
+    FUNCTION_LOADER(jpeg_set_quality, void (*) (j_compress_ptr cinfo, int quality, boolean force_baseline))
+    FUNCTION_LOADER(jpeg_set_defaults, void (*) (j_compress_ptr cinfo))
+    FUNCTION_LOADER(jpeg_write_scanlines, JDIMENSION (*) (j_compress_ptr cinfo, JSAMPARRAY scanlines, JDIMENSION num_lines))
+    FUNCTION_LOADER(jpeg_finish_compress, void (*) (j_compress_ptr cinfo))
+    FUNCTION_LOADER(jpeg_destroy_compress, void (*) (j_compress_ptr cinfo))
+    FUNCTION_LOADER(jpeg_std_error, struct jpeg_error_mgr * (*) (struct jpeg_error_mgr * err))
+#ifdef LIBJPEG_TURBO_VERSION
+    FUNCTION_LOADER(jpeg_crop_scanline, void (*) (j_decompress_ptr cinfo, JDIMENSION *xoffset, JDIMENSION *width))
+    FUNCTION_LOADER(jpeg_skip_scanlines, JDIMENSION (*) (j_decompress_ptr cinfo, JDIMENSION num_lines))
 #endif
-        FUNCTION_LOADER(jpeg_calc_output_dimensions, void (*) (j_decompress_ptr cinfo))
-        FUNCTION_LOADER(jpeg_CreateDecompress, void (*) (j_decompress_ptr cinfo, int version, size_t structsize))
-        FUNCTION_LOADER(jpeg_destroy_decompress, void (*) (j_decompress_ptr cinfo))
-        FUNCTION_LOADER(jpeg_finish_decompress, boolean (*) (j_decompress_ptr cinfo))
-        FUNCTION_LOADER(jpeg_read_header, int (*) (j_decompress_ptr cinfo, boolean require_image))
-        FUNCTION_LOADER(jpeg_read_scanlines, JDIMENSION (*) (j_decompress_ptr cinfo, JSAMPARRAY scanlines, JDIMENSION max_lines))
-        FUNCTION_LOADER(jpeg_resync_to_restart, boolean (*) (j_decompress_ptr cinfo, int desired))
-        FUNCTION_LOADER(jpeg_start_decompress, boolean (*) (j_decompress_ptr cinfo))
-        FUNCTION_LOADER(jpeg_CreateCompress, void (*) (j_compress_ptr cinfo, int version, size_t structsize))
-        FUNCTION_LOADER(jpeg_start_compress, void (*) (j_compress_ptr cinfo, boolean write_all_tables))
-        FUNCTION_LOADER(jpeg_set_quality, void (*) (j_compress_ptr cinfo, int quality, boolean force_baseline))
-        FUNCTION_LOADER(jpeg_set_defaults, void (*) (j_compress_ptr cinfo))
-        FUNCTION_LOADER(jpeg_write_scanlines, JDIMENSION (*) (j_compress_ptr cinfo, JSAMPARRAY scanlines, JDIMENSION num_lines))
-        FUNCTION_LOADER(jpeg_finish_compress, void (*) (j_compress_ptr cinfo))
-        FUNCTION_LOADER(jpeg_destroy_compress, void (*) (j_compress_ptr cinfo))
-        FUNCTION_LOADER(jpeg_std_error, struct jpeg_error_mgr * (*) (struct jpeg_error_mgr * err))
-    }
-    ++lib.loaded;
 
     return true;
 }
 
+static bool IMG_InitJPG(void)
+{
+    if (SDL_ShouldInit(&lib.init)) {
+        bool initialized = LoadJPGLibrary();
+        SDL_SetInitialized(&lib.init, initialized);
+        return initialized;
+    }
+    return true;
+}
+
 #if 0
 void IMG_QuitJPG(void)
 {
-    if ( lib.loaded == 0 ) {
-        return;
-    }
-    if ( lib.loaded == 1 ) {
+    if (SDL_ShouldQuit(&lib.init)) {
 #ifdef LOAD_JPG_DYNAMIC
         SDL_UnloadObject(lib.handle);
 #endif
+        SDL_SetInitialized(&lib.init, false);
     }
-    --lib.loaded;
 }
 #endif // 0
 
@@ -214,6 +232,7 @@ typedef struct {
     struct jpeg_source_mgr pub;
 
     SDL_IOStream *ctx;
+    bool in_memory;     /* the whole image was handed to libjpeg in place */
     Uint8 buffer[INPUT_BUFFER_SIZE];
 } my_source_mgr;
 
@@ -233,9 +252,11 @@ static void init_source (j_decompress_ptr cinfo)
 static boolean fill_input_buffer (j_decompress_ptr cinfo)
 {
     my_source_mgr * src = (my_source_mgr *) cinfo->src;
-    size_t nbytes;
+    size_t nbytes = 0;
 
-    nbytes = SDL_ReadIO(src->ctx, src->buffer, INPUT_BUFFER_SIZE);
+    if (!src->in_memory) {
+        nbytes = SDL_ReadIO(src->ctx, src->buffer, INPUT_BUFFER_SIZE);
+    }
     if (nbytes == 0) {
         /* Insert a fake EOI marker */
         src->buffer[0] = (Uint8) 0xFF;
@@ -299,6 +320,8 @@ static void term_source (j_decompress_ptr cinfo)
 static void jpeg_SDL_IO_src (j_decompress_ptr cinfo, SDL_IOStream *ctx)
 {
   my_source_mgr *src;
+  const Uint8 *data;
+  size_t datasize = 0;
 
   /* The source object and input buffer are made permanent so that a series
    * of JPEG images can be read from the same file by calling jpeg_stdio_src
@@ -321,8 +344,17 @@ static void jpeg_SDL_IO_src (j_decompress_ptr cinfo, SDL_IOStream *ctx)
   src->pub.resync_to_restart = lib.jpeg_resync_to_restart; /* use default method */
   src->pub.term_source = term_source;
   src->ctx = ctx;
+  src->in_memory = false;
   src->pub.bytes_in_buffer = 0; /* forces fill_input_buffer on first read */
   src->pub.next_input_byte = NULL; /* until buffer loaded */
+
+  /* Memory streams are decoded in place, like jpeg_mem_src() */
+  data = IMG_PeekIOMemory(ctx, &datasize);
+  if (data && datasize > 0 && SDL_SeekIO(ctx, 0, SDL_IO_SEEK_END) >= 0) {
+    src->in_memory = true;
+    src->pub.bytes_in_buffer = datasize;
+    src->pub.next_input_byte = data;
+  }
 }
 
 struct my_error_mgr {
@@ -343,15 +375,88 @@ static void output_no_message(j_common_ptr cinfo)
 
 struct loadjpeg_vars {
     const char *error;
+    IMG_LoadOptions *options;
     SDL_Surface *surface;
+    Uint8 *row;
     struct jpeg_decompress_struct cinfo;
     struct my_error_mgr jerr;
 };
 
+/* Get the libjpeg output color space that produces a pixel format directly */
+static bool GetJPGColorSpace(SDL_PixelFormat format, J_COLOR_SPACE *colorspace)
+{
+    switch (format) {
+    case SDL_PIXELFORMAT_RGB24:
+        *colorspace = JCS_RGB;
+        return true;
+#ifdef JCS_EXTENSIONS
+    /* libjpeg-turbo can also output these, with the X or alpha byte set to 0xFF */
+    case SDL_PIXELFORMAT_BGR24:
+        *colorspace = JCS_EXT_BGR;
+        return true;
+    case SDL_PIXELFORMAT_RGBX32:
+        *colorspace = JCS_EXT_RGBX;
+        return true;
+    case SDL_PIXELFORMAT_BGRX32:
+        *colorspace = JCS_EXT_BGRX;
+        return true;
+    case SDL_PIXELFORMAT_XRGB32:
+        *colorspace = JCS_EXT_XRGB;
+        return true;
+    case SDL_PIXELFORMAT_XBGR32:
+        *colorspace = JCS_EXT_XBGR;
+        return true;
+#endif
+#ifdef JCS_ALPHA_EXTENSIONS
+    case SDL_PIXELFORMAT_RGBA32:
+        *colorspace = JCS_EXT_RGBA;
+        return true;
+    case SDL_PIXELFORMAT_BGRA32:
+        *colorspace = JCS_EXT_BGRA;
+        return true;
+    case SDL_PIXELFORMAT_ARGB32:
+        *colorspace = JCS_EXT_ARGB;
+        return true;
+    case SDL_PIXELFORMAT_ABGR32:
+        *colorspace = JCS_EXT_ABGR;
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
 /* Load a JPEG type image from an SDL datasource */
+/* Let libjpeg reduce the image in the DCT domain, as far as the load options allow */
+static void SetJPGScale(struct loadjpeg_vars *vars)
+{
+    IMG_LoadOptions *options = vars->options;
+    int width, height;
+    unsigned int denom;
+
+    if (!options || !IMG_GetLoadSize(options, (int)vars->cinfo.image_width, (int)vars->cinfo.image_height, &width, &height)) {
+        return;
+    }
+
+    /* Use the largest scale that isn't smaller than requested, the caller reduces the rest */
+    for (denom = 8; denom > 1; denom /= 2) {
+        if ((int)((vars->cinfo.image_width + denom - 1) / denom) >= width &&
+            (int)((vars->cinfo.image_height + denom - 1) / denom) >= height) {
+            break;
+        }
+    }
+    vars->cinfo.scale_num = 1;
+    vars->cinfo.scale_denom = denom;
+    options->scale_denom = 1;
+    options->scaled_width = width;
+    options->scaled_height = height;
+}
+
 static bool LIBJPEG_LoadJPG_IO(SDL_IOStream *src, struct loadjpeg_vars *vars)
 {
     JSAMPROW rowptr[1];
+    SDL_PixelFormat format = SDL_PIXELFORMAT_RGB24;
+    SDL_Rect region;
 
     /* Create a decompression structure and load the JPEG header */
     vars->cinfo.err = lib.jpeg_std_error(&vars->jerr.errmgr);
@@ -372,13 +477,14 @@ static bool LIBJPEG_LoadJPG_IO(SDL_IOStream *src, struct loadjpeg_vars *vars)
         /* Set 32-bit Raw output */
         vars->cinfo.out_color_space = JCS_CMYK;
         vars->cinfo.quantize_colors = FALSE;
-        lib.jpeg_calc_output_dimensions(&vars->cinfo);
-
-        /* Allocate an output surface to hold the image */
-        vars->surface = SDL_CreateSurface(vars->cinfo.output_width, vars->cinfo.output_height, SDL_PIXELFORMAT_BGRA32);
+        format = SDL_PIXELFORMAT_BGRA32;
     } else {
-        /* Set 24-bit RGB output */
-        vars->cinfo.out_color_space = JCS_RGB;
+        /* Set the requested output format if possible, otherwise 24-bit RGB */
+        if (vars->options && GetJPGColorSpace(vars->options->format, &vars->cinfo.out_color_space)) {
+            format = vars->options->format;
+        } else {
+            vars->cinfo.out_color_space = JCS_RGB;
+        }
         vars->cinfo.quantize_colors = FALSE;
 #ifdef FAST_JPEG
         vars->cinfo.scale_num   = 1;
@@ -386,12 +492,28 @@ static bool LIBJPEG_LoadJPG_IO(SDL_IOStream *src, struct loadjpeg_vars *vars)
         vars->cinfo.dct_method = JDCT_FASTEST;
         vars->cinfo.do_fancy_upsampling = FALSE;
 #endif
-        lib.jpeg_calc_output_dimensions(&vars->cinfo);
-
-        /* Allocate an output surface to hold the image */
-        vars->surface = SDL_CreateSurface(vars->cinfo.output_width, vars->cinfo.output_height, SDL_PIXELFORMAT_RGB24);
     }
+    SetJPGScale(vars);
+    lib.jpeg_calc_output_dimensions(&vars->cinfo);
+
+    region.x = 0;
+    region.y = 0;
+    region.w = (int)vars->cinfo.output_width;
+    region.h = (int)vars->cinfo.output_height;
+#ifdef LIBJPEG_TURBO_VERSION
+    /* libjpeg-turbo can skip the rows and columns outside the region */
+    if (vars->options && vars->options->region) {
+        if (!IMG_GetLoadRegion(vars->options, region.w, region.h, &region)) {
+            lib.jpeg_destroy_decompress(&vars->cinfo);
+            return false;
+        }
+        vars->options->region = NULL;
+    }
+#endif
 
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
+    /* Allocate an output surface to hold the image */
+    vars->surface = IMG_CreateLoadSurface(region.w, region.h, format, vars->options);
     if (!vars->surface) {
         lib.jpeg_destroy_decompress(&vars->cinfo);
         return false;
@@ -399,7 +521,42 @@ static bool LIBJPEG_LoadJPG_IO(SDL_IOStream *src, struct loadjpeg_vars *vars)
 
     /* Decompress the image */
     lib.jpeg_start_decompress(&vars->cinfo);
+#ifdef LIBJPEG_TURBO_VERSION
+    if (region.w < (int)vars->cinfo.output_width || region.h < (int)vars->cinfo.output_height) {
+        JDIMENSION xoffset = (JDIMENSION)region.x;
+        JDIMENSION width = (JDIMENSION)region.w;
+        int bpp = SDL_BYTESPERPIXEL(format);
+        int y;
+
+        /* The columns are widened to the iMCU boundaries, so decode into a row buffer */
+        lib.jpeg_crop_scanline(&vars->cinfo, &xoffset, &width);
+        vars->row = (Uint8 *)SDL_malloc((size_t)width * bpp);
+        if (!vars->row) {
+            lib.jpeg_destroy_decompress(&vars->cinfo);
+            return false;
+        }
+        lib.jpeg_skip_scanlines(&vars->cinfo, (JDIMENSION)region.y);
+        rowptr[0] = (JSAMPROW)vars->row;
+        for (y = 0; y < region.h; ++y) {
+            if (!IMG_UpdateLoadProgress(y, region.h)) {
+                lib.jpeg_destroy_decompress(&vars->cinfo);
+                return false;
+            }
+            lib.jpeg_read_scanlines(&vars->cinfo, rowptr, (JDIMENSION) 1);
+            SDL_memcpy((Uint8 *)vars->surface->pixels + y * vars->surface->pitch,
+                       vars->row + (region.x - (int)xoffset) * bpp, (size_t)region.w * bpp);
+        }
+
+        /* The rows below the region are never decoded */
+        lib.jpeg_destroy_decompress(&vars->cinfo);
+        return true;
+    }
+#endif
     while (vars->cinfo.output_scanline < vars->cinfo.output_height) {
+        if (!IMG_UpdateLoadProgress(vars->cinfo.output_scanline, vars->cinfo.output_height)) {
+            lib.jpeg_destroy_decompress(&vars->cinfo);
+            return false;
+        }
         rowptr[0] = (JSAMPROW)(Uint8 *)vars->surface->pixels +
                             vars->cinfo.output_scanline * vars->surface->pitch;
         lib.jpeg_read_scanlines(&vars->cinfo, rowptr, (JDIMENSION) 1);
@@ -410,7 +567,7 @@ static bool LIBJPEG_LoadJPG_IO(SDL_IOStream *src, struct loadjpeg_vars *vars)
     return true;
 }
 
-SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
+static SDL_Surface *LoadJPG_IO(SDL_IOStream *src, IMG_LoadOptions *options)
 {
     Sint64 start;
     struct loadjpeg_vars vars;
@@ -426,10 +583,13 @@ SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
 
     start = SDL_TellIO(src);
     SDL_zero(vars);
+    vars.options = options;
 
     if (LIBJPEG_LoadJPG_IO(src, &vars)) {
+        SDL_free(vars.row);
         return vars.surface;
     }
+    SDL_free(vars.row);
 
     /* this may clobber a set error if seek fails: don't care. */
     SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
@@ -443,6 +603,80 @@ SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
     return NULL;
 }
 
+SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
+{
+    return LoadJPG_IO(src, NULL);
+}
+
+SDL_Surface *IMG_LoadJPGWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return LoadJPG_IO(src, options);
+}
+
+/* Read the JPEG header, without decompressing any image data */
+static bool LIBJPEG_GetJPGInfo_IO(SDL_IOStream *src, struct loadjpeg_vars *vars, SDL_PropertiesID props)
+{
+    SDL_PixelFormat format;
+
+    vars->cinfo.err = lib.jpeg_std_error(&vars->jerr.errmgr);
+    vars->jerr.errmgr.error_exit = my_error_exit;
+    vars->jerr.errmgr.output_message = output_no_message;
+    if (setjmp(vars->jerr.escape)) {
+        /* If we get here, libjpeg found an error */
+        lib.jpeg_destroy_decompress(&vars->cinfo);
+        vars->error = "JPEG loading error";
+        return false;
+    }
+
+    lib.jpeg_create_decompress(&vars->cinfo);
+    jpeg_SDL_IO_src(&vars->cinfo, src);
+    lib.jpeg_read_header(&vars->cinfo, TRUE);
+
+    /* Mirror the output format selection in LIBJPEG_LoadJPG_IO() */
+    if (vars->cinfo.num_components == 4) {
+        vars->cinfo.out_color_space = JCS_CMYK;
+        format = SDL_PIXELFORMAT_BGRA32;
+    } else {
+        vars->cinfo.out_color_space = JCS_RGB;
+#ifdef FAST_JPEG
+        vars->cinfo.scale_num   = 1;
+        vars->cinfo.scale_denom = 1;
+#endif
+        format = SDL_PIXELFORMAT_RGB24;
+    }
+    vars->cinfo.quantize_colors = FALSE;
+    lib.jpeg_calc_output_dimensions(&vars->cinfo);
+
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, vars->cinfo.output_width);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, vars->cinfo.output_height);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, format);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_BIT_DEPTH_NUMBER, vars->cinfo.data_precision);
+    SDL_SetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, false);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_FRAME_COUNT_NUMBER, 1);
+
+    lib.jpeg_destroy_decompress(&vars->cinfo);
+    return true;
+}
+
+bool IMG_GetJPGInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    struct loadjpeg_vars vars;
+
+    if (!IMG_InitJPG()) {
+        return false;
+    }
+
+    SDL_zero(vars);
+
+    if (!LIBJPEG_GetJPGInfo_IO(src, &vars, props)) {
+        if (vars.error) {
+            SDL_SetError("%s", vars.error);
+        }
+        return false;
+    }
+    return true;
+}
+
 #define OUTPUT_BUFFER_SIZE   4096
 typedef struct {
     struct jpeg_destination_mgr pub;
@@ -656,6 +890,89 @@ SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
     return IMG_LoadSTB_IO(src);
 }
 
+/* Get JPEG image information from the first start-of-frame marker */
+bool IMG_GetJPGInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    Uint8 magic[2];
+    Uint8 sof[6];
+    int size;
+
+    if (SDL_ReadIO(src, magic, 2) != 2 || magic[0] != 0xFF || magic[1] != 0xD8) {
+        return SDL_SetError("Not a JPEG file");
+    }
+
+    for (;;) {
+        /* Find the next marker, skipping any fill bytes */
+        do {
+            if (SDL_ReadIO(src, magic, 1) != 1) {
+                return SDL_SetError("Couldn't find JPEG frame header");
+            }
+        } while (magic[0] != 0xFF);
+        do {
+            if (SDL_ReadIO(src, &magic[1], 1) != 1) {
+                return SDL_SetError("Couldn't find JPEG frame header");
+            }
+        } while (magic[1] == 0xFF);
+
+        if (magic[1] == 0x01 || (magic[1] >= 0xD0 && magic[1] <= 0xD7)) {
+            /* These have nothing else */
+            continue;
+        }
+        if (magic[1] == 0xD9 || magic[1] == 0xDA) {
+            return SDL_SetError("Couldn't find JPEG frame header");
+        }
+        if (magic[1] >= 0xC0 && magic[1] <= 0xCF &&
+            magic[1] != 0xC4 && magic[1] != 0xC8 && magic[1] != 0xCC) {
+            /* Start of frame, skip the segment length */
+            if (SDL_SeekIO(src, 2, SDL_IO_SEEK_CUR) < 0) {
+                return SDL_SetError("Couldn't read JPEG frame header");
+            }
+            break;
+        }
+
+        /* Yes, it's big-endian */
+        if (SDL_ReadIO(src, magic, 2) != 2) {
+            return SDL_SetError("Couldn't find JPEG frame header");
+        }
+        size = (magic[0] << 8) | magic[1];
+        if (size < 2 || SDL_SeekIO(src, size - 2, SDL_IO_SEEK_CUR) < 0) {
+            return SDL_SetError("Couldn't find JPEG frame header");
+        }
+    }
+
+    if (SDL_ReadIO(src, sof, sizeof(sof)) != sizeof(sof)) {
+        return SDL_SetError("Couldn't read JPEG frame header");
+    }
+
+    /* stb_image decodes grayscale to 1 channel and everything else to RGB */
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, (sof[3] << 8) | sof[4]);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, (sof[1] << 8) | sof[2]);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, (sof[5] == 1) ? SDL_PIXELFORMAT_INDEX8 : SDL_PIXELFORMAT_RGB24);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_BIT_DEPTH_NUMBER, sof[0]);
+    SDL_SetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, false);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_FRAME_COUNT_NUMBER, 1);
+    return true;
+}
+
+/* stb_image allocates its own output buffer */
+SDL_Surface *IMG_LoadJPGWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return IMG_LoadJPG_IO(src);
+}
+
+#else
+
+/* The image is loaded by the platform backend */
+bool IMG_GetJPGInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    return SDL_Unsupported();
+}
+
+SDL_Surface *IMG_LoadJPGWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return IMG_LoadJPG_IO(src);
+}
+
 #endif /* WANT_JPEGLIB */
 
 #else
@@ -673,6 +990,16 @@ SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
     return NULL;
 }
 
+bool IMG_GetJPGInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    return SDL_SetError("SDL_image built without JPG support");
+}
+
+SDL_Surface *IMG_LoadJPGWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return IMG_LoadJPG_IO(src);
+}
+
 #endif /* LOAD_JPG */
 
 /* Use tinyjpeg as a fallback if we don't have a hard dependency on libjpeg */
@@ -23,13 +23,17 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_io.h"
+#include "IMG_limits.h"
+#include "IMG_stats.h"
+
 #ifdef LOAD_JXL
 
 #include <jxl/decode.h>
 
 
 static struct {
-    int loaded;
+    SDL_InitState init;
     void *handle;
     JxlDecoder* (*JxlDecoderCreate)(const JxlMemoryManager* memory_manager);
     JxlDecoderStatus (*JxlDecoderSubscribeEvents)(JxlDecoder* dec, int events_wanted);
@@ -55,40 +59,44 @@ static struct {
     /* Need to turn off optimizations so weak framework load check works */
     __attribute__ ((optnone))
 #endif
-static bool IMG_InitJXL(void)
+static bool LoadJXLLibrary(void)
 {
-    if ( lib.loaded == 0 ) {
 #ifdef LOAD_JXL_DYNAMIC
-        lib.handle = SDL_LoadObject(LOAD_JXL_DYNAMIC);
-        if ( lib.handle == NULL ) {
-            return false;
-        }
-#endif
-        FUNCTION_LOADER(JxlDecoderCreate, JxlDecoder* (*)(const JxlMemoryManager* memory_manager))
-        FUNCTION_LOADER(JxlDecoderSubscribeEvents, JxlDecoderStatus (*)(JxlDecoder* dec, int events_wanted))
-        FUNCTION_LOADER(JxlDecoderSetInput, JxlDecoderStatus (*)(JxlDecoder* dec, const uint8_t* data, size_t size))
-        FUNCTION_LOADER(JxlDecoderProcessInput, JxlDecoderStatus (*)(JxlDecoder* dec))
-        FUNCTION_LOADER(JxlDecoderGetBasicInfo, JxlDecoderStatus (*)(const JxlDecoder* dec, JxlBasicInfo* info))
-        FUNCTION_LOADER(JxlDecoderImageOutBufferSize, JxlDecoderStatus (*)(const JxlDecoder* dec, const JxlPixelFormat* format, size_t* size))
-        FUNCTION_LOADER(JxlDecoderSetImageOutBuffer, JxlDecoderStatus (*)(JxlDecoder* dec, const JxlPixelFormat* format, void* buffer, size_t size))
-        FUNCTION_LOADER(JxlDecoderDestroy, void (*)(JxlDecoder* dec))
+    lib.handle = SDL_LoadObject(LOAD_JXL_DYNAMIC);
+    if ( lib.handle == NULL ) {
+        return false;
     }
-    ++lib.loaded;
+#endif
+    FUNCTION_LOADER(JxlDecoderCreate, JxlDecoder* (*)(const JxlMemoryManager* memory_manager))
+    FUNCTION_LOADER(JxlDecoderSubscribeEvents, JxlDecoderStatus (*)(JxlDecoder* dec, int events_wanted))
+    FUNCTION_LOADER(JxlDecoderSetInput, JxlDecoderStatus (*)(JxlDecoder* dec, const uint8_t* data, size_t size))
+    FUNCTION_LOADER(JxlDecoderProcessInput, JxlDecoderStatus (*)(JxlDecoder* dec))
+    FUNCTION_LOADER(JxlDecoderGetBasicInfo, JxlDecoderStatus (*)(const JxlDecoder* dec, JxlBasicInfo* info))
+    FUNCTION_LOADER(JxlDecoderImageOutBufferSize, JxlDecoderStatus (*)(const JxlDecoder* dec, const JxlPixelFormat* format, size_t* size))
+    FUNCTION_LOADER(JxlDecoderSetImageOutBuffer, JxlDecoderStatus (*)(JxlDecoder* dec, const JxlPixelFormat* format, void* buffer, size_t size))
+    FUNCTION_LOADER(JxlDecoderDestroy, void (*)(JxlDecoder* dec))
+
+    return true;
+}
 
+static bool IMG_InitJXL(void)
+{
+    if (SDL_ShouldInit(&lib.init)) {
+        bool initialized = LoadJXLLibrary();
+        SDL_SetInitialized(&lib.init, initialized);
+        return initialized;
+    }
     return true;
 }
 #if 0
 void IMG_QuitJXL(void)
 {
-    if ( lib.loaded == 0 ) {
-        return;
-    }
-    if ( lib.loaded == 1 ) {
+    if (SDL_ShouldQuit(&lib.init)) {
 #ifdef LOAD_JXL_DYNAMIC
         SDL_UnloadObject(lib.handle);
 #endif
+        SDL_SetInitialized(&lib.init, false);
     }
-    --lib.loaded;
 }
 #endif // 0
 
@@ -131,7 +139,8 @@ bool IMG_isJXL(SDL_IOStream *src)
 SDL_Surface *IMG_LoadJXL_IO(SDL_IOStream *src)
 {
     Sint64 start;
-    unsigned char *data;
+    const Uint8 *data;
+    void *allocated = NULL;
     size_t datasize;
     JxlDecoder *decoder = NULL;
     JxlBasicInfo info;
@@ -151,7 +160,7 @@ SDL_Surface *IMG_LoadJXL_IO(SDL_IOStream *src)
         return NULL;
     }
 
-    data = (unsigned char *)SDL_LoadFile_IO(src, &datasize, false);
+    data = IMG_LoadIOData(src, &datasize, &allocated);
     if (!data) {
         return NULL;
     }
@@ -189,6 +198,10 @@ SDL_Surface *IMG_LoadJXL_IO(SDL_IOStream *src)
                 SDL_SetError("Couldn't get JXL image info");
                 goto done;
             }
+            if (!IMG_CheckImageLimits(info.xsize, info.ysize, SDL_PIXELFORMAT_RGBA32)) {
+                goto done;
+            }
+            IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
             break;
         case JXL_DEC_NEED_IMAGE_OUT_BUFFER:
             if (lib.JxlDecoderImageOutBufferSize(decoder, &format, &outputsize) != JXL_DEC_SUCCESS) {
@@ -238,9 +251,7 @@ done:
     if (decoder) {
         lib.JxlDecoderDestroy(decoder);
     }
-    if (data) {
-        SDL_free(data);
-    }
+    SDL_free(allocated);
     if (pixels) {
         SDL_free(pixels);
     }
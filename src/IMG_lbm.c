@@ -33,6 +33,9 @@
 #include <SDL3/SDL_endian.h>
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_limits.h"
+#include "IMG_stats.h"
+
 #ifdef LOAD_LBM
 
 
@@ -242,6 +245,13 @@ SDL_Surface *IMG_LoadLBM_IO(SDL_IOStream *src )
 
     stencil = (bmhd.mask & 1);   /* There is a mask ( 'stencil' ) */
 
+    if ( !IMG_CheckImageLimits( width, bmhd.h, ( nbplanes == 24 || flagHAM == 1 ) ? SDL_PIXELFORMAT_RGB24 : SDL_PIXELFORMAT_INDEX8 ) )
+    {
+        SDL_SeekIO( src, start, SDL_IO_SEEK_SET );
+        goto done;
+    }
+
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     /* Allocate memory for a temporary buffer ( used for
        decompression/deinterleaving ) */
 
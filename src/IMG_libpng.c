@@ -32,6 +32,12 @@
 #include "IMG_libpng.h"
 #include "IMG_anim_encoder.h"
 #include "IMG_anim_decoder.h"
+#include "IMG_info.h"
+#include "IMG_limits.h"
+#include "IMG_load_options.h"
+#include "IMG_progress.h"
+#include "IMG_scratch.h"
+#include "IMG_stats.h"
 
 #ifdef SDL_IMAGE_LIBPNG
 #include <png.h>
@@ -97,7 +103,7 @@ typedef png_inforp png_noconst16_inforp;
 
 static struct
 {
-    int loaded;
+    SDL_InitState init;
     #ifdef LOAD_LIBPNG_DYNAMIC
     void *handle_libpng;
 
@@ -120,6 +126,7 @@ static struct
     png_uint_32 (*png_get_tRNS)(png_const_structrp png_ptr, png_inforp info_ptr, png_bytep *trans, int *num_trans, png_color_16p *trans_values);
     png_uint_32 (*png_get_valid)(png_const_structrp png_ptr, png_const_inforp info_ptr, png_uint_32 flag);
     void (*png_read_image)(png_structrp png_ptr, png_bytepp image);
+    void (*png_read_row)(png_structrp png_ptr, png_bytep row, png_bytep display_row);
     void (*png_read_info)(png_structrp png_ptr, png_inforp info_ptr);
     void (*png_read_update_info)(png_structrp png_ptr, png_inforp info_ptr);
     void (*png_set_expand)(png_structrp png_ptr);
@@ -134,6 +141,8 @@ static struct
     void (*png_set_palette_to_rgb)(png_structrp png_ptr);
     void (*png_set_tRNS_to_alpha)(png_structrp png_ptr);
     void (*png_set_filler)(png_structrp png_ptr, png_uint_32 filler, int flags);
+    void (*png_set_bgr)(png_structrp png_ptr);
+    void (*png_set_swap_alpha)(png_structrp png_ptr);
 
     void (*png_set_read_user_chunk_fn)(png_structrp png_ptr, png_voidp user_chunk_ptr, png_user_chunk_ptr read_user_chunk_fn);
     void (*png_set_keep_unknown_chunks)(png_structrp png_ptr, int keep, png_const_bytep chunk_list, int num_chunks);
@@ -189,81 +198,92 @@ static struct
         }
 #endif
 
-static bool IMG_InitPNG(void)
+static bool LoadPNGLibrary(void)
 {
-    if (lib.loaded == 0) {
-        /* Uncomment this if you want to use zlib with libpng to decompress / compress manually if you'd prefer that.
-         *
-        lib.handle_zlib = SDL_LoadObject(LOAD_ZLIB_DYNAMIC);
-        if (lib.handle_zlib == NULL) {
-            return false;
-        }
-        */
+    /* Uncomment this if you want to use zlib with libpng to decompress / compress manually if you'd prefer that.
+     *
+    lib.handle_zlib = SDL_LoadObject(LOAD_ZLIB_DYNAMIC);
+    if (lib.handle_zlib == NULL) {
+        return false;
+    }
+    */
 
 #ifdef LOAD_LIBPNG_DYNAMIC
-        lib.handle_libpng = SDL_LoadObject(LOAD_LIBPNG_DYNAMIC);
-        if (lib.handle_libpng == NULL) {
-            return false;
-        }
+    lib.handle_libpng = SDL_LoadObject(LOAD_LIBPNG_DYNAMIC);
+    if (lib.handle_libpng == NULL) {
+        return false;
+    }
 #endif
 
-        FUNCTION_LOADER_LIBPNG(png_create_info_struct, png_infop(*)(png_noconst15_structrp png_ptr))
-        FUNCTION_LOADER_LIBPNG(png_create_read_struct, png_structp(*)(png_const_charp user_png_ver, png_voidp error_ptr, png_error_ptr error_fn, png_error_ptr warn_fn))
-        FUNCTION_LOADER_LIBPNG(png_destroy_read_struct, void (*)(png_structpp png_ptr_ptr, png_infopp info_ptr_ptr, png_infopp end_info_ptr_ptr))
-        FUNCTION_LOADER_LIBPNG(png_get_IHDR, png_uint_32(*)(png_noconst15_structrp png_ptr, png_noconst15_inforp info_ptr, png_uint_32 * width, png_uint_32 * height, int *bit_depth, int *color_type, int *interlace_method, int *compression_method, int *filter_method))
-        FUNCTION_LOADER_LIBPNG(png_get_io_ptr, png_voidp(*)(png_noconst15_structrp png_ptr))
-        FUNCTION_LOADER_LIBPNG(png_get_channels, png_byte(*)(png_const_structrp png_ptr, png_const_inforp info_ptr))
-
-        FUNCTION_LOADER_LIBPNG(png_error, void (*)(png_const_structrp png_ptr, png_const_charp error_message))
-
-        FUNCTION_LOADER_LIBPNG(png_get_PLTE, png_uint_32(*)(png_const_structrp png_ptr, png_noconst16_inforp info_ptr, png_colorp * palette, int *num_palette))
-        FUNCTION_LOADER_LIBPNG(png_get_tRNS, png_uint_32(*)(png_const_structrp png_ptr, png_inforp info_ptr, png_bytep * trans, int *num_trans, png_color_16p *trans_values))
-        FUNCTION_LOADER_LIBPNG(png_get_valid, png_uint_32(*)(png_const_structrp png_ptr, png_const_inforp info_ptr, png_uint_32 flag))
-        FUNCTION_LOADER_LIBPNG(png_read_image, void (*)(png_structrp png_ptr, png_bytepp image))
-        FUNCTION_LOADER_LIBPNG(png_read_info, void (*)(png_structrp png_ptr, png_inforp info_ptr))
-        FUNCTION_LOADER_LIBPNG(png_read_update_info, void (*)(png_structrp png_ptr, png_inforp info_ptr))
-        FUNCTION_LOADER_LIBPNG(png_set_expand, void (*)(png_structrp png_ptr))
-        FUNCTION_LOADER_LIBPNG(png_set_gray_to_rgb, void (*)(png_structrp png_ptr))
-        FUNCTION_LOADER_LIBPNG(png_set_read_fn, void (*)(png_structrp png_ptr, png_voidp io_ptr, png_rw_ptr read_data_fn))
-        FUNCTION_LOADER_LIBPNG(png_set_strip_16, void (*)(png_structrp png_ptr))
-        FUNCTION_LOADER_LIBPNG(png_set_interlace_handling, int (*)(png_structrp png_ptr))
-        FUNCTION_LOADER_LIBPNG(png_sig_cmp, int (*)(png_const_bytep sig, png_size_t start, png_size_t num_to_check))
+    FUNCTION_LOADER_LIBPNG(png_create_info_struct, png_infop(*)(png_noconst15_structrp png_ptr))
+    FUNCTION_LOADER_LIBPNG(png_create_read_struct, png_structp(*)(png_const_charp user_png_ver, png_voidp error_ptr, png_error_ptr error_fn, png_error_ptr warn_fn))
+    FUNCTION_LOADER_LIBPNG(png_destroy_read_struct, void (*)(png_structpp png_ptr_ptr, png_infopp info_ptr_ptr, png_infopp end_info_ptr_ptr))
+    FUNCTION_LOADER_LIBPNG(png_get_IHDR, png_uint_32(*)(png_noconst15_structrp png_ptr, png_noconst15_inforp info_ptr, png_uint_32 * width, png_uint_32 * height, int *bit_depth, int *color_type, int *interlace_method, int *compression_method, int *filter_method))
+    FUNCTION_LOADER_LIBPNG(png_get_io_ptr, png_voidp(*)(png_noconst15_structrp png_ptr))
+    FUNCTION_LOADER_LIBPNG(png_get_channels, png_byte(*)(png_const_structrp png_ptr, png_const_inforp info_ptr))
+
+    FUNCTION_LOADER_LIBPNG(png_error, void (*)(png_const_structrp png_ptr, png_const_charp error_message))
+
+    FUNCTION_LOADER_LIBPNG(png_get_PLTE, png_uint_32(*)(png_const_structrp png_ptr, png_noconst16_inforp info_ptr, png_colorp * palette, int *num_palette))
+    FUNCTION_LOADER_LIBPNG(png_get_tRNS, png_uint_32(*)(png_const_structrp png_ptr, png_inforp info_ptr, png_bytep * trans, int *num_trans, png_color_16p *trans_values))
+    FUNCTION_LOADER_LIBPNG(png_get_valid, png_uint_32(*)(png_const_structrp png_ptr, png_const_inforp info_ptr, png_uint_32 flag))
+    FUNCTION_LOADER_LIBPNG(png_read_image, void (*)(png_structrp png_ptr, png_bytepp image))
+    FUNCTION_LOADER_LIBPNG(png_read_row, void (*)(png_structrp png_ptr, png_bytep row, png_bytep display_row))
+    FUNCTION_LOADER_LIBPNG(png_read_info, void (*)(png_structrp png_ptr, png_inforp info_ptr))
+    FUNCTION_LOADER_LIBPNG(png_read_update_info, void (*)(png_structrp png_ptr, png_inforp info_ptr))
+    FUNCTION_LOADER_LIBPNG(png_set_expand, void (*)(png_structrp png_ptr))
+    FUNCTION_LOADER_LIBPNG(png_set_gray_to_rgb, void (*)(png_structrp png_ptr))
+    FUNCTION_LOADER_LIBPNG(png_set_read_fn, void (*)(png_structrp png_ptr, png_voidp io_ptr, png_rw_ptr read_data_fn))
+    FUNCTION_LOADER_LIBPNG(png_set_strip_16, void (*)(png_structrp png_ptr))
+    FUNCTION_LOADER_LIBPNG(png_set_interlace_handling, int (*)(png_structrp png_ptr))
+    FUNCTION_LOADER_LIBPNG(png_sig_cmp, int (*)(png_const_bytep sig, png_size_t start, png_size_t num_to_check))
 #ifndef LIBPNG_VERSION_12
-        FUNCTION_LOADER_LIBPNG(png_set_longjmp_fn, jmp_buf * (*)(png_structrp, png_longjmp_ptr, size_t))
+    FUNCTION_LOADER_LIBPNG(png_set_longjmp_fn, jmp_buf * (*)(png_structrp, png_longjmp_ptr, size_t))
 #endif
-        FUNCTION_LOADER_LIBPNG(png_set_palette_to_rgb, void (*)(png_structrp png_ptr))
-        FUNCTION_LOADER_LIBPNG(png_set_tRNS_to_alpha, void (*)(png_structrp png_ptr))
-        FUNCTION_LOADER_LIBPNG(png_set_filler, void (*)(png_structrp png_ptr, png_uint_32 filler, int flags))
+    FUNCTION_LOADER_LIBPNG(png_set_palette_to_rgb, void (*)(png_structrp png_ptr))
+    FUNCTION_LOADER_LIBPNG(png_set_tRNS_to_alpha, void (*)(png_structrp png_ptr))
+    FUNCTION_LOADER_LIBPNG(png_set_filler, void (*)(png_structrp png_ptr, png_uint_32 filler, int flags))
+    FUNCTION_LOADER_LIBPNG(png_set_bgr, void (*)(png_structrp png_ptr))
+    FUNCTION_LOADER_LIBPNG(png_set_swap_alpha, void (*)(png_structrp png_ptr))
+
+    FUNCTION_LOADER_LIBPNG(png_set_read_user_chunk_fn, void (*)(png_structrp png_ptr, png_voidp user_chunk_ptr, png_user_chunk_ptr read_user_chunk_fn))
+    FUNCTION_LOADER_LIBPNG(png_set_keep_unknown_chunks, void (*)(png_structrp png_ptr, int keep, png_const_bytep chunk_list, int num_chunks))
+    FUNCTION_LOADER_LIBPNG(png_set_sig_bytes, void (*)(png_structrp png_ptr, int num_bytes))
+    FUNCTION_LOADER_LIBPNG(png_set_compression_level, void (*)(png_structrp png_ptr, int level))
 
-        FUNCTION_LOADER_LIBPNG(png_set_read_user_chunk_fn, void (*)(png_structrp png_ptr, png_voidp user_chunk_ptr, png_user_chunk_ptr read_user_chunk_fn))
-        FUNCTION_LOADER_LIBPNG(png_set_keep_unknown_chunks, void (*)(png_structrp png_ptr, int keep, png_const_bytep chunk_list, int num_chunks))
-        FUNCTION_LOADER_LIBPNG(png_set_sig_bytes, void (*)(png_structrp png_ptr, int num_bytes))
-        FUNCTION_LOADER_LIBPNG(png_set_compression_level, void (*)(png_structrp png_ptr, int level))
+    FUNCTION_LOADER_LIBPNG(png_set_filter, void (*)(png_structrp png_ptr, int method, int filters))
 
-        FUNCTION_LOADER_LIBPNG(png_set_filter, void (*)(png_structrp png_ptr, int method, int filters))
+    FUNCTION_LOADER_LIBPNG(png_create_write_struct, png_structp(*)(png_const_charp user_png_ver, png_voidp error_ptr, png_error_ptr error_fn, png_error_ptr warn_fn))
+    FUNCTION_LOADER_LIBPNG(png_destroy_write_struct, void (*)(png_structpp png_ptr_ptr, png_infopp info_ptr_ptr))
+    FUNCTION_LOADER_LIBPNG(png_set_write_fn, void (*)(png_structrp png_ptr, png_voidp io_ptr, png_rw_ptr write_data_fn, png_flush_ptr output_flush_fn))
+    FUNCTION_LOADER_LIBPNG(png_set_IHDR, void (*)(png_noconst15_structrp png_ptr, png_inforp info_ptr, png_uint_32 width, png_uint_32 height, int bit_depth, int color_type, int interlace_type, int compression_type, int filter_type))
+    FUNCTION_LOADER_LIBPNG(png_write_info, void (*)(png_structrp png_ptr, png_noconst15_inforp info_ptr))
+    FUNCTION_LOADER_LIBPNG(png_set_rows, void (*)(png_noconst15_structrp png_ptr, png_inforp info_ptr, png_bytepp row_pointers))
+    FUNCTION_LOADER_LIBPNG(png_set_PLTE, void (*)(png_structrp png_ptr, png_inforp info_ptr, png_const_colorp palette, int num_palette))
+    FUNCTION_LOADER_LIBPNG(png_set_tRNS, void (*)(png_structrp png_ptr, png_inforp info_ptr, png_const_bytep trans_alpha, int num_trans, png_const_color_16p trans_color))
 
-        FUNCTION_LOADER_LIBPNG(png_create_write_struct, png_structp(*)(png_const_charp user_png_ver, png_voidp error_ptr, png_error_ptr error_fn, png_error_ptr warn_fn))
-        FUNCTION_LOADER_LIBPNG(png_destroy_write_struct, void (*)(png_structpp png_ptr_ptr, png_infopp info_ptr_ptr))
-        FUNCTION_LOADER_LIBPNG(png_set_write_fn, void (*)(png_structrp png_ptr, png_voidp io_ptr, png_rw_ptr write_data_fn, png_flush_ptr output_flush_fn))
-        FUNCTION_LOADER_LIBPNG(png_set_IHDR, void (*)(png_noconst15_structrp png_ptr, png_inforp info_ptr, png_uint_32 width, png_uint_32 height, int bit_depth, int color_type, int interlace_type, int compression_type, int filter_type))
-        FUNCTION_LOADER_LIBPNG(png_write_info, void (*)(png_structrp png_ptr, png_noconst15_inforp info_ptr))
-        FUNCTION_LOADER_LIBPNG(png_set_rows, void (*)(png_noconst15_structrp png_ptr, png_inforp info_ptr, png_bytepp row_pointers))
-        FUNCTION_LOADER_LIBPNG(png_set_PLTE, void (*)(png_structrp png_ptr, png_inforp info_ptr, png_const_colorp palette, int num_palette))
-        FUNCTION_LOADER_LIBPNG(png_set_tRNS, void (*)(png_structrp png_ptr, png_inforp info_ptr, png_const_bytep trans_alpha, int num_trans, png_const_color_16p trans_color))
+    FUNCTION_LOADER_LIBPNG(png_write_image, void (*)(png_structrp png_ptr, png_bytepp image))
+    FUNCTION_LOADER_LIBPNG(png_write_end, void (*)(png_structrp png_ptr, png_inforp info_ptr))
 
-        FUNCTION_LOADER_LIBPNG(png_write_image, void (*)(png_structrp png_ptr, png_bytepp image))
-        FUNCTION_LOADER_LIBPNG(png_write_end, void (*)(png_structrp png_ptr, png_inforp info_ptr))
+    FUNCTION_LOADER_LIBPNG(png_read_end, void (*)(png_structrp png_ptr, png_inforp info_ptr))
 
-        FUNCTION_LOADER_LIBPNG(png_read_end, void (*)(png_structrp png_ptr, png_inforp info_ptr))
+    FUNCTION_LOADER_LIBPNG(png_get_bit_depth, png_byte(*)(png_const_structrp png_ptr, png_const_inforp info_ptr))
+    FUNCTION_LOADER_LIBPNG(png_get_color_type, png_byte(*)(png_const_structrp png_ptr, png_const_inforp info_ptr))
+    FUNCTION_LOADER_LIBPNG(png_get_image_width, png_uint_32(*)(png_const_structrp png_ptr, png_const_inforp info_ptr))
+    FUNCTION_LOADER_LIBPNG(png_get_image_height, png_uint_32(*)(png_const_structrp png_ptr, png_const_inforp info_ptr))
 
-        FUNCTION_LOADER_LIBPNG(png_get_bit_depth, png_byte(*)(png_const_structrp png_ptr, png_const_inforp info_ptr))
-        FUNCTION_LOADER_LIBPNG(png_get_color_type, png_byte(*)(png_const_structrp png_ptr, png_const_inforp info_ptr))
-        FUNCTION_LOADER_LIBPNG(png_get_image_width, png_uint_32(*)(png_const_structrp png_ptr, png_const_inforp info_ptr))
-        FUNCTION_LOADER_LIBPNG(png_get_image_height, png_uint_32(*)(png_const_structrp png_ptr, png_const_inforp info_ptr))
+    FUNCTION_LOADER_LIBPNG(png_write_flush, void (*)(png_structrp png_ptr))
+
+    return true;
+}
 
-        FUNCTION_LOADER_LIBPNG(png_write_flush, void (*)(png_structrp png_ptr))
+static bool IMG_InitPNG(void)
+{
+    if (SDL_ShouldInit(&lib.init)) {
+        bool initialized = LoadPNGLibrary();
+        SDL_SetInitialized(&lib.init, initialized);
+        return initialized;
     }
-    ++lib.loaded;
     return true;
 }
 
@@ -345,10 +365,13 @@ cleanup:
 struct png_load_vars
 {
     const char *error;
+    IMG_LoadOptions *options;
     SDL_Surface *surface;
     png_structp png_ptr;
     png_infop info_ptr;
+    IMG_Scratch scratch;
     png_bytep *row_pointers;
+    png_bytep row;
     png_colorp color_ptr;
     SDL_Surface *source_surface_for_save;
 
@@ -363,8 +386,86 @@ struct png_load_vars
     png_color_16p trans_values;
 };
 
+/* Set up libpng transformations that produce an 8-bit RGB format directly */
+static bool LIBPNG_SetOutputFormat(struct png_load_vars *vars, SDL_PixelFormat format)
+{
+    int channels;
+    bool bgr, alpha_first, alpha;
+
+    switch (format) {
+    case SDL_PIXELFORMAT_RGB24:
+        channels = 3;
+        bgr = false;
+        alpha_first = false;
+        break;
+    case SDL_PIXELFORMAT_BGR24:
+        channels = 3;
+        bgr = true;
+        alpha_first = false;
+        break;
+    case SDL_PIXELFORMAT_RGBA32:
+    case SDL_PIXELFORMAT_RGBX32:
+        channels = 4;
+        bgr = false;
+        alpha_first = false;
+        break;
+    case SDL_PIXELFORMAT_BGRA32:
+    case SDL_PIXELFORMAT_BGRX32:
+        channels = 4;
+        bgr = true;
+        alpha_first = false;
+        break;
+    case SDL_PIXELFORMAT_ARGB32:
+    case SDL_PIXELFORMAT_XRGB32:
+        channels = 4;
+        bgr = false;
+        alpha_first = true;
+        break;
+    case SDL_PIXELFORMAT_ABGR32:
+    case SDL_PIXELFORMAT_XBGR32:
+        channels = 4;
+        bgr = true;
+        alpha_first = true;
+        break;
+    default:
+        return false;
+    }
+
+    if (vars->color_type == PNG_COLOR_TYPE_PALETTE) {
+        alpha = lib.png_get_valid(vars->png_ptr, vars->info_ptr, PNG_INFO_tRNS) != 0;
+    } else {
+        alpha = (vars->color_type & PNG_COLOR_MASK_ALPHA) != 0;
+    }
+    if (alpha && channels == 3) {
+        // Don't drop the alpha channel, let the caller convert
+        return false;
+    }
+
+    // Expand palette, low bit depth and tRNS data to 8-bit RGB(A)
+    lib.png_set_expand(vars->png_ptr);
+    if (!(vars->color_type & PNG_COLOR_MASK_COLOR)) {
+        lib.png_set_gray_to_rgb(vars->png_ptr);
+    }
+    if (vars->bit_depth == 16) {
+        lib.png_set_strip_16(vars->png_ptr);
+    }
+    if (bgr) {
+        lib.png_set_bgr(vars->png_ptr);
+    }
+    if (channels == 4) {
+        if (!alpha) {
+            lib.png_set_filler(vars->png_ptr, 0xFF, alpha_first ? PNG_FILLER_BEFORE : PNG_FILLER_AFTER);
+        } else if (alpha_first) {
+            lib.png_set_swap_alpha(vars->png_ptr);
+        }
+    }
+    return true;
+}
+
 static bool LIBPNG_LoadPNG_IO_Internal(SDL_IOStream *src, struct png_load_vars *vars)
 {
+    SDL_Rect region;
+
     if (SDL_ReadIO(src, vars->header, sizeof(vars->header)) != sizeof(vars->header)) {
         vars->error = "Failed to read PNG header from SDL_IOStream";
         return false;
@@ -416,8 +517,10 @@ static bool LIBPNG_LoadPNG_IO_Internal(SDL_IOStream *src, struct png_load_vars *
         lib.png_set_gray_to_rgb(vars->png_ptr);
     }
 
-    if (vars->color_type == PNG_COLOR_TYPE_PALETTE ||
-        vars->color_type == PNG_COLOR_TYPE_GRAY) {
+    if (vars->options && LIBPNG_SetOutputFormat(vars, vars->options->format)) {
+        vars->format = vars->options->format;
+    } else if (vars->color_type == PNG_COLOR_TYPE_PALETTE ||
+               vars->color_type == PNG_COLOR_TYPE_GRAY) {
         if (vars->bit_depth == 1) {
             vars->format = SDL_PIXELFORMAT_INDEX1MSB;
         } else if (vars->bit_depth == 2) {
@@ -445,7 +548,23 @@ static bool LIBPNG_LoadPNG_IO_Internal(SDL_IOStream *src, struct png_load_vars *
     lib.png_get_IHDR(vars->png_ptr, vars->info_ptr, &vars->width, &vars->height, &vars->bit_depth,
                      &vars->color_type, &vars->interlace_type, NULL, NULL);
 
-    vars->surface = SDL_CreateSurface(vars->width, vars->height, vars->format);
+    region.x = 0;
+    region.y = 0;
+    region.w = (int)vars->width;
+    region.h = (int)vars->height;
+
+    // Rows of non-interlaced images can be read one at a time, stopping after the region
+    if (vars->options && vars->options->region &&
+        vars->interlace_type == PNG_INTERLACE_NONE && SDL_BITSPERPIXEL(vars->format) >= 8) {
+        if (!IMG_GetLoadRegion(vars->options, region.w, region.h, &region)) {
+            vars->error = SDL_GetError();
+            return false;
+        }
+        vars->options->region = NULL;
+    }
+
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
+    vars->surface = IMG_CreateLoadSurface(region.w, region.h, vars->format, vars->options);
     if (vars->surface == NULL) {
         vars->error = SDL_GetError();
         return false;
@@ -489,23 +608,56 @@ static bool LIBPNG_LoadPNG_IO_Internal(SDL_IOStream *src, struct png_load_vars *
         }
     }
 
-    vars->row_pointers = (png_bytep *)SDL_malloc(sizeof(png_bytep) * vars->height);
-    if (!vars->row_pointers) {
-        vars->error = "Out of memory allocating row pointers";
-        return false;
-    }
-    for (png_uint_32 y = 0; y < vars->height; y++) {
-        vars->row_pointers[y] = (png_bytep)((Uint8 *)vars->surface->pixels + y * (size_t)vars->surface->pitch);
-    }
+    if (region.w < (int)vars->width || region.h < (int)vars->height) {
+        int bpp = SDL_BYTESPERPIXEL(vars->format);
 
-    lib.png_read_image(vars->png_ptr, vars->row_pointers);
+        vars->row = (png_bytep)IMG_AllocScratch(&vars->scratch, (size_t)vars->width * bpp);
+        if (!vars->row) {
+            vars->error = "Out of memory allocating row buffer";
+            return false;
+        }
+        for (int y = 0; y < region.y + region.h; y++) {
+            if (!IMG_UpdateLoadProgress(y, region.y + region.h)) {
+                return false;
+            }
+            lib.png_read_row(vars->png_ptr, vars->row, NULL);
+            if (y >= region.y) {
+                SDL_memcpy((Uint8 *)vars->surface->pixels + (y - region.y) * (size_t)vars->surface->pitch,
+                           vars->row + region.x * bpp, (size_t)region.w * bpp);
+            }
+        }
+    } else {
+        vars->row_pointers = (png_bytep *)IMG_AllocScratch(&vars->scratch, sizeof(png_bytep) * vars->height);
+        if (!vars->row_pointers) {
+            vars->error = "Out of memory allocating row pointers";
+            return false;
+        }
+        for (png_uint_32 y = 0; y < vars->height; y++) {
+            vars->row_pointers[y] = (png_bytep)((Uint8 *)vars->surface->pixels + y * (size_t)vars->surface->pitch);
+        }
+
+        if (vars->interlace_type == PNG_INTERLACE_NONE && IMG_IsLoadProgressActive()) {
+            // Read a row at a time, so the load can be cancelled part way
+            for (png_uint_32 y = 0; y < vars->height; y++) {
+                if (!IMG_UpdateLoadProgress(y, vars->height)) {
+                    return false;
+                }
+                lib.png_read_row(vars->png_ptr, vars->row_pointers[y], NULL);
+            }
+        } else {
+            lib.png_read_image(vars->png_ptr, vars->row_pointers);
+        }
+    }
 
 #if SDL_BYTEORDER != SDL_BIG_ENDIAN
     if (vars->format == SDL_PIXELFORMAT_RGBA64) {
-        Uint16 *pixels = (Uint16 *)vars->surface->pixels;
-        int num_pixels = vars->width * vars->height * 4;
-        for (int i = 0; i < num_pixels; i++) {
-            pixels[i] = SDL_Swap16(pixels[i]);
+        // The target surface may have padding between rows
+        for (int y = 0; y < vars->surface->h; y++) {
+            Uint16 *pixels = (Uint16 *)((Uint8 *)vars->surface->pixels + y * (size_t)vars->surface->pitch);
+            int num_pixels = vars->surface->w * 4;
+            for (int i = 0; i < num_pixels; i++) {
+                pixels[i] = SDL_Swap16(pixels[i]);
+            }
         }
     }
 #endif
@@ -513,7 +665,7 @@ static bool LIBPNG_LoadPNG_IO_Internal(SDL_IOStream *src, struct png_load_vars *
     return true;
 }
 
-SDL_Surface *IMG_LoadPNG_IO(SDL_IOStream *src)
+static SDL_Surface *LoadPNG_IO(SDL_IOStream *src, IMG_LoadOptions *options)
 {
     Sint64 start_pos;
     bool success = false;
@@ -531,6 +683,7 @@ SDL_Surface *IMG_LoadPNG_IO(SDL_IOStream *src)
 
     struct png_load_vars vars;
     SDL_zero(vars);
+    vars.options = options;
 
     success = LIBPNG_LoadPNG_IO_Internal(src, &vars);
 
@@ -539,9 +692,7 @@ SDL_Surface *IMG_LoadPNG_IO(SDL_IOStream *src)
                                     vars.info_ptr ? &vars.info_ptr : (png_infopp)NULL,
                                     (png_infopp)NULL);
     }
-    if (vars.row_pointers) {
-        SDL_free(vars.row_pointers);
-    }
+    IMG_FreeScratch(&vars.scratch);
 
     if (success) {
         return vars.surface;
@@ -557,6 +708,155 @@ SDL_Surface *IMG_LoadPNG_IO(SDL_IOStream *src)
     }
 }
 
+SDL_Surface *IMG_LoadPNG_IO(SDL_IOStream *src)
+{
+    return LoadPNG_IO(src, NULL);
+}
+
+SDL_Surface *IMG_LoadPNGWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return LoadPNG_IO(src, options);
+}
+
+static bool LIBPNG_GetPNGInfo_IO_Internal(SDL_IOStream *src, struct png_load_vars *vars)
+{
+    if (SDL_ReadIO(src, vars->header, sizeof(vars->header)) != sizeof(vars->header)) {
+        vars->error = "Failed to read PNG header from SDL_IOStream";
+        return false;
+    }
+    if (lib.png_sig_cmp(vars->header, 0, 8)) {
+        vars->error = "Not a valid PNG file signature";
+        return false;
+    }
+
+    vars->png_ptr = lib.png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    if (vars->png_ptr == NULL) {
+        vars->error = "Couldn't allocate memory for PNG read struct";
+        return false;
+    }
+    vars->info_ptr = lib.png_create_info_struct(vars->png_ptr);
+    if (vars->info_ptr == NULL) {
+        vars->error = "Couldn't create image information for PNG file";
+        return false;
+    }
+#ifndef LIBPNG_VERSION_12
+    if (setjmp(*lib.png_set_longjmp_fn(vars->png_ptr, longjmp, sizeof(jmp_buf))))
+#else
+    if (setjmp(vars->png_ptr->jmpbuf))
+#endif
+    {
+        vars->error = "Error during PNG read operation";
+        return false;
+    }
+
+    lib.png_set_read_fn(vars->png_ptr, src, png_read_data);
+    lib.png_set_sig_bytes(vars->png_ptr, 8);
+
+    /* This reads everything up to the first IDAT chunk, but no pixel data */
+    lib.png_read_info(vars->png_ptr, vars->info_ptr);
+    lib.png_get_IHDR(vars->png_ptr, vars->info_ptr, &vars->width, &vars->height, &vars->bit_depth,
+                     &vars->color_type, &vars->interlace_type, NULL, NULL);
+    vars->num_trans = lib.png_get_valid(vars->png_ptr, vars->info_ptr, PNG_INFO_tRNS) ? 1 : 0;
+
+    /* Mirror the output format selection in LIBPNG_LoadPNG_IO_Internal() */
+    if (vars->color_type != PNG_COLOR_TYPE_PALETTE && vars->num_trans) {
+        vars->color_type |= PNG_COLOR_MASK_ALPHA;
+    }
+    if (vars->color_type == PNG_COLOR_TYPE_PALETTE ||
+        vars->color_type == PNG_COLOR_TYPE_GRAY) {
+        if (vars->bit_depth == 1) {
+            vars->format = SDL_PIXELFORMAT_INDEX1MSB;
+        } else if (vars->bit_depth == 2) {
+            vars->format = SDL_PIXELFORMAT_INDEX2MSB;
+        } else if (vars->bit_depth == 4) {
+            vars->format = SDL_PIXELFORMAT_INDEX4MSB;
+        } else /* if (vars->bit_depth == 8) */ {
+            vars->format = SDL_PIXELFORMAT_INDEX8;
+        }
+    } else if (vars->bit_depth == 16) {
+        if (vars->color_type & PNG_COLOR_MASK_ALPHA) {
+            vars->format = SDL_PIXELFORMAT_RGBA64;
+        } else {
+            vars->format = SDL_PIXELFORMAT_RGB48;
+        }
+    } else {
+        if (vars->color_type & PNG_COLOR_MASK_ALPHA) {
+            vars->format = SDL_PIXELFORMAT_RGBA32;
+        } else {
+            vars->format = SDL_PIXELFORMAT_RGB24;
+        }
+    }
+    return true;
+}
+
+/* Count the frames of an APNG image by walking the chunks before the image data */
+static Uint32 GetPNGFrameCount(SDL_IOStream *src)
+{
+    Uint8 chunk[8];
+
+    if (SDL_SeekIO(src, sizeof(png_sig), SDL_IO_SEEK_CUR) < 0) {
+        return 1;
+    }
+    while (SDL_ReadIO(src, chunk, sizeof(chunk)) == sizeof(chunk)) {
+        Uint32 length = ((Uint32)chunk[0] << 24) | ((Uint32)chunk[1] << 16) | ((Uint32)chunk[2] << 8) | chunk[3];
+
+        if (SDL_memcmp(&chunk[4], "IDAT", 4) == 0) {
+            break;
+        }
+        if (SDL_memcmp(&chunk[4], "acTL", 4) == 0 && length == 8) {
+            if (SDL_ReadIO(src, chunk, 4) != 4) {
+                break;
+            }
+            return SDL_max(((Uint32)chunk[0] << 24) | ((Uint32)chunk[1] << 16) | ((Uint32)chunk[2] << 8) | chunk[3], 1);
+        }
+        /* Skip the chunk data and CRC */
+        if (SDL_SeekIO(src, (Sint64)length + 4, SDL_IO_SEEK_CUR) < 0) {
+            break;
+        }
+    }
+    return 1;
+}
+
+bool IMG_GetPNGInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    Sint64 start_pos;
+    bool success;
+
+    if (!IMG_InitPNG()) {
+        return false;
+    }
+
+    start_pos = SDL_TellIO(src);
+
+    struct png_load_vars vars;
+    SDL_zero(vars);
+
+    success = LIBPNG_GetPNGInfo_IO_Internal(src, &vars);
+
+    if (vars.png_ptr) {
+        lib.png_destroy_read_struct(&vars.png_ptr,
+                                    vars.info_ptr ? &vars.info_ptr : (png_infopp)NULL,
+                                    (png_infopp)NULL);
+    }
+
+    if (!success) {
+        if (vars.error) {
+            SDL_SetError("%s", vars.error);
+        }
+        return false;
+    }
+
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, vars.width);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, vars.height);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, vars.format);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_BIT_DEPTH_NUMBER, vars.bit_depth);
+    SDL_SetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, (vars.color_type & PNG_COLOR_MASK_ALPHA) || vars.num_trans);
+
+    SDL_SeekIO(src, start_pos, SDL_IO_SEEK_SET);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_FRAME_COUNT_NUMBER, GetPNGFrameCount(src));
+    return true;
+}
+
 #if SAVE_PNG
 
 struct png_save_vars
@@ -565,6 +865,7 @@ struct png_save_vars
     SDL_Surface *surface;
     png_structp png_ptr;
     png_infop info_ptr;
+    IMG_Scratch scratch;
     png_bytep *row_pointers;
     png_colorp color_ptr;
     SDL_Surface *source_surface_for_save;
@@ -608,7 +909,7 @@ static bool LIBPNG_SavePNG_IO_Internal(struct png_save_vars *vars, SDL_Surface *
         int i;
         int last_transparent = -1;
 
-        vars->color_ptr = (png_colorp)SDL_malloc(sizeof(png_color) * ncolors);
+        vars->color_ptr = (png_colorp)IMG_AllocScratch(&vars->scratch, sizeof(png_color) * ncolors);
         if (vars->color_ptr == NULL) {
             vars->error = "Couldn't allocate palette for PNG file";
             return false;
@@ -654,7 +955,7 @@ static bool LIBPNG_SavePNG_IO_Internal(struct png_save_vars *vars, SDL_Surface *
 
     lib.png_write_info(vars->png_ptr, vars->info_ptr);
 
-    vars->row_pointers = (png_bytep *)SDL_malloc(sizeof(png_bytep) * vars->source_surface_for_save->h);
+    vars->row_pointers = (png_bytep *)IMG_AllocScratch(&vars->scratch, sizeof(png_bytep) * vars->source_surface_for_save->h);
     if (!vars->row_pointers) {
         vars->error = "Out of memory allocating row pointers";
         return false;
@@ -691,12 +992,7 @@ bool IMG_SavePNG_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio)
     if (vars.png_ptr) {
         lib.png_destroy_write_struct(&vars.png_ptr, &vars.info_ptr);
     }
-    if (vars.color_ptr) {
-        SDL_free(vars.color_ptr);
-    }
-    if (vars.row_pointers) {
-        SDL_free(vars.row_pointers);
-    }
+    IMG_FreeScratch(&vars.scratch);
     if (vars.source_surface_for_save && vars.source_surface_for_save != surface) {
         SDL_DestroySurface(vars.source_surface_for_save);
     }
@@ -772,6 +1068,7 @@ typedef struct
 
 typedef struct
 {
+    IMG_Scratch *scratch;
     SDL_IOStream *mem_stream;
     SDL_IOStream *read_stream;
     png_structp png_ptr;
@@ -791,8 +1088,19 @@ static SDL_Surface *decompress_png_frame_data(DecompressionContext *context, png
      * (if any) for us.
      */
 
-    // Create a memory stream to hold our synthetic PNG
-    context->mem_stream = SDL_IOFromDynamicMem();
+    if (!IMG_CheckImageLimits(width, height, SDL_PIXELFORMAT_RGBA32)) {
+        goto error;
+    }
+
+    bool has_plte = (png_color_type == PNG_COLOR_TYPE_PALETTE && palette_colors && palette_count > 0);
+    size_t png_size = 8 + (8 + 13 + 4) + (has_plte ? 8 + palette_count * 3 + 4 : 0) + (8 + compressed_size + 4) + 12;
+    png_bytep png_data = (png_bytep)IMG_AllocScratch(context->scratch, png_size);
+    if (!png_data) {
+        goto error;
+    }
+
+    // Create a memory stream to hold our synthetic PNG, sized for the chunks below
+    context->mem_stream = SDL_IOFromMem(png_data, png_size);
     if (!context->mem_stream) {
         SDL_SetError("Failed to create memory stream");
         goto error;
@@ -841,7 +1149,7 @@ static SDL_Surface *decompress_png_frame_data(DecompressionContext *context, png
     }
 
     // Write PLTE chunk if this is a palette-based image
-    if (png_color_type == PNG_COLOR_TYPE_PALETTE && palette_colors && palette_count > 0) {
+    if (has_plte) {
         // Calculate PLTE chunk size (3 bytes per color)
         png_uint_32 plte_size = palette_count * 3;
 
@@ -855,7 +1163,7 @@ static SDL_Surface *decompress_png_frame_data(DecompressionContext *context, png
         }
 
         // Write palette data
-        png_byte *plte_data = (png_byte *)SDL_malloc(plte_size);
+        png_byte *plte_data = (png_byte *)IMG_AllocScratch(context->scratch, plte_size);
         if (!plte_data) {
             SDL_SetError("Out of memory for PLTE data");
             goto error;
@@ -868,7 +1176,6 @@ static SDL_Surface *decompress_png_frame_data(DecompressionContext *context, png
         }
 
         if (SDL_WriteIO(context->mem_stream, plte_data, plte_size) != plte_size) {
-            SDL_free(plte_data);
             SDL_SetError("Failed to write PLTE data");
             goto error;
         }
@@ -878,7 +1185,6 @@ static SDL_Surface *decompress_png_frame_data(DecompressionContext *context, png
         crc = SDL_crc32(crc, plte_data, plte_size);
         png_byte crc_bytes[4];
         custom_png_save_uint_32(crc_bytes, crc);
-        SDL_free(plte_data);
 
         if (SDL_WriteIO(context->mem_stream, crc_bytes, 4) != 4) {
             SDL_SetError("Failed to write PLTE CRC");
@@ -936,29 +1242,10 @@ static SDL_Surface *decompress_png_frame_data(DecompressionContext *context, png
         SDL_SetError("data size >= INT32_MAX");
         goto error;
     }
-    void *buffer = NULL;
 
-    if (SDL_SeekIO(context->mem_stream, 0, SDL_IO_SEEK_SET) < 0) {
-        SDL_SetError("Failed to rewind memory stream");
-        goto error;
-    }
-
-    buffer = SDL_malloc(data_size);
-    if (!buffer) {
-        SDL_SetError("Out of memory for PNG data buffer");
-        goto error;
-    }
-
-    if (SDL_ReadIO(context->mem_stream, buffer, data_size) != (size_t)data_size) {
-        SDL_SetError("Failed to read from memory stream");
-        SDL_free(buffer);
-        goto error;
-    }
-
-    context->read_stream = SDL_IOFromConstMem(buffer, data_size);
+    context->read_stream = SDL_IOFromConstMem(png_data, (size_t)data_size);
     if (!context->read_stream) {
         SDL_SetError("Failed to create read stream");
-        SDL_free(buffer);
         goto error;
     }
 
@@ -966,14 +1253,12 @@ static SDL_Surface *decompress_png_frame_data(DecompressionContext *context, png
     context->png_ptr = lib.png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
     if (!context->png_ptr) {
         SDL_SetError("Failed to create PNG read struct");
-        SDL_free(buffer);
         goto error;
     }
 
     context->info_ptr = lib.png_create_info_struct(context->png_ptr);
     if (!context->info_ptr) {
         SDL_SetError("Failed to create PNG info struct");
-        SDL_free(buffer);
         goto error;
     }
 
@@ -984,7 +1269,6 @@ static SDL_Surface *decompress_png_frame_data(DecompressionContext *context, png
 #endif
     {
         SDL_SetError("Error during PNG read");
-        SDL_free(buffer);
         goto error;
     }
 
@@ -1007,13 +1291,11 @@ static SDL_Surface *decompress_png_frame_data(DecompressionContext *context, png
 
     context->surface = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_RGBA32);
     if (!context->surface) {
-        SDL_free(buffer);
         goto error;
     }
 
-    context->row_pointers = (png_bytep *)SDL_malloc(height * sizeof(png_bytep));
+    context->row_pointers = (png_bytep *)IMG_AllocScratch(context->scratch, height * sizeof(png_bytep));
     if (!context->row_pointers) {
-        SDL_free(buffer);
         goto error;
     }
 
@@ -1023,18 +1305,13 @@ static SDL_Surface *decompress_png_frame_data(DecompressionContext *context, png
 
     lib.png_read_image(context->png_ptr, context->row_pointers);
 
-    SDL_free(context->row_pointers);
     lib.png_destroy_read_struct(&context->png_ptr, &context->info_ptr, NULL);
     SDL_CloseIO(context->read_stream);
     SDL_CloseIO(context->mem_stream);
-    SDL_free(buffer);
 
     return context->surface;
 
 error:
-    if (context->row_pointers) {
-        SDL_free(context->row_pointers);
-    }
     if (context->png_ptr) {
         lib.png_destroy_read_struct(&context->png_ptr, context->info_ptr ? &context->info_ptr : NULL, NULL);
     }
@@ -1122,6 +1399,8 @@ struct IMG_AnimationDecoderContext
     int palette_count;
     png_bytep trans_alpha;
     int trans_count;
+
+    IMG_Scratch scratch;    /* temporaries for decoding a frame */
 };
 
 static bool IMG_AnimationDecoderReset_Internal(IMG_AnimationDecoder *decoder)
@@ -1200,11 +1479,14 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
             if (!SDL_FillSurfaceRect(ctx->canvas, &prev_frame_rect, 0x00000000)) {
                 return SDL_SetError("Failed to fill canvas for background dispose operation");
             }
+            IMG_AddDecoderDirtyRect(decoder, ctx->canvas, &prev_frame_rect);
             break;
         case PNG_DISPOSE_OP_PREVIOUS:
             if (!SDL_BlitSurface(ctx->prev_canvas_copy, NULL, ctx->canvas, NULL)) {
                 return SDL_SetError("Failed to restore previous canvas copy for dispose operation");
             }
+            // The copy was made just before the previous frame was drawn
+            IMG_AddDecoderDirtyRect(decoder, ctx->canvas, &prev_frame_rect);
             break;
         }
     }
@@ -1215,8 +1497,12 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
         }
     }
 
+    // The temporaries of the previous frame aren't needed anymore
+    IMG_ResetScratch(&ctx->scratch);
+
     DecompressionContext decompressionContext;
     SDL_zero(decompressionContext);
+    decompressionContext.scratch = &ctx->scratch;
     SDL_Surface *temp_frame = decompress_png_frame_data(
         &decompressionContext,
         fctl->raw_idat_data,
@@ -1276,8 +1562,9 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
         return SDL_SetError("Failed to blit frame onto canvas: %s", SDL_GetError());
     }
     SDL_DestroySurface(temp_frame);
+    IMG_AddDecoderDirtyRect(decoder, ctx->canvas, &dest_rect);
 
-    retval = SDL_DuplicateSurface(ctx->canvas);
+    retval = IMG_GetDecoderCanvasFrame(decoder, ctx->canvas);
     if (!retval) {
         return false;
     }
@@ -1317,6 +1604,7 @@ static bool IMG_AnimationDecoderClose_Internal(IMG_AnimationDecoder *decoder)
         SDL_DestroySurface(ctx->prev_canvas_copy);
     }
 
+    IMG_FreeScratch(&ctx->scratch);
     SDL_free(ctx);
     decoder->ctx = NULL;
     return true;
@@ -1392,6 +1680,13 @@ bool IMG_CreateAPNGAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
             ctx->bit_depth = *(Uint8 *)(chunk_data + 8);
             ctx->png_color_type = *(Uint8 *)(chunk_data + 9);
 
+            if (!IMG_CheckImageLimits(ctx->width, ctx->height, SDL_PIXELFORMAT_RGBA32)) {
+                SDL_free(chunk_data);
+                SDL_free(ctx);
+                decoder->ctx = NULL;
+                return false;
+            }
+
         } else if (SDL_memcmp(chunk_type, "acTL", 4) == 0) {
             if (chunk_length != 8) {
                 SDL_SetError("Invalid acTL chunk size");
@@ -1653,6 +1948,7 @@ bool IMG_CreateAPNGAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
     decoder->GetNextFrame = IMG_AnimationDecoderGetNextFrame_Internal;
     decoder->Reset = IMG_AnimationDecoderReset_Internal;
     decoder->Close = IMG_AnimationDecoderClose_Internal;
+    decoder->tracks_dirty_rects = true;
 
     bool ignoreProps = SDL_GetBooleanProperty(props, IMG_PROP_METADATA_IGNORE_PROPS_BOOLEAN, false);
     if (!ignoreProps) {
@@ -0,0 +1,119 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Decode resource limits, see IMG_limits.h */
+
+#include <SDL3_image/SDL_image.h>
+
+#include "IMG_limits.h"
+
+/* The limits installed by the load on each thread */
+static SDL_TLSID current_limits;
+
+static Sint64 GetLimitHint(const char *name)
+{
+    const char *hint = SDL_GetHint(name);
+    Sint64 value;
+
+    if (!hint || !*hint) {
+        return 0;
+    }
+    value = (Sint64)SDL_strtoll(hint, NULL, 0);
+    return SDL_max(value, 0);
+}
+
+void IMG_GetDecodeLimits(IMG_DecodeLimits *limits)
+{
+    IMG_DecodeLimits *current = (IMG_DecodeLimits *)SDL_GetTLS(&current_limits);
+
+    if (current) {
+        *limits = *current;
+    } else {
+        limits->max_pixels = GetLimitHint(IMG_HINT_MAX_PIXELS);
+        limits->max_bytes = GetLimitHint(IMG_HINT_MAX_IMAGE_BYTES);
+        limits->max_frames = GetLimitHint(IMG_HINT_MAX_ANIMATION_FRAMES);
+        limits->max_animation_bytes = GetLimitHint(IMG_HINT_MAX_ANIMATION_BYTES);
+    }
+    limits->prev = NULL;
+}
+
+void IMG_PushDecodeLimits(IMG_DecodeLimits *limits)
+{
+    limits->prev = (IMG_DecodeLimits *)SDL_GetTLS(&current_limits);
+    SDL_SetTLS(&current_limits, limits, NULL);
+}
+
+void IMG_PopDecodeLimits(IMG_DecodeLimits *limits)
+{
+    SDL_SetTLS(&current_limits, limits->prev, NULL);
+    limits->prev = NULL;
+}
+
+bool IMG_HasImageLimits(void)
+{
+    IMG_DecodeLimits limits;
+
+    IMG_GetDecodeLimits(&limits);
+    return limits.max_pixels || limits.max_bytes;
+}
+
+bool IMG_CheckImageLimits(Sint64 width, Sint64 height, SDL_PixelFormat format)
+{
+    IMG_DecodeLimits limits;
+    Sint64 pitch;
+
+    if (width <= 0 || height <= 0) {
+        /* The decoder reports invalid sizes itself */
+        return true;
+    }
+
+    IMG_GetDecodeLimits(&limits);
+
+    /* Divide rather than multiply, the sizes in a hostile header can overflow */
+    if (limits.max_pixels && height > limits.max_pixels / width) {
+        return SDL_SetError("Image too large (%" SDL_PRIs64 "x%" SDL_PRIs64 "), the limit is %" SDL_PRIs64 " pixels",
+                            width, height, limits.max_pixels);
+    }
+
+    if (limits.max_bytes) {
+        if (SDL_BYTESPERPIXEL(format) > 0) {
+            pitch = width * SDL_BYTESPERPIXEL(format);
+        } else {
+            pitch = (width * SDL_BITSPERPIXEL(format) + 7) / 8;
+        }
+        if (pitch > limits.max_bytes || (pitch > 0 && height > limits.max_bytes / pitch)) {
+            return SDL_SetError("Image too large (%" SDL_PRIs64 "x%" SDL_PRIs64 "), the limit is %" SDL_PRIs64 " bytes",
+                                width, height, limits.max_bytes);
+        }
+    }
+    return true;
+}
+
+bool IMG_CheckAnimationLimits(const IMG_DecodeLimits *limits, Sint64 frames, Sint64 bytes)
+{
+    if (limits->max_frames && frames > limits->max_frames) {
+        return SDL_SetError("Animation has too many frames, the limit is %" SDL_PRIs64, limits->max_frames);
+    }
+    if (limits->max_animation_bytes && bytes > limits->max_animation_bytes) {
+        return SDL_SetError("Animation too large, the limit is %" SDL_PRIs64 " bytes", limits->max_animation_bytes);
+    }
+    return true;
+}
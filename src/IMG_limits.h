@@ -0,0 +1,57 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Resource limits for decoding untrusted images, see IMG_HINT_MAX_PIXELS.
+ *
+ * Decoders call IMG_CheckImageLimits() as soon as they know the size of the
+ * image, before allocating anything that grows with it, and fail with the
+ * error it sets. The limits come from the hints, unless a load or an
+ * animation decoder installed its own with IMG_PushDecodeLimits().
+ *
+ * A limit of 0 means no limit.
+ */
+
+typedef struct IMG_DecodeLimits IMG_DecodeLimits;
+
+struct IMG_DecodeLimits
+{
+    Sint64 max_pixels;              /* pixels in an image or an animation frame */
+    Sint64 max_bytes;               /* decoded bytes of an image or an animation frame */
+    Sint64 max_frames;              /* frames decoded from an animation */
+    Sint64 max_animation_bytes;     /* decoded bytes of all the frames of an animation */
+    IMG_DecodeLimits *prev;         /* the limits that were installed before these */
+};
+
+/* Get the limits that apply to loads on this thread */
+extern void IMG_GetDecodeLimits(IMG_DecodeLimits *limits);
+
+/* Install limits for the loads on this thread, until IMG_PopDecodeLimits() */
+extern void IMG_PushDecodeLimits(IMG_DecodeLimits *limits);
+extern void IMG_PopDecodeLimits(IMG_DecodeLimits *limits);
+
+/* Returns true if the size of images is limited, for decoders that have to read ahead to check it */
+extern bool IMG_HasImageLimits(void);
+
+/* Returns false with the error set if an image of this size may not be decoded */
+extern bool IMG_CheckImageLimits(Sint64 width, Sint64 height, SDL_PixelFormat format);
+
+/* Returns false with the error set if an animation has more frames or decoded bytes than allowed */
+extern bool IMG_CheckAnimationLimits(const IMG_DecodeLimits *limits, Sint64 frames, Sint64 bytes);
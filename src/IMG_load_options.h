@@ -0,0 +1,65 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Options for loading a single image, see IMG_LoadWithProperties() and
+ * IMG_LoadInto_IO().
+ *
+ * Each function loads the image like IMG_LoadXXX_IO(), but honors the
+ * options its decoder can apply natively. Output surfaces are created with
+ * IMG_CreateLoadSurface(), which shares the pixels of the target surface if it
+ * matches. Anything the decoder can't do is left to the caller, which checks
+ * the returned surface and converts it if needed. Backends that don't support
+ * any options just call IMG_LoadXXX_IO().
+ *
+ * Decoders that scale the image natively get the output size from
+ * IMG_GetLoadSize() and reset `scale_denom` to 1, the caller then reduces the
+ * result to fit `max_width` and `max_height` if it doesn't already. Decoders
+ * that can only get partway there also set `scaled_width` and `scaled_height`
+ * to the output size, and the caller reduces the result to exactly that size.
+ *
+ * Decoders that crop the image natively clip `region` with
+ * IMG_GetLoadRegion() and reset it to NULL, otherwise the caller crops the
+ * result.
+ */
+
+typedef struct IMG_LoadOptions
+{
+    SDL_Surface *target;        /* decode into this surface if it matches, or NULL */
+    SDL_PixelFormat format;     /* requested pixel format, or SDL_PIXELFORMAT_UNKNOWN */
+    int scale_denom;            /* decode at 1/scale_denom of the size, or 1 */
+    int max_width;              /* maximum output width, or 0 */
+    int max_height;             /* maximum output height, or 0 */
+    int scaled_width;           /* output size left for the caller to reach, or 0 */
+    int scaled_height;
+    const SDL_Rect *region;     /* decode only this part of the image, or NULL */
+} IMG_LoadOptions;
+
+extern SDL_Surface *IMG_CreateLoadSurface(int width, int height, SDL_PixelFormat format, const IMG_LoadOptions *options);
+extern bool IMG_GetLoadSize(const IMG_LoadOptions *options, int width, int height, int *out_width, int *out_height);
+extern bool IMG_GetLoadRegion(const IMG_LoadOptions *options, int width, int height, SDL_Rect *region);
+
+extern SDL_Surface *IMG_LoadAVIFWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options);
+extern SDL_Surface *IMG_LoadJPGWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options);
+extern SDL_Surface *IMG_LoadPNGWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options);
+extern SDL_Surface *IMG_LoadSVGWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options);
+extern SDL_Surface *IMG_LoadTGAWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options);
+extern SDL_Surface *IMG_LoadTIFWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options);
+extern SDL_Surface *IMG_LoadWEBPWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options);
@@ -37,6 +37,9 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_limits.h"
+#include "IMG_stats.h"
+
 #ifdef LOAD_PCX
 
 struct PCXheader {
@@ -146,6 +149,11 @@ SDL_Surface *IMG_LoadPCX_IO(SDL_IOStream *src)
         error = "unsupported PCX format";
         goto done;
     }
+    if (!IMG_CheckImageLimits(width, height, format)) {
+        SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+        goto done;
+    }
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     surface = SDL_CreateSurface(width, height, format);
     if ( surface == NULL ) {
         goto done;
@@ -25,6 +25,10 @@
 
 #if !defined(SDL_IMAGE_LIBPNG)
 
+#include "IMG_info.h"
+#include "IMG_load_options.h"
+#include "IMG_stats.h"
+
 /* We'll have PNG save support by default */
 #if !defined(SAVE_PNG)
 #define SAVE_PNG 1
@@ -61,9 +65,80 @@ bool IMG_isPNG(SDL_IOStream *src)
 /* Load a PNG type image from an SDL datasource */
 SDL_Surface *IMG_LoadPNG_IO(SDL_IOStream *src)
 {
+    /* SDL reads the header and the pixels in one call */
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     return SDL_LoadPNG_IO(src, false);
 }
 
+/* Get PNG image information by walking the chunks before the image data */
+bool IMG_GetPNGInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    Uint8 header[33];
+    Uint8 chunk[8];
+    Uint32 width, height, frames = 1;
+    Uint8 bit_depth, color_type;
+    bool trans = false;
+    SDL_PixelFormat format;
+
+    /* The signature is always followed by the IHDR chunk */
+    if (SDL_ReadIO(src, header, sizeof(header)) != sizeof(header) ||
+        header[0] != 0x89 || SDL_memcmp(&header[1], "PNG", 3) != 0 ||
+        SDL_memcmp(&header[12], "IHDR", 4) != 0) {
+        return SDL_SetError("Not a valid PNG file signature");
+    }
+    width = ((Uint32)header[16] << 24) | ((Uint32)header[17] << 16) | ((Uint32)header[18] << 8) | header[19];
+    height = ((Uint32)header[20] << 24) | ((Uint32)header[21] << 16) | ((Uint32)header[22] << 8) | header[23];
+    bit_depth = header[24];
+    color_type = header[25];
+
+    while (SDL_ReadIO(src, chunk, sizeof(chunk)) == sizeof(chunk)) {
+        Uint32 length = ((Uint32)chunk[0] << 24) | ((Uint32)chunk[1] << 16) | ((Uint32)chunk[2] << 8) | chunk[3];
+
+        if (SDL_memcmp(&chunk[4], "IDAT", 4) == 0) {
+            break;
+        }
+        if (SDL_memcmp(&chunk[4], "tRNS", 4) == 0) {
+            trans = true;
+        } else if (SDL_memcmp(&chunk[4], "acTL", 4) == 0 && length == 8) {
+            if (SDL_ReadIO(src, chunk, 4) != 4) {
+                break;
+            }
+            frames = ((Uint32)chunk[0] << 24) | ((Uint32)chunk[1] << 16) | ((Uint32)chunk[2] << 8) | chunk[3];
+            frames = SDL_max(frames, 1);
+            length -= 4;
+        }
+        /* Skip the chunk data and CRC */
+        if (SDL_SeekIO(src, (Sint64)length + 4, SDL_IO_SEEK_CUR) < 0) {
+            break;
+        }
+    }
+
+    /* Color types: 0 gray, 2 RGB, 3 palette, 4 gray + alpha, 6 RGB + alpha */
+    if (color_type == 0 || color_type == 3) {
+        if (bit_depth == 1) {
+            format = SDL_PIXELFORMAT_INDEX1MSB;
+        } else if (bit_depth == 2) {
+            format = SDL_PIXELFORMAT_INDEX2MSB;
+        } else if (bit_depth == 4) {
+            format = SDL_PIXELFORMAT_INDEX4MSB;
+        } else {
+            format = SDL_PIXELFORMAT_INDEX8;
+        }
+    } else if (bit_depth == 16) {
+        format = (color_type & 4) ? SDL_PIXELFORMAT_RGBA64 : SDL_PIXELFORMAT_RGB48;
+    } else {
+        format = (color_type & 4) ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGB24;
+    }
+
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, width);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, height);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, format);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_BIT_DEPTH_NUMBER, bit_depth);
+    SDL_SetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, (color_type & 4) || trans);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_FRAME_COUNT_NUMBER, frames);
+    return true;
+}
+
 #else
 
 /* See if an image is contained in a data source */
@@ -79,8 +154,19 @@ SDL_Surface *IMG_LoadPNG_IO(SDL_IOStream *src)
     return NULL;
 }
 
+bool IMG_GetPNGInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    return SDL_SetError("SDL_image built without PNG support");
+}
+
 #endif /* LOAD_PNG */
 
+/* Only the libpng backend supports load options */
+SDL_Surface *IMG_LoadPNGWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return IMG_LoadPNG_IO(src);
+}
+
 #if SAVE_PNG
 
 bool IMG_SavePNG_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio)
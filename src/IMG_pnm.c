@@ -29,6 +29,9 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_limits.h"
+#include "IMG_stats.h"
+
 #ifdef LOAD_PNM
 
 /* See if an image is contained in a data source */
@@ -143,6 +146,10 @@ SDL_Surface *IMG_LoadPNM_IO(SDL_IOStream *src)
     height = ReadNumber(src);
     if(width <= 0 || height <= 0)
         ERROR("Unable to read image width and height");
+    if(!IMG_CheckImageLimits(width, height, kind == PPM ? SDL_PIXELFORMAT_RGB24 : SDL_PIXELFORMAT_INDEX8)) {
+        SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+        goto done;
+    }
 
     if(kind != PBM) {
         maxval = ReadNumber(src);
@@ -154,6 +161,7 @@ SDL_Surface *IMG_LoadPNM_IO(SDL_IOStream *src)
     /* binary PNM allows just a single character of whitespace after
        the last parameter, and we've already consumed it */
 
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     if(kind == PPM) {
         /* 24-bit surface in R,G,B byte order */
         surface = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_RGB24);
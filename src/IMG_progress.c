@@ -0,0 +1,140 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+/* Load progress and cancellation, see IMG_progress.h */
+
+#include <SDL3_image/SDL_image.h>
+
+#include "IMG_progress.h"
+
+/* The callback is called this many times over the image at most */
+#define PROGRESS_STEPS  1024
+
+/* The progress of the load on each thread */
+static SDL_TLSID current_progress;
+
+/* The number of loads with progress installed, to skip the hooks cheaply */
+static SDL_AtomicInt active_count;
+
+static IMG_LoadProgress *GetCurrentProgress(void)
+{
+    if (SDL_GetAtomicInt(&active_count) == 0) {
+        return NULL;
+    }
+    return (IMG_LoadProgress *)SDL_GetTLS(&current_progress);
+}
+
+static bool SetCancelledError(void)
+{
+    return SDL_SetError("Load cancelled");
+}
+
+void IMG_BeginLoadProgress(IMG_LoadProgress *progress, IMG_LoadProgressCallback callback, void *userdata, Uint64 deadline)
+{
+    SDL_zerop(progress);
+
+    if (!callback && !deadline) {
+        return;
+    }
+
+    progress->callback = callback;
+    progress->userdata = userdata;
+    progress->deadline = deadline;
+    progress->step = -1;
+
+    SDL_AddAtomicInt(&active_count, 1);
+    progress->prev = (IMG_LoadProgress *)SDL_GetTLS(&current_progress);
+    if (!SDL_SetTLS(&current_progress, progress, NULL)) {
+        /* The load can't be cancelled, but it can still finish */
+        SDL_AddAtomicInt(&active_count, -1);
+        return;
+    }
+    progress->active = true;
+}
+
+void IMG_EndLoadProgress(IMG_LoadProgress *progress)
+{
+    if (!progress->active) {
+        return;
+    }
+
+    SDL_SetTLS(&current_progress, progress->prev, NULL);
+    progress->prev = NULL;
+    progress->active = false;
+    SDL_AddAtomicInt(&active_count, -1);
+
+    /* Decoders tried after the cancelled one may have replaced the error */
+    if (progress->cancelled) {
+        SetCancelledError();
+    }
+}
+
+bool IMG_UpdateLoadProgress(Sint64 done, Sint64 total)
+{
+    IMG_LoadProgress *progress = GetCurrentProgress();
+    float fraction;
+    int step;
+
+    if (!progress) {
+        return true;
+    }
+    if (progress->cancelled) {
+        return SetCancelledError();
+    }
+
+    /* Checking the clock is cheap enough to do every time */
+    if (progress->deadline && SDL_GetTicksNS() >= progress->deadline) {
+        progress->cancelled = true;
+        progress->timed_out = true;
+        return SetCancelledError();
+    }
+
+    if (total > 0) {
+        done = SDL_clamp(done, 0, total);
+        fraction = (float)((double)done / (double)total);
+    } else {
+        fraction = 0.0f;
+    }
+    step = (int)(fraction * PROGRESS_STEPS);
+    if (step == progress->step) {
+        return true;
+    }
+    progress->step = step;
+
+    if (progress->callback && !progress->callback(progress->userdata, fraction)) {
+        progress->cancelled = true;
+        return SetCancelledError();
+    }
+    return true;
+}
+
+bool IMG_IsLoadCancelled(void)
+{
+    IMG_LoadProgress *progress = GetCurrentProgress();
+
+    return progress && progress->cancelled;
+}
+
+bool IMG_IsLoadProgressActive(void)
+{
+    return GetCurrentProgress() != NULL;
+}
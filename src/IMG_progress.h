@@ -0,0 +1,65 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+/* Progress reporting and cancellation of loads, see
+ * IMG_PROP_LOAD_PROGRESS_CALLBACK_POINTER.
+ *
+ * The load functions that take a progress callback or a deadline install
+ * them on the calling thread while the image is decoded. Decoders report
+ * how far they got with IMG_UpdateLoadProgress() between rows, strips or
+ * tiles, and stop decoding when it returns false. The deadline is checked on
+ * every update, the callback only when the progress has moved on.
+ *
+ * All the hooks return right away when no load with a callback or a
+ * deadline is running.
+ */
+
+typedef struct IMG_LoadProgress IMG_LoadProgress;
+
+struct IMG_LoadProgress
+{
+    bool active;                /* true while installed as this thread's progress */
+    bool cancelled;
+    bool timed_out;             /* true if the load was cancelled by the deadline */
+    IMG_LoadProgressCallback callback;
+    void *userdata;
+    Uint64 deadline;            /* in SDL_GetTicksNS() time, 0 for none */
+    int step;                   /* the last step reported, see IMG_UpdateLoadProgress() */
+    IMG_LoadProgress *prev;     /* the progress that was active before this one */
+};
+
+/* Install a progress callback and deadline on this thread, if either is set */
+extern void IMG_BeginLoadProgress(IMG_LoadProgress *progress, IMG_LoadProgressCallback callback, void *userdata, Uint64 deadline);
+
+/* Uninstall the progress, setting the error again if the load was cancelled */
+extern void IMG_EndLoadProgress(IMG_LoadProgress *progress);
+
+/* Report that `done` out of `total` units of the image have been decoded.
+ * Returns false with the error set if the load should stop.
+ */
+extern bool IMG_UpdateLoadProgress(Sint64 done, Sint64 total);
+
+/* Returns true if the load running on this thread has been cancelled */
+extern bool IMG_IsLoadCancelled(void);
+
+/* Returns true if a load with a callback or a deadline is running on this thread */
+extern bool IMG_IsLoadProgressActive(void);
@@ -26,6 +26,11 @@
 #include <SDL3_image/SDL_image.h>
 #include <limits.h> /* for INT_MAX */
 
+#include "IMG_info.h"
+#include "IMG_io.h"
+#include "IMG_limits.h"
+#include "IMG_stats.h"
+
 #ifdef LOAD_QOI
 
 /* SDL < 2.0.12 compatibility */
@@ -66,25 +71,36 @@ bool IMG_isQOI(SDL_IOStream *src)
 /* Load a QOI type image from an SDL datasource */
 SDL_Surface *IMG_LoadQOI_IO(SDL_IOStream *src)
 {
-    void *data;
+    const Uint8 *data;
+    void *allocated;
     size_t size;
     void *pixel_data;
     qoi_desc image_info;
     SDL_Surface *surface = NULL;
 
-    data = SDL_LoadFile_IO(src, &size, false);
+    data = IMG_LoadIOData(src, &size, &allocated);
     if ( !data ) {
         return NULL;
     }
     if ( size > INT_MAX ) {
-        SDL_free(data);
+        SDL_free(allocated);
         SDL_SetError("QOI image is too big.");
         return NULL;
     }
+    /* qoi_decode() allocates the pixels before it returns the size */
+    if ( size >= QOI_HEADER_SIZE &&
+         !IMG_CheckImageLimits(((Uint32)data[4] << 24) | ((Uint32)data[5] << 16) | ((Uint32)data[6] << 8) | data[7],
+                               ((Uint32)data[8] << 24) | ((Uint32)data[9] << 16) | ((Uint32)data[10] << 8) | data[11],
+                               SDL_PIXELFORMAT_RGBA32) ) {
+        SDL_free(allocated);
+        return NULL;
+    }
 
+    /* qoi_decode() reads the header and the pixels in one call */
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     pixel_data = qoi_decode(data, (int)size, &image_info, 4);
     /* pixel_data is in R,G,B,A order regardless of endianness */
-    SDL_free(data);
+    SDL_free(allocated);
     if ( !pixel_data ) {
         SDL_SetError("Couldn't parse QOI image");
         return NULL;
@@ -107,6 +123,34 @@ SDL_Surface *IMG_LoadQOI_IO(SDL_IOStream *src)
     return surface;
 }
 
+/* Get QOI image information from the header */
+bool IMG_GetQOIInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    Uint8 header[QOI_HEADER_SIZE];
+    Uint32 width, height;
+
+    if (SDL_ReadIO(src, header, sizeof(header)) != sizeof(header) ||
+        SDL_memcmp(header, "qoif", 4) != 0) {
+        return SDL_SetError("Couldn't parse QOI image");
+    }
+
+    width = ((Uint32)header[4] << 24) | ((Uint32)header[5] << 16) | ((Uint32)header[6] << 8) | header[7];
+    height = ((Uint32)header[8] << 24) | ((Uint32)header[9] << 16) | ((Uint32)header[10] << 8) | header[11];
+    if (width == 0 || height == 0 || header[12] < 3 || header[12] > 4 ||
+        height >= QOI_PIXELS_MAX / width) {
+        return SDL_SetError("Couldn't parse QOI image");
+    }
+
+    /* The image is always decoded as RGBA */
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, width);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, height);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, SDL_PIXELFORMAT_RGBA32);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_BIT_DEPTH_NUMBER, 8);
+    SDL_SetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, header[12] == 4);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_FRAME_COUNT_NUMBER, 1);
+    return true;
+}
+
 #else
 
 /* See if an image is contained in a data source */
@@ -122,4 +166,9 @@ SDL_Surface *IMG_LoadQOI_IO(SDL_IOStream *src)
     return NULL;
 }
 
+bool IMG_GetQOIInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    return SDL_SetError("SDL_image built without QOI support");
+}
+
 #endif /* LOAD_QOI */
@@ -0,0 +1,266 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Bump allocator for decoder temporaries, see IMG_scratch.h */
+
+#include <SDL3_image/SDL_image.h>
+
+#include "IMG_scratch.h"
+#include "IMG_stats.h"
+
+/* Alignment of every allocation */
+#define SCRATCH_ALIGN       16
+
+/* Smallest block allocated at once */
+#define SCRATCH_BLOCK_SIZE  (64 * 1024)
+
+/* Largest block kept around for the next load on the same thread, see IMG_HINT_SCRATCH_KEEP_SIZE */
+#define SCRATCH_KEEP_SIZE   (1024 * 1024)
+
+#define SCRATCH_ALIGN_UP(x) (((x) + SCRATCH_ALIGN - 1) & ~(size_t)(SCRATCH_ALIGN - 1))
+
+struct IMG_ScratchBlock
+{
+    IMG_ScratchBlock *next;
+    IMG_ScratchFreeFunc free_func;  /* NULL if the block is on the heap */
+    void *userdata;
+    size_t size;
+    size_t used;
+    size_t last;                    /* offset of the last allocation */
+};
+
+#define SCRATCH_HEADER_SIZE SCRATCH_ALIGN_UP(sizeof(IMG_ScratchBlock))
+#define SCRATCH_DATA(block) ((Uint8 *)(block) + SCRATCH_HEADER_SIZE)
+
+static SDL_SpinLock allocator_lock;
+static IMG_ScratchAllocFunc allocator_alloc;
+static IMG_ScratchFreeFunc allocator_free;
+static void *allocator_userdata;
+
+/* A heap block kept by each thread between loads, freed when the thread exits */
+static SDL_TLSID kept_block;
+
+bool IMG_SetScratchAllocator(IMG_ScratchAllocFunc alloc_func, IMG_ScratchFreeFunc free_func, void *userdata)
+{
+    if (!alloc_func != !free_func) {
+        return SDL_InvalidParamError(alloc_func ? "free_func" : "alloc_func");
+    }
+
+    SDL_LockSpinlock(&allocator_lock);
+    allocator_alloc = alloc_func;
+    allocator_free = free_func;
+    allocator_userdata = userdata;
+    SDL_UnlockSpinlock(&allocator_lock);
+    return true;
+}
+
+static IMG_ScratchBlock *CreateBlock(size_t size)
+{
+    IMG_ScratchAllocFunc alloc_func;
+    IMG_ScratchFreeFunc free_func;
+    IMG_ScratchBlock *block;
+    void *userdata;
+
+    if (size > SDL_SIZE_MAX - SCRATCH_HEADER_SIZE - SCRATCH_ALIGN) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    size = SDL_max(SCRATCH_ALIGN_UP(size), SCRATCH_BLOCK_SIZE);
+
+    SDL_LockSpinlock(&allocator_lock);
+    alloc_func = allocator_alloc;
+    free_func = allocator_free;
+    userdata = allocator_userdata;
+    SDL_UnlockSpinlock(&allocator_lock);
+
+    if (alloc_func) {
+        block = (IMG_ScratchBlock *)alloc_func(userdata, SCRATCH_HEADER_SIZE + size);
+        if (!block) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        IMG_CountLoadAllocation(SCRATCH_HEADER_SIZE + size);
+    } else {
+        block = (IMG_ScratchBlock *)SDL_GetTLS(&kept_block);
+        if (block && block->size >= size) {
+            SDL_SetTLS(&kept_block, NULL, NULL);
+            size = block->size;
+        } else {
+            block = (IMG_ScratchBlock *)SDL_malloc(SCRATCH_HEADER_SIZE + size);
+            if (!block) {
+                return NULL;
+            }
+            IMG_CountLoadAllocation(SCRATCH_HEADER_SIZE + size);
+        }
+    }
+
+    block->next = NULL;
+    block->free_func = free_func;
+    block->userdata = userdata;
+    block->size = size;
+    block->used = 0;
+    block->last = 0;
+    return block;
+}
+
+static size_t GetKeepSize(void)
+{
+    const char *hint = SDL_GetHint(IMG_HINT_SCRATCH_KEEP_SIZE);
+
+    if (!hint || !*hint) {
+        return SCRATCH_KEEP_SIZE;
+    }
+    return (size_t)SDL_strtoull(hint, NULL, 0);
+}
+
+static void DestroyBlock(IMG_ScratchBlock *block)
+{
+    IMG_ScratchBlock *kept;
+
+    if (block->free_func) {
+        block->free_func(block->userdata, block);
+        return;
+    }
+
+    /* Keep the largest reasonable block for the next load on this thread */
+    kept = (IMG_ScratchBlock *)SDL_GetTLS(&kept_block);
+    if (block->size <= GetKeepSize() && (!kept || kept->size < block->size) &&
+        SDL_SetTLS(&kept_block, block, SDL_free)) {
+        SDL_free(kept);
+        return;
+    }
+    SDL_free(block);
+}
+
+void *IMG_AllocScratch(IMG_Scratch *scratch, size_t size)
+{
+    IMG_ScratchBlock *block = scratch->blocks;
+
+    if (size == 0) {
+        size = 1;
+    }
+
+    if (block) {
+        size_t offset = SCRATCH_ALIGN_UP(block->used);
+
+        if (offset <= block->size && size <= block->size - offset) {
+            block->last = offset;
+            block->used = offset + size;
+            return SCRATCH_DATA(block) + offset;
+        }
+    }
+
+    /* The rest of the current block is left unused */
+    block = CreateBlock(size);
+    if (!block) {
+        return NULL;
+    }
+    block->next = scratch->blocks;
+    block->used = size;
+    scratch->blocks = block;
+    return SCRATCH_DATA(block);
+}
+
+void *IMG_CallocScratch(IMG_Scratch *scratch, size_t count, size_t size)
+{
+    void *mem;
+
+    if (size && count > SDL_SIZE_MAX / size) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    mem = IMG_AllocScratch(scratch, count * size);
+    if (mem) {
+        SDL_memset(mem, 0, count * size);
+    }
+    return mem;
+}
+
+void *IMG_ReallocScratch(IMG_Scratch *scratch, void *mem, size_t old_size, size_t new_size)
+{
+    IMG_ScratchBlock *block = scratch->blocks;
+    void *new_mem;
+
+    if (!mem) {
+        return IMG_AllocScratch(scratch, new_size);
+    }
+
+    if (block && (Uint8 *)mem == SCRATCH_DATA(block) + block->last && new_size <= block->size - block->last) {
+        block->used = block->last + new_size;
+        return mem;
+    }
+
+    new_mem = IMG_AllocScratch(scratch, new_size);
+    if (new_mem) {
+        SDL_memcpy(new_mem, mem, SDL_min(old_size, new_size));
+    }
+    return new_mem;
+}
+
+void IMG_ResetScratch(IMG_Scratch *scratch)
+{
+    IMG_ScratchBlock *largest = NULL;
+    IMG_ScratchBlock *block = scratch->blocks;
+
+    while (block) {
+        IMG_ScratchBlock *next = block->next;
+
+        if (!largest || block->size > largest->size) {
+            if (largest) {
+                DestroyBlock(largest);
+            }
+            largest = block;
+        } else {
+            DestroyBlock(block);
+        }
+        block = next;
+    }
+
+    if (largest) {
+        largest->next = NULL;
+        largest->used = 0;
+        largest->last = 0;
+    }
+    scratch->blocks = largest;
+}
+
+void IMG_FreeScratch(IMG_Scratch *scratch)
+{
+    IMG_ScratchBlock *block = scratch->blocks;
+
+    while (block) {
+        IMG_ScratchBlock *next = block->next;
+
+        DestroyBlock(block);
+        block = next;
+    }
+    scratch->blocks = NULL;
+}
+
+void IMG_FreeKeptScratch(void)
+{
+    IMG_ScratchBlock *kept = (IMG_ScratchBlock *)SDL_GetTLS(&kept_block);
+
+    if (kept) {
+        SDL_SetTLS(&kept_block, NULL, NULL);
+        SDL_free(kept);
+    }
+}
@@ -0,0 +1,58 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Scratch memory for decoder and encoder temporaries.
+ *
+ * An IMG_Scratch hands out memory from large blocks with a bump pointer and
+ * releases all of it at once. A decoder keeps one per load, or one per
+ * animation decoder or encoder that it resets between frames, instead of
+ * allocating and freeing each temporary buffer. The blocks come from the
+ * allocator set with IMG_SetScratchAllocator(), or from the heap, with one
+ * block of up to IMG_HINT_SCRATCH_KEEP_SIZE kept per thread for the next
+ * load. The kept block is freed with the thread's SDL TLS data.
+ *
+ * A zeroed IMG_Scratch is empty and ready to use.
+ */
+
+typedef struct IMG_ScratchBlock IMG_ScratchBlock;
+
+typedef struct IMG_Scratch
+{
+    IMG_ScratchBlock *blocks;   /* the block being allocated from comes first */
+} IMG_Scratch;
+
+/* Allocate uninitialized memory, aligned for any type */
+extern void *IMG_AllocScratch(IMG_Scratch *scratch, size_t size);
+
+/* Allocate zeroed memory for `count` elements of `size` bytes */
+extern void *IMG_CallocScratch(IMG_Scratch *scratch, size_t count, size_t size);
+
+/* Resize an allocation, in place if it's the last one that was made */
+extern void *IMG_ReallocScratch(IMG_Scratch *scratch, void *mem, size_t old_size, size_t new_size);
+
+/* Release all the allocations, keeping the largest block for the next ones */
+extern void IMG_ResetScratch(IMG_Scratch *scratch);
+
+/* Release all the allocations and the blocks behind them */
+extern void IMG_FreeScratch(IMG_Scratch *scratch);
+
+/* Free the block kept by the calling thread */
+extern void IMG_FreeKeptScratch(void);
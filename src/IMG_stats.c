@@ -0,0 +1,361 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Per-load statistics, see IMG_stats.h */
+
+#include <SDL3_image/SDL_image.h>
+
+#include "IMG_stats.h"
+
+/* The number of formats with totals, more than the formats SDL_image supports */
+#define MAX_FORMATS 32
+
+typedef struct StatsIO
+{
+    SDL_IOStream *src;
+    IMG_LoadStats *stats;
+} StatsIO;
+
+typedef struct FormatEntry
+{
+    char type[16];
+    IMG_FormatStats stats;
+} FormatEntry;
+
+/* The stats of the load on each thread */
+static SDL_TLSID current_stats;
+
+/* The number of loads being measured, to skip the hooks cheaply */
+static SDL_AtomicInt active_count;
+
+static SDL_SpinLock format_lock;
+static FormatEntry formats[MAX_FORMATS];
+static int num_formats;
+
+static IMG_LoadStats *GetCurrentStats(void)
+{
+    if (SDL_GetAtomicInt(&active_count) == 0) {
+        return NULL;
+    }
+    return (IMG_LoadStats *)SDL_GetTLS(&current_stats);
+}
+
+static Sint64 SDLCALL StatsIOSize(void *userdata)
+{
+    StatsIO *io = (StatsIO *)userdata;
+
+    return SDL_GetIOSize(io->src);
+}
+
+static Sint64 SDLCALL StatsIOSeek(void *userdata, Sint64 offset, SDL_IOWhence whence)
+{
+    StatsIO *io = (StatsIO *)userdata;
+
+    ++io->stats->seek_calls;
+    return SDL_SeekIO(io->src, offset, whence);
+}
+
+static size_t SDLCALL StatsIORead(void *userdata, void *ptr, size_t size, SDL_IOStatus *status)
+{
+    StatsIO *io = (StatsIO *)userdata;
+    size_t amount;
+
+    ++io->stats->read_calls;
+    amount = SDL_ReadIO(io->src, ptr, size);
+    io->stats->bytes_read += amount;
+    if (amount < size) {
+        *status = SDL_GetIOStatus(io->src);
+    }
+    return amount;
+}
+
+static bool SDLCALL StatsIOClose(void *userdata)
+{
+    SDL_free(userdata);
+    return true;
+}
+
+static SDL_IOStream *OpenStatsIO(IMG_LoadStats *stats, SDL_IOStream *src)
+{
+    SDL_IOStreamInterface iface;
+    SDL_IOStream *stream;
+    StatsIO *io;
+
+    io = (StatsIO *)SDL_malloc(sizeof(*io));
+    if (!io) {
+        return NULL;
+    }
+    io->src = src;
+    io->stats = stats;
+
+    SDL_INIT_INTERFACE(&iface);
+    iface.size = StatsIOSize;
+    iface.seek = StatsIOSeek;
+    iface.read = StatsIORead;
+    iface.close = StatsIOClose;
+
+    stream = SDL_OpenIO(&iface, io);
+    if (!stream) {
+        SDL_free(io);
+        return NULL;
+    }
+
+    /* Keep the memory stream properties, so decoders can still read in place */
+    SDL_CopyProperties(SDL_GetIOProperties(src), SDL_GetIOProperties(stream));
+    return stream;
+}
+
+SDL_IOStream *IMG_BeginLoadStats(IMG_LoadStats *stats, SDL_IOStream *src)
+{
+    SDL_zerop(stats);
+
+    if (GetCurrentStats() || !SDL_GetHintBoolean(IMG_HINT_LOAD_STATS, false)) {
+        return NULL;
+    }
+
+    stats->enabled = true;
+    stats->io = OpenStatsIO(stats, src);
+    IMG_ResumeLoadStats(stats, IMG_LOAD_PHASE_HEADER);
+    return stats->io;
+}
+
+void IMG_SuspendLoadStats(IMG_LoadStats *stats)
+{
+    if (!stats->active) {
+        return;
+    }
+
+    stats->phase_ns[stats->phase] += SDL_GetTicksNS() - stats->phase_start;
+    SDL_SetTLS(&current_stats, stats->prev, NULL);
+    stats->prev = NULL;
+    stats->active = false;
+    SDL_AddAtomicInt(&active_count, -1);
+}
+
+void IMG_ResumeLoadStats(IMG_LoadStats *stats, IMG_LoadPhase phase)
+{
+    if (!stats->enabled || stats->active) {
+        return;
+    }
+
+    /* If the TLS can't be set the hooks miss this load, but the stream still counts */
+    SDL_AddAtomicInt(&active_count, 1);
+    stats->prev = (IMG_LoadStats *)SDL_GetTLS(&current_stats);
+    SDL_SetTLS(&current_stats, stats, NULL);
+    stats->active = true;
+    stats->phase = phase;
+    stats->phase_start = SDL_GetTicksNS();
+}
+
+void IMG_PublishLoadStats(const IMG_LoadStats *stats, SDL_PropertiesID props)
+{
+    if (!stats->enabled || !props) {
+        return;
+    }
+
+    if (*stats->type) {
+        SDL_SetStringProperty(props, IMG_PROP_STATS_TYPE_STRING, stats->type);
+    }
+    SDL_SetNumberProperty(props, IMG_PROP_STATS_BYTES_READ_NUMBER, (Sint64)stats->bytes_read);
+    SDL_SetNumberProperty(props, IMG_PROP_STATS_READ_CALLS_NUMBER, (Sint64)stats->read_calls);
+    SDL_SetNumberProperty(props, IMG_PROP_STATS_SEEK_CALLS_NUMBER, (Sint64)stats->seek_calls);
+    SDL_SetNumberProperty(props, IMG_PROP_STATS_PROBES_NUMBER, (Sint64)stats->probes);
+    SDL_SetNumberProperty(props, IMG_PROP_STATS_BYTES_ALLOCATED_NUMBER, (Sint64)stats->bytes_allocated);
+    SDL_SetNumberProperty(props, IMG_PROP_STATS_HEADER_US_NUMBER, (Sint64)SDL_NS_TO_US(stats->phase_ns[IMG_LOAD_PHASE_HEADER]));
+    SDL_SetNumberProperty(props, IMG_PROP_STATS_DECODE_US_NUMBER, (Sint64)SDL_NS_TO_US(stats->phase_ns[IMG_LOAD_PHASE_DECODE]));
+    SDL_SetNumberProperty(props, IMG_PROP_STATS_CONVERT_US_NUMBER, (Sint64)SDL_NS_TO_US(stats->phase_ns[IMG_LOAD_PHASE_CONVERT]));
+    SDL_SetBooleanProperty(props, IMG_PROP_STATS_DISK_CACHE_HIT_BOOLEAN, stats->disk_cache_hit);
+}
+
+/* Find the totals for a format, adding them if `create` is true. Call with format_lock held */
+static IMG_FormatStats *FindFormat(const char *type, bool create)
+{
+    char key[sizeof(formats[0].type)];
+    int i;
+
+    for (i = 0; type[i] && i < (int)sizeof(key) - 1; ++i) {
+        key[i] = (char)SDL_toupper((unsigned char)type[i]);
+    }
+    key[i] = '\0';
+
+    for (i = 0; i < num_formats; ++i) {
+        if (SDL_strcmp(formats[i].type, key) == 0) {
+            return &formats[i].stats;
+        }
+    }
+    if (!create || num_formats == MAX_FORMATS) {
+        return NULL;
+    }
+
+    SDL_strlcpy(formats[num_formats].type, key, sizeof(formats[num_formats].type));
+    SDL_zero(formats[num_formats].stats);
+    return &formats[num_formats++].stats;
+}
+
+void IMG_EndLoadStats(IMG_LoadStats *stats, bool success)
+{
+    IMG_FormatStats *totals;
+
+    if (!stats->enabled) {
+        return;
+    }
+
+    IMG_SuspendLoadStats(stats);
+    if (stats->io) {
+        SDL_CloseIO(stats->io);
+        stats->io = NULL;
+    }
+
+    stats->enabled = false;
+
+    if (!*stats->type) {
+        return;
+    }
+
+    SDL_LockSpinlock(&format_lock);
+    totals = FindFormat(stats->type, true);
+    if (totals) {
+        ++totals->loads;
+        if (!success) {
+            ++totals->failures;
+        }
+        totals->bytes_read += stats->bytes_read;
+        totals->read_calls += stats->read_calls;
+        totals->seek_calls += stats->seek_calls;
+        totals->probes += stats->probes;
+        totals->bytes_allocated += stats->bytes_allocated;
+        totals->header_us += SDL_NS_TO_US(stats->phase_ns[IMG_LOAD_PHASE_HEADER]);
+        totals->decode_us += SDL_NS_TO_US(stats->phase_ns[IMG_LOAD_PHASE_DECODE]);
+        totals->convert_us += SDL_NS_TO_US(stats->phase_ns[IMG_LOAD_PHASE_CONVERT]);
+    }
+    SDL_UnlockSpinlock(&format_lock);
+}
+
+void IMG_FinishLoadStats(IMG_LoadStats *stats, SDL_Surface *surface)
+{
+    if (!stats->enabled) {
+        return;
+    }
+
+    IMG_SuspendLoadStats(stats);
+    if (surface) {
+        if (!(surface->flags & SDL_SURFACE_PREALLOCATED)) {
+            stats->bytes_allocated += (Uint64)surface->pitch * surface->h;
+        }
+        IMG_PublishLoadStats(stats, SDL_GetSurfaceProperties(surface));
+    }
+    IMG_EndLoadStats(stats, surface != NULL);
+}
+
+void IMG_SetLoadType(const char *type)
+{
+    IMG_LoadStats *stats = GetCurrentStats();
+    int i;
+
+    if (!stats) {
+        return;
+    }
+
+    for (i = 0; type[i] && i < (int)sizeof(stats->type) - 1; ++i) {
+        stats->type[i] = (char)SDL_toupper((unsigned char)type[i]);
+    }
+    stats->type[i] = '\0';
+}
+
+void IMG_SetLoadPhase(IMG_LoadPhase phase)
+{
+    IMG_LoadStats *stats = GetCurrentStats();
+    Uint64 now;
+
+    if (!stats || stats->phase == phase) {
+        return;
+    }
+
+    now = SDL_GetTicksNS();
+    stats->phase_ns[stats->phase] += now - stats->phase_start;
+    stats->phase = phase;
+    stats->phase_start = now;
+}
+
+void IMG_CountLoadProbes(int count)
+{
+    IMG_LoadStats *stats = GetCurrentStats();
+
+    if (stats) {
+        stats->probes += count;
+    }
+}
+
+void IMG_CountLoadBytesRead(size_t size)
+{
+    IMG_LoadStats *stats = GetCurrentStats();
+
+    if (stats) {
+        stats->bytes_read += size;
+    }
+}
+
+void IMG_CountLoadAllocation(size_t size)
+{
+    IMG_LoadStats *stats = GetCurrentStats();
+
+    if (stats) {
+        stats->bytes_allocated += size;
+    }
+}
+
+void IMG_CountDiskCacheHit(void)
+{
+    IMG_LoadStats *stats = GetCurrentStats();
+
+    if (stats) {
+        stats->disk_cache_hit = true;
+    }
+}
+
+bool IMG_GetFormatStats(const char *type, IMG_FormatStats *stats)
+{
+    IMG_FormatStats *totals;
+
+    if (!type || !*type) {
+        return SDL_InvalidParamError("type");
+    }
+    if (!stats) {
+        return SDL_InvalidParamError("stats");
+    }
+
+    SDL_LockSpinlock(&format_lock);
+    totals = FindFormat(type, false);
+    if (totals) {
+        *stats = *totals;
+    } else {
+        SDL_zerop(stats);
+    }
+    SDL_UnlockSpinlock(&format_lock);
+    return true;
+}
+
+void IMG_ResetFormatStats(void)
+{
+    SDL_LockSpinlock(&format_lock);
+    num_formats = 0;
+    SDL_UnlockSpinlock(&format_lock);
+}
@@ -0,0 +1,92 @@
+/*
+  SDL_image:  An example image loading library for use with SDL
+  Copyright (C) 1997-2025 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+/* Per-load statistics, see IMG_HINT_LOAD_STATS.
+ *
+ * The generic load functions begin collecting statistics for a load when
+ * the hint is set, and read the image through a stream that counts the
+ * reads and seeks. While a load is active on a thread, the decoders report
+ * the phase they are in with IMG_SetLoadPhase(), and the allocators and
+ * in place readers report what they did. Loads nested in another load on
+ * the same thread are counted as part of the outer load.
+ *
+ * All the hooks return right away when no load is being measured.
+ */
+
+typedef enum IMG_LoadPhase
+{
+    IMG_LOAD_PHASE_HEADER,      /* detecting the format and reading the header */
+    IMG_LOAD_PHASE_DECODE,      /* decoding the pixels */
+    IMG_LOAD_PHASE_CONVERT,     /* converting or scaling the decoded pixels */
+    IMG_LOAD_PHASE_COUNT
+} IMG_LoadPhase;
+
+typedef struct IMG_LoadStats IMG_LoadStats;
+
+struct IMG_LoadStats
+{
+    bool enabled;
+    bool active;                /* true while installed as this thread's stats */
+    char type[16];              /* the format being loaded, empty until it's known */
+    SDL_IOStream *io;           /* the stream counting reads and seeks */
+    Uint64 bytes_read;
+    Uint64 read_calls;
+    Uint64 seek_calls;
+    Uint64 probes;
+    Uint64 bytes_allocated;
+    bool disk_cache_hit;        /* true if the image came from the disk cache */
+    Uint64 phase_ns[IMG_LOAD_PHASE_COUNT];
+    IMG_LoadPhase phase;
+    Uint64 phase_start;
+    IMG_LoadStats *prev;        /* the stats that were active before these */
+};
+
+/* Start collecting statistics if the hint is set and no load is being
+ * measured on this thread. Returns a stream reading from `src` that should
+ * be used for the load, or NULL if statistics aren't collected or the
+ * stream can't be created, in which case `src` should be used.
+ */
+extern SDL_IOStream *IMG_BeginLoadStats(IMG_LoadStats *stats, SDL_IOStream *src);
+
+/* Stop and restart collecting statistics around calls into a decoder */
+extern void IMG_SuspendLoadStats(IMG_LoadStats *stats);
+extern void IMG_ResumeLoadStats(IMG_LoadStats *stats, IMG_LoadPhase phase);
+
+/* Set the statistics of a load as properties */
+extern void IMG_PublishLoadStats(const IMG_LoadStats *stats, SDL_PropertiesID props);
+
+/* Stop collecting statistics, close the counting stream and add the load
+ * to the totals for its format.
+ */
+extern void IMG_EndLoadStats(IMG_LoadStats *stats, bool success);
+
+/* End the statistics of a load that returns `surface`, and set them as
+ * properties of the surface.
+ */
+extern void IMG_FinishLoadStats(IMG_LoadStats *stats, SDL_Surface *surface);
+
+/* Hooks for the decoders and helpers */
+extern void IMG_SetLoadType(const char *type);
+extern void IMG_SetLoadPhase(IMG_LoadPhase phase);
+extern void IMG_CountLoadProbes(int count);
+extern void IMG_CountLoadBytesRead(size_t size);
+extern void IMG_CountLoadAllocation(size_t size);
+extern void IMG_CountDiskCacheHit(void);
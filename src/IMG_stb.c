@@ -21,6 +21,11 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_info.h"
+#include "IMG_limits.h"
+#include "IMG_progress.h"
+#include "IMG_stats.h"
+
 #ifdef USE_STBIMAGE
 
 #define malloc SDL_malloc
@@ -58,7 +63,14 @@
 
 static int IMG_LoadSTB_IO_read(void *user, char *data, int size)
 {
-    size_t amount = SDL_ReadIO((SDL_IOStream*)user, data, size);
+    SDL_IOStream *src = (SDL_IOStream*)user;
+    size_t amount;
+
+    /* stb_image can't report rows, so report how much of the file has been read */
+    if (IMG_IsLoadProgressActive() && !IMG_UpdateLoadProgress(SDL_TellIO(src), SDL_GetIOSize(src))) {
+        return 0;
+    }
+    amount = SDL_ReadIO(src, data, size);
     return (int)amount;
 }
 
@@ -73,6 +85,32 @@ static int IMG_LoadSTB_IO_eof(void *user)
     return SDL_GetIOStatus(src) == SDL_IO_STATUS_EOF;
 }
 
+/* stb_image allocates the pixels before it returns the size, so check the header first */
+static bool CheckSTBImageLimits(SDL_IOStream *src, bool is_png, bool use_palette)
+{
+    SDL_PropertiesID props = SDL_CreateProperties();
+    SDL_PixelFormat format;
+    bool result = true;
+
+    if (!props) {
+        return true;
+    }
+    if (is_png ? IMG_GetPNGInfo_IO(src, props) : IMG_GetJPGInfo_IO(src, props)) {
+        /* stb_image returns 8 bits per channel, with 1 channel for palettes and grayscale */
+        if (SDL_GetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, false) && !use_palette) {
+            format = SDL_PIXELFORMAT_RGBA32;
+        } else if (use_palette || SDL_ISPIXELFORMAT_INDEXED((SDL_PixelFormat)SDL_GetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN))) {
+            format = SDL_PIXELFORMAT_INDEX8;
+        } else {
+            format = SDL_PIXELFORMAT_RGB24;
+        }
+        result = IMG_CheckImageLimits(SDL_GetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, 0),
+                                      SDL_GetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, 0), format);
+    }
+    SDL_DestroyProperties(props);
+    return result;
+}
+
 SDL_Surface *IMG_LoadSTB_IO(SDL_IOStream *src)
 {
     Sint64 start;
@@ -81,6 +119,7 @@ SDL_Surface *IMG_LoadSTB_IO(SDL_IOStream *src)
     stbi_uc *pixels;
     stbi_io_callbacks rw_callbacks;
     SDL_Surface *surface = NULL;
+    bool is_png = false;
     bool use_palette = false;
     unsigned int palette_colors[256];
 
@@ -99,18 +138,29 @@ SDL_Surface *IMG_LoadSTB_IO(SDL_IOStream *src)
             magic[12] == 'I' &&
             magic[13] == 'H' &&
             magic[14] == 'D' &&
-            magic[15] == 'R' &&
-            magic[25] == PNG_COLOR_INDEXED) {
-            use_palette = true;
+            magic[15] == 'R') {
+            is_png = true;
+            if (magic[25] == PNG_COLOR_INDEXED) {
+                use_palette = true;
+            }
         }
     }
     SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
 
+    /* stb_image reads the header and the pixels in one call */
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     /* Load the image data */
     rw_callbacks.read = IMG_LoadSTB_IO_read;
     rw_callbacks.skip = IMG_LoadSTB_IO_skip;
     rw_callbacks.eof = IMG_LoadSTB_IO_eof;
     w = h = format = 0; /* silence warning */
+    if (IMG_HasImageLimits()) {
+        bool within_limits = CheckSTBImageLimits(src, is_png, use_palette);
+        SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+        if (!within_limits) {
+            return NULL;
+        }
+    }
     if (use_palette) {
         /* Unused palette entries will be opaque white */
         SDL_memset(palette_colors, 0xff, sizeof(palette_colors));
@@ -138,6 +188,7 @@ SDL_Surface *IMG_LoadSTB_IO(SDL_IOStream *src)
         return NULL;
     }
 
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_CONVERT);
     if (use_palette) {
         surface = SDL_CreateSurfaceFrom(
             w,
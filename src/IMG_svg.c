@@ -25,6 +25,10 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_load_options.h"
+#include "IMG_progress.h"
+#include "IMG_stats.h"
+
 #ifdef LOAD_SVG
 
 /* Replace C runtime functions with SDL C runtime functions for building on Windows */
@@ -72,6 +76,7 @@
 #undef HAVE_STDIO_H
 
 #define NSVG_EXPORT static
+#define NSVG_PROGRESS(done, total) IMG_UpdateLoadProgress(done, total)
 #define NANOSVG_IMPLEMENTATION
 #include "nanosvg.h"
 #define NANOSVGRAST_IMPLEMENTATION
@@ -102,8 +107,7 @@ bool IMG_isSVG(SDL_IOStream *src)
     return is_SVG;
 }
 
-/* Load a SVG type image from an SDL datasource */
-SDL_Surface *IMG_LoadSizedSVG_IO(SDL_IOStream *src, int width, int height)
+static SDL_Surface *LoadSVG_IO(SDL_IOStream *src, int width, int height, IMG_LoadOptions *options)
 {
     char *data;
     struct NSVGimage *image;
@@ -124,6 +128,7 @@ SDL_Surface *IMG_LoadSizedSVG_IO(SDL_IOStream *src, int width, int height)
         return NULL;
     }
 
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     rasterizer = nsvgCreateRasterizer();
     if (!rasterizer) {
         SDL_SetError("Couldn't create SVG rasterizer");
@@ -144,9 +149,16 @@ SDL_Surface *IMG_LoadSizedSVG_IO(SDL_IOStream *src, int width, int height)
         scale = 1.0f;
     }
 
-    surface = SDL_CreateSurface((int)SDL_ceilf(image->width * scale),
-                                (int)SDL_ceilf(image->height * scale),
-                                SDL_PIXELFORMAT_RGBA32);
+    width = (int)SDL_ceilf(image->width * scale);
+    height = (int)SDL_ceilf(image->height * scale);
+
+    /* Rasterize directly at the scaled size */
+    if (options && IMG_GetLoadSize(options, width, height, &width, &height)) {
+        scale = SDL_min(width / image->width, height / image->height);
+        options->scale_denom = 1;
+    }
+
+    surface = IMG_CreateLoadSurface(width, height, SDL_PIXELFORMAT_RGBA32, options);
 
     if (!surface) {
         nsvgDeleteRasterizer(rasterizer);
@@ -158,9 +170,24 @@ SDL_Surface *IMG_LoadSizedSVG_IO(SDL_IOStream *src, int width, int height)
     nsvgDeleteRasterizer(rasterizer);
     nsvgDelete(image);
 
+    if (IMG_IsLoadCancelled()) {
+        SDL_DestroySurface(surface);
+        return NULL;
+    }
     return surface;
 }
 
+/* Load a SVG type image from an SDL datasource */
+SDL_Surface *IMG_LoadSizedSVG_IO(SDL_IOStream *src, int width, int height)
+{
+    return LoadSVG_IO(src, width, height, NULL);
+}
+
+SDL_Surface *IMG_LoadSVGWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return LoadSVG_IO(src, 0, 0, options);
+}
+
 #else
 
 /* See if an image is contained in a data source */
@@ -176,6 +203,11 @@ SDL_Surface *IMG_LoadSizedSVG_IO(SDL_IOStream *src, int width, int height)
     return NULL;
 }
 
+SDL_Surface *IMG_LoadSVGWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return IMG_LoadSizedSVG_IO(src, 0, 0);
+}
+
 #endif /* LOAD_SVG */
 
 /* Load a SVG type image from an SDL datasource */
@@ -25,6 +25,10 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_info.h"
+#include "IMG_load_options.h"
+#include "IMG_stats.h"
+
 // We will have TGA saving feature by default.
 #ifndef SAVE_TGA
 #define SAVE_TGA 1
@@ -86,8 +90,8 @@ enum tga_type {
  * 2000-08-09 Mattias Engdegård <f91-men@nada.kth.se>: alpha inversion removed
  */
 
-/* Load a TGA type image from an SDL datasource */
-SDL_Surface *IMG_LoadTGA_IO(SDL_IOStream *src)
+/* Load a TGA type image from an SDL datasource, with optional load options */
+static SDL_Surface *LoadTGA_IO(SDL_IOStream *src, IMG_LoadOptions *options)
 {
     Sint64 start;
     const char *error = NULL;
@@ -182,9 +186,10 @@ SDL_Surface *IMG_LoadTGA_IO(SDL_IOStream *src)
 
     SDL_SeekIO(src, hdr.infolen, SDL_IO_SEEK_CUR); /* skip info field */
 
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     w = LE16(hdr.width);
     h = LE16(hdr.height);
-    img = SDL_CreateSurface(w, h, format);
+    img = IMG_CreateLoadSurface(w, h, format, options);
     if (img == NULL) {
         error = "Out of memory";
         goto error;
@@ -341,6 +346,12 @@ error:
     return NULL;
 }
 
+/* Load a TGA type image from an SDL datasource */
+SDL_Surface *IMG_LoadTGA_IO(SDL_IOStream *src)
+{
+    return LoadTGA_IO(src, NULL);
+}
+
 #else
 
 /* dummy TGA load routine */
@@ -354,6 +365,101 @@ SDL_Surface *IMG_LoadTGA_IO(SDL_IOStream *src)
 
 #endif /* !defined(__APPLE__) || defined(SDL_IMAGE_USE_COMMON_BACKEND) */
 
+#if defined(LOAD_TGA) && (!defined(__APPLE__) || defined(SDL_IMAGE_USE_COMMON_BACKEND))
+
+/* Get TGA image information from the header, matching IMG_LoadTGA_IO() */
+bool IMG_GetTGAInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    struct TGAheader hdr;
+    SDL_PixelFormat format;
+    int depth;
+    bool alpha = false;
+
+    if (SDL_ReadIO(src, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+        return SDL_SetError("Error reading TGA data");
+    }
+
+    switch (hdr.type) {
+    case TGA_TYPE_INDEXED:
+    case TGA_TYPE_RLE_INDEXED:
+        if (!hdr.has_cmap || hdr.pixel_bits != 8 || LE16(hdr.cmap_len) > 256) {
+            return SDL_SetError("Unsupported TGA format");
+        }
+        /* A 32-bit colormap provides a colorkey */
+        alpha = (hdr.cmap_bits == 32);
+        break;
+    case TGA_TYPE_RGB:
+    case TGA_TYPE_RLE_RGB:
+        if (hdr.pixel_bits == 8) {
+            return SDL_SetError("Unsupported TGA format");
+        }
+        break;
+    case TGA_TYPE_BW:
+    case TGA_TYPE_RLE_BW:
+        if (hdr.pixel_bits != 8) {
+            return SDL_SetError("Unsupported TGA format");
+        }
+        break;
+    default:
+        return SDL_SetError("Unsupported TGA format");
+    }
+
+    switch (hdr.pixel_bits) {
+    case 8:
+        format = SDL_PIXELFORMAT_INDEX8;
+        depth = 8;
+        break;
+    case 15:
+    case 16:
+        format = SDL_PIXELFORMAT_XRGB1555;
+        depth = 5;
+        break;
+    case 24:
+        format = SDL_PIXELFORMAT_BGR24;
+        depth = 8;
+        break;
+    case 32:
+        format = SDL_PIXELFORMAT_BGRA32;
+        depth = 8;
+        alpha = true;
+        break;
+    default:
+        return SDL_SetError("Unsupported TGA format");
+    }
+
+    if ((hdr.flags & TGA_INTERLEAVE_MASK) != TGA_INTERLEAVE_NONE
+       || hdr.flags & TGA_ORIGIN_RIGHT) {
+        return SDL_SetError("Unsupported TGA format");
+    }
+
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, LE16(hdr.width));
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, LE16(hdr.height));
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, format);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_BIT_DEPTH_NUMBER, depth);
+    SDL_SetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, alpha);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_FRAME_COUNT_NUMBER, 1);
+    return true;
+}
+
+SDL_Surface *IMG_LoadTGAWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return LoadTGA_IO(src, options);
+}
+
+#else
+
+bool IMG_GetTGAInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    return SDL_Unsupported();
+}
+
+SDL_Surface *IMG_LoadTGAWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return IMG_LoadTGA_IO(src);
+}
+
+#endif /* LOAD_TGA */
+
 #if SAVE_TGA
 
 bool IMG_SaveTGA_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio)
@@ -19,23 +19,33 @@
   3. This notice may not be removed or altered from any source distribution.
 */
 
-#if !(defined(__APPLE__) || defined(SDL_IMAGE_USE_WIC_BACKEND)) || defined(SDL_IMAGE_USE_COMMON_BACKEND)
-
 /* This is a TIFF image file loading framework */
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_io.h"
+#include "IMG_limits.h"
+#include "IMG_load_options.h"
+#include "IMG_progress.h"
+#include "IMG_stats.h"
+
+#if !(defined(__APPLE__) || defined(SDL_IMAGE_USE_WIC_BACKEND)) || defined(SDL_IMAGE_USE_COMMON_BACKEND)
+
 #ifdef LOAD_TIF
 
 #include <tiffio.h>
 
 static struct {
-    int loaded;
+    SDL_InitState init;
     void *handle;
     TIFF* (*TIFFClientOpen)(const char*, const char*, thandle_t, TIFFReadWriteProc, TIFFReadWriteProc, TIFFSeekProc, TIFFCloseProc, TIFFSizeProc, TIFFMapFileProc, TIFFUnmapFileProc);
     void (*TIFFClose)(TIFF*);
     int (*TIFFGetField)(TIFF*, ttag_t, ...);
     int (*TIFFReadRGBAImageOriented)(TIFF*, Uint32, Uint32, Uint32*, int, int);
+    int (*TIFFRGBAImageOK)(TIFF*, char [1024]);
+    int (*TIFFRGBAImageBegin)(TIFFRGBAImage*, TIFF*, int, char [1024]);
+    int (*TIFFRGBAImageGet)(TIFFRGBAImage*, Uint32*, Uint32, Uint32);
+    void (*TIFFRGBAImageEnd)(TIFFRGBAImage*);
     TIFFErrorHandler (*TIFFSetErrorHandler)(TIFFErrorHandler);
 } lib;
 
@@ -48,37 +58,45 @@ static struct {
     lib.FUNC = FUNC;
 #endif
 
-static bool IMG_InitTIF(void)
+static bool LoadTIFLibrary(void)
 {
-    if ( lib.loaded == 0 ) {
 #ifdef LOAD_TIF_DYNAMIC
-        lib.handle = SDL_LoadObject(LOAD_TIF_DYNAMIC);
-        if ( lib.handle == NULL ) {
-            return false;
-        }
-#endif
-        FUNCTION_LOADER(TIFFClientOpen, TIFF * (*)(const char*, const char*, thandle_t, TIFFReadWriteProc, TIFFReadWriteProc, TIFFSeekProc, TIFFCloseProc, TIFFSizeProc, TIFFMapFileProc, TIFFUnmapFileProc))
-        FUNCTION_LOADER(TIFFClose, void (*)(TIFF*))
-        FUNCTION_LOADER(TIFFGetField, int (*)(TIFF*, ttag_t, ...))
-        FUNCTION_LOADER(TIFFReadRGBAImageOriented, int (*)(TIFF*, Uint32, Uint32, Uint32*, int, int))
-        FUNCTION_LOADER(TIFFSetErrorHandler, TIFFErrorHandler (*)(TIFFErrorHandler))
+    lib.handle = SDL_LoadObject(LOAD_TIF_DYNAMIC);
+    if ( lib.handle == NULL ) {
+        return false;
     }
-    ++lib.loaded;
+#endif
+    FUNCTION_LOADER(TIFFClientOpen, TIFF * (*)(const char*, const char*, thandle_t, TIFFReadWriteProc, TIFFReadWriteProc, TIFFSeekProc, TIFFCloseProc, TIFFSizeProc, TIFFMapFileProc, TIFFUnmapFileProc))
+    FUNCTION_LOADER(TIFFClose, void (*)(TIFF*))
+    FUNCTION_LOADER(TIFFGetField, int (*)(TIFF*, ttag_t, ...))
+    FUNCTION_LOADER(TIFFReadRGBAImageOriented, int (*)(TIFF*, Uint32, Uint32, Uint32*, int, int))
+    FUNCTION_LOADER(TIFFRGBAImageOK, int (*)(TIFF*, char [1024]))
+    FUNCTION_LOADER(TIFFRGBAImageBegin, int (*)(TIFFRGBAImage*, TIFF*, int, char [1024]))
+    FUNCTION_LOADER(TIFFRGBAImageGet, int (*)(TIFFRGBAImage*, Uint32*, Uint32, Uint32))
+    FUNCTION_LOADER(TIFFRGBAImageEnd, void (*)(TIFFRGBAImage*))
+    FUNCTION_LOADER(TIFFSetErrorHandler, TIFFErrorHandler (*)(TIFFErrorHandler))
+
+    return true;
+}
 
+static bool IMG_InitTIF(void)
+{
+    if (SDL_ShouldInit(&lib.init)) {
+        bool initialized = LoadTIFLibrary();
+        SDL_SetInitialized(&lib.init, initialized);
+        return initialized;
+    }
     return true;
 }
 #if 0
 void IMG_QuitTIF(void)
 {
-    if ( lib.loaded == 0 ) {
-        return;
-    }
-    if ( lib.loaded == 1 ) {
+    if (SDL_ShouldQuit(&lib.init)) {
 #ifdef LOAD_TIF_DYNAMIC
         SDL_UnloadObject(lib.handle);
 #endif
+        SDL_SetInitialized(&lib.init, false);
     }
-    --lib.loaded;
 }
 #endif // 0
 
@@ -113,7 +131,17 @@ static int tiff_close(thandle_t fd)
 
 static int tiff_map(thandle_t fd, tdata_t* pbase, toff_t* psize)
 {
-    return (0);
+    /* Memory streams are read in place, libtiff falls back to tiff_read() for the rest */
+    const Uint8 *mem;
+    size_t size = 0;
+
+    mem = IMG_GetIOMemory((SDL_IOStream*)fd, &size);
+    if (!mem) {
+        return 0;
+    }
+    *pbase = (tdata_t)mem;
+    *psize = (toff_t)size;
+    return 1;
 }
 
 static void tiff_unmap(thandle_t fd, tdata_t base, toff_t size)
@@ -161,12 +189,53 @@ bool IMG_isTIF(SDL_IOStream * src)
     return is_TIF;
 }
 
-SDL_Surface* IMG_LoadTIF_IO(SDL_IOStream * src)
+/* Read a region of the image, a band of strips or tiles at a time while the
+ * load can be cancelled.
+ */
+static bool ReadTIFRegion(TIFF *tiff, const SDL_Rect *region, SDL_Surface *surface)
+{
+    TIFFRGBAImage img;
+    char emsg[1024];
+    Uint32 band = 0;
+    int y, rows;
+    bool result = true;
+
+    if (!lib.TIFFRGBAImageOK(tiff, emsg) || !lib.TIFFRGBAImageBegin(&img, tiff, 0, emsg)) {
+        return SDL_SetError("%s", emsg);
+    }
+    img.req_orientation = ORIENTATION_TOPLEFT;
+    img.col_offset = region->x;
+
+    /* Images stored bottom up or mirrored are flipped within each call, so read them at once */
+    if (IMG_IsLoadProgressActive() && img.orientation == ORIENTATION_TOPLEFT) {
+        if (!lib.TIFFGetField(tiff, TIFFTAG_TILELENGTH, &band)) {
+            lib.TIFFGetField(tiff, TIFFTAG_ROWSPERSTRIP, &band);
+        }
+    }
+    if (band == 0 || band > (Uint32)region->h) {
+        band = (Uint32)region->h;
+    }
+
+    for (y = 0; y < region->h && result; y += rows) {
+        if (!IMG_UpdateLoadProgress(y, region->h)) {
+            result = false;
+            break;
+        }
+        rows = SDL_min((int)band, region->h - y);
+        img.row_offset = region->y + y;
+        result = lib.TIFFRGBAImageGet(&img, (Uint32 *)((Uint8 *)surface->pixels + y * surface->pitch), region->w, rows) != 0;
+    }
+    lib.TIFFRGBAImageEnd(&img);
+    return result;
+}
+
+static SDL_Surface *LoadTIF_IO(SDL_IOStream *src, IMG_LoadOptions *options)
 {
     Sint64 start;
     TIFF* tiff = NULL;
     SDL_Surface* surface = NULL;
     Uint32 img_width, img_height;
+    SDL_Rect region;
 
     if ( !src ) {
         /* The error message has been set in SDL_IOFromFile */
@@ -178,8 +247,7 @@ SDL_Surface* IMG_LoadTIF_IO(SDL_IOStream * src)
         return NULL;
     }
 
-    /* turn off memory mapped access with the m flag */
-    tiff = lib.TIFFClientOpen("SDL_image", "rm", (thandle_t)src,
+    tiff = lib.TIFFClientOpen("SDL_image", "r", (thandle_t)src,
         tiff_read, tiff_write, tiff_seek, tiff_close, tiff_size, tiff_map, tiff_unmap);
     if(!tiff)
         goto error;
@@ -188,12 +256,41 @@ SDL_Surface* IMG_LoadTIF_IO(SDL_IOStream * src)
     lib.TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &img_width);
     lib.TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &img_height);
 
-    surface = SDL_CreateSurface(img_width, img_height, SDL_PIXELFORMAT_ABGR8888);
-    if(!surface)
-        goto error;
-
-    if(!lib.TIFFReadRGBAImageOriented(tiff, img_width, img_height, (Uint32 *)surface->pixels, ORIENTATION_TOPLEFT, 0))
-        goto error;
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
+    if (options && options->region) {
+        if (!IMG_GetLoadRegion(options, img_width, img_height, &region))
+            goto error;
+        options->region = NULL;
+
+        if(!IMG_CheckImageLimits(region.w, region.h, SDL_PIXELFORMAT_ABGR8888))
+            goto error;
+
+        surface = SDL_CreateSurface(region.w, region.h, SDL_PIXELFORMAT_ABGR8888);
+        if(!surface)
+            goto error;
+
+        if(!ReadTIFRegion(tiff, &region, surface))
+            goto error;
+    } else {
+        if(!IMG_CheckImageLimits(img_width, img_height, SDL_PIXELFORMAT_ABGR8888))
+            goto error;
+
+        surface = SDL_CreateSurface(img_width, img_height, SDL_PIXELFORMAT_ABGR8888);
+        if(!surface)
+            goto error;
+
+        if (IMG_IsLoadProgressActive()) {
+            region.x = 0;
+            region.y = 0;
+            region.w = (int)img_width;
+            region.h = (int)img_height;
+            if(!ReadTIFRegion(tiff, &region, surface))
+                goto error;
+        } else {
+            if(!lib.TIFFReadRGBAImageOriented(tiff, img_width, img_height, (Uint32 *)surface->pixels, ORIENTATION_TOPLEFT, 0))
+                goto error;
+        }
+    }
 
     lib.TIFFClose(tiff);
 
@@ -210,6 +307,16 @@ error:
     return NULL;
 }
 
+SDL_Surface *IMG_LoadTIF_IO(SDL_IOStream *src)
+{
+    return LoadTIF_IO(src, NULL);
+}
+
+SDL_Surface *IMG_LoadTIFWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return LoadTIF_IO(src, options);
+}
+
 #else
 
 /* See if an image is contained in a data source */
@@ -228,3 +335,12 @@ SDL_Surface *IMG_LoadTIF_IO(SDL_IOStream *src)
 #endif /* LOAD_TIF */
 
 #endif /* !defined(__APPLE__) || defined(SDL_IMAGE_USE_COMMON_BACKEND) */
+
+#if !defined(LOAD_TIF) || ((defined(__APPLE__) || defined(SDL_IMAGE_USE_WIC_BACKEND)) && !defined(SDL_IMAGE_USE_COMMON_BACKEND))
+
+SDL_Surface *IMG_LoadTIFWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return IMG_LoadTIF_IO(src);
+}
+
+#endif
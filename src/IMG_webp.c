@@ -24,6 +24,11 @@
 #include <SDL3_image/SDL_image.h>
 
 #include "IMG_webp.h"
+#include "IMG_info.h"
+#include "IMG_io.h"
+#include "IMG_limits.h"
+#include "IMG_load_options.h"
+#include "IMG_stats.h"
 #include "IMG_anim_encoder.h"
 #include "IMG_anim_decoder.h"
 #include "xmlman.h"
@@ -59,7 +64,7 @@
 
 static struct
 {
-    int loaded;
+    SDL_InitState init;
     void *handle_libwebpdemux;
     void *handle_libwebp;
     void *handle_libwebpmux;
@@ -67,6 +72,8 @@ static struct
     VP8StatusCode (*WebPGetFeaturesInternal)(const uint8_t *data, size_t data_size, WebPBitstreamFeatures *features, int decoder_abi_version);
     uint8_t *(*WebPDecodeRGBInto)(const uint8_t *data, size_t data_size, uint8_t *output_buffer, size_t output_buffer_size, int output_stride);
     uint8_t *(*WebPDecodeRGBAInto)(const uint8_t *data, size_t data_size, uint8_t *output_buffer, size_t output_buffer_size, int output_stride);
+    int (*WebPInitDecoderConfigInternal)(WebPDecoderConfig *config, int version);
+    VP8StatusCode (*WebPDecode)(const uint8_t *data, size_t data_size, WebPDecoderConfig *config);
     WebPDemuxer *(*WebPDemuxInternal)(const WebPData *data, int allow_partial, WebPDemuxState *state, int version);
     int (*WebPDemuxGetFrame)(const WebPDemuxer *dmux, int frame_number, WebPIterator *iter);
     int (*WebPDemuxNextFrame)(WebPIterator *iter);
@@ -150,84 +157,90 @@ static struct
 /* Need to turn off optimizations so weak framework load check works */
 __attribute__((optnone))
 #endif
-static bool IMG_InitWEBP(void)
+static bool LoadWEBPLibrary(void)
 {
-    if (lib.loaded == 0) {
 #if defined(LOAD_WEBP_DYNAMIC) && defined(LOAD_WEBPDEMUX_DYNAMIC) && defined(LOAD_WEBPMUX_DYNAMIC)
-        lib.handle_libwebp = SDL_LoadObject(LOAD_WEBP_DYNAMIC);
-        if (lib.handle_libwebp == NULL) {
-            return false;
-        }
-        lib.handle_libwebpdemux = SDL_LoadObject(LOAD_WEBPDEMUX_DYNAMIC);
-        if (lib.handle_libwebpdemux == NULL) {
-            return false;
-        }
-        lib.handle_libwebpmux = SDL_LoadObject(LOAD_WEBPMUX_DYNAMIC);
-        if (lib.handle_libwebpmux == NULL) {
-            return false;
-        }
+    lib.handle_libwebp = SDL_LoadObject(LOAD_WEBP_DYNAMIC);
+    if (lib.handle_libwebp == NULL) {
+        return false;
+    }
+    lib.handle_libwebpdemux = SDL_LoadObject(LOAD_WEBPDEMUX_DYNAMIC);
+    if (lib.handle_libwebpdemux == NULL) {
+        return false;
+    }
+    lib.handle_libwebpmux = SDL_LoadObject(LOAD_WEBPMUX_DYNAMIC);
+    if (lib.handle_libwebpmux == NULL) {
+        return false;
+    }
 #endif
-        FUNCTION_LOADER_LIBWEBP(WebPGetFeaturesInternal, VP8StatusCode(*)(const uint8_t *data, size_t data_size, WebPBitstreamFeatures *features, int decoder_abi_version))
-        FUNCTION_LOADER_LIBWEBP(WebPDecodeRGBInto, uint8_t *(*)(const uint8_t *data, size_t data_size, uint8_t *output_buffer, size_t output_buffer_size, int output_stride))
-        FUNCTION_LOADER_LIBWEBP(WebPDecodeRGBAInto, uint8_t *(*)(const uint8_t *data, size_t data_size, uint8_t *output_buffer, size_t output_buffer_size, int output_stride))
-        FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxInternal, WebPDemuxer * (*)(const WebPData *, int, WebPDemuxState *, int))
-        FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxGetFrame, int (*)(const WebPDemuxer *dmux, int frame_number, WebPIterator *iter))
-        FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxNextFrame, int (*)(WebPIterator *iter))
-        FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxReleaseIterator, void (*)(WebPIterator *iter))
-        FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxGetI, uint32_t (*)(const WebPDemuxer *dmux, WebPFormatFeature feature))
-        FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxDelete, void (*)(WebPDemuxer *dmux))
-
-        // Encoding frame functions
-        FUNCTION_LOADER_LIBWEBP(WebPConfigInitInternal, int (*)(WebPConfig *, WebPPreset, float, int))
-        FUNCTION_LOADER_LIBWEBP(WebPValidateConfig, int (*)(const WebPConfig *))
-        FUNCTION_LOADER_LIBWEBP(WebPPictureInitInternal, int (*)(WebPPicture *, int))
-        FUNCTION_LOADER_LIBWEBP(WebPEncode, int (*)(const WebPConfig *, WebPPicture *))
-        FUNCTION_LOADER_LIBWEBP(WebPPictureFree, void (*)(WebPPicture *))
-        FUNCTION_LOADER_LIBWEBP(WebPPictureImportRGBA, int (*)(WebPPicture *, const uint8_t *, int))
-
-        FUNCTION_LOADER_LIBWEBP(WebPMemoryWriterInit, void (*)(WebPMemoryWriter *))
-        FUNCTION_LOADER_LIBWEBP(WebPMemoryWrite, int (*)(const uint8_t *, size_t, const WebPPicture *))
-        FUNCTION_LOADER_LIBWEBP(WebPMemoryWriterClear, void (*)(WebPMemoryWriter *))
-
-        // Free function required for cleanup after muxing.
-        FUNCTION_LOADER_LIBWEBP(WebPFree, void (*)(void *))
-
-        // Muxing functions
-        FUNCTION_LOADER_LIBWEBPMUX(WebPAnimEncoderNewInternal, WebPAnimEncoder * (*)(int, int, const WebPAnimEncoderOptions *, int))
-        FUNCTION_LOADER_LIBWEBPMUX(WebPAnimEncoderOptionsInitInternal, int (*)(WebPAnimEncoderOptions *, int))
-        FUNCTION_LOADER_LIBWEBPMUX(WebPAnimEncoderAdd, int (*)(WebPAnimEncoder *, WebPPicture *, int, const WebPConfig *))
-        FUNCTION_LOADER_LIBWEBPMUX(WebPAnimEncoderAssemble, int (*)(WebPAnimEncoder *, WebPData *))
-        FUNCTION_LOADER_LIBWEBPMUX(WebPAnimEncoderDelete, void (*)(WebPAnimEncoder *))
-
-        // Used for extracting EXIF & XMP chunks.
-        FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxGetChunk, int (*)(const WebPDemuxer *dmux, const char fourcc[4], int chunk_number, WebPChunkIterator *iter))
-        FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxReleaseChunkIterator, void (*)(WebPChunkIterator* iter))
-
-        // Used for setting EXIF & XMP chunks and for loop count.
-        FUNCTION_LOADER_LIBWEBPMUX(WebPMuxCreateInternal, WebPMux * (*)(const WebPData*, int, int))
-        FUNCTION_LOADER_LIBWEBPMUX(WebPMuxDelete, void (*)(WebPMux* mux))
-        FUNCTION_LOADER_LIBWEBPMUX(WebPMuxSetChunk, WebPMuxError (*)(WebPMux *mux, const char fourcc[4], const WebPData *chunk_data, int copy_data))
-        FUNCTION_LOADER_LIBWEBPMUX(WebPMuxGetAnimationParams, WebPMuxError (*)(const WebPMux* mux, WebPMuxAnimParams* params))
-        FUNCTION_LOADER_LIBWEBPMUX(WebPMuxSetAnimationParams, WebPMuxError (*)(WebPMux* mux, const WebPMuxAnimParams* params))
-        FUNCTION_LOADER_LIBWEBPMUX(WebPMuxAssemble, WebPMuxError (*)(WebPMux* mux, WebPData* assembled_data))
-    }
-    ++lib.loaded;
+    FUNCTION_LOADER_LIBWEBP(WebPGetFeaturesInternal, VP8StatusCode(*)(const uint8_t *data, size_t data_size, WebPBitstreamFeatures *features, int decoder_abi_version))
+    FUNCTION_LOADER_LIBWEBP(WebPDecodeRGBInto, uint8_t *(*)(const uint8_t *data, size_t data_size, uint8_t *output_buffer, size_t output_buffer_size, int output_stride))
+    FUNCTION_LOADER_LIBWEBP(WebPDecodeRGBAInto, uint8_t *(*)(const uint8_t *data, size_t data_size, uint8_t *output_buffer, size_t output_buffer_size, int output_stride))
+    FUNCTION_LOADER_LIBWEBP(WebPInitDecoderConfigInternal, int (*)(WebPDecoderConfig *config, int version))
+    FUNCTION_LOADER_LIBWEBP(WebPDecode, VP8StatusCode (*)(const uint8_t *data, size_t data_size, WebPDecoderConfig *config))
+    FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxInternal, WebPDemuxer * (*)(const WebPData *, int, WebPDemuxState *, int))
+    FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxGetFrame, int (*)(const WebPDemuxer *dmux, int frame_number, WebPIterator *iter))
+    FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxNextFrame, int (*)(WebPIterator *iter))
+    FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxReleaseIterator, void (*)(WebPIterator *iter))
+    FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxGetI, uint32_t (*)(const WebPDemuxer *dmux, WebPFormatFeature feature))
+    FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxDelete, void (*)(WebPDemuxer *dmux))
+
+    // Encoding frame functions
+    FUNCTION_LOADER_LIBWEBP(WebPConfigInitInternal, int (*)(WebPConfig *, WebPPreset, float, int))
+    FUNCTION_LOADER_LIBWEBP(WebPValidateConfig, int (*)(const WebPConfig *))
+    FUNCTION_LOADER_LIBWEBP(WebPPictureInitInternal, int (*)(WebPPicture *, int))
+    FUNCTION_LOADER_LIBWEBP(WebPEncode, int (*)(const WebPConfig *, WebPPicture *))
+    FUNCTION_LOADER_LIBWEBP(WebPPictureFree, void (*)(WebPPicture *))
+    FUNCTION_LOADER_LIBWEBP(WebPPictureImportRGBA, int (*)(WebPPicture *, const uint8_t *, int))
+
+    FUNCTION_LOADER_LIBWEBP(WebPMemoryWriterInit, void (*)(WebPMemoryWriter *))
+    FUNCTION_LOADER_LIBWEBP(WebPMemoryWrite, int (*)(const uint8_t *, size_t, const WebPPicture *))
+    FUNCTION_LOADER_LIBWEBP(WebPMemoryWriterClear, void (*)(WebPMemoryWriter *))
+
+    // Free function required for cleanup after muxing.
+    FUNCTION_LOADER_LIBWEBP(WebPFree, void (*)(void *))
+
+    // Muxing functions
+    FUNCTION_LOADER_LIBWEBPMUX(WebPAnimEncoderNewInternal, WebPAnimEncoder * (*)(int, int, const WebPAnimEncoderOptions *, int))
+    FUNCTION_LOADER_LIBWEBPMUX(WebPAnimEncoderOptionsInitInternal, int (*)(WebPAnimEncoderOptions *, int))
+    FUNCTION_LOADER_LIBWEBPMUX(WebPAnimEncoderAdd, int (*)(WebPAnimEncoder *, WebPPicture *, int, const WebPConfig *))
+    FUNCTION_LOADER_LIBWEBPMUX(WebPAnimEncoderAssemble, int (*)(WebPAnimEncoder *, WebPData *))
+    FUNCTION_LOADER_LIBWEBPMUX(WebPAnimEncoderDelete, void (*)(WebPAnimEncoder *))
+
+    // Used for extracting EXIF & XMP chunks.
+    FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxGetChunk, int (*)(const WebPDemuxer *dmux, const char fourcc[4], int chunk_number, WebPChunkIterator *iter))
+    FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxReleaseChunkIterator, void (*)(WebPChunkIterator* iter))
+
+    // Used for setting EXIF & XMP chunks and for loop count.
+    FUNCTION_LOADER_LIBWEBPMUX(WebPMuxCreateInternal, WebPMux * (*)(const WebPData*, int, int))
+    FUNCTION_LOADER_LIBWEBPMUX(WebPMuxDelete, void (*)(WebPMux* mux))
+    FUNCTION_LOADER_LIBWEBPMUX(WebPMuxSetChunk, WebPMuxError (*)(WebPMux *mux, const char fourcc[4], const WebPData *chunk_data, int copy_data))
+    FUNCTION_LOADER_LIBWEBPMUX(WebPMuxGetAnimationParams, WebPMuxError (*)(const WebPMux* mux, WebPMuxAnimParams* params))
+    FUNCTION_LOADER_LIBWEBPMUX(WebPMuxSetAnimationParams, WebPMuxError (*)(WebPMux* mux, const WebPMuxAnimParams* params))
+    FUNCTION_LOADER_LIBWEBPMUX(WebPMuxAssemble, WebPMuxError (*)(WebPMux* mux, WebPData* assembled_data))
 
     return true;
 }
+
+static bool IMG_InitWEBP(void)
+{
+    if (SDL_ShouldInit(&lib.init)) {
+        bool initialized = LoadWEBPLibrary();
+        SDL_SetInitialized(&lib.init, initialized);
+        return initialized;
+    }
+    return true;
+}
 #if 0
 void IMG_QuitWEBP(void)
 {
-    if (lib.loaded == 0) {
-        return;
-    }
-    if (lib.loaded == 1) {
+    if (SDL_ShouldQuit(&lib.init)) {
 #if defined(LOAD_WEBP_DYNAMIC) && defined(LOAD_WEBPDEMUX_DYNAMIC)
         SDL_UnloadObject(lib.handle_libwebp);
         SDL_UnloadObject(lib.handle_libwebpdemux);
 #endif
+        SDL_SetInitialized(&lib.init, false);
     }
-    --lib.loaded;
 }
 #endif // 0
 
@@ -277,16 +290,51 @@ bool IMG_isWEBP(SDL_IOStream *src)
     return webp_getinfo(src, NULL);
 }
 
-SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
+/* Get the libwebp colorspace that produces an 8-bit pixel format directly */
+static bool GetWEBPColorspace(SDL_PixelFormat format, int has_alpha, WEBP_CSP_MODE *mode)
+{
+    switch (format) {
+    case SDL_PIXELFORMAT_RGB24:
+        *mode = MODE_RGB;
+        break;
+    case SDL_PIXELFORMAT_BGR24:
+        *mode = MODE_BGR;
+        break;
+    case SDL_PIXELFORMAT_RGBA32:
+    case SDL_PIXELFORMAT_RGBX32:
+        *mode = MODE_RGBA;
+        break;
+    case SDL_PIXELFORMAT_BGRA32:
+    case SDL_PIXELFORMAT_BGRX32:
+        *mode = MODE_BGRA;
+        break;
+    case SDL_PIXELFORMAT_ARGB32:
+    case SDL_PIXELFORMAT_XRGB32:
+        *mode = MODE_ARGB;
+        break;
+    default:
+        return false;
+    }
+
+    /* Don't drop the alpha channel, let the caller convert */
+    if (has_alpha && SDL_BYTESPERPIXEL(format) == 3) {
+        return false;
+    }
+    return true;
+}
+
+static SDL_Surface *LoadWEBP_IO(SDL_IOStream *src, IMG_LoadOptions *options)
 {
     Sint64 start;
     const char *error = NULL;
     SDL_Surface *surface = NULL;
     Uint32 format;
     WebPBitstreamFeatures features;
+    WebPDecoderConfig config;
     size_t raw_data_size;
-    uint8_t *raw_data = NULL;
-    uint8_t *ret;
+    const uint8_t *raw_data = NULL;
+    void *allocated = NULL;
+    int width, height;
 
     if (!src) {
         /* The error message has been set in SDL_IOFromFile */
@@ -305,13 +353,8 @@ SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
         goto error;
     }
 
-    raw_data = (uint8_t *)SDL_malloc(raw_data_size);
+    raw_data = IMG_ReadIOData(src, raw_data_size, &allocated);
     if (raw_data == NULL) {
-        error = "Failed to allocate enough buffer for WEBP";
-        goto error;
-    }
-
-    if (SDL_ReadIO(src, raw_data, raw_data_size) != raw_data_size) {
         error = "Failed to read WEBP";
         goto error;
     }
@@ -341,9 +384,7 @@ SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
                 SDL_Surface *surf = animation->frames[0];
                 if (surf) {
                     ++surf->refcount;
-                    if (raw_data) {
-                        SDL_free(raw_data);
-                    }
+                    SDL_free(allocated);
                     IMG_FreeAnimation(animation);
                     return surf;
                 } else {
@@ -359,39 +400,69 @@ SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
         }
     }
 
-    if (features.has_alpha) {
+    if (!lib.WebPInitDecoderConfigInternal(&config, WEBP_DECODER_ABI_VERSION)) {
+        error = "WebPInitDecoderConfig has failed";
+        goto error;
+    }
+
+    if (options && GetWEBPColorspace(options->format, features.has_alpha, &config.output.colorspace)) {
+        format = options->format;
+    } else if (features.has_alpha) {
         format = SDL_PIXELFORMAT_RGBA32;
+        config.output.colorspace = MODE_RGBA;
     } else {
         format = SDL_PIXELFORMAT_RGB24;
+        config.output.colorspace = MODE_RGB;
     }
 
-    surface = SDL_CreateSurface(features.width, features.height, format);
+    /* libwebp can crop and then scale to any size while decoding */
+    width = features.width;
+    height = features.height;
+    if (options && options->region) {
+        SDL_Rect region;
+
+        if (!IMG_GetLoadRegion(options, width, height, &region)) {
+            goto error;
+        }
+        config.options.use_cropping = 1;
+        config.options.crop_left = region.x;
+        config.options.crop_top = region.y;
+        config.options.crop_width = region.w;
+        config.options.crop_height = region.h;
+        width = region.w;
+        height = region.h;
+        options->region = NULL;
+    }
+    if (options && IMG_GetLoadSize(options, width, height, &width, &height)) {
+        config.options.use_scaling = 1;
+        config.options.scaled_width = width;
+        config.options.scaled_height = height;
+        options->scale_denom = 1;
+    }
+
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
+    surface = IMG_CreateLoadSurface(width, height, format, options);
     if (surface == NULL) {
         error = "Failed to allocate SDL_Surface";
         goto error;
     }
 
-    if (features.has_alpha) {
-        ret = lib.WebPDecodeRGBAInto(raw_data, raw_data_size, (uint8_t *)surface->pixels, surface->pitch * surface->h, surface->pitch);
-    } else {
-        ret = lib.WebPDecodeRGBInto(raw_data, raw_data_size, (uint8_t *)surface->pixels, surface->pitch * surface->h, surface->pitch);
-    }
+    config.output.is_external_memory = 1;
+    config.output.u.RGBA.rgba = (uint8_t *)surface->pixels;
+    config.output.u.RGBA.stride = surface->pitch;
+    config.output.u.RGBA.size = (size_t)surface->pitch * surface->h;
 
-    if (!ret) {
+    if (lib.WebPDecode(raw_data, raw_data_size, &config) != VP8_STATUS_OK) {
         error = "Failed to decode WEBP";
         goto error;
     }
 
-    if (raw_data) {
-        SDL_free(raw_data);
-    }
+    SDL_free(allocated);
 
     return surface;
 
 error:
-    if (raw_data) {
-        SDL_free(raw_data);
-    }
+    SDL_free(allocated);
 
     if (surface) {
         SDL_DestroySurface(surface);
@@ -405,6 +476,114 @@ error:
     return NULL;
 }
 
+SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
+{
+    return LoadWEBP_IO(src, NULL);
+}
+
+SDL_Surface *IMG_LoadWEBPWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return LoadWEBP_IO(src, options);
+}
+
+/* Count the ANMF chunks in a RIFF container, without reading their payload */
+static int GetWEBPFrameCount(SDL_IOStream *src, Sint64 start)
+{
+    Uint8 chunk[8];
+    Uint32 size;
+    int frames = 0;
+
+    if (SDL_SeekIO(src, start + 12, SDL_IO_SEEK_SET) < 0) {
+        return 0;
+    }
+    while (SDL_ReadIO(src, chunk, sizeof(chunk)) == sizeof(chunk)) {
+        if (SDL_memcmp(chunk, "ANMF", 4) == 0) {
+            ++frames;
+        }
+        size = ((Uint32)chunk[4] << 0) | ((Uint32)chunk[5] << 8) | ((Uint32)chunk[6] << 16) | ((Uint32)chunk[7] << 24);
+        /* Chunks are padded to an even size */
+        size += (size & 1);
+        if (SDL_SeekIO(src, size, SDL_IO_SEEK_CUR) < 0) {
+            break;
+        }
+    }
+    return frames;
+}
+
+bool IMG_GetWEBPInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    Sint64 start;
+    const char *error = NULL;
+    WebPBitstreamFeatures features;
+    VP8StatusCode status;
+    size_t raw_data_size = 0;
+    size_t buffer_size;
+    uint8_t *raw_data = NULL;
+    int frames = 1;
+
+    start = SDL_TellIO(src);
+
+    if (!IMG_InitWEBP()) {
+        return false;
+    }
+
+    if (!webp_getinfo(src, &raw_data_size) || raw_data_size == 0) {
+        return SDL_SetError("Invalid WEBP");
+    }
+
+    /* The features are near the start of the file, read more only if needed */
+    buffer_size = SDL_min(raw_data_size, 4096);
+    for (;;) {
+        uint8_t *new_data = (uint8_t *)SDL_realloc(raw_data, buffer_size);
+        if (!new_data) {
+            error = "Failed to allocate enough buffer for WEBP";
+            goto done;
+        }
+        raw_data = new_data;
+
+        if (SDL_SeekIO(src, start, SDL_IO_SEEK_SET) < 0 ||
+            SDL_ReadIO(src, raw_data, buffer_size) != buffer_size) {
+            error = "Failed to read WEBP";
+            goto done;
+        }
+
+        status = lib.WebPGetFeaturesInternal(raw_data, buffer_size, &features, WEBP_DECODER_ABI_VERSION);
+        if (status != VP8_STATUS_NOT_ENOUGH_DATA || buffer_size == raw_data_size) {
+            break;
+        }
+        buffer_size = SDL_min(raw_data_size, buffer_size * 2);
+    }
+    if (status != VP8_STATUS_OK) {
+        error = "WebPGetFeatures has failed";
+        goto done;
+    }
+
+    if (features.has_animation) {
+        frames = GetWEBPFrameCount(src, start);
+    }
+
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_WIDTH_NUMBER, features.width);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_HEIGHT_NUMBER, features.height);
+    if (features.has_animation) {
+        /* Animated images are composited onto a 32-bit canvas */
+        SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, features.has_alpha ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGBX32);
+    } else {
+        SDL_SetNumberProperty(props, IMG_PROP_INFO_PIXEL_FORMAT_NUMBER, features.has_alpha ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGB24);
+    }
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_BIT_DEPTH_NUMBER, 8);
+    SDL_SetBooleanProperty(props, IMG_PROP_INFO_HAS_ALPHA_BOOLEAN, features.has_alpha ? true : false);
+    SDL_SetNumberProperty(props, IMG_PROP_INFO_FRAME_COUNT_NUMBER, frames);
+
+done:
+    if (raw_data) {
+        SDL_free(raw_data);
+    }
+    if (error) {
+        return SDL_SetError("%s", error);
+    }
+    return true;
+}
+
 struct IMG_AnimationDecoderContext
 {
     WebPDemuxer *demuxer;
@@ -412,8 +591,9 @@ struct IMG_AnimationDecoderContext
     SDL_Surface *canvas;
     WebPMuxAnimDispose dispose_method;
     uint32_t bgcolor;
-    uint8_t *raw_data;
+    const uint8_t *raw_data;
     size_t raw_data_size;
+    void *allocated;
     WebPDemuxState demux_state;
 };
 
@@ -455,7 +635,13 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
     SDL_Surface *retval = NULL;
 
     if (totalFrames == availableFrames || dispose_method == WEBP_MUX_DISPOSE_BACKGROUND) {
+        SDL_Rect canvas_rect = { 0, 0, canvas->w, canvas->h };
         SDL_FillSurfaceRect(canvas, NULL, iter->has_alpha ? 0 : bgcolor);
+        IMG_AddDecoderDirtyRect(decoder, canvas, &canvas_rect);
+    }
+
+    if (!IMG_CheckImageLimits(iter->width, iter->height, SDL_PIXELFORMAT_RGBA32)) {
+        return false;
     }
 
     SDL_Surface *curr = SDL_CreateSurface(iter->width, iter->height, SDL_PIXELFORMAT_RGBA32);
@@ -486,8 +672,9 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
         return SDL_SetError("Failed to blit WEBP frame to canvas");
     }
     SDL_DestroySurface(curr);
+    IMG_AddDecoderDirtyRect(decoder, canvas, &dst);
 
-    retval = SDL_DuplicateSurface(canvas);
+    retval = IMG_GetDecoderCanvasFrame(decoder, canvas);
     if (!retval) {
         return SDL_SetError("Failed to duplicate the surface for the next frame");
     }
@@ -513,9 +700,7 @@ static bool IMG_AnimationDecoderClose_Internal(IMG_AnimationDecoder *decoder)
     if (decoder->ctx->demuxer) {
         lib.WebPDemuxDelete(decoder->ctx->demuxer);
     }
-    if (decoder->ctx->raw_data) {
-        SDL_free(decoder->ctx->raw_data);
-    }
+    SDL_free(decoder->ctx->allocated);
     lib.WebPDemuxReleaseIterator(&decoder->ctx->iter);
     SDL_free(decoder->ctx);
     decoder->ctx = NULL;
@@ -546,17 +731,12 @@ bool IMG_CreateWEBPAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
         return false;
     }
 
+    /* The stream stays open as long as the decoder, so its memory can be used in place */
     decoder->ctx->raw_data_size = (size_t)stream_size;
-    decoder->ctx->raw_data = (uint8_t *)SDL_malloc(decoder->ctx->raw_data_size);
-    if (!decoder->ctx->raw_data) {
-        SDL_free(decoder->ctx);
-        decoder->ctx = NULL;
-        SDL_SetError("Out of memory for WebP file buffer");
-        return false;
+    if (SDL_SeekIO(decoder->src, decoder->start, SDL_IO_SEEK_SET) >= 0) {
+        decoder->ctx->raw_data = IMG_ReadIOData(decoder->src, decoder->ctx->raw_data_size, &decoder->ctx->allocated);
     }
-    if (SDL_SeekIO(decoder->src, decoder->start, SDL_IO_SEEK_SET) < 0 ||
-        SDL_ReadIO(decoder->src, decoder->ctx->raw_data, decoder->ctx->raw_data_size) != decoder->ctx->raw_data_size) {
-        SDL_free(decoder->ctx->raw_data);
+    if (!decoder->ctx->raw_data) {
         SDL_free(decoder->ctx);
         decoder->ctx = NULL;
         SDL_SetError("Failed to read WebP file into memory");
@@ -566,7 +746,7 @@ bool IMG_CreateWEBPAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
     WebPData wd = { decoder->ctx->raw_data, decoder->ctx->raw_data_size };
     decoder->ctx->demuxer = lib.WebPDemuxInternal(&wd, 0, NULL, WEBP_DEMUX_ABI_VERSION);
     if (!decoder->ctx->demuxer) {
-        SDL_free(decoder->ctx->raw_data);
+        SDL_free(decoder->ctx->allocated);
         SDL_free(decoder->ctx);
         decoder->ctx = NULL;
         SDL_SetError("WebPDemux failed to initialize demuxer (not a valid WebP file or corrupted data)");
@@ -577,6 +757,14 @@ bool IMG_CreateWEBPAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
     uint32_t height = lib.WebPDemuxGetI(decoder->ctx->demuxer, WEBP_FF_CANVAS_HEIGHT);
     uint32_t flags = lib.WebPDemuxGetI(decoder->ctx->demuxer, WEBP_FF_FORMAT_FLAGS);
 
+    if (!IMG_CheckImageLimits(width, height, SDL_PIXELFORMAT_RGBA32)) {
+        lib.WebPDemuxDelete(decoder->ctx->demuxer);
+        SDL_free(decoder->ctx->allocated);
+        SDL_free(decoder->ctx);
+        decoder->ctx = NULL;
+        return false;
+    }
+
     bool ignoreProps = SDL_GetBooleanProperty(props, IMG_PROP_METADATA_IGNORE_PROPS_BOOLEAN, false);
     if (!ignoreProps) {
         // Allow implicit properties to be set which are not globalized but specific to the decoder.
@@ -624,7 +812,7 @@ bool IMG_CreateWEBPAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
     decoder->ctx->canvas = SDL_CreateSurface(width, height, has_alpha ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGBX32);
     if (!decoder->ctx->canvas) {
         lib.WebPDemuxDelete(decoder->ctx->demuxer);
-        SDL_free(decoder->ctx->raw_data);
+        SDL_free(decoder->ctx->allocated);
         SDL_free(decoder->ctx);
         decoder->ctx = NULL;
         return false;
@@ -652,6 +840,7 @@ bool IMG_CreateWEBPAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
     decoder->GetNextFrame = IMG_AnimationDecoderGetNextFrame_Internal;
     decoder->Reset = IMG_AnimationDecoderReset_Internal;
     decoder->Close = IMG_AnimationDecoderClose_Internal;
+    decoder->tracks_dirty_rects = true;
 
     return true;
 }
@@ -1070,6 +1259,16 @@ SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
     return NULL;
 }
 
+bool IMG_GetWEBPInfo_IO(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    return SDL_SetError("SDL_image built without WEBP support");
+}
+
+SDL_Surface *IMG_LoadWEBPWithOptions_IO(SDL_IOStream *src, IMG_LoadOptions *options)
+{
+    return IMG_LoadWEBP_IO(src);
+}
+
 bool IMG_CreateWEBPAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_PropertiesID props)
 {
     return SDL_SetError("SDL_image built without WEBP support");
@@ -23,6 +23,10 @@
 
 #include <SDL3/SDL_endian.h>
 #include <SDL3_image/SDL_image.h>
+#include "IMG_limits.h"
+#include "IMG_progress.h"
+#include "IMG_scratch.h"
+#include "IMG_stats.h"
 
 #ifdef LOAD_XCF
 
@@ -154,7 +158,7 @@ typedef struct {
     Uint32 precision;
     xcf_prop *properties;
 
-    Uint64 *layer_file_offsets;
+    Uint64 *layer_file_offsets;     /* allocated from the load's scratch memory */
     Uint64 *channel_file_offsets;
 
     xcf_compr_type compr;
@@ -336,7 +340,6 @@ static void free_xcf_header(xcf_header *h)
 {
     if (h) {
         SDL_free(h->cm_map);
-        SDL_free(h->layer_file_offsets);
         SDL_free(h);
     }
 }
@@ -717,7 +720,7 @@ static void create_channel_surface(SDL_Surface *surf, xcf_image_type itype, Uint
 }
 
 static int
-do_layer_surface(SDL_Surface *surface, SDL_IOStream *src, xcf_header *head, xcf_layer *layer, load_tile_type load_tile)
+do_layer_surface(SDL_Surface *surface, SDL_IOStream *src, xcf_header *head, xcf_layer *layer, load_tile_type load_tile, int layer_index, int nlayers)
 {
     xcf_hierarchy  *hierarchy;
     xcf_level      *level;
@@ -728,6 +731,7 @@ do_layer_surface(SDL_Surface *surface, SDL_IOStream *src, xcf_header *head, xcf_
     Uint32         x, y, tx, ty, ox, oy;
     Uint32         *row;
     Uint64         length;
+    Sint64         ntiles;
 
     if (SDL_SeekIO(src, layer->hierarchy_file_offset, SDL_IO_SEEK_SET) < 0) {
         return 1;
@@ -754,8 +758,14 @@ do_layer_surface(SDL_Surface *surface, SDL_IOStream *src, xcf_header *head, xcf_
             continue;
         level = read_xcf_level(src, head);
 
+        ntiles = (Sint64)((level->width + 63) / 64) * ((level->height + 63) / 64);
         ty = tx = 0;
         for (j = 0; level->tile_file_offsets[j]; j++) {
+            if (!IMG_UpdateLoadProgress(layer_index * ntiles + j, nlayers * ntiles)) {
+                free_xcf_level(level);
+                free_xcf_hierarchy(hierarchy);
+                return 1;
+            }
             SDL_SeekIO(src, level->tile_file_offsets[j], SDL_IO_SEEK_SET);
             ox = tx + 64 > level->width ? level->width % 64 : 64;
             oy = ty + 64 > level->height ? level->height % 64 : 64;
@@ -894,9 +904,10 @@ SDL_Surface *IMG_LoadXCF_IO(SDL_IOStream *src)
     xcf_layer    *layer;
     xcf_channel **channel = NULL;
     int chnls = 0;
-    int i, offsets;
+    int i, offsets, max_offsets;
     Sint64 offset, fp;
     load_tile_type load_tile;
+    IMG_Scratch scratch;
 
     if (!src) {
         /* The error message has been set in SDL_IOFromFile */
@@ -906,6 +917,7 @@ SDL_Surface *IMG_LoadXCF_IO(SDL_IOStream *src)
 
     /* Initialize the data we will clean up when we're done */
     surface = NULL;
+    SDL_zero(scratch);
 
     head = read_xcf_header(src);
     if (!head) {
@@ -925,6 +937,12 @@ SDL_Surface *IMG_LoadXCF_IO(SDL_IOStream *src)
         goto done;
     }
 
+    if (!IMG_CheckImageLimits(head->width, head->height, SDL_PIXELFORMAT_ARGB8888)) {
+        SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+        goto done;
+    }
+
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     /* Create the surface of the appropriate type */
     surface = SDL_CreateSurface(head->width, head->height, SDL_PIXELFORMAT_ARGB8888);
     if (surface == NULL) {
@@ -933,9 +951,20 @@ SDL_Surface *IMG_LoadXCF_IO(SDL_IOStream *src)
     }
 
     offsets = 0;
+    max_offsets = 0;
 
     while ((offset = read_offset(src, head)) != 0) {
-        head->layer_file_offsets = (Uint64 *)SDL_realloc(head->layer_file_offsets, sizeof(Uint64) * (offsets + 1));
+        if (offsets == max_offsets) {
+            int new_max = max_offsets ? max_offsets * 2 : 16;
+            Uint64 *new_offsets = (Uint64 *)IMG_ReallocScratch(&scratch, head->layer_file_offsets,
+                                                               sizeof(Uint64) * max_offsets, sizeof(Uint64) * new_max);
+            if (!new_offsets) {
+                error = "Out of memory";
+                goto done;
+            }
+            head->layer_file_offsets = new_offsets;
+            max_offsets = new_max;
+        }
         head->layer_file_offsets[offsets] = offset;
         offsets++;
     }
@@ -955,7 +984,13 @@ SDL_Surface *IMG_LoadXCF_IO(SDL_IOStream *src)
         layer = read_xcf_layer(src, head);
         if (layer != NULL) {
             if (layer->visible) {
-                do_layer_surface(lays, src, head, layer, load_tile);
+                do_layer_surface(lays, src, head, layer, load_tile, offsets - i, offsets);
+                if (IMG_IsLoadCancelled()) {
+                    free_xcf_layer(layer);
+                    SDL_DestroySurface(lays);
+                    error = "Load cancelled";
+                    goto done;
+                }
                 rs.x = 0;
                 rs.y = 0;
                 rs.w = layer->width;
@@ -1014,6 +1049,7 @@ done:
     SDL_free(channel);
 
     free_xcf_header(head);
+    IMG_FreeScratch(&scratch);
 
     if (error) {
         SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
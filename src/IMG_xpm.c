@@ -47,6 +47,9 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_limits.h"
+#include "IMG_stats.h"
+
 #ifdef LOAD_XPM
 
 /* See if an image is contained in a data source */
@@ -1040,6 +1043,12 @@ static SDL_Surface *load_xpm(char **xpm, SDL_IOStream *src, bool force_32bit)
         goto done;
     }
 
+    if (!IMG_CheckImageLimits(w, h, (ncolors <= 256 && !force_32bit) ? SDL_PIXELFORMAT_INDEX8 : SDL_PIXELFORMAT_ARGB8888)) {
+        if ( src )
+            SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+        goto done;
+    }
+
     /* Check for allocation overflow */
     if ((size_t)((Uint32)ncolors * cpp)/cpp != (Uint32)ncolors) {
         error = "Invalid color specification";
@@ -1052,6 +1061,7 @@ static SDL_Surface *load_xpm(char **xpm, SDL_IOStream *src, bool force_32bit)
     }
     nextkey = keystrings;
 
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     /* Create the new surface */
     if (ncolors <= 256 && !force_32bit) {
         indexed = 1;
@@ -23,6 +23,9 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG_limits.h"
+#include "IMG_stats.h"
+
 #ifdef LOAD_XV
 
 static int get_line(SDL_IOStream *src, char *line, int size)
@@ -118,7 +121,12 @@ SDL_Surface *IMG_LoadXV_IO(SDL_IOStream *src)
         error = "Unsupported image format";
         goto done;
     }
+    if ( !IMG_CheckImageLimits(w, h, SDL_PIXELFORMAT_RGB332) ) {
+        SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+        goto done;
+    }
 
+    IMG_SetLoadPhase(IMG_LOAD_PHASE_DECODE);
     /* Create the 3-3-2 indexed palette surface */
     surface = SDL_CreateSurface(w, h, SDL_PIXELFORMAT_RGB332);
     if ( surface == NULL ) {
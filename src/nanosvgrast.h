@@ -1387,6 +1387,9 @@ NSVG_EXPORT void nsvgRasterize(NSVGrasterizer* r,
 	NSVGedge *e = NULL;
 	NSVGcachedPaint cache;
 	int i;
+#ifdef NSVG_PROGRESS
+	int ishape = 0, nshapes = 0;
+#endif
 
 	r->bitmap = dst;
 	r->width = w;
@@ -1402,7 +1405,17 @@ NSVG_EXPORT void nsvgRasterize(NSVGrasterizer* r,
 	for (i = 0; i < h; i++)
 		memset(&dst[i*stride], 0, w*4);
 
+#ifdef NSVG_PROGRESS
+	for (shape = image->shapes; shape != NULL; shape = shape->next)
+		nshapes++;
+#endif
+
 	for (shape = image->shapes; shape != NULL; shape = shape->next) {
+#ifdef NSVG_PROGRESS
+		// Stop drawing if the caller asks, leaving the remaining shapes out
+		if (!NSVG_PROGRESS(ishape++, nshapes))
+			break;
+#endif
 		if (!(shape->flags & NSVG_FLAGS_VISIBLE))
 			continue;
 
@@ -0,0 +1,501 @@
+/*
+  Copyright 1997-2025 Sam Lantinga
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Animation decode and encode benchmark
+ *
+ * Encodes generated sequences with each animation encoder and decodes them
+ * and the sample animations in the test directory with the animation
+ * decoders, and prints the frames per second, the time per pixel or the
+ * size per frame, and the peak heap usage of each one as JSON.
+ */
+
+#include <SDL3_image/SDL_image.h>
+
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_test.h>
+
+#include <stdio.h>
+
+#include "testutils.h"
+
+#define DEFAULT_ITERATIONS  5
+#define QUICK_ITERATIONS    2
+
+/* Size of the moving sprite in the sprite sequence */
+#define SPRITE_SIZE         32
+
+typedef enum
+{
+    SEQUENCE_FULL,      /* every pixel changes in every frame */
+    SEQUENCE_SPRITE,    /* a small sprite moves over a still background */
+    SEQUENCE_STATIC     /* every frame is the same */
+} SequenceType;
+
+typedef struct
+{
+    const char *name;
+    SequenceType type;
+} Sequence;
+
+typedef struct
+{
+    const char *file;
+    const char *type;
+} SampleAnimation;
+
+typedef struct
+{
+    Uint64 median;
+    Uint64 p95;
+    size_t peak;
+} Timing;
+
+static bool counting_allocations;
+
+static int iterations = DEFAULT_ITERATIONS;
+static int frame_width = 640;
+static int frame_height = 360;
+static int num_frames = 60;
+static SDL_IOStream *json;
+static bool first_result = true;
+
+/* The animation formats with both an encoder and a decoder */
+static const char *animation_types[] = {
+    "ani",
+    "gif",
+    "png",
+    "webp",
+    "avifs",
+};
+
+static const Sequence sequences[] = {
+    { "full", SEQUENCE_FULL },
+    { "sprite", SEQUENCE_SPRITE },
+    { "static", SEQUENCE_STATIC },
+};
+
+static const SampleAnimation sample_animations[] = {
+    { "rgbrgb.ani", "ani" },
+    { "rgbrgb.avifs", "avifs" },
+    { "rgbrgb.gif", "gif" },
+    { "rgbrgb.png", "png" },
+    { "rgbrgb.webp", "webp" },
+};
+
+static int SDLCALL CompareTimes(const void *a, const void *b)
+{
+    Uint64 ta = *(const Uint64 *)a;
+    Uint64 tb = *(const Uint64 *)b;
+
+    return (ta < tb) ? -1 : (ta > tb);
+}
+
+/* Sort the times of all the iterations and get the median and 95th percentile */
+static void GetTiming(Uint64 *times, size_t peak, Timing *timing)
+{
+    SDL_qsort(times, iterations, sizeof(*times), CompareTimes);
+    timing->median = SDL_max(times[iterations / 2], 1);
+    timing->p95 = times[(iterations * 95 + 99) / 100 - 1];
+    timing->peak = peak;
+}
+
+static void PrintResultStart(const char *name, const char *operation, const char *type, int width, int height, int frames, const Timing *timing)
+{
+    SDL_IOprintf(json, "%s\n    {\n", first_result ? "" : ",");
+    first_result = false;
+    SDL_IOprintf(json, "      \"name\": \"%s\",\n", name);
+    SDL_IOprintf(json, "      \"operation\": \"%s\",\n", operation);
+    SDL_IOprintf(json, "      \"type\": \"%s\",\n", type);
+    SDL_IOprintf(json, "      \"width\": %d,\n", width);
+    SDL_IOprintf(json, "      \"height\": %d,\n", height);
+    SDL_IOprintf(json, "      \"frames\": %d,\n", frames);
+    SDL_IOprintf(json, "      \"iterations\": %d,\n", iterations);
+    SDL_IOprintf(json, "      \"median_us\": %.1f,\n", timing->median / 1000.0);
+    SDL_IOprintf(json, "      \"p95_us\": %.1f,\n", timing->p95 / 1000.0);
+    SDL_IOprintf(json, "      \"frames_per_s\": %.2f,\n", frames / (timing->median / 1000000000.0));
+}
+
+static void PrintResultEnd(const Timing *timing)
+{
+    if (counting_allocations) {
+        SDL_IOprintf(json, "      \"peak_alloc_bytes\": %" SDL_PRIu64 "\n", (Uint64)timing->peak);
+    } else {
+        SDL_IOprintf(json, "      \"peak_alloc_bytes\": null\n");
+    }
+    SDL_IOprintf(json, "    }");
+}
+
+/* Decode an animation from memory `iterations` times and print the results */
+static void BenchmarkDecode(const char *name, const char *type, const void *data, size_t datasize)
+{
+    Uint64 *times;
+    Timing timing;
+    size_t peak = 0;
+    int width = 0, height = 0;
+    int frames = 0;
+    int i;
+
+    times = (Uint64 *)SDL_calloc(iterations, sizeof(*times));
+    if (!times) {
+        return;
+    }
+
+    for (i = 0; i < iterations; ++i) {
+        IMG_AnimationDecoder *decoder;
+        IMG_AnimationDecoderStatus status;
+        SDL_Surface *frame;
+        Uint64 duration;
+        size_t baseline;
+        Uint64 start;
+
+        baseline = ResetPeakAllocated();
+        start = SDL_GetTicksNS();
+        decoder = IMG_CreateAnimationDecoder_IO(SDL_IOFromConstMem(data, datasize), true, type);
+        if (!decoder) {
+            SDL_Log("%s: couldn't create %s decoder: %s", name, type, SDL_GetError());
+            SDL_free(times);
+            return;
+        }
+        frames = 0;
+        while (IMG_GetAnimationDecoderFrame(decoder, &frame, &duration) && frame) {
+            width = frame->w;
+            height = frame->h;
+            ++frames;
+            SDL_DestroySurface(frame);
+        }
+        status = IMG_GetAnimationDecoderStatus(decoder);
+        IMG_CloseAnimationDecoder(decoder);
+        times[i] = SDL_GetTicksNS() - start;
+        peak = SDL_max(peak, GetPeakAllocated() - baseline);
+
+        if (status == IMG_DECODER_STATUS_FAILED || frames == 0) {
+            SDL_Log("%s: couldn't decode %s: %s", name, type, SDL_GetError());
+            SDL_free(times);
+            return;
+        }
+    }
+
+    GetTiming(times, peak, &timing);
+    PrintResultStart(name, "decode", type, width, height, frames, &timing);
+    SDL_IOprintf(json, "      \"input_bytes\": %" SDL_PRIu64 ",\n", (Uint64)datasize);
+    SDL_IOprintf(json, "      \"ns_per_pixel\": %.3f,\n", (double)timing.median / ((double)frames * width * height));
+    PrintResultEnd(&timing);
+
+    SDL_free(times);
+}
+
+/* Encode frames `iterations` times and print the results.
+ * Returns the output of the last iteration to free with SDL_free(), or NULL if encoding failed.
+ */
+static void *BenchmarkEncode(const char *name, const char *type, SDL_Surface **frames, size_t *datasize)
+{
+    Uint64 *times;
+    Timing timing;
+    size_t peak = 0;
+    void *data = NULL;
+    int i, j;
+
+    times = (Uint64 *)SDL_calloc(iterations, sizeof(*times));
+    if (!times) {
+        return NULL;
+    }
+
+    for (i = 0; i < iterations; ++i) {
+        IMG_AnimationEncoder *encoder;
+        SDL_IOStream *dst;
+        size_t baseline;
+        Uint64 start;
+        bool result = true;
+
+        dst = SDL_IOFromDynamicMem();
+        if (!dst) {
+            goto failed;
+        }
+
+        baseline = ResetPeakAllocated();
+        start = SDL_GetTicksNS();
+        encoder = IMG_CreateAnimationEncoder_IO(dst, false, type);
+        if (!encoder) {
+            SDL_CloseIO(dst);
+            goto failed;
+        }
+        for (j = 0; j < num_frames && result; ++j) {
+            result = IMG_AddAnimationEncoderFrame(encoder, frames[j], 16);
+        }
+        if (!IMG_CloseAnimationEncoder(encoder)) {
+            result = false;
+        }
+        times[i] = SDL_GetTicksNS() - start;
+        peak = SDL_max(peak, GetPeakAllocated() - baseline);
+
+        if (result && i == iterations - 1) {
+            const void *mem = SDL_GetPointerProperty(SDL_GetIOProperties(dst), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+
+            *datasize = (size_t)SDL_TellIO(dst);
+            data = SDL_malloc(*datasize);
+            if (data) {
+                SDL_memcpy(data, mem, *datasize);
+            }
+        }
+        SDL_CloseIO(dst);
+
+        if (!result) {
+            goto failed;
+        }
+    }
+
+    GetTiming(times, peak, &timing);
+    PrintResultStart(name, "encode", type, frame_width, frame_height, num_frames, &timing);
+    if (data) {
+        SDL_IOprintf(json, "      \"output_bytes\": %" SDL_PRIu64 ",\n", (Uint64)*datasize);
+        SDL_IOprintf(json, "      \"bytes_per_frame\": %.1f,\n", (double)*datasize / num_frames);
+    }
+    PrintResultEnd(&timing);
+
+    SDL_free(times);
+    return data;
+
+failed:
+    SDL_Log("%s: couldn't encode %s: %s", name, type, SDL_GetError());
+    SDL_free(data);
+    SDL_free(times);
+    return NULL;
+}
+
+/* Fill an RGBA surface with gradients and some noise, offset by `shift` */
+static void FillBackground(SDL_Surface *surface, int shift, Uint64 *seed)
+{
+    int x, y;
+
+    for (y = 0; y < surface->h; ++y) {
+        Uint8 *row = (Uint8 *)surface->pixels + y * surface->pitch;
+        for (x = 0; x < surface->w; ++x) {
+            Uint32 noise = SDL_rand_bits_r(seed);
+
+            row[x * 4 + 0] = (Uint8)(((x + shift) * 255 / surface->w) + (noise & 0x7));
+            row[x * 4 + 1] = (Uint8)(((y + shift) * 255 / surface->h) + ((noise >> 3) & 0x7));
+            row[x * 4 + 2] = (Uint8)((((x + shift) ^ y) & 0xff) + ((noise >> 6) & 0x7));
+            row[x * 4 + 3] = SDL_ALPHA_OPAQUE;
+        }
+    }
+}
+
+static void DestroyFrames(SDL_Surface **frames)
+{
+    int i;
+
+    if (!frames) {
+        return;
+    }
+    for (i = 0; i < num_frames; ++i) {
+        SDL_DestroySurface(frames[i]);
+    }
+    SDL_free(frames);
+}
+
+static SDL_Surface **CreateFrames(SequenceType type)
+{
+    SDL_Surface **frames;
+    Uint64 seed = 0x5eed;
+    int i;
+
+    frames = (SDL_Surface **)SDL_calloc(num_frames, sizeof(*frames));
+    if (!frames) {
+        return NULL;
+    }
+
+    for (i = 0; i < num_frames; ++i) {
+        if (i == 0 || type == SEQUENCE_FULL) {
+            frames[i] = SDL_CreateSurface(frame_width, frame_height, SDL_PIXELFORMAT_RGBA32);
+            if (frames[i]) {
+                FillBackground(frames[i], i * 8, &seed);
+            }
+        } else {
+            frames[i] = SDL_DuplicateSurface(frames[0]);
+        }
+        if (!frames[i]) {
+            DestroyFrames(frames);
+            return NULL;
+        }
+
+        if (type == SEQUENCE_SPRITE) {
+            SDL_Rect rect;
+
+            rect.w = SDL_min(SPRITE_SIZE, frame_width);
+            rect.h = SDL_min(SPRITE_SIZE, frame_height);
+            rect.x = (i * 4) % (frame_width - rect.w + 1);
+            rect.y = (i * 2) % (frame_height - rect.h + 1);
+            SDL_FillSurfaceRect(frames[i], &rect, SDL_MapSurfaceRGBA(frames[i], 255, 64, 0, 255));
+        }
+    }
+    return frames;
+}
+
+static void BenchmarkSequences(void)
+{
+    int i, j;
+
+    for (i = 0; i < (int)SDL_arraysize(sequences); ++i) {
+        SDL_Surface **frames = CreateFrames(sequences[i].type);
+
+        if (!frames) {
+            SDL_Log("%s: couldn't create frames: %s", sequences[i].name, SDL_GetError());
+            continue;
+        }
+
+        for (j = 0; j < (int)SDL_arraysize(animation_types); ++j) {
+            const char *type = animation_types[j];
+            void *data;
+            size_t datasize = 0;
+
+            data = BenchmarkEncode(sequences[i].name, type, frames, &datasize);
+            if (data) {
+                BenchmarkDecode(sequences[i].name, type, data, datasize);
+                SDL_free(data);
+            }
+        }
+
+        DestroyFrames(frames);
+    }
+}
+
+static void BenchmarkSamples(void)
+{
+    int i;
+
+    for (i = 0; i < (int)SDL_arraysize(sample_animations); ++i) {
+        const SampleAnimation *sample = &sample_animations[i];
+        char *file;
+        void *data;
+        size_t datasize;
+
+        file = GetTestFilename(TEST_FILE_DIST, sample->file);
+        if (!file) {
+            continue;
+        }
+        data = SDL_LoadFile(file, &datasize);
+        if (data) {
+            BenchmarkDecode(sample->file, sample->type, data, datasize);
+            SDL_free(data);
+        } else {
+            SDL_Log("%s: skipped: %s", sample->file, SDL_GetError());
+        }
+        SDL_free(file);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    SDLTest_CommonState *state;
+    const char *output_file = NULL;
+    bool quick = false;
+    int result = 0;
+    int i;
+
+    counting_allocations = InstallCountingAllocator();
+
+    /* Initialize test framework */
+    state = SDLTest_CommonCreateState(argv, 0);
+    if (!state) {
+        return 1;
+    }
+
+    /* Parse commandline */
+    for (i = 1; i < argc;) {
+        int consumed;
+
+        consumed = SDLTest_CommonArg(state, i);
+        if (!consumed) {
+            if (SDL_strcmp(argv[i], "--quick") == 0) {
+                quick = true;
+                consumed = 1;
+            } else if (SDL_strcmp(argv[i], "--iterations") == 0 && argv[i + 1]) {
+                iterations = SDL_atoi(argv[i + 1]);
+                consumed = (iterations > 0) ? 2 : -1;
+            } else if (SDL_strcmp(argv[i], "--frames") == 0 && argv[i + 1]) {
+                num_frames = SDL_atoi(argv[i + 1]);
+                consumed = (num_frames > 0) ? 2 : -1;
+            } else if (SDL_strcmp(argv[i], "--size") == 0 && argv[i + 1] && argv[i + 2]) {
+                frame_width = SDL_atoi(argv[i + 1]);
+                frame_height = SDL_atoi(argv[i + 2]);
+                consumed = (frame_width > 0 && frame_height > 0) ? 3 : -1;
+            } else if (SDL_strcmp(argv[i], "--output") == 0 && argv[i + 1]) {
+                output_file = argv[i + 1];
+                consumed = 2;
+            }
+        }
+        if (consumed <= 0) {
+            const char *options[] = {
+                "[--quick]",
+                "[--iterations N]",
+                "[--frames N]",
+                "[--size WIDTH HEIGHT]",
+                "[--output FILE]",
+                NULL
+            };
+            SDLTest_CommonLogUsage(state, argv[0], options);
+            return 1;
+        }
+
+        i += consumed;
+    }
+
+    if (quick) {
+        if (iterations == DEFAULT_ITERATIONS) {
+            iterations = QUICK_ITERATIONS;
+        }
+        frame_width = 64;
+        frame_height = 64;
+        num_frames = 4;
+    }
+
+    json = SDL_IOFromDynamicMem();
+    if (!json) {
+        SDL_Log("Couldn't create output stream: %s", SDL_GetError());
+        return 1;
+    }
+
+    if (!counting_allocations) {
+        SDL_Log("Couldn't install the counting allocator, peak allocations aren't reported");
+    }
+
+    SDL_IOprintf(json, "{\n");
+    SDL_IOprintf(json, "  \"sdl_version\": \"%d.%d.%d\",\n", SDL_VERSIONNUM_MAJOR(SDL_GetVersion()), SDL_VERSIONNUM_MINOR(SDL_GetVersion()), SDL_VERSIONNUM_MICRO(SDL_GetVersion()));
+    SDL_IOprintf(json, "  \"sdl_image_version\": \"%d.%d.%d\",\n", SDL_VERSIONNUM_MAJOR(IMG_Version()), SDL_VERSIONNUM_MINOR(IMG_Version()), SDL_VERSIONNUM_MICRO(IMG_Version()));
+    SDL_IOprintf(json, "  \"results\": [");
+
+    BenchmarkSamples();
+    BenchmarkSequences();
+
+    SDL_IOprintf(json, "\n  ]\n}\n");
+
+    /* Print the results once all the benchmarks are done, so the output doesn't disturb them */
+    {
+        const void *mem = SDL_GetPointerProperty(SDL_GetIOProperties(json), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+        size_t size = (size_t)SDL_TellIO(json);
+
+        if (output_file) {
+            if (!SDL_SaveFile(output_file, mem, size)) {
+                SDL_Log("Couldn't write %s: %s", output_file, SDL_GetError());
+                result = 1;
+            }
+        } else {
+            fwrite(mem, 1, size, stdout);
+            fflush(stdout);
+        }
+    }
+    SDL_CloseIO(json);
+
+    SDL_Quit();
+    SDLTest_CommonDestroyState(state);
+    return result;
+}
@@ -0,0 +1,649 @@
+/*
+  Copyright 1997-2025 Sam Lantinga
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Still image decode benchmark
+ *
+ * Decodes the sample images in the test directory and large generated
+ * images repeatedly, from file and memory streams, and prints the median
+ * and 95th percentile decode time, the throughput and the peak heap usage
+ * of each one as JSON, so builds with different backends can be compared
+ * on the same machine.
+ */
+
+#include <SDL3_image/SDL_image.h>
+
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_test.h>
+
+#include <stdio.h>
+
+#include "testutils.h"
+
+#define DEFAULT_ITERATIONS  10
+#define QUICK_ITERATIONS    3
+
+typedef bool (*SaveFunc)(SDL_Surface *surface, SDL_IOStream *dst);
+
+typedef struct
+{
+    const char *name;
+    SDL_PixelFormat format;
+    SaveFunc save;
+} SyntheticImage;
+
+typedef struct
+{
+    int width;
+    int height;
+} SyntheticSize;
+
+static bool counting_allocations;
+
+static int iterations = DEFAULT_ITERATIONS;
+static SDL_IOStream *json;
+static bool first_result = true;
+
+static const char *sample_files[] = {
+    "palette.bmp",
+    "palette.gif",
+    "rgbrgb.gif",
+    "rgbrgb.png",
+    "rgbrgb.webp",
+    "sample.avif",
+    "sample.bmp",
+    "sample.cur",
+    "sample.ico",
+    "sample.jpg",
+    "sample.jxl",
+    "sample.pcx",
+    "sample.png",
+    "sample.pnm",
+    "sample.qoi",
+    "sample.tga",
+    "sample.tif",
+    "sample.webp",
+    "sample.xcf",
+    "sample.xpm",
+    "svg.svg",
+};
+
+static const SyntheticSize synthetic_sizes[] = {
+    { 3840, 2160 },
+    { 7680, 4320 },
+};
+
+static const SyntheticSize quick_sizes[] = {
+    { 320, 180 },
+};
+
+static int SDLCALL CompareTimes(const void *a, const void *b)
+{
+    Uint64 ta = *(const Uint64 *)a;
+    Uint64 tb = *(const Uint64 *)b;
+
+    return (ta < tb) ? -1 : (ta > tb);
+}
+
+/* Decode an image `iterations` times and print the results.
+ * The image is read from `file` if `data` is NULL, and from memory otherwise.
+ */
+static void BenchmarkDecode(const char *name, const char *file, const void *data, size_t datasize)
+{
+    Uint64 *times;
+    Uint64 median, p95;
+    size_t peak = 0;
+    int width = 0, height = 0;
+    Uint64 decoded_size = 0;
+    char type[16];
+    SDL_IOStream *src;
+    int i;
+
+    times = (Uint64 *)SDL_calloc(iterations, sizeof(*times));
+    if (!times) {
+        return;
+    }
+
+    SDL_strlcpy(type, "", sizeof(type));
+    src = data ? SDL_IOFromConstMem(data, datasize) : SDL_IOFromFile(file, "rb");
+    if (src) {
+        const char *detected = IMG_DetectFormat(src);
+        if (detected) {
+            SDL_strlcpy(type, detected, sizeof(type));
+        }
+        datasize = (size_t)SDL_GetIOSize(src);
+        SDL_CloseIO(src);
+    }
+
+    for (i = 0; i < iterations; ++i) {
+        SDL_Surface *surface;
+        size_t baseline;
+        Uint64 start;
+
+        baseline = ResetPeakAllocated();
+        start = SDL_GetTicksNS();
+        if (data) {
+            src = SDL_IOFromConstMem(data, datasize);
+        } else {
+            src = SDL_IOFromFile(file, "rb");
+        }
+        surface = IMG_Load_IO(src, true);
+        times[i] = SDL_GetTicksNS() - start;
+        peak = SDL_max(peak, GetPeakAllocated() - baseline);
+
+        if (!surface) {
+            SDL_Log("%s: couldn't decode %s: %s", name, data ? "memory" : file, SDL_GetError());
+            SDL_free(times);
+            return;
+        }
+        width = surface->w;
+        height = surface->h;
+        decoded_size = (Uint64)surface->pitch * surface->h;
+        SDL_DestroySurface(surface);
+    }
+
+    SDL_qsort(times, iterations, sizeof(*times), CompareTimes);
+    median = times[iterations / 2];
+    p95 = times[(iterations * 95 + 99) / 100 - 1];
+    if (median == 0) {
+        median = 1;
+    }
+
+    SDL_IOprintf(json, "%s\n    {\n", first_result ? "" : ",");
+    first_result = false;
+    SDL_IOprintf(json, "      \"name\": \"%s\",\n", name);
+    if (*type) {
+        SDL_IOprintf(json, "      \"type\": \"%s\",\n", type);
+    }
+    SDL_IOprintf(json, "      \"source\": \"%s\",\n", data ? "memory" : "file");
+    SDL_IOprintf(json, "      \"width\": %d,\n", width);
+    SDL_IOprintf(json, "      \"height\": %d,\n", height);
+    SDL_IOprintf(json, "      \"input_bytes\": %" SDL_PRIu64 ",\n", (Uint64)datasize);
+    SDL_IOprintf(json, "      \"iterations\": %d,\n", iterations);
+    SDL_IOprintf(json, "      \"median_us\": %.1f,\n", median / 1000.0);
+    SDL_IOprintf(json, "      \"p95_us\": %.1f,\n", p95 / 1000.0);
+    SDL_IOprintf(json, "      \"decoded_mb_per_s\": %.2f,\n", (decoded_size / 1000000.0) / (median / 1000000000.0));
+    SDL_IOprintf(json, "      \"input_mb_per_s\": %.2f,\n", (datasize / 1000000.0) / (median / 1000000000.0));
+    if (counting_allocations) {
+        SDL_IOprintf(json, "      \"peak_alloc_bytes\": %" SDL_PRIu64 "\n", (Uint64)peak);
+    } else {
+        SDL_IOprintf(json, "      \"peak_alloc_bytes\": null\n");
+    }
+    SDL_IOprintf(json, "    }");
+
+    SDL_free(times);
+}
+
+static void BenchmarkSamples(void)
+{
+    int i;
+
+    for (i = 0; i < (int)SDL_arraysize(sample_files); ++i) {
+        const char *name = sample_files[i];
+        char *file;
+        void *data;
+        size_t datasize;
+
+        file = GetTestFilename(TEST_FILE_DIST, name);
+        if (!file) {
+            continue;
+        }
+
+        /* Skip the formats this build can't load */
+        data = SDL_LoadFile(file, &datasize);
+        if (data) {
+            SDL_Surface *surface = IMG_Load_IO(SDL_IOFromConstMem(data, datasize), true);
+            if (surface) {
+                SDL_DestroySurface(surface);
+                BenchmarkDecode(name, file, NULL, 0);
+                BenchmarkDecode(name, NULL, data, datasize);
+            } else {
+                SDL_Log("%s: skipped: %s", name, SDL_GetError());
+            }
+            SDL_free(data);
+        } else {
+            SDL_Log("%s: skipped: %s", name, SDL_GetError());
+        }
+        SDL_free(file);
+    }
+}
+
+/* Fill an RGBA surface with gradients and some noise, so it doesn't compress unrealistically well */
+static SDL_Surface *CreateSyntheticSurface(int width, int height, SDL_PixelFormat format)
+{
+    SDL_Surface *surface;
+    Uint64 seed = 0x5eed;
+    int x, y;
+
+    if (format == SDL_PIXELFORMAT_INDEX8) {
+        SDL_Palette *palette;
+        SDL_Color colors[256];
+
+        surface = SDL_CreateSurface(width, height, format);
+        if (!surface) {
+            return NULL;
+        }
+        palette = SDL_CreateSurfacePalette(surface);
+        if (!palette) {
+            SDL_DestroySurface(surface);
+            return NULL;
+        }
+        for (x = 0; x < 256; ++x) {
+            colors[x].r = (Uint8)x;
+            colors[x].g = (Uint8)(255 - x);
+            colors[x].b = (Uint8)((x * 7) & 0xff);
+            colors[x].a = SDL_ALPHA_OPAQUE;
+        }
+        SDL_SetPaletteColors(palette, colors, 0, 256);
+
+        for (y = 0; y < height; ++y) {
+            Uint8 *row = (Uint8 *)surface->pixels + y * surface->pitch;
+            for (x = 0; x < width; ++x) {
+                row[x] = (Uint8)(((x * 256 / width) ^ (y * 256 / height)) + (SDL_rand_bits_r(&seed) & 0x3));
+            }
+        }
+        return surface;
+    }
+
+    surface = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_RGBA32);
+    if (!surface) {
+        return NULL;
+    }
+    for (y = 0; y < height; ++y) {
+        Uint8 *row = (Uint8 *)surface->pixels + y * surface->pitch;
+        for (x = 0; x < width; ++x) {
+            Uint32 noise = SDL_rand_bits_r(&seed);
+
+            row[x * 4 + 0] = (Uint8)((x * 255 / width) + (noise & 0x7));
+            row[x * 4 + 1] = (Uint8)((y * 255 / height) + ((noise >> 3) & 0x7));
+            row[x * 4 + 2] = (Uint8)(((x ^ y) & 0xff) + ((noise >> 6) & 0x7));
+            row[x * 4 + 3] = (Uint8)(255 - (x * 128 / width));
+        }
+    }
+
+    if (format != SDL_PIXELFORMAT_RGBA32) {
+        SDL_Surface *converted = SDL_ConvertSurface(surface, format);
+        SDL_DestroySurface(surface);
+        surface = converted;
+    }
+    return surface;
+}
+
+static bool SavePNG(SDL_Surface *surface, SDL_IOStream *dst)
+{
+    return IMG_SavePNG_IO(surface, dst, false);
+}
+
+static bool SaveJPG(SDL_Surface *surface, SDL_IOStream *dst)
+{
+    return IMG_SaveJPG_IO(surface, dst, false, 90);
+}
+
+static bool SaveBMP(SDL_Surface *surface, SDL_IOStream *dst)
+{
+    return IMG_SaveBMP_IO(surface, dst, false);
+}
+
+static bool SaveTGA(SDL_Surface *surface, SDL_IOStream *dst)
+{
+    return IMG_SaveTGA_IO(surface, dst, false);
+}
+
+static bool SaveGIF(SDL_Surface *surface, SDL_IOStream *dst)
+{
+    return IMG_SaveGIF_IO(surface, dst, false);
+}
+
+static bool SaveWEBP(SDL_Surface *surface, SDL_IOStream *dst)
+{
+    return IMG_SaveWEBP_IO(surface, dst, false, 90.0f);
+}
+
+/* A minimal PNG writer for the variants IMG_SavePNG_IO() doesn't write,
+ * with stored deflate blocks and no filtering.
+ */
+static Uint32 crc_table[256];
+
+static Uint32 UpdateCRC(Uint32 crc, const Uint8 *data, size_t size)
+{
+    size_t i;
+
+    if (!crc_table[1]) {
+        Uint32 n, k;
+
+        for (n = 0; n < 256; ++n) {
+            Uint32 c = n;
+            for (k = 0; k < 8; ++k) {
+                c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+            }
+            crc_table[n] = c;
+        }
+    }
+
+    crc = ~crc;
+    for (i = 0; i < size; ++i) {
+        crc = crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static bool WritePNGChunk(SDL_IOStream *dst, const char *type, const Uint8 *data, size_t size)
+{
+    Uint32 crc = UpdateCRC(0, (const Uint8 *)type, 4);
+
+    crc = UpdateCRC(crc, data, size);
+    return SDL_WriteU32BE(dst, (Uint32)size) &&
+           SDL_WriteIO(dst, type, 4) == 4 &&
+           SDL_WriteIO(dst, data, size) == size &&
+           SDL_WriteU32BE(dst, crc);
+}
+
+/* Write the filtered rows of a pass: the pixels at (x0 + n * dx, y0 + m * dy) */
+static Uint8 *WritePNGPass(Uint8 *out, SDL_Surface *surface, int depth, int x0, int y0, int dx, int dy)
+{
+    int x, y;
+
+    if (x0 >= surface->w || y0 >= surface->h) {
+        return out;
+    }
+    for (y = y0; y < surface->h; y += dy) {
+        const Uint8 *row = (const Uint8 *)surface->pixels + y * surface->pitch;
+
+        *out++ = 0; /* no filter */
+        for (x = x0; x < surface->w; x += dx) {
+            const Uint8 *pixel = row + x * 4;
+            int c;
+
+            for (c = 0; c < 4; ++c) {
+                *out++ = pixel[c];
+                if (depth == 16) {
+                    *out++ = (Uint8)(pixel[c] ^ (x & 0xff));
+                }
+            }
+        }
+    }
+    return out;
+}
+
+static bool WriteRawPNG(SDL_Surface *surface, SDL_IOStream *dst, int depth, bool interlaced)
+{
+    static const Uint8 signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    static const int adam7[7][4] = {
+        { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 },
+        { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 }
+    };
+    const size_t bpp = (size_t)depth / 2;
+    Uint8 header[13];
+    Uint8 *raw = NULL, *end, *zlib = NULL, *out;
+    size_t rawsize, zlibsize, offset;
+    Uint32 a = 1, b = 0;
+    bool result = false;
+    int i;
+
+    if (surface->format != SDL_PIXELFORMAT_RGBA32) {
+        return SDL_SetError("Unsupported surface format");
+    }
+
+    /* Every pass row has a filter byte and the passes have at most one row per image row each */
+    rawsize = (size_t)surface->h * (1 + surface->w * bpp) + (interlaced ? 7 * (size_t)surface->h : 0);
+    raw = (Uint8 *)SDL_malloc(rawsize);
+    if (!raw) {
+        goto done;
+    }
+    if (interlaced) {
+        end = raw;
+        for (i = 0; i < 7; ++i) {
+            end = WritePNGPass(end, surface, depth, adam7[i][0], adam7[i][1], adam7[i][2], adam7[i][3]);
+        }
+    } else {
+        end = WritePNGPass(raw, surface, depth, 0, 0, 1, 1);
+    }
+    rawsize = end - raw;
+
+    zlibsize = 2 + rawsize + 5 * (rawsize / 65535 + 1) + 4;
+    zlib = (Uint8 *)SDL_malloc(zlibsize);
+    if (!zlib) {
+        goto done;
+    }
+    out = zlib;
+    *out++ = 0x78;
+    *out++ = 0x01;
+    offset = 0;
+    do {
+        size_t len = SDL_min(rawsize - offset, 65535);
+
+        *out++ = (offset + len == rawsize) ? 1 : 0;
+        *out++ = (Uint8)(len & 0xff);
+        *out++ = (Uint8)(len >> 8);
+        *out++ = (Uint8)(~len & 0xff);
+        *out++ = (Uint8)((~len >> 8) & 0xff);
+        SDL_memcpy(out, raw + offset, len);
+        out += len;
+        offset += len;
+    } while (offset < rawsize);
+    for (offset = 0; offset < rawsize; ++offset) {
+        a = (a + raw[offset]) % 65521;
+        b = (b + a) % 65521;
+    }
+    *out++ = (Uint8)(b >> 8);
+    *out++ = (Uint8)b;
+    *out++ = (Uint8)(a >> 8);
+    *out++ = (Uint8)a;
+
+    header[0] = (Uint8)(surface->w >> 24);
+    header[1] = (Uint8)(surface->w >> 16);
+    header[2] = (Uint8)(surface->w >> 8);
+    header[3] = (Uint8)surface->w;
+    header[4] = (Uint8)(surface->h >> 24);
+    header[5] = (Uint8)(surface->h >> 16);
+    header[6] = (Uint8)(surface->h >> 8);
+    header[7] = (Uint8)surface->h;
+    header[8] = (Uint8)depth;
+    header[9] = 6;  /* RGBA */
+    header[10] = 0; /* deflate */
+    header[11] = 0; /* adaptive filtering */
+    header[12] = interlaced ? 1 : 0;
+
+    result = SDL_WriteIO(dst, signature, sizeof(signature)) == sizeof(signature) &&
+             WritePNGChunk(dst, "IHDR", header, sizeof(header)) &&
+             WritePNGChunk(dst, "IDAT", zlib, out - zlib) &&
+             WritePNGChunk(dst, "IEND", NULL, 0);
+
+done:
+    SDL_free(raw);
+    SDL_free(zlib);
+    return result;
+}
+
+static bool SaveInterlacedPNG(SDL_Surface *surface, SDL_IOStream *dst)
+{
+    return WriteRawPNG(surface, dst, 8, true);
+}
+
+static bool Save16BitPNG(SDL_Surface *surface, SDL_IOStream *dst)
+{
+    return WriteRawPNG(surface, dst, 16, false);
+}
+
+/* There is no progressive JPEG variant, IMG_SaveJPG_IO() only writes baseline JPEG */
+static const SyntheticImage synthetic_images[] = {
+    { "png-index8", SDL_PIXELFORMAT_INDEX8, SavePNG },
+    { "png-rgb24", SDL_PIXELFORMAT_RGB24, SavePNG },
+    { "png-rgba32", SDL_PIXELFORMAT_RGBA32, SavePNG },
+    { "png-rgba32-interlaced", SDL_PIXELFORMAT_RGBA32, SaveInterlacedPNG },
+    { "png-rgba64", SDL_PIXELFORMAT_RGBA32, Save16BitPNG },
+    { "jpg-rgb24", SDL_PIXELFORMAT_RGB24, SaveJPG },
+    { "bmp-index8", SDL_PIXELFORMAT_INDEX8, SaveBMP },
+    { "bmp-rgb24", SDL_PIXELFORMAT_RGB24, SaveBMP },
+    { "bmp-rgba32", SDL_PIXELFORMAT_RGBA32, SaveBMP },
+    { "tga-rgba32", SDL_PIXELFORMAT_RGBA32, SaveTGA },
+    { "gif-index8", SDL_PIXELFORMAT_INDEX8, SaveGIF },
+    { "webp-rgba32", SDL_PIXELFORMAT_RGBA32, SaveWEBP },
+};
+
+/* Encode a synthetic image into memory, returns the data to free with SDL_free() */
+static void *EncodeSynthetic(const SyntheticImage *image, int width, int height, size_t *datasize)
+{
+    SDL_Surface *surface;
+    SDL_IOStream *dst;
+    void *data = NULL;
+
+    surface = CreateSyntheticSurface(width, height, image->format);
+    if (!surface) {
+        return NULL;
+    }
+
+    dst = SDL_IOFromDynamicMem();
+    if (dst) {
+        if (image->save(surface, dst)) {
+            const void *mem = SDL_GetPointerProperty(SDL_GetIOProperties(dst), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+
+            *datasize = (size_t)SDL_TellIO(dst);
+            data = SDL_malloc(*datasize);
+            if (data) {
+                SDL_memcpy(data, mem, *datasize);
+            }
+        }
+        SDL_CloseIO(dst);
+    }
+    SDL_DestroySurface(surface);
+    return data;
+}
+
+static void BenchmarkSynthetic(const SyntheticSize *sizes, int num_sizes)
+{
+    int i, j;
+
+    for (i = 0; i < num_sizes; ++i) {
+        for (j = 0; j < (int)SDL_arraysize(synthetic_images); ++j) {
+            const SyntheticImage *image = &synthetic_images[j];
+            char name[64];
+            char *file;
+            void *data;
+            size_t datasize = 0;
+
+            SDL_snprintf(name, sizeof(name), "%s-%dx%d", image->name, sizes[i].width, sizes[i].height);
+
+            data = EncodeSynthetic(image, sizes[i].width, sizes[i].height, &datasize);
+            if (!data) {
+                SDL_Log("%s: skipped: %s", name, SDL_GetError());
+                continue;
+            }
+
+            file = GetTestFilename(TEST_FILE_BUILT, "benchimage.tmp");
+            if (file && SDL_SaveFile(file, data, datasize)) {
+                BenchmarkDecode(name, file, NULL, 0);
+                SDL_RemovePath(file);
+            }
+            BenchmarkDecode(name, NULL, data, datasize);
+
+            SDL_free(file);
+            SDL_free(data);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    SDLTest_CommonState *state;
+    const char *output_file = NULL;
+    bool quick = false;
+    int result = 0;
+    int i;
+
+    counting_allocations = InstallCountingAllocator();
+
+    /* Initialize test framework */
+    state = SDLTest_CommonCreateState(argv, 0);
+    if (!state) {
+        return 1;
+    }
+
+    /* Parse commandline */
+    for (i = 1; i < argc;) {
+        int consumed;
+
+        consumed = SDLTest_CommonArg(state, i);
+        if (!consumed) {
+            if (SDL_strcmp(argv[i], "--quick") == 0) {
+                quick = true;
+                consumed = 1;
+            } else if (SDL_strcmp(argv[i], "--iterations") == 0 && argv[i + 1]) {
+                iterations = SDL_atoi(argv[i + 1]);
+                consumed = (iterations > 0) ? 2 : -1;
+            } else if (SDL_strcmp(argv[i], "--output") == 0 && argv[i + 1]) {
+                output_file = argv[i + 1];
+                consumed = 2;
+            }
+        }
+        if (consumed <= 0) {
+            const char *options[] = {
+                "[--quick]",
+                "[--iterations N]",
+                "[--output FILE]",
+                NULL
+            };
+            SDLTest_CommonLogUsage(state, argv[0], options);
+            return 1;
+        }
+
+        i += consumed;
+    }
+
+    if (quick && iterations == DEFAULT_ITERATIONS) {
+        iterations = QUICK_ITERATIONS;
+    }
+
+    json = SDL_IOFromDynamicMem();
+    if (!json) {
+        SDL_Log("Couldn't create output stream: %s", SDL_GetError());
+        return 1;
+    }
+
+    if (!counting_allocations) {
+        SDL_Log("Couldn't install the counting allocator, peak allocations aren't reported");
+    }
+
+    SDL_IOprintf(json, "{\n");
+    SDL_IOprintf(json, "  \"sdl_version\": \"%d.%d.%d\",\n", SDL_VERSIONNUM_MAJOR(SDL_GetVersion()), SDL_VERSIONNUM_MINOR(SDL_GetVersion()), SDL_VERSIONNUM_MICRO(SDL_GetVersion()));
+    SDL_IOprintf(json, "  \"sdl_image_version\": \"%d.%d.%d\",\n", SDL_VERSIONNUM_MAJOR(IMG_Version()), SDL_VERSIONNUM_MINOR(IMG_Version()), SDL_VERSIONNUM_MICRO(IMG_Version()));
+    SDL_IOprintf(json, "  \"results\": [");
+
+    BenchmarkSamples();
+    if (quick) {
+        BenchmarkSynthetic(quick_sizes, (int)SDL_arraysize(quick_sizes));
+    } else {
+        BenchmarkSynthetic(synthetic_sizes, (int)SDL_arraysize(synthetic_sizes));
+    }
+
+    SDL_IOprintf(json, "\n  ]\n}\n");
+
+    /* Print the results once all the benchmarks are done, so the output doesn't disturb them */
+    {
+        const void *mem = SDL_GetPointerProperty(SDL_GetIOProperties(json), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+        size_t size = (size_t)SDL_TellIO(json);
+
+        if (output_file) {
+            if (!SDL_SaveFile(output_file, mem, size)) {
+                SDL_Log("Couldn't write %s: %s", output_file, SDL_GetError());
+                result = 1;
+            }
+        } else {
+            fwrite(mem, 1, size, stdout);
+            fflush(stdout);
+        }
+    }
+    SDL_CloseIO(json);
+
+    SDL_Quit();
+    SDLTest_CommonDestroyState(state);
+    return result;
+}
@@ -0,0 +1,342 @@
+/*
+  Copyright 1997-2025 Sam Lantinga
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Allocation budget tests
+ *
+ * Loads the sample images and some larger generated images with counting
+ * allocators installed, and checks that the number of allocations and the
+ * bytes allocated by each load stay within a budget, so decoders that start
+ * making extra copies of the image fail the tests.
+ *
+ * Only allocations made with SDL_malloc() are counted. The budgets were
+ * measured with the stb_image backend and with libpng and libjpeg, and have
+ * an entry for each backend where they differ. These aren't covered:
+ * - libpng, libjpeg, libtiff, libwebp, libavif and libjxl allocate with
+ *   malloc(), so only the allocations SDL_image makes around them count
+ * - the WIC and ImageIO backends decode outside of SDL_image entirely
+ * - BMP, and PNG with the stb_image backend, are loaded by SDL itself
+ * - TIFF, WEBP, AVIF and JXL haven't been measured and have no budget
+ */
+
+#include <SDL3_image/SDL_image.h>
+
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_test.h>
+
+#include "testutils.h"
+
+#define KB(x)   ((x) * 1024)
+
+/* Size of the generated images */
+#define GENERATED_SIZE      512
+
+/* A load may make at most `max_allocations` allocations, and allocate at
+ * most `max_bytes` bytes plus `max_image_ratio` times the size of the
+ * decoded image. Growing an allocation with SDL_realloc() counts as an
+ * allocation of the added bytes.
+ */
+typedef struct
+{
+    const char *name;
+    int max_allocations;
+    size_t max_bytes;
+    float max_image_ratio;
+} AllocBudget;
+
+typedef bool (*SaveFunc)(SDL_Surface *surface, SDL_IOStream *dst);
+
+typedef struct
+{
+    AllocBudget budget;
+    SaveFunc save;
+} GeneratedBudget;
+
+static bool counting_allocations;
+
+/* The decoder used for JPG and PNG images, in the same order as IMG_jpg.c and IMG_png.c */
+#if defined(USE_STBIMAGE)
+#define BUDGET_JPG_STBIMAGE
+#elif defined(SDL_IMAGE_USE_COMMON_BACKEND) || \
+      !(defined(SDL_IMAGE_USE_WIC_BACKEND) || (defined(__APPLE__) && defined(JPG_USES_IMAGEIO)))
+#define BUDGET_JPG_LIBJPEG
+#endif
+#if defined(SDL_IMAGE_LIBPNG)
+#define BUDGET_PNG_LIBPNG
+#endif
+
+/* The budgets of the samples, which are all small, so the fixed part dominates.
+ * Most decoders write straight into the surface, and only allocate it and its
+ * palette.
+ */
+static const AllocBudget sample_budgets[] = {
+    { "palette.gif", 16, KB(8), 1.1f },
+    { "sample.cur", 16, KB(8), 1.1f },
+    { "sample.ico", 16, KB(8), 1.1f },
+#ifdef BUDGET_JPG_STBIMAGE
+    { "sample.jpg", 24, KB(64), 1.6f },
+#elif defined(BUDGET_JPG_LIBJPEG)
+    { "sample.jpg", 16, KB(8), 1.1f },
+#endif
+    { "sample.pcx", 16, KB(8), 1.1f },
+#ifdef BUDGET_PNG_LIBPNG
+    { "sample.png", 16, KB(8), 1.1f },
+#endif
+    { "sample.pnm", 16, KB(8), 1.1f },
+    { "sample.qoi", 16, KB(8), 1.1f },
+    { "sample.tga", 16, KB(8), 1.1f },
+    { "sample.xcf", 32, KB(16), 2.0f },
+    { "sample.xpm", 16, KB(24), 1.1f },
+    { "svg.svg", 32, KB(64), 1.1f },
+};
+
+#ifdef BUDGET_PNG_LIBPNG
+static bool SavePNG(SDL_Surface *surface, SDL_IOStream *dst)
+{
+    return IMG_SavePNG_IO(surface, dst, false);
+}
+#endif
+
+#if defined(BUDGET_JPG_STBIMAGE) || defined(BUDGET_JPG_LIBJPEG)
+static bool SaveJPG(SDL_Surface *surface, SDL_IOStream *dst)
+{
+    return IMG_SaveJPG_IO(surface, dst, false, 90);
+}
+#endif
+
+static bool SaveTGA(SDL_Surface *surface, SDL_IOStream *dst)
+{
+    return IMG_SaveTGA_IO(surface, dst, false);
+}
+
+/* The budgets of the generated RGBA images. stb_image decodes the JPG
+ * components into buffers of its own before converting them into the image.
+ */
+static const GeneratedBudget generated_budgets[] = {
+#ifdef BUDGET_JPG_STBIMAGE
+    { { "jpg", 24, KB(64), 1.6f }, SaveJPG },
+#elif defined(BUDGET_JPG_LIBJPEG)
+    { { "jpg", 16, KB(8), 1.1f }, SaveJPG },
+#endif
+#ifdef BUDGET_PNG_LIBPNG
+    { { "png", 16, KB(8), 1.1f }, SavePNG },
+#endif
+    { { "tga", 16, KB(8), 1.1f }, SaveTGA },
+};
+
+/* Load an image from memory and check the allocations against a budget.
+ * Returns false if the image can't be loaded in this build.
+ */
+static bool CheckBudget(const AllocBudget *budget, const void *data, size_t datasize)
+{
+    SDL_IOStream *src;
+    SDL_Surface *surface;
+    size_t image_bytes, max_bytes;
+    size_t bytes;
+    int count;
+
+    /* Load once first, so lazy initialization and kept buffers aren't counted */
+    surface = IMG_Load_IO(SDL_IOFromConstMem(data, datasize), true);
+    if (!surface) {
+        SDLTest_Log("%s: skipped, can't be loaded: %s", budget->name, SDL_GetError());
+        return false;
+    }
+    SDL_DestroySurface(surface);
+
+    src = SDL_IOFromConstMem(data, datasize);
+    SDLTest_AssertCheck(src != NULL, "SDL_IOFromConstMem(%s)", budget->name);
+    if (!src) {
+        return true;
+    }
+    StartCountingAllocations();
+    surface = IMG_Load_IO(src, true);
+    StopCountingAllocations(&count, &bytes);
+    SDLTest_AssertCheck(surface != NULL, "IMG_Load_IO(%s)", budget->name);
+    if (!surface) {
+        return true;
+    }
+
+    image_bytes = (size_t)surface->pitch * surface->h;
+    max_bytes = budget->max_bytes + (size_t)(budget->max_image_ratio * image_bytes);
+    SDLTest_Log("%s: %dx%d, %d allocations, %u bytes for a %u byte image",
+                budget->name, surface->w, surface->h, count, (unsigned int)bytes, (unsigned int)image_bytes);
+    SDLTest_AssertCheck(count <= budget->max_allocations,
+                        "%s: %d allocations, budget is %d",
+                        budget->name, count, budget->max_allocations);
+    SDLTest_AssertCheck(bytes <= max_bytes,
+                        "%s: %u bytes allocated, budget is %u",
+                        budget->name, (unsigned int)bytes, (unsigned int)max_bytes);
+
+    SDL_DestroySurface(surface);
+    return true;
+}
+
+/* Create an RGBA image with smooth gradients */
+static SDL_Surface *CreateGeneratedSurface(void)
+{
+    SDL_Surface *surface;
+    int x, y;
+
+    surface = SDL_CreateSurface(GENERATED_SIZE, GENERATED_SIZE, SDL_PIXELFORMAT_RGBA32);
+    if (!surface) {
+        return NULL;
+    }
+    for (y = 0; y < surface->h; ++y) {
+        Uint8 *row = (Uint8 *)surface->pixels + y * surface->pitch;
+        for (x = 0; x < surface->w; ++x) {
+            row[x * 4 + 0] = (Uint8)(x * 255 / surface->w);
+            row[x * 4 + 1] = (Uint8)(y * 255 / surface->h);
+            row[x * 4 + 2] = (Uint8)((x + y) / 4);
+            row[x * 4 + 3] = (Uint8)(255 - x / 4);
+        }
+    }
+    return surface;
+}
+
+static int SDLCALL TestSampleBudgets(void *arg)
+{
+    int i;
+    int checked = 0;
+
+    (void)arg;
+
+    if (!counting_allocations) {
+        SDLTest_Log("Couldn't install the counting allocator");
+        return TEST_SKIPPED;
+    }
+
+    for (i = 0; i < (int)SDL_arraysize(sample_budgets); ++i) {
+        const AllocBudget *budget = &sample_budgets[i];
+        char *filename;
+        void *data;
+        size_t datasize;
+
+        filename = GetTestFilename(TEST_FILE_DIST, budget->name);
+        SDLTest_AssertCheck(filename != NULL, "Building filename should succeed");
+        if (!filename) {
+            continue;
+        }
+        data = SDL_LoadFile(filename, &datasize);
+        SDLTest_AssertCheck(data != NULL, "SDL_LoadFile(\"%s\")", filename);
+        if (data) {
+            if (CheckBudget(budget, data, datasize)) {
+                ++checked;
+            }
+            SDL_free(data);
+        }
+        SDL_free(filename);
+    }
+
+    if (checked == 0) {
+        return TEST_SKIPPED;
+    }
+    return TEST_COMPLETED;
+}
+
+static int SDLCALL TestGeneratedBudgets(void *arg)
+{
+    SDL_Surface *surface;
+    int i;
+    int checked = 0;
+
+    (void)arg;
+
+    if (!counting_allocations) {
+        SDLTest_Log("Couldn't install the counting allocator");
+        return TEST_SKIPPED;
+    }
+
+    surface = CreateGeneratedSurface();
+    SDLTest_AssertCheck(surface != NULL, "Creating the generated image should succeed");
+    if (!surface) {
+        return TEST_ABORTED;
+    }
+
+    for (i = 0; i < (int)SDL_arraysize(generated_budgets); ++i) {
+        const GeneratedBudget *generated = &generated_budgets[i];
+        SDL_IOStream *dst;
+
+        dst = SDL_IOFromDynamicMem();
+        SDLTest_AssertCheck(dst != NULL, "SDL_IOFromDynamicMem()");
+        if (!dst) {
+            continue;
+        }
+        if (generated->save(surface, dst)) {
+            const void *mem = SDL_GetPointerProperty(SDL_GetIOProperties(dst), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+
+            if (CheckBudget(&generated->budget, mem, (size_t)SDL_TellIO(dst))) {
+                ++checked;
+            }
+        } else {
+            SDLTest_Log("%s: skipped, can't be saved: %s", generated->budget.name, SDL_GetError());
+        }
+        SDL_CloseIO(dst);
+    }
+
+    SDL_DestroySurface(surface);
+
+    if (checked == 0) {
+        return TEST_SKIPPED;
+    }
+    return TEST_COMPLETED;
+}
+
+static const SDLTest_TestCaseReference sampleBudgetsTestCase = {
+    TestSampleBudgets, "SampleBudgets", "Check the allocations made loading the sample images", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference generatedBudgetsTestCase = {
+    TestGeneratedBudgets, "GeneratedBudgets", "Check the allocations made loading generated images", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference *testCases[] =  {
+    &sampleBudgetsTestCase,
+    &generatedBudgetsTestCase,
+    NULL
+};
+static SDLTest_TestSuiteReference testSuite = {
+    "alloc",
+    NULL,
+    testCases,
+    NULL
+};
+static SDLTest_TestSuiteReference *testSuites[] =  {
+    &testSuite,
+    NULL
+};
+
+int main(int argc, char *argv[])
+{
+    int result;
+    SDLTest_CommonState *state;
+    SDLTest_TestSuiteRunner *runner;
+
+    counting_allocations = InstallCountingAllocator();
+
+    /* Initialize test framework */
+    state = SDLTest_CommonCreateState(argv, 0);
+    if (!state) {
+        return 1;
+    }
+
+    runner = SDLTest_CreateTestSuiteRunner(state, testSuites);
+
+    if (!SDLTest_CommonDefaultArgs(state, argc, argv)) {
+        return 1;
+    }
+
+    result = SDLTest_ExecuteTestSuiteRunner(runner);
+
+    SDL_Quit();
+    SDLTest_DestroyTestSuiteRunner(runner);
+    SDLTest_CommonDestroyState(state);
+    return result;
+}
@@ -863,6 +863,188 @@ static int SDLCALL testDecodeThirdPartyMetadata(void *args)
     return TEST_COMPLETED;
 }
 
+static bool SurfacesMatch(SDL_Surface *a, SDL_Surface *b)
+{
+    if (a->w != b->w || a->h != b->h || a->format != b->format) {
+        return false;
+    }
+    size_t row_size = (size_t)a->w * SDL_BYTESPERPIXEL(a->format);
+    for (int y = 0; y < a->h; ++y) {
+        if (SDL_memcmp((Uint8 *)a->pixels + y * a->pitch, (Uint8 *)b->pixels + y * b->pitch, row_size) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static IMG_AnimationDecoder *CreateFrameModeDecoder(const char *path, const char *mode)
+{
+    SDL_PropertiesID props = SDL_CreateProperties();
+    SDL_SetStringProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_FILENAME_STRING, path);
+    if (mode) {
+        SDL_SetBooleanProperty(props, mode, true);
+    }
+    IMG_AnimationDecoder *decoder = IMG_CreateAnimationDecoderWithProperties(props);
+    SDL_DestroyProperties(props);
+    return decoder;
+}
+
+static int SDLCALL testFrameModes(void *args)
+{
+    (void)args;
+    SDLTest_Log("Starting test 'Borrowed and Recycled Frames Test'");
+
+    for (size_t cim = 0; cim < SDL_arraysize(inputImages); ++cim) {
+        const char *inputImage = inputImages[cim].filename;
+
+        if (!FormatAnimationEnabled(inputImages[cim].format)) {
+            SDLTest_Log("Animation format %s disabled (input)", inputImages[cim].format);
+            continue;
+        }
+
+        char *inputImagePath = GetTestFilename(inputImage);
+        if (!inputImagePath) {
+            SDLTest_LogError("Failed to convert '%s' to absolute path", inputImage);
+            return TEST_ABORTED;
+        }
+
+        IMG_AnimationDecoder *decoder = CreateFrameModeDecoder(inputImagePath, NULL);
+        IMG_AnimationDecoder *borrowDecoder = CreateFrameModeDecoder(inputImagePath, IMG_PROP_ANIMATION_DECODER_CREATE_BORROW_FRAMES_BOOLEAN);
+        IMG_AnimationDecoder *recycleDecoder = CreateFrameModeDecoder(inputImagePath, IMG_PROP_ANIMATION_DECODER_CREATE_RECYCLE_FRAMES_BOOLEAN);
+        SDL_free(inputImagePath);
+        SDLTest_AssertCheck(decoder && borrowDecoder && recycleDecoder, "IMG_CreateAnimationDecoderWithProperties(\"%s\"): %s", inputImage, SDL_GetError());
+
+        SDL_Surface *recycled = NULL;
+        int frames = 0;
+        while (decoder && borrowDecoder && recycleDecoder) {
+            SDL_Surface *frame = NULL;
+            SDL_Surface *borrowed = NULL;
+            SDL_Surface *previous = recycled;
+
+            if (!IMG_GetAnimationDecoderFrame(decoder, &frame, NULL)) {
+                SDLTest_AssertCheck(IMG_GetAnimationDecoderStatus(decoder) == IMG_DECODER_STATUS_COMPLETE, "IMG_GetAnimationDecoderFrame: %s", SDL_GetError());
+                break;
+            }
+            bool gotBorrowed = IMG_GetAnimationDecoderFrame(borrowDecoder, &borrowed, NULL);
+            bool gotRecycled = IMG_GetAnimationDecoderFrame(recycleDecoder, &recycled, NULL);
+            SDLTest_AssertCheck(gotBorrowed && gotRecycled, "Frame %d of %s should decode in every mode: %s", frames, inputImage, SDL_GetError());
+            if (gotBorrowed && gotRecycled) {
+                SDLTest_AssertCheck(SurfacesMatch(frame, borrowed), "Borrowed frame %d of %s should match the owned frame", frames, inputImage);
+                SDLTest_AssertCheck(SurfacesMatch(frame, recycled), "Recycled frame %d of %s should match the owned frame", frames, inputImage);
+                // ANI frames are whole cursor images, loaded without a surface to decode into
+                if (previous && SDL_strcmp(inputImages[cim].format, "ANI") != 0) {
+                    SDLTest_AssertCheck(recycled == previous, "Frame %d of %s should be decoded into the recycled surface", frames, inputImage);
+                }
+            }
+            SDL_DestroySurface(frame);
+            if (!gotBorrowed || !gotRecycled) {
+                break;
+            }
+            ++frames;
+        }
+        SDLTest_AssertCheck(frames >= MIN_FRAMES, "%s should have at least %d frames, got %d", inputImage, MIN_FRAMES, frames);
+
+        SDL_DestroySurface(recycled);
+        IMG_CloseAnimationDecoder(decoder);
+        IMG_CloseAnimationDecoder(borrowDecoder);
+        IMG_CloseAnimationDecoder(recycleDecoder);
+    }
+
+    SDLTest_Log("Finished test 'Borrowed and Recycled Frames Test'.");
+    return TEST_COMPLETED;
+}
+
+/* Check that two frames only differ inside a rectangle */
+static bool SurfacesMatchOutside(SDL_Surface *a, SDL_Surface *b, const SDL_Rect *rect)
+{
+    if (a->w != b->w || a->h != b->h || a->format != b->format) {
+        return false;
+    }
+    int bpp = SDL_BYTESPERPIXEL(a->format);
+    for (int y = 0; y < a->h; ++y) {
+        const Uint8 *rowA = (const Uint8 *)a->pixels + y * a->pitch;
+        const Uint8 *rowB = (const Uint8 *)b->pixels + y * b->pitch;
+        if (y < rect->y || y >= rect->y + rect->h) {
+            if (SDL_memcmp(rowA, rowB, (size_t)a->w * bpp) != 0) {
+                return false;
+            }
+            continue;
+        }
+        int right = rect->x + rect->w;
+        if (SDL_memcmp(rowA, rowB, (size_t)rect->x * bpp) != 0 ||
+            SDL_memcmp(rowA + right * bpp, rowB + right * bpp, (size_t)(a->w - right) * bpp) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int SDLCALL testFrameRects(void *args)
+{
+    (void)args;
+    SDLTest_Log("Starting test 'Frame Rectangles Test'");
+
+    for (size_t cim = 0; cim < SDL_arraysize(inputImages); ++cim) {
+        const char *inputImage = inputImages[cim].filename;
+
+        if (!FormatAnimationEnabled(inputImages[cim].format)) {
+            SDLTest_Log("Animation format %s disabled (input)", inputImages[cim].format);
+            continue;
+        }
+
+        char *inputImagePath = GetTestFilename(inputImage);
+        if (!inputImagePath) {
+            SDLTest_LogError("Failed to convert '%s' to absolute path", inputImage);
+            return TEST_ABORTED;
+        }
+
+        IMG_AnimationDecoder *decoder = IMG_CreateAnimationDecoder(inputImagePath);
+        SDL_free(inputImagePath);
+        SDLTest_AssertCheck(decoder != NULL, "IMG_CreateAnimationDecoder(\"%s\"): %s", inputImage, SDL_GetError());
+        if (!decoder) {
+            continue;
+        }
+
+        SDL_Surface *previous = NULL;
+        SDL_Rect rect;
+        int frames = 0;
+        for (;;) {
+            SDL_Surface *frame = NULL;
+
+            if (!IMG_GetAnimationDecoderFrame(decoder, &frame, NULL)) {
+                SDLTest_AssertCheck(IMG_GetAnimationDecoderStatus(decoder) == IMG_DECODER_STATUS_COMPLETE, "IMG_GetAnimationDecoderFrame: %s", SDL_GetError());
+                SDLTest_AssertCheck(IMG_GetAnimationDecoderFrameRect(decoder, &rect) && SDL_RectEmpty(&rect), "The rectangle of %s should be empty after the last frame", inputImage);
+                break;
+            }
+            if (!IMG_GetAnimationDecoderFrameRect(decoder, &rect)) {
+                SDLTest_AssertCheck(false, "IMG_GetAnimationDecoderFrameRect: %s", SDL_GetError());
+                SDL_DestroySurface(frame);
+                break;
+            }
+
+            SDL_Rect bounds = { 0, 0, frame->w, frame->h };
+            SDL_Rect clipped;
+            if (!previous) {
+                SDLTest_AssertCheck(SDL_RectsEqual(&rect, &bounds), "The first frame of %s should change everything, got %d,%d %dx%d", inputImage, rect.x, rect.y, rect.w, rect.h);
+            } else {
+                bool inside = SDL_RectEmpty(&rect) || (SDL_GetRectIntersection(&rect, &bounds, &clipped) && SDL_RectsEqual(&rect, &clipped));
+                SDLTest_AssertCheck(inside, "The rectangle of frame %d of %s should be inside the frame", frames, inputImage);
+                SDLTest_AssertCheck(inside && SurfacesMatchOutside(frame, previous, &rect), "Frame %d of %s should only change inside %d,%d %dx%d", frames, inputImage, rect.x, rect.y, rect.w, rect.h);
+            }
+            SDL_DestroySurface(previous);
+            previous = frame;
+            ++frames;
+        }
+        SDLTest_AssertCheck(frames >= MIN_FRAMES, "%s should have at least %d frames, got %d", inputImage, MIN_FRAMES, frames);
+
+        SDL_DestroySurface(previous);
+        IMG_CloseAnimationDecoder(decoder);
+    }
+
+    SDLTest_Log("Finished test 'Frame Rectangles Test'.");
+    return TEST_COMPLETED;
+}
+
 static const SDLTest_TestCaseReference decodeEncodeAnimations = {
     testDecodeEncode, "decode_encode_animation", "Animation Decoder/Encoder Tests -- Decode, encode decoded frames then decode again to compare...", TEST_ENABLED
 };
@@ -879,11 +1061,21 @@ static const SDLTest_TestCaseReference decodeThirdPartyMetadata = {
     testDecodeThirdPartyMetadata, "animation_decodeThirdPartyMetadata", "Decode Third Party Metadata", TEST_ENABLED
 };
 
+static const SDLTest_TestCaseReference frameModes = {
+    testFrameModes, "animation_frameModes", "Borrowed and recycled decoder frames", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference frameRects = {
+    testFrameRects, "animation_frameRects", "Changed areas of decoder frames", TEST_ENABLED
+};
+
 static const SDLTest_TestCaseReference *animationTests[] = {
     &decodeEncodeAnimations,
     &decoderRewindAnimations,
     &animationMetadata,
     &decodeThirdPartyMetadata,
+    &frameModes,
+    &frameRects,
     NULL
 };
 
@@ -507,10 +507,34 @@ typedef enum
     LOAD_CONVENIENCE = 0,
     LOAD_IO,
     LOAD_TYPED_IO,
+    LOAD_CONST_MEM,
+    LOAD_INTO_IO,
+    LOAD_WITH_PROPERTIES,
+    LOAD_ASYNC,
     LOAD_FORMAT_SPECIFIC,
     LOAD_SIZED
 } LoadMode;
 
+typedef struct
+{
+    SDL_Semaphore *done;
+    SDL_Surface *surface;
+    char *error;
+} AsyncLoadResult;
+
+static void SDLCALL
+AsyncLoadCallback(void *userdata, IMG_LoadID id, SDL_Surface *surface, const char *error)
+{
+    AsyncLoadResult *result = (AsyncLoadResult *)userdata;
+
+    (void)id;
+    result->surface = surface;
+    if (error) {
+        result->error = SDL_strdup(error);
+    }
+    SDL_SignalSemaphore(result->done);
+}
+
 /* Convert to RGBA for comparison, if necessary */
 static bool
 ConvertToRgba32(SDL_Surface **surface_p)
@@ -718,6 +742,36 @@ FormatLoadTest(const Format *format,
                                     filename, format->name, check);
             }
 
+            if (format->checkFunction != NULL) {
+                SDLTest_AssertPass("About to call IMG_DetectFormat(<src>)");
+                const char *detected = IMG_DetectFormat(src);
+
+                SDLTest_AssertCheck(detected != NULL &&
+                                    SDL_strncmp(format->name, detected, SDL_strlen(detected)) == 0,
+                                    "Should detect %s as %s -> %s",
+                                    filename, format->name, detected ? detected : "(null)");
+            }
+
+            if (format->checkFunction != NULL) {
+                SDLTest_AssertPass("About to call IMG_GetImageInfo_IO(<src>, false)");
+                SDL_PropertiesID info = IMG_GetImageInfo_IO(src, false);
+
+                if (SDLTest_AssertCheck(info != 0,
+                                        "Get image info for %s (%s)",
+                                        filename, SDL_GetError())) {
+                    Sint64 w = SDL_GetNumberProperty(info, IMG_PROP_INFO_WIDTH_NUMBER, 0);
+                    Sint64 h = SDL_GetNumberProperty(info, IMG_PROP_INFO_HEIGHT_NUMBER, 0);
+
+                    SDLTest_AssertCheck(w == format->w,
+                                        "Expected info width %d px, got %d",
+                                        format->w, (int)w);
+                    SDLTest_AssertCheck(h == format->h,
+                                        "Expected info height %d px, got %d",
+                                        format->h, (int)h);
+                    SDL_DestroyProperties(info);
+                }
+            }
+
             SDL_ClearError();
             SDLTest_AssertPass("About to call IMG_Load_IO(<src>, true)");
             surface = IMG_Load_IO(src, true);
@@ -730,6 +784,81 @@ FormatLoadTest(const Format *format,
             src = NULL;      /* ownership taken */
             break;
 
+        case LOAD_CONST_MEM:
+            {
+                size_t size = 0;
+                void *data = SDL_LoadFile_IO(src, &size, false);
+
+                if (SDLTest_AssertCheck(data != NULL,
+                                        "Reading %s should succeed (%s)",
+                                        filename, SDL_GetError())) {
+                    SDLTest_AssertPass("About to call IMG_LoadTyped_IO(<const memory>, true, \"%s\")", format->name);
+                    surface = IMG_LoadTyped_IO(SDL_IOFromConstMem(data, size), true, format->name);
+                    SDL_free(data);
+                }
+            }
+            break;
+
+        case LOAD_INTO_IO:
+            surface = SDL_CreateSurface(format->w, format->h, SDL_PIXELFORMAT_RGBA32);
+            SDLTest_AssertCheck(surface != NULL,
+                                "Creating target surface should succeed (%s)",
+                                SDL_GetError());
+            if (surface != NULL) {
+                SDLTest_AssertPass("About to call IMG_LoadTypedInto_IO(<src>, true, \"%s\", <surface>)", format->name);
+                if (!IMG_LoadTypedInto_IO(src, true, format->name, surface)) {
+                    SDL_DestroySurface(surface);
+                    surface = NULL;
+                }
+            }
+            src = NULL;      /* ownership taken */
+            break;
+
+        case LOAD_WITH_PROPERTIES:
+            {
+                SDL_PropertiesID props = SDL_CreateProperties();
+
+                SDL_SetPointerProperty(props, IMG_PROP_LOAD_IOSTREAM_POINTER, src);
+                SDL_SetBooleanProperty(props, IMG_PROP_LOAD_IOSTREAM_AUTOCLOSE_BOOLEAN, true);
+                SDL_SetStringProperty(props, IMG_PROP_LOAD_TYPE_STRING, format->name);
+                SDL_SetNumberProperty(props, IMG_PROP_LOAD_PIXEL_FORMAT_NUMBER, SDL_PIXELFORMAT_BGRA32);
+                SDLTest_AssertPass("About to call IMG_LoadWithProperties(<props>)");
+                surface = IMG_LoadWithProperties(props);
+                src = NULL;      /* ownership taken */
+                SDL_DestroyProperties(props);
+
+                if (surface != NULL) {
+                    SDLTest_AssertCheck(surface->format == SDL_PIXELFORMAT_BGRA32,
+                                        "Expected format %s, got %s",
+                                        SDL_GetPixelFormatName(SDL_PIXELFORMAT_BGRA32),
+                                        SDL_GetPixelFormatName(surface->format));
+                }
+            }
+            break;
+
+        case LOAD_ASYNC:
+            {
+                AsyncLoadResult result;
+                IMG_LoadID id;
+
+                SDL_zero(result);
+                result.done = SDL_CreateSemaphore(0);
+                SDLTest_AssertPass("About to call IMG_LoadAsync_IO(<src>, true, <callback>)");
+                id = IMG_LoadAsync_IO(src, true, AsyncLoadCallback, &result);
+                src = NULL;      /* ownership taken */
+
+                if (SDLTest_AssertCheck(id != 0, "IMG_LoadAsync_IO should succeed (%s)", SDL_GetError())) {
+                    SDL_WaitSemaphore(result.done);
+                    surface = result.surface;
+                    if (!surface) {
+                        SDL_SetError("%s", result.error);
+                    }
+                }
+                SDL_free(result.error);
+                SDL_DestroySemaphore(result.done);
+            }
+            break;
+
         case LOAD_FORMAT_SPECIFIC:
             SDLTest_AssertPass("About to call IMG_Load%s_IO(<src>)", format->name);
             surface = format->loadFunction(src);
@@ -875,6 +1004,202 @@ out:
     }
 }
 
+static void
+FormatScaledLoadTest(const Format *format)
+{
+    /* Denominators libjpeg can reach directly, partway and not at all */
+    static const int denominators[] = { 2, 3, 16 };
+    SDL_PropertiesID props;
+    SDL_Surface *surface;
+    char *filename;
+    int max_width = SDL_max(format->w / 3, 1);
+    int i;
+
+    filename = GetTestFilename(TEST_FILE_DIST, format->sample);
+    if (!SDLTest_AssertCheck(filename != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        return;
+    }
+
+    props = SDL_CreateProperties();
+    SDL_SetStringProperty(props, IMG_PROP_LOAD_FILENAME_STRING, filename);
+    SDL_SetStringProperty(props, IMG_PROP_LOAD_TYPE_STRING, format->name);
+    for (i = 0; i < (int)SDL_arraysize(denominators); ++i) {
+        int denom = denominators[i];
+        int expected_w = (format->w + denom - 1) / denom;
+        int expected_h = (format->h + denom - 1) / denom;
+
+        SDL_SetNumberProperty(props, IMG_PROP_LOAD_SCALE_DENOMINATOR_NUMBER, denom);
+        SDLTest_AssertPass("About to call IMG_LoadWithProperties(<scale denominator %d>)", denom);
+        surface = IMG_LoadWithProperties(props);
+        if (SDLTest_AssertCheck(surface != NULL,
+                                "Load %s at 1/%d size (%s)", filename, denom, SDL_GetError())) {
+            SDLTest_AssertCheck(surface->w == expected_w && surface->h == expected_h,
+                                "Expected %dx%d px, got %dx%d",
+                                expected_w, expected_h, surface->w, surface->h);
+            SDL_DestroySurface(surface);
+        }
+    }
+
+    SDL_SetNumberProperty(props, IMG_PROP_LOAD_SCALE_DENOMINATOR_NUMBER, 1);
+    SDL_SetNumberProperty(props, IMG_PROP_LOAD_MAX_WIDTH_NUMBER, max_width);
+    SDLTest_AssertPass("About to call IMG_LoadWithProperties(<max width %d>)", max_width);
+    surface = IMG_LoadWithProperties(props);
+    if (SDLTest_AssertCheck(surface != NULL,
+                            "Load %s with a maximum width (%s)", filename, SDL_GetError())) {
+        SDLTest_AssertCheck(surface->w == max_width && surface->h <= format->h,
+                            "Expected width %d px, got %dx%d",
+                            max_width, surface->w, surface->h);
+        SDL_DestroySurface(surface);
+    }
+
+    SDL_DestroyProperties(props);
+    SDL_free(filename);
+}
+
+static void
+FormatRegionLoadTest(const Format *format)
+{
+    SDL_Surface *full = NULL;
+    SDL_Surface *expected = NULL;
+    SDL_Surface *surface = NULL;
+    SDL_IOStream *src;
+    SDL_Rect rect;
+    char *filename;
+    int diff;
+
+    filename = GetTestFilename(TEST_FILE_DIST, format->sample);
+    if (!SDLTest_AssertCheck(filename != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        return;
+    }
+
+    SDLTest_AssertPass("About to call IMG_Load(\"%s\")", filename);
+    full = IMG_Load(filename);
+    if (!SDLTest_AssertCheck(full != NULL, "Load %s (%s)", filename, SDL_GetError()) ||
+        !ConvertToRgba32(&full)) {
+        goto out;
+    }
+
+    /* The region extends past the right edge of the image, so it gets clipped */
+    rect.x = format->w / 2;
+    rect.y = format->h / 4;
+    rect.w = format->w;
+    rect.h = SDL_max(format->h / 2, 1);
+
+    src = SDL_IOFromFile(filename, "rb");
+    SDLTest_AssertPass("About to call IMG_LoadRegion_IO(<src>, true, { %d, %d, %d, %d })",
+                       rect.x, rect.y, rect.w, rect.h);
+    surface = IMG_LoadRegion_IO(src, true, &rect);
+    if (!SDLTest_AssertCheck(surface != NULL, "Load region of %s (%s)", filename, SDL_GetError())) {
+        goto out;
+    }
+    SDLTest_AssertCheck(surface->w == format->w - rect.x && surface->h == rect.h,
+                        "Expected %dx%d px, got %dx%d",
+                        format->w - rect.x, rect.h, surface->w, surface->h);
+    if (!ConvertToRgba32(&surface) || surface->w != format->w - rect.x || surface->h != rect.h) {
+        goto out;
+    }
+
+    expected = SDL_CreateSurfaceFrom(surface->w, surface->h, full->format,
+                                     (Uint8 *)full->pixels + rect.y * full->pitch + rect.x * 4, full->pitch);
+    if (SDLTest_AssertCheck(expected != NULL, "Creating expected region should succeed (%s)", SDL_GetError())) {
+        diff = SDLTest_CompareSurfaces(surface, expected, format->tolerance);
+        SDLTest_AssertCheck(diff == 0,
+                            "Region differed from full image by at most %d in %d pixels",
+                            format->tolerance, diff);
+    }
+
+    rect.x = format->w;
+    src = SDL_IOFromFile(filename, "rb");
+    SDLTest_AssertPass("About to call IMG_LoadRegion_IO(<src>, true, <outside of image>)");
+    SDL_DestroySurface(surface);
+    surface = IMG_LoadRegion_IO(src, true, &rect);
+    SDLTest_AssertCheck(surface == NULL, "Loading a region outside of the image should fail");
+
+out:
+    SDL_DestroySurface(surface);
+    SDL_DestroySurface(expected);
+    SDL_DestroySurface(full);
+    SDL_free(filename);
+}
+
+static void
+FormatTextureLoadTest(const Format *format, bool streaming)
+{
+    SDL_Surface *target = NULL;
+    SDL_Surface *reference = NULL;
+    SDL_Surface *surface = NULL;
+    SDL_Renderer *renderer = NULL;
+    SDL_Texture *texture = NULL;
+    char *filename;
+    int diff;
+
+    filename = GetTestFilename(TEST_FILE_DIST, format->sample);
+    if (!SDLTest_AssertCheck(filename != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        return;
+    }
+
+    target = SDL_CreateSurface(format->w, format->h, SDL_PIXELFORMAT_RGBA32);
+    if (!SDLTest_AssertCheck(target != NULL, "Creating render target should succeed (%s)", SDL_GetError())) {
+        goto out;
+    }
+    renderer = SDL_CreateSoftwareRenderer(target);
+    if (!SDLTest_AssertCheck(renderer != NULL, "Creating software renderer should succeed (%s)", SDL_GetError())) {
+        goto out;
+    }
+
+    SDL_SetHint(IMG_HINT_STREAMING_TEXTURES, streaming ? "1" : "0");
+    SDLTest_AssertPass("About to call IMG_LoadTexture(<software renderer>, \"%s\") with %s textures",
+                       filename, streaming ? "streaming" : "static");
+    texture = IMG_LoadTexture(renderer, filename);
+    SDL_ResetHint(IMG_HINT_STREAMING_TEXTURES);
+    if (!SDLTest_AssertCheck(texture != NULL, "Load %s as a texture (%s)", filename, SDL_GetError())) {
+        goto out;
+    }
+    if (!streaming) {
+        SDL_TextureAccess access = (SDL_TextureAccess)SDL_GetNumberProperty(SDL_GetTextureProperties(texture), SDL_PROP_TEXTURE_ACCESS_NUMBER, -1);
+        SDLTest_AssertCheck(access == SDL_TEXTUREACCESS_STATIC,
+                            "Textures should be static by default, got access %d", (int)access);
+    }
+    if (!SDLTest_AssertCheck(texture->w == format->w && texture->h == format->h,
+                             "Expected %dx%d px, got %dx%d",
+                             format->w, format->h, texture->w, texture->h)) {
+        goto out;
+    }
+
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+    SDL_RenderTexture(renderer, texture, NULL, NULL);
+    surface = SDL_RenderReadPixels(renderer, NULL);
+    if (!SDLTest_AssertCheck(surface != NULL, "Reading rendered pixels should succeed (%s)", SDL_GetError()) ||
+        !ConvertToRgba32(&surface)) {
+        goto out;
+    }
+
+    reference = IMG_Load(filename);
+    if (!SDLTest_AssertCheck(reference != NULL, "Load %s (%s)", filename, SDL_GetError()) ||
+        !ConvertToRgba32(&reference)) {
+        goto out;
+    }
+
+    diff = SDLTest_CompareSurfaces(surface, reference, format->tolerance);
+    SDLTest_AssertCheck(diff == 0,
+                        "Texture differed from IMG_Load() by at most %d in %d pixels",
+                        format->tolerance, diff);
+
+out:
+    SDL_DestroySurface(reference);
+    SDL_DestroySurface(surface);
+    SDL_DestroyTexture(texture);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroySurface(target);
+    SDL_free(filename);
+}
+
 static void
 FormatTest(const Format *format)
 {
@@ -902,9 +1227,17 @@ FormatTest(const Format *format)
                 SDLTest_Log("SKIP: Recognising %s by magic number is not supported", format->name);
             } else {
                 FormatLoadTest(format, LOAD_IO);
+                FormatLoadTest(format, LOAD_ASYNC);
+                FormatRegionLoadTest(format);
             }
 
             FormatLoadTest(format, LOAD_TYPED_IO);
+            FormatLoadTest(format, LOAD_CONST_MEM);
+            FormatLoadTest(format, LOAD_INTO_IO);
+            FormatLoadTest(format, LOAD_WITH_PROPERTIES);
+            FormatScaledLoadTest(format);
+            FormatTextureLoadTest(format, false);
+            FormatTextureLoadTest(format, true);
 
             if (format->loadFunction != NULL) {
                 FormatLoadTest(format, LOAD_FORMAT_SPECIFIC);
@@ -945,12 +1278,847 @@ TestFormats(void *arg)
     return TEST_COMPLETED;
 }
 
+static int SDLCALL
+TestLoadBatch(void *arg)
+{
+    const Format *loaded[SDL_arraysize(formats)];
+    const char *files[SDL_arraysize(formats) + 1];
+    SDL_Surface *out[SDL_arraysize(formats) + 1];
+    char *errors[SDL_arraysize(formats) + 1];
+    int count = 0;
+    bool result;
+    size_t i;
+    int j;
+    (void)arg;
+
+    for (i = 0; i < SDL_arraysize(formats); i++) {
+        if (!formats[i].canLoad || SDL_strcmp(formats[i].name, "SVG-sized") == 0) {
+            continue;
+        }
+        files[count] = GetTestFilename(TEST_FILE_DIST, formats[i].sample);
+        if (!SDLTest_AssertCheck(files[count] != NULL,
+                                 "Building filename should succeed (%s)",
+                                 SDL_GetError())) {
+            goto out;
+        }
+        loaded[count] = &formats[i];
+        ++count;
+    }
+
+    /* One file that can't be loaded, to check the per-file errors */
+    files[count] = GetTestFilename(TEST_FILE_DIST, "nonexistent.png");
+    if (!SDLTest_AssertCheck(files[count] != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        goto out;
+    }
+    ++count;
+
+    SDLTest_AssertPass("About to call IMG_LoadBatch(<%d files>, 4 threads)", count);
+    result = IMG_LoadBatch(files, count, out, 4, errors);
+    SDLTest_AssertCheck(!result, "Loading a batch with a missing file should fail");
+
+    for (j = 0; j < count - 1; j++) {
+        if (SDLTest_AssertCheck(out[j] != NULL,
+                                "Load %s in a batch (%s)",
+                                files[j], errors[j] ? errors[j] : "")) {
+            SDLTest_AssertCheck(out[j]->w == loaded[j]->w && out[j]->h == loaded[j]->h,
+                                "Expected %dx%d px, got %dx%d",
+                                loaded[j]->w, loaded[j]->h, out[j]->w, out[j]->h);
+        }
+        SDLTest_AssertCheck(errors[j] == NULL, "No error should be reported for %s", files[j]);
+    }
+    SDLTest_AssertCheck(out[count - 1] == NULL && errors[count - 1] != NULL,
+                        "Loading %s in a batch should report an error", files[count - 1]);
+
+    for (j = 0; j < count; j++) {
+        SDL_DestroySurface(out[j]);
+        SDL_free(errors[j]);
+    }
+
+out:
+    for (j = 0; j < count; j++) {
+        SDL_free((char *)files[j]);
+    }
+    return TEST_COMPLETED;
+}
+
+static int SDLCALL
+TestLoadCached(void *arg)
+{
+    IMG_Cache *cache = NULL;
+    IMG_CacheStats stats;
+    SDL_Surface *first = NULL;
+    SDL_Surface *second = NULL;
+    SDL_Surface *other = NULL;
+    SDL_IOStream *src;
+    char *bmp = NULL;
+    char *palette = NULL;
+    (void)arg;
+
+    bmp = GetTestFilename(TEST_FILE_DIST, "sample.bmp");
+    palette = GetTestFilename(TEST_FILE_DIST, "palette.bmp");
+    if (!SDLTest_AssertCheck(bmp != NULL && palette != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        goto out;
+    }
+
+    cache = IMG_CreateCache(64 * 1024 * 1024);
+    if (!SDLTest_AssertCheck(cache != NULL,
+                             "IMG_CreateCache should succeed (%s)",
+                             SDL_GetError())) {
+        goto out;
+    }
+
+    first = IMG_LoadCached(cache, bmp);
+    second = IMG_LoadCached(cache, bmp);
+    if (!SDLTest_AssertCheck(first != NULL && second != NULL,
+                             "IMG_LoadCached(\"%s\") should succeed (%s)",
+                             bmp, SDL_GetError())) {
+        goto out;
+    }
+    SDLTest_AssertCheck(first == second, "Loading the same file twice should return the cached image");
+    IMG_GetCacheStats(cache, &stats);
+    SDLTest_AssertCheck(stats.hits == 1 && stats.misses == 1 && stats.count == 1,
+                        "Expected 1 hit, 1 miss and 1 image, got %d, %d and %d",
+                        (int)stats.hits, (int)stats.misses, stats.count);
+    IMG_ReleaseCachedSurface(second);
+    second = NULL;
+
+    /* The stream is only read on a miss */
+    src = SDL_IOFromFile(bmp, "rb");
+    second = IMG_LoadCached_IO(cache, "sample", src, true);
+    src = SDL_IOFromFile(bmp, "rb");
+    other = IMG_LoadCached_IO(cache, "sample", src, true);
+    SDLTest_AssertCheck(second != NULL && second == other,
+                        "Loading the same key twice should return the cached image");
+    IMG_ReleaseCachedSurface(other);
+    other = NULL;
+    IMG_ReleaseCachedSurface(second);
+    second = NULL;
+
+    SDLTest_AssertCheck(IMG_LoadCached(cache, "nonexistent.png") == NULL,
+                        "Loading a missing file should fail");
+    IMG_DestroyCache(cache);
+
+    /* A cache that can only hold one image at a time */
+    cache = IMG_CreateCache((size_t)first->pitch * first->h);
+    if (!SDLTest_AssertCheck(cache != NULL,
+                             "IMG_CreateCache should succeed (%s)",
+                             SDL_GetError())) {
+        goto out;
+    }
+    second = IMG_LoadCached(cache, bmp);
+    other = IMG_LoadCached(cache, palette);
+    SDLTest_AssertCheck(second != NULL && other != NULL,
+                        "IMG_LoadCached should succeed (%s)",
+                        SDL_GetError());
+    IMG_GetCacheStats(cache, &stats);
+    SDLTest_AssertCheck(stats.evictions >= 1 && stats.bytes <= (size_t)first->pitch * first->h,
+                        "The cache should stay within its budget");
+    SDLTest_AssertCheck(second == NULL || second->w == first->w,
+                        "Evicted images should stay valid until they're released");
+
+out:
+    IMG_ReleaseCachedSurface(first);
+    IMG_ReleaseCachedSurface(second);
+    IMG_ReleaseCachedSurface(other);
+    IMG_DestroyCache(cache);
+    SDL_free(bmp);
+    SDL_free(palette);
+    return TEST_COMPLETED;
+}
+
+static int SDLCALL
+TestDiskCache(void *arg)
+{
+    SDL_Surface *decoded = NULL;
+    SDL_Surface *cached = NULL;
+    char *bmp = NULL;
+    char *dir = NULL;
+    char **files;
+    int count = -1;
+    (void)arg;
+
+    bmp = GetTestFilename(TEST_FILE_DIST, "sample.bmp");
+    dir = GetTestFilename(TEST_FILE_BUILT, "diskcache");
+    if (!SDLTest_AssertCheck(bmp != NULL && dir != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        goto out;
+    }
+
+    if (!SDLTest_AssertCheck(IMG_SetDiskCacheDirectory(dir),
+                             "IMG_SetDiskCacheDirectory(\"%s\") should succeed (%s)",
+                             dir, SDL_GetError())) {
+        goto out;
+    }
+    IMG_PruneDiskCache(0);
+
+    /* Load through a stream, IMG_Load() may use a platform backend */
+    SDL_SetHint(IMG_HINT_LOAD_STATS, "1");
+    decoded = IMG_Load_IO(SDL_IOFromFile(bmp, "rb"), true);
+    cached = IMG_Load_IO(SDL_IOFromFile(bmp, "rb"), true);
+    SDL_ResetHint(IMG_HINT_LOAD_STATS);
+    if (SDLTest_AssertCheck(decoded != NULL && cached != NULL,
+                            "Loading %s twice should succeed (%s)",
+                            bmp, SDL_GetError())) {
+        SDLTest_AssertCheck(!SDL_GetBooleanProperty(SDL_GetSurfaceProperties(decoded), IMG_PROP_STATS_DISK_CACHE_HIT_BOOLEAN, true),
+                            "The first load should decode the image");
+        SDLTest_AssertCheck(SDL_GetBooleanProperty(SDL_GetSurfaceProperties(cached), IMG_PROP_STATS_DISK_CACHE_HIT_BOOLEAN, false),
+                            "The second load should come from the disk cache");
+        SDLTest_AssertCheck(cached->format == decoded->format,
+                            "The cached image should have the same format");
+        SDLTest_AssertCheck(SDLTest_CompareSurfaces(cached, decoded, 0) == 0,
+                            "The cached image should have the same pixels");
+    }
+    SDL_DestroySurface(cached);
+
+    /* The decode limits apply to cached images too */
+    SDL_SetHint(IMG_HINT_MAX_PIXELS, "16");
+    cached = IMG_Load_IO(SDL_IOFromFile(bmp, "rb"), true);
+    SDL_ResetHint(IMG_HINT_MAX_PIXELS);
+    SDLTest_AssertCheck(cached == NULL,
+                        "Loading a cached image over " IMG_HINT_MAX_PIXELS " should fail");
+
+    files = SDL_GlobDirectory(dir, "*", 0, &count);
+    SDLTest_AssertCheck(count == 1, "Expected 1 cached image, got %d", count);
+    SDL_free(files);
+
+    SDLTest_AssertCheck(IMG_PruneDiskCache(0),
+                        "IMG_PruneDiskCache(0) should succeed (%s)",
+                        SDL_GetError());
+    files = SDL_GlobDirectory(dir, "*", 0, &count);
+    SDLTest_AssertCheck(count == 0, "Expected no cached images after pruning, got %d", count);
+    SDL_free(files);
+
+    IMG_SetDiskCacheDirectory(NULL);
+    SDL_RemovePath(dir);
+
+out:
+    SDL_DestroySurface(decoded);
+    SDL_DestroySurface(cached);
+    SDL_free(bmp);
+    SDL_free(dir);
+    return TEST_COMPLETED;
+}
+
+static int SDLCALL
+TestLoadStats(void *arg)
+{
+    IMG_FormatStats stats;
+    SDL_Surface *surface = NULL;
+    SDL_PropertiesID props;
+    char *bmp = NULL;
+    (void)arg;
+
+    bmp = GetTestFilename(TEST_FILE_DIST, "sample.bmp");
+    if (!SDLTest_AssertCheck(bmp != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        goto out;
+    }
+
+    surface = IMG_Load(bmp);
+    if (!SDLTest_AssertCheck(surface != NULL,
+                             "IMG_Load(\"%s\") should succeed (%s)",
+                             bmp, SDL_GetError())) {
+        goto out;
+    }
+    props = SDL_GetSurfaceProperties(surface);
+    SDLTest_AssertCheck(!SDL_HasProperty(props, IMG_PROP_STATS_BYTES_READ_NUMBER),
+                        "Statistics should only be collected when enabled");
+    SDL_DestroySurface(surface);
+
+    /* Load through a stream, IMG_Load() may use a platform backend */
+    SDL_SetHint(IMG_HINT_LOAD_STATS, "1");
+    IMG_ResetFormatStats();
+    surface = IMG_Load_IO(SDL_IOFromFile(bmp, "rb"), true);
+    SDL_ResetHint(IMG_HINT_LOAD_STATS);
+    if (!SDLTest_AssertCheck(surface != NULL,
+                             "IMG_Load_IO(\"%s\") should succeed (%s)",
+                             bmp, SDL_GetError())) {
+        goto out;
+    }
+
+    props = SDL_GetSurfaceProperties(surface);
+    SDLTest_AssertCheck(SDL_strcmp(SDL_GetStringProperty(props, IMG_PROP_STATS_TYPE_STRING, ""), "BMP") == 0,
+                        "The decoded format should be BMP");
+    SDLTest_AssertCheck(SDL_GetNumberProperty(props, IMG_PROP_STATS_BYTES_READ_NUMBER, 0) > 0 &&
+                        SDL_GetNumberProperty(props, IMG_PROP_STATS_READ_CALLS_NUMBER, 0) > 0,
+                        "The reads should be counted");
+    SDLTest_AssertCheck(SDL_GetNumberProperty(props, IMG_PROP_STATS_PROBES_NUMBER, 0) > 0,
+                        "The format probes should be counted");
+    SDLTest_AssertCheck(SDL_GetNumberProperty(props, IMG_PROP_STATS_BYTES_ALLOCATED_NUMBER, 0) >= (Sint64)surface->pitch * surface->h,
+                        "The pixels should be counted as allocated");
+    SDLTest_AssertCheck(SDL_HasProperty(props, IMG_PROP_STATS_DECODE_US_NUMBER),
+                        "The decode time should be set");
+
+    SDLTest_AssertCheck(IMG_GetFormatStats("bmp", &stats) && stats.loads == 1 && stats.failures == 0,
+                        "Expected 1 BMP load, got %d", (int)stats.loads);
+    SDLTest_AssertCheck(stats.bytes_read == (Uint64)SDL_GetNumberProperty(props, IMG_PROP_STATS_BYTES_READ_NUMBER, 0),
+                        "The format totals should include the load");
+    IMG_ResetFormatStats();
+    IMG_GetFormatStats("BMP", &stats);
+    SDLTest_AssertCheck(stats.loads == 0, "IMG_ResetFormatStats should clear the totals");
+
+out:
+    SDL_DestroySurface(surface);
+    SDL_free(bmp);
+    return TEST_COMPLETED;
+}
+
+static bool SDLCALL
+CountLoadProgress(void *userdata, float progress)
+{
+    int *calls = (int *)userdata;
+
+    ++*calls;
+    return progress >= 0.0f && progress <= 1.0f;
+}
+
+static bool SDLCALL
+CancelLoadProgress(void *userdata, float progress)
+{
+    (void)userdata;
+    (void)progress;
+    return false;
+}
+
+static int SDLCALL
+TestLoadProgress(void *arg)
+{
+    SDL_Surface *surface = NULL;
+    SDL_PropertiesID props = 0;
+    char *bmp = NULL;
+    int calls = 0;
+    (void)arg;
+
+    bmp = GetTestFilename(TEST_FILE_DIST, "sample.bmp");
+    if (!SDLTest_AssertCheck(bmp != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        goto out;
+    }
+
+    props = SDL_CreateProperties();
+    SDL_SetStringProperty(props, IMG_PROP_LOAD_FILENAME_STRING, bmp);
+    SDL_SetPointerProperty(props, IMG_PROP_LOAD_PROGRESS_CALLBACK_POINTER, (void *)CountLoadProgress);
+    SDL_SetPointerProperty(props, IMG_PROP_LOAD_PROGRESS_USERDATA_POINTER, &calls);
+    surface = IMG_LoadWithProperties(props);
+    SDLTest_AssertCheck(surface != NULL,
+                        "IMG_LoadWithProperties(\"%s\") should succeed (%s)",
+                        bmp, SDL_GetError());
+    SDLTest_AssertCheck(calls > 0, "The progress callback should be called");
+    SDLTest_AssertCheck(SDL_GetNumberProperty(props, IMG_PROP_LOAD_STATUS_NUMBER, -1) == IMG_LOAD_STATUS_OK,
+                        "The load status should be IMG_LOAD_STATUS_OK");
+    SDL_DestroySurface(surface);
+
+    /* Every decoder checks for cancellation at least when it finishes */
+    SDL_SetPointerProperty(props, IMG_PROP_LOAD_PROGRESS_CALLBACK_POINTER, (void *)CancelLoadProgress);
+    surface = IMG_LoadWithProperties(props);
+    SDLTest_AssertCheck(surface == NULL && SDL_strcmp(SDL_GetError(), "Load cancelled") == 0,
+                        "Returning false from the progress callback should cancel the load (%s)",
+                        SDL_GetError());
+    SDLTest_AssertCheck(SDL_GetNumberProperty(props, IMG_PROP_LOAD_STATUS_NUMBER, -1) == IMG_LOAD_STATUS_CANCELLED,
+                        "The load status should be IMG_LOAD_STATUS_CANCELLED");
+    SDL_DestroySurface(surface);
+
+    SDL_ClearProperty(props, IMG_PROP_LOAD_PROGRESS_CALLBACK_POINTER);
+    SDL_SetNumberProperty(props, IMG_PROP_LOAD_DEADLINE_NUMBER, 1);
+    surface = IMG_LoadWithProperties(props);
+    SDLTest_AssertCheck(surface == NULL && SDL_strcmp(SDL_GetError(), "Load cancelled") == 0,
+                        "A deadline in the past should cancel the load (%s)",
+                        SDL_GetError());
+    SDLTest_AssertCheck(SDL_GetNumberProperty(props, IMG_PROP_LOAD_STATUS_NUMBER, -1) == IMG_LOAD_STATUS_TIMED_OUT,
+                        "The load status should be IMG_LOAD_STATUS_TIMED_OUT");
+    SDL_DestroySurface(surface);
+
+    SDL_SetNumberProperty(props, IMG_PROP_LOAD_DEADLINE_NUMBER, 0);
+    SDL_SetStringProperty(props, IMG_PROP_LOAD_FILENAME_STRING, "nonexistent.bmp");
+    surface = IMG_LoadWithProperties(props);
+    SDLTest_AssertCheck(surface == NULL &&
+                        SDL_GetNumberProperty(props, IMG_PROP_LOAD_STATUS_NUMBER, -1) == IMG_LOAD_STATUS_FAILED,
+                        "The load status of a missing file should be IMG_LOAD_STATUS_FAILED");
+    SDL_DestroySurface(surface);
+    surface = NULL;
+
+out:
+    SDL_DestroySurface(surface);
+    SDL_DestroyProperties(props);
+    SDL_free(bmp);
+    return TEST_COMPLETED;
+}
+
+static int SDLCALL
+TestDecodeLimits(void *arg)
+{
+    SDL_Surface *surface = NULL;
+    SDL_PropertiesID props = 0;
+    char *bmp = NULL;
+    (void)arg;
+
+    bmp = GetTestFilename(TEST_FILE_DIST, "sample.bmp");
+    if (!SDLTest_AssertCheck(bmp != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        goto out;
+    }
+
+    SDL_SetHint(IMG_HINT_MAX_PIXELS, "16");
+    surface = IMG_Load(bmp);
+    SDLTest_AssertCheck(surface == NULL && SDL_strncmp(SDL_GetError(), "Image too large", 15) == 0,
+                        "Loading an image over " IMG_HINT_MAX_PIXELS " should fail (%s)",
+                        SDL_GetError());
+    SDL_DestroySurface(surface);
+
+    /* The load properties override the hints */
+    props = SDL_CreateProperties();
+    SDL_SetStringProperty(props, IMG_PROP_LOAD_FILENAME_STRING, bmp);
+    SDL_SetNumberProperty(props, IMG_PROP_LOAD_MAX_PIXELS_NUMBER, 0);
+    surface = IMG_LoadWithProperties(props);
+    SDLTest_AssertCheck(surface != NULL,
+                        "IMG_LoadWithProperties(\"%s\") with no pixel limit should succeed (%s)",
+                        bmp, SDL_GetError());
+    SDL_DestroySurface(surface);
+    SDL_ResetHint(IMG_HINT_MAX_PIXELS);
+
+    SDL_SetNumberProperty(props, IMG_PROP_LOAD_MAX_PIXELS_NUMBER, 0);
+    SDL_SetNumberProperty(props, IMG_PROP_LOAD_MAX_BYTES_NUMBER, 64);
+    surface = IMG_LoadWithProperties(props);
+    SDLTest_AssertCheck(surface == NULL && SDL_strncmp(SDL_GetError(), "Image too large", 15) == 0,
+                        "Loading an image over " IMG_PROP_LOAD_MAX_BYTES_NUMBER " should fail (%s)",
+                        SDL_GetError());
+    SDL_DestroySurface(surface);
+    surface = NULL;
+
+out:
+    SDL_ResetHint(IMG_HINT_MAX_PIXELS);
+    SDL_DestroySurface(surface);
+    SDL_DestroyProperties(props);
+    SDL_free(bmp);
+    return TEST_COMPLETED;
+}
+
+#if !USING_IMAGEIO && defined(LOAD_GIF)
+
+/* Builds a GIF with a single image out of raw LZW codes, to feed the decoder
+ * streams that no encoder would write.
+ */
+typedef struct
+{
+    Uint8 data[8192];
+    size_t size;
+    Uint8 codes[4096];
+    size_t codes_size;
+    Uint32 bits;
+    int nbits;
+    int clear_code;
+    int code_size;
+    int max_code;
+    int max_code_size;
+    bool fresh;
+} TestGIF;
+
+static void
+PutTestGIFByte(TestGIF *gif, int value)
+{
+    if (gif->size < sizeof(gif->data)) {
+        gif->data[gif->size++] = (Uint8)value;
+    }
+}
+
+/* Palette entry i is (i, 255 - i, 128) */
+static void
+StartTestGIF(TestGIF *gif, int screen_width, int screen_height, int colors)
+{
+    int bits = 1;
+    int i;
+
+    SDL_zerop(gif);
+    while ((2 << bits) < colors) {
+        ++bits;
+    }
+    SDL_memcpy(gif->data, "GIF89a", 6);
+    gif->size = 6;
+    PutTestGIFByte(gif, screen_width & 0xFF);
+    PutTestGIFByte(gif, screen_width >> 8);
+    PutTestGIFByte(gif, screen_height & 0xFF);
+    PutTestGIFByte(gif, screen_height >> 8);
+    PutTestGIFByte(gif, 0x80 | bits);
+    PutTestGIFByte(gif, 0);
+    PutTestGIFByte(gif, 0);
+    for (i = 0; i < (2 << bits); ++i) {
+        PutTestGIFByte(gif, i);
+        PutTestGIFByte(gif, 255 - i);
+        PutTestGIFByte(gif, 128);
+    }
+}
+
+static void
+ResetTestGIFCodes(TestGIF *gif)
+{
+    gif->code_size = 1;
+    while ((1 << gif->code_size) <= gif->clear_code) {
+        ++gif->code_size;
+    }
+    gif->max_code = gif->clear_code + 2;
+    gif->max_code_size = 2 * gif->clear_code;
+    gif->fresh = true;
+}
+
+static void
+AddTestGIFImage(TestGIF *gif, int left, int top, int width, int height, int min_code_size)
+{
+    PutTestGIFByte(gif, ',');
+    PutTestGIFByte(gif, left & 0xFF);
+    PutTestGIFByte(gif, left >> 8);
+    PutTestGIFByte(gif, top & 0xFF);
+    PutTestGIFByte(gif, top >> 8);
+    PutTestGIFByte(gif, width & 0xFF);
+    PutTestGIFByte(gif, width >> 8);
+    PutTestGIFByte(gif, height & 0xFF);
+    PutTestGIFByte(gif, height >> 8);
+    PutTestGIFByte(gif, 0);
+    PutTestGIFByte(gif, min_code_size);
+    gif->clear_code = 1 << SDL_min(min_code_size, 12);
+    ResetTestGIFCodes(gif);
+}
+
+/* Writes a code at the current code size, growing it the way the decoder does */
+static void
+PutTestGIFCode(TestGIF *gif, int code)
+{
+    gif->bits |= (Uint32)code << gif->nbits;
+    gif->nbits += gif->code_size;
+    while (gif->nbits >= 8 && gif->codes_size < sizeof(gif->codes)) {
+        gif->codes[gif->codes_size++] = (Uint8)gif->bits;
+        gif->bits >>= 8;
+        gif->nbits -= 8;
+    }
+
+    if (code == gif->clear_code) {
+        ResetTestGIFCodes(gif);
+    } else if (gif->fresh) {
+        gif->fresh = false;
+    } else if (gif->max_code < 4096) {
+        ++gif->max_code;
+        if (gif->max_code >= gif->max_code_size && gif->max_code_size < 4096) {
+            gif->max_code_size *= 2;
+            ++gif->code_size;
+        }
+    }
+}
+
+/* Packs the codes into data sub-blocks. A truncated file ends partway through
+ * a sub-block, with no block terminator or trailer.
+ */
+static void
+FinishTestGIF(TestGIF *gif, bool truncated)
+{
+    size_t i;
+    size_t count;
+
+    if (gif->nbits > 0) {
+        gif->codes[gif->codes_size++] = (Uint8)gif->bits;
+        gif->nbits = 0;
+    }
+    for (i = 0; i < gif->codes_size; i += count) {
+        count = SDL_min(gif->codes_size - i, 255);
+        if (truncated) {
+            PutTestGIFByte(gif, 255);
+        } else {
+            PutTestGIFByte(gif, (int)count);
+        }
+        SDL_memcpy(gif->data + gif->size, gif->codes + i, count);
+        gif->size += count;
+    }
+    if (!truncated) {
+        PutTestGIFByte(gif, 0);
+        PutTestGIFByte(gif, ';');
+    }
+}
+
+static SDL_Surface *
+LoadTestGIF(const TestGIF *gif)
+{
+    SDL_IOStream *src;
+    SDL_Surface *surface;
+
+    src = SDL_IOFromConstMem(gif->data, gif->size);
+    if (!src) {
+        return NULL;
+    }
+    surface = IMG_LoadGIF_IO(src);
+    SDL_CloseIO(src);
+    return surface;
+}
+
+static Uint8
+GetIndexedPixel(SDL_Surface *surface, int x, int y)
+{
+    return ((const Uint8 *)surface->pixels)[y * surface->pitch + x];
+}
+
+/* Checks that the first `count` pixels of an INDEX8 surface are `index` */
+static bool
+CheckIndexedPixels(SDL_Surface *surface, int count, Uint8 index)
+{
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        if (GetIndexedPixel(surface, i % surface->w, i / surface->w) != index) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int SDLCALL
+TestGIFCodeStreams(void *arg)
+{
+    SDL_Surface *surface;
+    TestGIF *gif;
+    int code;
+    (void)arg;
+
+    gif = (TestGIF *)SDL_malloc(sizeof(*gif));
+    if (!SDLTest_AssertCheck(gif != NULL, "Allocating the test GIF should succeed")) {
+        return TEST_ABORTED;
+    }
+
+    /* Each code is one pixel longer than the last, so the strings soon run
+     * past the end of a row, and then across several rows.
+     */
+    StartTestGIF(gif, 32, 32, 4);
+    AddTestGIFImage(gif, 0, 0, 32, 32, 2);
+    PutTestGIFCode(gif, 4);
+    PutTestGIFCode(gif, 1);
+    for (code = 6; code < 6 + 44; ++code) {
+        PutTestGIFCode(gif, code);
+    }
+    PutTestGIFCode(gif, 5);
+    FinishTestGIF(gif, false);
+    surface = LoadTestGIF(gif);
+    if (SDLTest_AssertCheck(surface != NULL,
+                            "Decoding strings longer than a row should succeed (%s)",
+                            SDL_GetError())) {
+        SDLTest_AssertCheck(surface->w == 32 && surface->h == 32,
+                            "Expected 32x32 image, got %dx%d", surface->w, surface->h);
+        SDLTest_AssertCheck(CheckIndexedPixels(surface, 32 * 32, 1),
+                            "Strings split across rows should be decoded in full");
+        SDL_DestroySurface(surface);
+    }
+
+    /* A code past the end of the table stops decoding, keeping what came before */
+    StartTestGIF(gif, 4, 1, 4);
+    AddTestGIFImage(gif, 0, 0, 4, 1, 2);
+    PutTestGIFCode(gif, 4);
+    PutTestGIFCode(gif, 1);
+    PutTestGIFCode(gif, 7);
+    PutTestGIFCode(gif, 1);
+    PutTestGIFCode(gif, 5);
+    FinishTestGIF(gif, false);
+    SDL_ClearError();
+    surface = LoadTestGIF(gif);
+    if (SDLTest_AssertCheck(surface != NULL,
+                            "Decoding an out of range code should return a partial image (%s)",
+                            SDL_GetError())) {
+        SDLTest_AssertCheck(GetIndexedPixel(surface, 0, 0) == 1 && GetIndexedPixel(surface, 1, 0) == 0,
+                            "Decoding should stop at the out of range code");
+        SDLTest_AssertCheck(SDL_strcmp(SDL_GetError(), "invalid LWZ data") == 0,
+                            "The out of range code should be reported (%s)", SDL_GetError());
+        SDL_DestroySurface(surface);
+    }
+
+    /* The first code after a clear has to be a literal */
+    StartTestGIF(gif, 4, 1, 4);
+    AddTestGIFImage(gif, 0, 0, 4, 1, 2);
+    PutTestGIFCode(gif, 4);
+    PutTestGIFCode(gif, 6);
+    PutTestGIFCode(gif, 5);
+    FinishTestGIF(gif, false);
+    SDL_ClearError();
+    surface = LoadTestGIF(gif);
+    if (SDLTest_AssertCheck(surface != NULL,
+                            "Decoding a string code after a clear should return a partial image (%s)",
+                            SDL_GetError())) {
+        SDLTest_AssertCheck(CheckIndexedPixels(surface, 4, 0),
+                            "Nothing should be decoded after the bad code");
+        SDL_DestroySurface(surface);
+    }
+
+    /* The data ends partway through a sub-block */
+    StartTestGIF(gif, 4, 4, 4);
+    AddTestGIFImage(gif, 0, 0, 4, 4, 2);
+    PutTestGIFCode(gif, 4);
+    PutTestGIFCode(gif, 1);
+    PutTestGIFCode(gif, 1);
+    PutTestGIFCode(gif, 1);
+    FinishTestGIF(gif, true);
+    SDL_ClearError();
+    surface = LoadTestGIF(gif);
+    if (SDLTest_AssertCheck(surface != NULL,
+                            "Decoding truncated data should return a partial image (%s)",
+                            SDL_GetError())) {
+        SDLTest_AssertCheck(surface->w == 4 && surface->h == 4,
+                            "Expected 4x4 image, got %dx%d", surface->w, surface->h);
+        SDLTest_AssertCheck(CheckIndexedPixels(surface, 3, 1),
+                            "The pixels before the end of the data should be decoded");
+        SDLTest_AssertCheck(SDL_strcmp(SDL_GetError(), "ran off the end of my bits") == 0,
+                            "The truncation should be reported (%s)", SDL_GetError());
+        SDL_DestroySurface(surface);
+    }
+
+    /* Codes can't be wider than 12 bits */
+    StartTestGIF(gif, 4, 1, 4);
+    AddTestGIFImage(gif, 0, 0, 4, 1, 13);
+    FinishTestGIF(gif, false);
+    surface = LoadTestGIF(gif);
+    SDLTest_AssertCheck(surface == NULL,
+                        "Decoding with an out of range code size should fail (%s)",
+                        SDL_GetError());
+    SDL_DestroySurface(surface);
+
+    SDL_free(gif);
+    return TEST_COMPLETED;
+}
+
+static int SDLCALL
+TestGIFScreen(void *arg)
+{
+    SDL_Surface *surface;
+    SDL_Palette *palette;
+    TestGIF *gif;
+    Uint32 colorkey = 0;
+    Uint8 r, g, b, a;
+    (void)arg;
+
+    gif = (TestGIF *)SDL_malloc(sizeof(*gif));
+    if (!SDLTest_AssertCheck(gif != NULL, "Allocating the test GIF should succeed")) {
+        return TEST_ABORTED;
+    }
+
+    /* A 2x2 image in the middle of a 4x4 screen, with no transparent color */
+    StartTestGIF(gif, 4, 4, 4);
+    AddTestGIFImage(gif, 1, 1, 2, 2, 2);
+    PutTestGIFCode(gif, 4);
+    PutTestGIFCode(gif, 1);
+    PutTestGIFCode(gif, 2);
+    PutTestGIFCode(gif, 1);
+    PutTestGIFCode(gif, 2);
+    PutTestGIFCode(gif, 5);
+    FinishTestGIF(gif, false);
+    surface = LoadTestGIF(gif);
+    if (SDLTest_AssertCheck(surface != NULL,
+                            "Loading a GIF smaller than its screen should succeed (%s)",
+                            SDL_GetError())) {
+        SDLTest_AssertCheck(surface->format == SDL_PIXELFORMAT_INDEX8,
+                            "Expected an INDEX8 surface, got %s", SDL_GetPixelFormatName(surface->format));
+        SDLTest_AssertCheck(surface->w == 4 && surface->h == 4,
+                            "Expected the 4x4 screen size, got %dx%d", surface->w, surface->h);
+        palette = SDL_GetSurfacePalette(surface);
+        SDLTest_AssertCheck(palette != NULL && palette->ncolors == 5,
+                            "The palette should have an extra color for the padding (%d colors)",
+                            palette ? palette->ncolors : 0);
+        SDLTest_AssertCheck(SDL_GetSurfaceColorKey(surface, &colorkey) && colorkey == 4,
+                            "The padding color should be the colorkey");
+        if (surface->format == SDL_PIXELFORMAT_INDEX8 && surface->w == 4 && surface->h == 4) {
+            SDLTest_AssertCheck(GetIndexedPixel(surface, 0, 0) == 4 && GetIndexedPixel(surface, 3, 3) == 4 &&
+                                GetIndexedPixel(surface, 3, 1) == 4 && GetIndexedPixel(surface, 1, 3) == 4,
+                                "The screen outside the image should be transparent");
+            SDLTest_AssertCheck(GetIndexedPixel(surface, 1, 1) == 1 && GetIndexedPixel(surface, 2, 1) == 2 &&
+                                GetIndexedPixel(surface, 1, 2) == 1 && GetIndexedPixel(surface, 2, 2) == 2,
+                                "The image should be at its offset on the screen");
+        }
+        SDL_DestroySurface(surface);
+    }
+
+    /* With all 256 colors in use there's none left for the padding */
+    StartTestGIF(gif, 4, 4, 256);
+    AddTestGIFImage(gif, 1, 1, 2, 2, 8);
+    PutTestGIFCode(gif, 256);
+    PutTestGIFCode(gif, 1);
+    PutTestGIFCode(gif, 2);
+    PutTestGIFCode(gif, 1);
+    PutTestGIFCode(gif, 2);
+    PutTestGIFCode(gif, 257);
+    FinishTestGIF(gif, false);
+    surface = LoadTestGIF(gif);
+    if (SDLTest_AssertCheck(surface != NULL,
+                            "Loading a 256 color GIF smaller than its screen should succeed (%s)",
+                            SDL_GetError())) {
+        SDLTest_AssertCheck(!SDL_ISPIXELFORMAT_INDEXED(surface->format) && SDL_ISPIXELFORMAT_ALPHA(surface->format),
+                            "Expected a surface with alpha, got %s", SDL_GetPixelFormatName(surface->format));
+        SDLTest_AssertCheck(surface->w == 4 && surface->h == 4,
+                            "Expected the 4x4 screen size, got %dx%d", surface->w, surface->h);
+        if (surface->w == 4 && surface->h == 4) {
+            SDLTest_AssertCheck(SDL_ReadSurfacePixel(surface, 0, 0, &r, &g, &b, &a) && a == 0,
+                                "The screen outside the image should be transparent");
+            SDLTest_AssertCheck(SDL_ReadSurfacePixel(surface, 2, 1, &r, &g, &b, &a) &&
+                                r == 2 && g == 253 && b == 128 && a == 255,
+                                "The image should be at its offset on the screen");
+        }
+        SDL_DestroySurface(surface);
+    }
+
+    SDL_free(gif);
+    return TEST_COMPLETED;
+}
+
+#endif /* !USING_IMAGEIO && LOAD_GIF */
+
 static const SDLTest_TestCaseReference formatsTestCase = {
     TestFormats, "Images", "Load and save various image formats", TEST_ENABLED
 };
 
+static const SDLTest_TestCaseReference loadBatchTestCase = {
+    TestLoadBatch, "LoadBatch", "Load many images in parallel", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference loadCachedTestCase = {
+    TestLoadCached, "LoadCached", "Load images through a cache", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference diskCacheTestCase = {
+    TestDiskCache, "DiskCache", "Load images through the disk cache", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference loadStatsTestCase = {
+    TestLoadStats, "LoadStats", "Collect per-load statistics", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference loadProgressTestCase = {
+    TestLoadProgress, "LoadProgress", "Cancel loads with a progress callback or a deadline", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference decodeLimitsTestCase = {
+    TestDecodeLimits, "DecodeLimits", "Refuse images over the decode limits", TEST_ENABLED
+};
+
+#if !USING_IMAGEIO && defined(LOAD_GIF)
+static const SDLTest_TestCaseReference gifCodeStreamsTestCase = {
+    TestGIFCodeStreams, "GIFCodeStreams", "Decode malformed and truncated GIF data", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference gifScreenTestCase = {
+    TestGIFScreen, "GIFScreen", "Load GIF images smaller than their screen", TEST_ENABLED
+};
+#endif
+
 static const SDLTest_TestCaseReference *testCases[] =  {
     &formatsTestCase,
+    &loadBatchTestCase,
+    &loadCachedTestCase,
+    &diskCacheTestCase,
+    &loadStatsTestCase,
+    &loadProgressTestCase,
+    &decodeLimitsTestCase,
+#if !USING_IMAGEIO && defined(LOAD_GIF)
+    &gifCodeStreamsTestCase,
+    &gifScreenTestCase,
+#endif
     NULL
 };
 static SDLTest_TestSuiteReference testSuite = {
@@ -1009,6 +2177,7 @@ main(int argc, char *argv[])
     }
 
     /* Shutdown everything */
+    IMG_QuitAsyncLoad();
     SDLTest_CommonQuit(state);
     return result;
 failure:
@@ -0,0 +1,203 @@
+/*
+  Copyright 1997-2025 Sam Lantinga
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+#include "testutils.h"
+
+#if defined(SDL_PLATFORM_OS2) || defined(SDL_PLATFORM_WIN32)
+static const char pathsep[] = "\\";
+#elif defined(SDL_PLATFORM_RISCOS)
+static const char pathsep[] = ".";
+#else
+static const char pathsep[] = "/";
+#endif
+
+/* Space in front of each allocation for its size, keeping the alignment of the real allocator */
+#define ALLOC_HEADER_SIZE   16
+
+static SDL_malloc_func real_malloc;
+static SDL_calloc_func real_calloc;
+static SDL_realloc_func real_realloc;
+static SDL_free_func real_free;
+static SDL_SpinLock alloc_lock;
+static size_t alloc_current;
+static size_t alloc_peak;
+static bool alloc_counting;
+static int alloc_count;
+static size_t alloc_bytes;
+
+char *
+GetTestFilename(TestFileType type, const char *file)
+{
+    const char *base;
+    char *path = NULL;
+    bool needPathSep = true;
+
+    if (type == TEST_FILE_DIST) {
+        base = SDL_getenv("SDL_TEST_SRCDIR");
+    } else {
+        base = SDL_getenv("SDL_TEST_BUILDDIR");
+    }
+
+    if (base == NULL) {
+        base = SDL_GetBasePath();
+        /* SDL_GetBasePath() guarantees a trailing path separator */
+        needPathSep = false;
+    }
+
+    if (base != NULL) {
+        size_t len = SDL_strlen(base) + SDL_strlen(pathsep) + SDL_strlen(file) + 1;
+
+        path = SDL_malloc(len);
+        if (path == NULL) {
+            return NULL;
+        }
+
+        if (needPathSep) {
+            SDL_snprintf(path, len, "%s%s%s", base, pathsep, file);
+        } else {
+            SDL_snprintf(path, len, "%s%s", base, file);
+        }
+    } else {
+        path = SDL_strdup(file);
+        if (path == NULL) {
+            return NULL;
+        }
+    }
+
+    return path;
+}
+
+static void AddAllocated(size_t added, size_t removed)
+{
+    SDL_LockSpinlock(&alloc_lock);
+    alloc_current = alloc_current + added - removed;
+    if (alloc_current > alloc_peak) {
+        alloc_peak = alloc_current;
+    }
+    if (alloc_counting && added > removed) {
+        ++alloc_count;
+        alloc_bytes += added - removed;
+    }
+    SDL_UnlockSpinlock(&alloc_lock);
+}
+
+static void *SDLCALL CountingMalloc(size_t size)
+{
+    Uint8 *mem;
+
+    if (size > SDL_SIZE_MAX - ALLOC_HEADER_SIZE) {
+        return NULL;
+    }
+    mem = (Uint8 *)real_malloc(ALLOC_HEADER_SIZE + size);
+    if (!mem) {
+        return NULL;
+    }
+    *(size_t *)mem = size;
+    AddAllocated(size, 0);
+    return mem + ALLOC_HEADER_SIZE;
+}
+
+static void *SDLCALL CountingCalloc(size_t nmemb, size_t size)
+{
+    Uint8 *mem;
+
+    if (size && nmemb > (SDL_SIZE_MAX - ALLOC_HEADER_SIZE) / size) {
+        return NULL;
+    }
+    size *= nmemb;
+    mem = (Uint8 *)real_calloc(1, ALLOC_HEADER_SIZE + size);
+    if (!mem) {
+        return NULL;
+    }
+    *(size_t *)mem = size;
+    AddAllocated(size, 0);
+    return mem + ALLOC_HEADER_SIZE;
+}
+
+static void *SDLCALL CountingRealloc(void *ptr, size_t size)
+{
+    Uint8 *mem;
+    size_t old_size;
+
+    if (!ptr) {
+        return CountingMalloc(size);
+    }
+    if (size > SDL_SIZE_MAX - ALLOC_HEADER_SIZE) {
+        return NULL;
+    }
+    mem = (Uint8 *)ptr - ALLOC_HEADER_SIZE;
+    old_size = *(size_t *)mem;
+    mem = (Uint8 *)real_realloc(mem, ALLOC_HEADER_SIZE + size);
+    if (!mem) {
+        return NULL;
+    }
+    *(size_t *)mem = size;
+    AddAllocated(size, old_size);
+    return mem + ALLOC_HEADER_SIZE;
+}
+
+static void SDLCALL CountingFree(void *ptr)
+{
+    Uint8 *mem;
+
+    if (!ptr) {
+        return;
+    }
+    mem = (Uint8 *)ptr - ALLOC_HEADER_SIZE;
+    AddAllocated(0, *(size_t *)mem);
+    real_free(mem);
+}
+
+bool InstallCountingAllocator(void)
+{
+    SDL_GetOriginalMemoryFunctions(&real_malloc, &real_calloc, &real_realloc, &real_free);
+    return SDL_SetMemoryFunctions(CountingMalloc, CountingCalloc, CountingRealloc, CountingFree);
+}
+
+void StartCountingAllocations(void)
+{
+    SDL_LockSpinlock(&alloc_lock);
+    alloc_counting = true;
+    alloc_count = 0;
+    alloc_bytes = 0;
+    SDL_UnlockSpinlock(&alloc_lock);
+}
+
+void StopCountingAllocations(int *count, size_t *bytes)
+{
+    SDL_LockSpinlock(&alloc_lock);
+    alloc_counting = false;
+    *count = alloc_count;
+    *bytes = alloc_bytes;
+    SDL_UnlockSpinlock(&alloc_lock);
+}
+
+size_t ResetPeakAllocated(void)
+{
+    size_t current;
+
+    SDL_LockSpinlock(&alloc_lock);
+    current = alloc_current;
+    alloc_peak = current;
+    SDL_UnlockSpinlock(&alloc_lock);
+    return current;
+}
+
+size_t GetPeakAllocated(void)
+{
+    size_t peak;
+
+    SDL_LockSpinlock(&alloc_lock);
+    peak = alloc_peak;
+    SDL_UnlockSpinlock(&alloc_lock);
+    return peak;
+}
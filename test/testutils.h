@@ -0,0 +1,50 @@
+/*
+  Copyright 1997-2025 Sam Lantinga
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Helpers shared by testalloc, benchimage and benchanimation */
+
+#ifndef TESTUTILS_H
+#define TESTUTILS_H
+
+#include <SDL3/SDL.h>
+
+typedef enum
+{
+    TEST_FILE_DIST,
+    TEST_FILE_BUILT
+} TestFileType;
+
+/*
+ * Return the absolute path to a resource file, like GetTestFilename()
+ * in testimage.c.
+ *
+ * Fails and returns NULL if out of memory.
+ */
+extern char *GetTestFilename(TestFileType type, const char *file);
+
+/* Replace the SDL allocator with one that keeps track of what is allocated.
+ * This has to be called before SDL allocates anything, returns false if the
+ * allocator couldn't be replaced.
+ */
+extern bool InstallCountingAllocator(void);
+
+/* Count the allocations made until StopCountingAllocations(). Growing an
+ * allocation with SDL_realloc() counts as an allocation of the added bytes.
+ */
+extern void StartCountingAllocations(void);
+extern void StopCountingAllocations(int *count, size_t *bytes);
+
+/* Start measuring the peak heap usage, returns the current usage */
+extern size_t ResetPeakAllocated(void);
+extern size_t GetPeakAllocated(void);
+
+#endif /* TESTUTILS_H */